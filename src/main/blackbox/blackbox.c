@@ -789,7 +789,7 @@ static void blackboxSetState(BlackboxState newState)
     blackboxState = newState;
 }
 
-static void writeIntraframe(void)
+STATIC_UNIT_TESTED void writeIntraframe(void)
 {
     blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
 
@@ -1019,7 +1019,7 @@ static void blackboxWriteArrayUsingAveragePredictor32(int arrOffsetInHistory, in
     }
 }
 
-static void writeInterframe(void)
+STATIC_UNIT_TESTED void writeInterframe(void)
 {
     blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
     blackboxMainState_t *blackboxLast = blackboxHistory[1];
@@ -1547,7 +1547,7 @@ static void writeGPSFrame(timeUs_t currentTimeUs)
 /**
  * Fill the current state of the blackbox using values read from the flight controller
  */
-static void loadMainState(timeUs_t currentTimeUs)
+STATIC_UNIT_TESTED void loadMainState(timeUs_t currentTimeUs)
 {
     blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
 
@@ -2024,7 +2024,7 @@ static bool blackboxShouldLogIFrame(void)
 }
 
 // Called once every FC loop in order to keep track of how many FC loop iterations have passed
-static void blackboxAdvanceIterationTimers(void)
+STATIC_UNIT_TESTED void blackboxAdvanceIterationTimers(void)
 {
     blackboxSlowFrameIterationTimer++;
     blackboxIteration++;
@@ -2037,7 +2037,7 @@ static void blackboxAdvanceIterationTimers(void)
 }
 
 // Called once every FC loop in order to log the current state
-static void blackboxLogIteration(timeUs_t currentTimeUs)
+STATIC_UNIT_TESTED void blackboxLogIteration(timeUs_t currentTimeUs)
 {
     // Write a keyframe every BLACKBOX_I_INTERVAL frames so we can resynchronise upon missing frames
     if (blackboxShouldLogIFrame()) {
@@ -2219,6 +2219,9 @@ void blackboxUpdate(timeUs_t currentTimeUs)
         break;
     }
 
+    // Header states and events write through the frame buffer as well
+    blackboxDeviceCommit();
+
     // Did we run out of room on the device? Stop!
     if (isBlackboxDeviceFull()) {
         blackboxSetState(BLACKBOX_STATE_STOPPED);
@@ -52,6 +52,8 @@ static uint8_t blackboxMaxHeaderBytesPerIteration;
 // How many bytes can we write *this* iteration without overflowing transmit buffers or overstressing the OpenLog?
 int32_t blackboxHeaderBudget;
 
+FASTRAM blackboxFrameBuffer_t blackboxFrameBuffer;
+
 STATIC_UNIT_TESTED serialPort_t *blackboxPort = NULL;
 #ifndef UNIT_TEST
 static portSharing_e blackboxPortSharing;
@@ -87,22 +89,41 @@ void blackboxOpen(void)
 }
 #endif // UNIT_TEST
 
-void blackboxWrite(uint8_t value)
+/**
+ * Hand everything collected in the frame buffer to the device with a single write.
+ */
+void blackboxDeviceCommit(void)
 {
+    const uint8_t *data = blackboxFrameBuffer.data;
+    const int length = blackboxFrameBuffer.length;
+
+    if (length == 0) {
+        return;
+    }
+
+    blackboxFrameBuffer.length = 0;
+
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
-        flashfsWriteByte(value); // Write byte asynchronously
+        flashfsWrite(data, length, false); // Write asynchronously
         break;
 #endif
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        afatfs_fputc(blackboxSDCard.logFile, value);
+        afatfs_fwrite(blackboxSDCard.logFile, data, length); // Ignore failures due to buffers filling up
         break;
 #endif
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        serialWrite(blackboxPort, value);
+        if (blackboxPort->vTable->writeBuf) {
+            serialWriteBuf(blackboxPort, data, length);
+        } else {
+            // serialWriteBuf() would spin on a full tx buffer if the driver has no bulk write
+            for (int i = 0; i < length; i++) {
+                serialWrite(blackboxPort, data[i]);
+            }
+        }
         break;
     }
 }
@@ -110,35 +131,18 @@ void blackboxWrite(uint8_t value)
 // Print the null-terminated string 's' to the blackbox device and return the number of bytes written
 int blackboxPrint(const char *s)
 {
-    int length;
-    const uint8_t *pos;
+    const int length = strlen(s);
 
-    switch (blackboxConfig()->device) {
+    for (int written = 0; written < length; ) {
+        const int chunk = MIN(length - written, BLACKBOX_FRAME_BUFFER_SIZE - blackboxFrameBuffer.length);
 
-#ifdef USE_FLASHFS
-    case BLACKBOX_DEVICE_FLASH:
-        length = strlen(s);
-        flashfsWrite((const uint8_t*) s, length, false); // Write asynchronously
-        break;
-#endif
+        memcpy(&blackboxFrameBuffer.data[blackboxFrameBuffer.length], s + written, chunk);
+        blackboxFrameBuffer.length += chunk;
+        written += chunk;
 
-#ifdef USE_SDCARD
-    case BLACKBOX_DEVICE_SDCARD:
-        length = strlen(s);
-        afatfs_fwrite(blackboxSDCard.logFile, (const uint8_t*) s, length); // Ignore failures due to buffers filling up
-        break;
-#endif
-
-    case BLACKBOX_DEVICE_SERIAL:
-    default:
-        pos = (uint8_t*) s;
-        while (*pos) {
-            serialWrite(blackboxPort, *pos);
-            pos++;
+        if (blackboxFrameBuffer.length >= BLACKBOX_FRAME_BUFFER_SIZE) {
+            blackboxDeviceCommit();
         }
-
-        length = pos - (uint8_t*) s;
-        break;
     }
 
     return length;
@@ -151,6 +155,8 @@ int blackboxPrint(const char *s)
  */
 void blackboxDeviceFlush(void)
 {
+    blackboxDeviceCommit();
+
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
         /*
@@ -174,6 +180,8 @@ void blackboxDeviceFlush(void)
  */
 bool blackboxDeviceFlushForce(void)
 {
+    blackboxDeviceCommit();
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         // Nothing to speed up flushing on serial, as serial is continuously being drained out of its buffer
@@ -279,6 +287,8 @@ bool blackboxDeviceOpen(void)
 #ifndef UNIT_TEST
 void blackboxDeviceClose(void)
 {
+    blackboxFrameBuffer.length = 0;
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         // Since the serial port could be shared with other processes, we have to give it back here
@@ -466,6 +476,8 @@ bool blackboxDeviceEndLog(bool retainLog)
     (void) retainLog;
 #endif
 
+    blackboxDeviceCommit();
+
     switch (blackboxConfig()->device) {
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
@@ -53,10 +53,31 @@ typedef enum {
  */
 #define BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION 64
 
+/*
+ * Everything written to the log is collected here and handed to the device in bulk, at the latest once per
+ * blackboxUpdate(), instead of dispatching every byte to the device driver.
+ */
+#define BLACKBOX_FRAME_BUFFER_SIZE 256
+
+typedef struct blackboxFrameBuffer_s {
+    uint8_t data[BLACKBOX_FRAME_BUFFER_SIZE];
+    uint16_t length;
+} blackboxFrameBuffer_t;
+
 extern int32_t blackboxHeaderBudget;
+extern blackboxFrameBuffer_t blackboxFrameBuffer;
 
 void blackboxOpen(void);
-void blackboxWrite(uint8_t value);
+void blackboxDeviceCommit(void);
+
+static inline void blackboxWrite(uint8_t value)
+{
+    blackboxFrameBuffer.data[blackboxFrameBuffer.length++] = value;
+
+    if (blackboxFrameBuffer.length >= BLACKBOX_FRAME_BUFFER_SIZE) {
+        blackboxDeviceCommit();
+    }
+}
 
 void blackboxDeviceFlush(void);
 bool blackboxDeviceFlushForce(void);
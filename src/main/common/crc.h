@@ -21,6 +21,8 @@
 
 struct sbuf_s;
 
+void crcInit(void);
+
 uint16_t crc16_ccitt(uint16_t crc, unsigned char a);
 uint16_t crc16_ccitt_update(uint16_t crc, const void *data, uint32_t length);
 void crc16_ccitt_sbuf_append(struct sbuf_s *dst, uint8_t *start);
@@ -42,6 +42,12 @@ float nullFilterApply4(void *filter, float input, float f_cut, float dt)
     return input;
 }
 
+void nullFilter3Apply(void *filter, float *samples)
+{
+    UNUSED(filter);
+    UNUSED(samples);
+}
+
 // PT1 Low Pass filter
 
 static float pt1ComputeRC(const float f_cut)
@@ -108,6 +114,32 @@ void pt1FilterReset(pt1Filter_t *filter, float input)
     filter->state = input;
 }
 
+void pt1Filter3Init(pt1Filter3_t *filter, float f_cut, float dT)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->state[axis] = 0.0f;
+    }
+    filter->RC = pt1ComputeRC(f_cut);
+    filter->dT = dT;
+    filter->alpha = filter->dT / (filter->RC + filter->dT);
+}
+
+void pt1Filter3UpdateCutoff(pt1Filter3_t *filter, float f_cut)
+{
+    filter->RC = pt1ComputeRC(f_cut);
+    filter->alpha = filter->dT / (filter->RC + filter->dT);
+}
+
+void FAST_CODE NOINLINE pt1Filter3Apply(pt1Filter3_t *filter, float *samples)
+{
+    const float alpha = filter->alpha;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        filter->state[axis] = filter->state[axis] + alpha * (samples[axis] - filter->state[axis]);
+        samples[axis] = filter->state[axis];
+    }
+}
+
 /*
  * PT2 LowPassFilter
  */
@@ -316,6 +348,87 @@ FAST_CODE void biquadFilterUpdate(biquadFilter_t *filter, float filterFreq, uint
     filter->y2 = y2;
 }
 
+static void biquadFilter3SetCoefficients(biquadFilter3_t *filter, int axis, const biquadFilter_t *coeffs)
+{
+    filter->b0[axis] = coeffs->b0;
+    filter->b1[axis] = coeffs->b1;
+    filter->b2[axis] = coeffs->b2;
+    filter->a1[axis] = coeffs->a1;
+    filter->a2[axis] = coeffs->a2;
+}
+
+void biquadFilter3Init(biquadFilter3_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t coeffs;
+    biquadFilterInit(&coeffs, filterFreq, samplingIntervalUs, Q, filterType);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilter3SetCoefficients(filter, axis, &coeffs);
+        filter->x1[axis] = filter->x2[axis] = 0;
+        filter->y1[axis] = filter->y2[axis] = 0;
+    }
+}
+
+void biquadFilter3InitLPF(biquadFilter3_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs)
+{
+    biquadFilter3Init(filter, filterFreq, samplingIntervalUs, BIQUAD_Q, FILTER_LPF);
+}
+
+// Coefficients are computed once and shared by all axes, filter state is kept
+FAST_CODE void biquadFilter3Update(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t coeffs;
+    biquadFilterInit(&coeffs, filterFreq, refreshRate, Q, filterType);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilter3SetCoefficients(filter, axis, &coeffs);
+    }
+}
+
+FAST_CODE void biquadFilter3UpdateAxis(biquadFilter3_t *filter, int axis, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t coeffs;
+    biquadFilterInit(&coeffs, filterFreq, refreshRate, Q, filterType);
+    biquadFilter3SetCoefficients(filter, axis, &coeffs);
+}
+
+// Direct form 2 transposed, same as biquadFilterApply()
+void FAST_CODE NOINLINE biquadFilter3Apply(biquadFilter3_t *filter, float *samples)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float input = samples[axis];
+        const float result = filter->b0[axis] * input + filter->x1[axis];
+        filter->x1[axis] = filter->b1[axis] * input - filter->a1[axis] * result + filter->x2[axis];
+        filter->x2[axis] = filter->b2[axis] * input - filter->a2[axis] * result;
+        samples[axis] = result;
+    }
+}
+
+// Direct form 1, same as biquadFilterApplyDF1(). Better suited to filters with frequently updated coefficients
+void FAST_CODE biquadFilter3ApplyDF1(biquadFilter3_t *filter, float *samples)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float input = samples[axis];
+        const float result = filter->b0[axis] * input + filter->b1[axis] * filter->x1[axis] + filter->b2[axis] * filter->x2[axis]
+                             - filter->a1[axis] * filter->y1[axis] - filter->a2[axis] * filter->y2[axis];
+
+        filter->x2[axis] = filter->x1[axis];
+        filter->x1[axis] = input;
+        filter->y2[axis] = filter->y1[axis];
+        filter->y1[axis] = result;
+
+        samples[axis] = result;
+    }
+}
+
+// Cascade of DF1 filters, e.g. a notch bank
+void FAST_CODE NOINLINE biquadFilter3BankApplyDF1(biquadFilter3_t *filters, unsigned count, float *samples)
+{
+    for (unsigned i = 0; i < count; i++) {
+        biquadFilter3ApplyDF1(&filters[i], samples);
+    }
+}
+
 void initFilter(const uint8_t filterType, filter_t *filter, const float cutoffFrequency, const uint32_t refreshRate) {
     const float dT = US2S(refreshRate);
 
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/axis.h"
+
 typedef struct rateLimitFilter_s {
     float state;
 } rateLimitFilter_t;
@@ -52,6 +54,28 @@ typedef union {
     pt3Filter_t pt3;
 } filter_t;
 
+/*
+ * X/Y/Z filters applied in a single call. State and coefficients are stored
+ * as per axis arrays (structure of arrays) so the axis loop can be pipelined
+ * by the FPU or vectorized on the host.
+ */
+typedef struct pt1Filter3_s {
+    float state[XYZ_AXIS_COUNT];
+    float RC;
+    float dT;
+    float alpha;
+} pt1Filter3_t;
+
+typedef struct biquadFilter3_s {
+    float b0[XYZ_AXIS_COUNT], b1[XYZ_AXIS_COUNT], b2[XYZ_AXIS_COUNT], a1[XYZ_AXIS_COUNT], a2[XYZ_AXIS_COUNT];
+    float x1[XYZ_AXIS_COUNT], x2[XYZ_AXIS_COUNT], y1[XYZ_AXIS_COUNT], y2[XYZ_AXIS_COUNT];
+} biquadFilter3_t;
+
+typedef union {
+    biquadFilter3_t biquad;
+    pt1Filter3_t pt1;
+} filter3_t;
+
 typedef enum {
     FILTER_PT1 = 0,
     FILTER_BIQUAD,
@@ -85,12 +109,14 @@ typedef struct alphaBetaGammaFilter_s {
 
 typedef float (*filterApplyFnPtr)(void *filter, float input);
 typedef float (*filterApply4FnPtr)(void *filter, float input, float f_cut, float dt);
+typedef void (*filter3ApplyFnPtr)(void *filter, float *samples);
 
 #define BIQUAD_BANDWIDTH 1.9f     /* bandwidth in octaves */
 #define BIQUAD_Q 1.0f / sqrtf(2.0f)     /* quality factor - butterworth*/
 
 float nullFilterApply(void *filter, float input);
 float nullFilterApply4(void *filter, float input, float f_cut, float dt);
+void nullFilter3Apply(void *filter, float *samples);
 
 void pt1FilterInit(pt1Filter_t *filter, float f_cut, float dT);
 void pt1FilterInitRC(pt1Filter_t *filter, float tau, float dT);
@@ -130,6 +156,21 @@ float biquadFilterApplyDF1(biquadFilter_t *filter, float input);
 float filterGetNotchQ(float centerFrequencyHz, float cutoffFrequencyHz);
 void biquadFilterUpdate(biquadFilter_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
 
+/*
+ * 3-axis filters, samples are filtered in place
+ */
+void pt1Filter3Init(pt1Filter3_t *filter, float f_cut, float dT);
+void pt1Filter3UpdateCutoff(pt1Filter3_t *filter, float f_cut);
+void pt1Filter3Apply(pt1Filter3_t *filter, float *samples);
+
+void biquadFilter3Init(biquadFilter3_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs, float Q, biquadFilterType_e filterType);
+void biquadFilter3InitLPF(biquadFilter3_t *filter, uint16_t filterFreq, uint32_t samplingIntervalUs);
+void biquadFilter3Update(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+void biquadFilter3UpdateAxis(biquadFilter3_t *filter, int axis, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+void biquadFilter3Apply(biquadFilter3_t *filter, float *samples);
+void biquadFilter3ApplyDF1(biquadFilter3_t *filter, float *samples);
+void biquadFilter3BankApplyDF1(biquadFilter3_t *filters, unsigned count, float *samples);
+
 void alphaBetaGammaFilterInit(alphaBetaGammaFilter_t *filter, float alpha, float boostGain, float halfLife, float dT);
 float alphaBetaGammaFilterApply(alphaBetaGammaFilter_t *filter, float input);
 
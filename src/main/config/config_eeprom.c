@@ -30,6 +30,7 @@
 #include "config/config_eeprom.h"
 #include "config/config_streamer.h"
 #include "config/parameter_group.h"
+#include "config/parameter_group_ids.h"
 
 #include "drivers/system.h"
 #include "drivers/flash.h"
@@ -76,6 +77,24 @@ typedef struct {
 } PG_PACKED configFooter_t;
 // checksum is appended just after footer. It is not included in footer to make checksum calculation consistent
 
+/*
+ * The config area holds a full copy of the config (header, records, footer
+ * and checksum) followed by segments (records, footer and checksum) appended
+ * by later saves with only the PG instances that changed. Each copy starts at
+ * a streamer write boundary and the latest record of a PG instance wins.
+ * The checksum of a segment is seeded with the one of the copy before it and
+ * every full copy carries a generation record, so segments left behind by an
+ * earlier full copy never validate. When the erased space after the last copy
+ * runs out, the next save writes a new full copy.
+ */
+#define CONFIG_GENERATION_PGN   PG_ID_INVALID
+
+typedef struct {
+    const uint8_t *end;     // end of the last valid copy
+    uint16_t checksum;      // checksum of the last valid copy, seeds the next segment
+    uint16_t generation;    // of the full copy
+} configStore_t;
+
 // Used to check the compiler packing at build time.
 typedef struct {
     uint8_t byte;
@@ -129,21 +148,20 @@ void initEEPROM(void)
 #endif
 }
 
-// Scan the EEPROM config. Returns true if the config is valid.
-bool isEEPROMContentValid(void)
+// Checks the records, footer and checksum of a copy of the config. crc holds
+// the checksum the copy is seeded with and gets its checksum. Returns the end
+// of the copy or NULL if it's not valid.
+static const uint8_t *scanConfigCopy(const uint8_t *p, uint16_t *crc, uint16_t *generation)
 {
-    const uint8_t *p = &__config_start;
-    const configHeader_t *header = (const configHeader_t *)p;
-
-    if (header->format != EEPROM_CONF_VERSION) {
-        return false;
-    }
-    uint16_t crc = crc16_ccitt_update(0, header, sizeof(*header));
-    p += sizeof(*header);
+    uint16_t copyCrc = *crc;
 
     for (;;) {
         const configRecord_t *record = (const configRecord_t *)p;
 
+        if (p + sizeof(configFooter_t) > &__config_end) {
+            return NULL;
+        }
+
         if (record->size == 0) {
             // Found the end.  Stop scanning.
             break;
@@ -151,166 +169,354 @@ bool isEEPROMContentValid(void)
 
         if (p + sizeof(*record) >= &__config_end) {
             // Too big. Further checking for size doesn't make sense
-            return false;
+            return NULL;
         }
 
         if (p + record->size >= &__config_end || record->size < sizeof(*record)) {
             // Too big or too small.
-            return false;
+            return NULL;
+        }
+
+        if (generation && record->pgn == CONFIG_GENERATION_PGN && record->size == sizeof(*record) + sizeof(*generation)) {
+            memcpy(generation, record->pg, sizeof(*generation));
         }
 
-        crc = crc16_ccitt_update(crc, p, record->size);
+        copyCrc = crc16_ccitt_update(copyCrc, p, record->size);
 
         p += record->size;
     }
 
+    if (p + sizeof(configFooter_t) + sizeof(uint16_t) > &__config_end) {
+        return NULL;
+    }
     const configFooter_t *footer = (const configFooter_t *)p;
-    crc = crc16_ccitt_update(crc, footer, sizeof(*footer));
+    copyCrc = crc16_ccitt_update(copyCrc, footer, sizeof(*footer));
     p += sizeof(*footer);
     const uint16_t checkSum = *(uint16_t *)p;
     p += sizeof(checkSum);
-    eepromConfigSize = p - &__config_start;
-    return crc == checkSum;
+
+    if (copyCrc != checkSum) {
+        return NULL;
+    }
+    *crc = copyCrc;
+    return p;
 }
 
-uint16_t getEEPROMConfigSize(void)
+// Copies start at a streamer write boundary, so a segment never shares a
+// flash word with what was written before it
+static const uint8_t *alignConfigCopy(const uint8_t *p)
 {
-    return eepromConfigSize;
+    const uintptr_t offset = p - &__config_start;
+    return &__config_start + (offset + CONFIG_STREAMER_BUFFER_SIZE - 1) / CONFIG_STREAMER_BUFFER_SIZE * CONFIG_STREAMER_BUFFER_SIZE;
 }
 
-// find config record for reg + classification (profile info) in EEPROM
-// return NULL when record is not found
-// this function assumes that EEPROM content is valid
-static const configRecord_t *findEEPROM(const pgRegistry_t *reg, configRecordFlags_e classification)
+// Scan the EEPROM config: the full copy and the segments appended after it,
+// up to the first one that doesn't validate. Returns true if the config is valid.
+static bool scanConfigStore(configStore_t *store)
 {
     const uint8_t *p = &__config_start;
-    p += sizeof(configHeader_t);             // skip header
-    while (true) {
-        const configRecord_t *record = (const configRecord_t *)p;
-        // Ensure that the record header fits into config memory, otherwise accessing size and flags may cause a hardfault.
-        if (p + sizeof(*record) >= &__config_end) {
+    const configHeader_t *header = (const configHeader_t *)p;
+
+    if (header->format != EEPROM_CONF_VERSION) {
+        return false;
+    }
+    uint16_t crc = crc16_ccitt_update(0, header, sizeof(*header));
+    p += sizeof(*header);
+
+    store->generation = 0;
+    p = scanConfigCopy(p, &crc, &store->generation);
+    if (!p) {
+        return false;
+    }
+
+    for (;;) {
+        const uint8_t *segment = alignConfigCopy(p);
+        if (segment + sizeof(configFooter_t) > &__config_end || ((const configRecord_t *)segment)->size == 0) {
             break;
         }
 
-        // Check that record header makes sense
-        if (record->size == 0 || p + record->size >= &__config_end || record->size < sizeof(*record)) {
+        uint16_t segmentCrc = crc;
+        const uint8_t *segmentEnd = scanConfigCopy(segment, &segmentCrc, NULL);
+        if (!segmentEnd) {
+            // Erased, partially written or left over from an earlier full copy
             break;
         }
+        crc = segmentCrc;
+        p = segmentEnd;
+    }
+
+    store->end = p;
+    store->checksum = crc;
+    return true;
+}
+
+bool isEEPROMContentValid(void)
+{
+    configStore_t store;
+    if (!scanConfigStore(&store)) {
+        return false;
+    }
+    eepromConfigSize = store.end - &__config_start;
+    return true;
+}
+
+uint16_t getEEPROMConfigSize(void)
+{
+    return eepromConfigSize;
+}
+
+// Walks the records of all the copies in storage order, returns NULL after the
+// last one. This function assumes that the store has been scanned as valid.
+static const configRecord_t *nextConfigRecord(const configStore_t *store, const configRecord_t *record)
+{
+    const uint8_t *p = record ? (const uint8_t *)record + record->size : &__config_start + sizeof(configHeader_t);
+    if (((const configRecord_t *)p)->size == 0) {
+        // End of this copy, continue with the segment after it
+        p = alignConfigCopy(p + sizeof(configFooter_t) + sizeof(uint16_t));
+        if (p >= store->end) {
+            return NULL;
+        }
+    }
+    return (const configRecord_t *)p;
+}
 
-        // Check if this is the record we're looking for (check for size)
+// find the latest config record for reg + classification (profile info) in EEPROM
+// return NULL when record is not found
+static const configRecord_t *findEEPROM(const configStore_t *store, const pgRegistry_t *reg, configRecordFlags_e classification)
+{
+    const configRecord_t *found = NULL;
+    for (const configRecord_t *record = nextConfigRecord(store, NULL); record; record = nextConfigRecord(store, record)) {
         if (pgN(reg) == record->pgn && (record->flags & CR_CLASSIFICATION_MASK) == classification) {
-            return record;
+            found = record;
         }
+    }
+    return found;
+}
 
-        p += record->size;
+// Records are written in registry order, so the PG of a record is almost
+// always the one of the record before it or the next one in the registry
+static const pgRegistry_t *findRecordPg(const pgRegistry_t *hint, pgn_t pgn)
+{
+    if (hint) {
+        if (pgN(hint) == pgn) {
+            return hint;
+        }
+        if (hint + 1 < __pg_registry_end && pgN(hint + 1) == pgn) {
+            return hint + 1;
+        }
     }
-    // record not found
-    return NULL;
+    return pgFind(pgn);
+}
+
+static int configRecordProfileCount(const pgRegistry_t *reg)
+{
+    return pgIsSystem(reg) ? 1 : CR_CLASSICATION_PROFILE_LAST - CR_CLASSICATION_PROFILE1 + 1;
+}
+
+static configRecordFlags_e configRecordClassification(const pgRegistry_t *reg, int profileIndex)
+{
+    return pgIsSystem(reg) ? CR_CLASSICATION_SYSTEM : CR_CLASSICATION_PROFILE1 + profileIndex;
 }
 
 // Initialize all PG records from EEPROM.
-// This functions processes all PGs sequentially, scanning EEPROM for each one. This is suboptimal,
-//   but each PG is loaded/initialized exactly once and in defined order.
+// All PGs are reset and then every stored record is loaded in a single pass in
+// storage order, so the latest copy of each PG wins. pgLoad will handle version mismatch.
 bool loadEEPROM(void)
 {
     PG_FOREACH(reg) {
-        configRecordFlags_e cls_start, cls_end;
-        if (pgIsSystem(reg)) {
-            cls_start = CR_CLASSICATION_SYSTEM;
-            cls_end = CR_CLASSICATION_SYSTEM;
-        } else {
-            cls_start = CR_CLASSICATION_PROFILE1;
-            cls_end = CR_CLASSICATION_PROFILE_LAST;
+        for (int profileIndex = 0; profileIndex < configRecordProfileCount(reg); profileIndex++) {
+            pgReset(reg, profileIndex);
         }
-        for (configRecordFlags_e cls = cls_start; cls <= cls_end; cls++) {
-            int profileIndex = cls - cls_start;
-            const configRecord_t *rec = findEEPROM(reg, cls);
-            if (rec) {
-                // config from EEPROM is available, use it to initialize PG. pgLoad will handle version mismatch
-                pgLoad(reg, profileIndex, rec->pg, rec->size - offsetof(configRecord_t, pg), rec->version);
-            } else {
-                pgReset(reg, profileIndex);
-            }
+    }
+
+    configStore_t store;
+    if (!scanConfigStore(&store)) {
+        return true;
+    }
+
+    const pgRegistry_t *hint = NULL;
+    for (const configRecord_t *record = nextConfigRecord(&store, NULL); record; record = nextConfigRecord(&store, record)) {
+        const pgRegistry_t *reg = findRecordPg(hint, record->pgn);
+        if (!reg) {
+            continue;
+        }
+        hint = reg;
+
+        const int profileIndex = (record->flags & CR_CLASSIFICATION_MASK) - configRecordClassification(reg, 0);
+        if (profileIndex < 0 || profileIndex >= configRecordProfileCount(reg)) {
+            continue;
         }
+        pgLoad(reg, profileIndex, record->pg, record->size - offsetof(configRecord_t, pg), record->version);
+    }
+    return true;
+}
+
+static bool writeConfigData(config_streamer_t *streamer, uint16_t *crc, const void *data, uint16_t size)
+{
+    if (config_streamer_write(streamer, data, size) < 0) {
+        return false;
     }
+    *crc = crc16_ccitt_update(*crc, data, size);
     return true;
 }
 
-static bool writeSettingsToEEPROM(void)
+static bool writeConfigRecord(config_streamer_t *streamer, uint16_t *crc, const pgRegistry_t *reg, int profileIndex)
+{
+    const uint16_t regSize = pgSize(reg);
+    const configRecord_t record = {
+        .size = sizeof(configRecord_t) + regSize,
+        .pgn = pgN(reg),
+        .version = pgVersion(reg),
+        .flags = configRecordClassification(reg, profileIndex),
+    };
+
+    return writeConfigData(streamer, crc, &record, sizeof(record)) &&
+        writeConfigData(streamer, crc, reg->address + (regSize * profileIndex), regSize);
+}
+
+// Footer and checksum close each copy
+static bool finishConfigCopy(config_streamer_t *streamer, uint16_t crc)
+{
+    const configFooter_t footer = {
+        .terminator = 0,
+    };
+
+    if (!writeConfigData(streamer, &crc, &footer, sizeof(footer))) {
+        return false;
+    }
+
+    // append checksum now
+    if (config_streamer_write(streamer, (uint8_t *)&crc, sizeof(crc)) < 0) {
+        return false;
+    }
+
+    if (config_streamer_flush(streamer) < 0) {
+        return false;
+    }
+
+    return config_streamer_finish(streamer) == 0;
+}
+
+// Writes a full copy of the config from the start of the config area, dropping
+// all appended segments
+static bool writeSettingsToEEPROM(uint16_t generation)
 {
     config_streamer_t streamer;
     config_streamer_init(&streamer);
 
     config_streamer_start(&streamer, (uintptr_t)&__config_start, &__config_end - &__config_start);
 
-    configHeader_t header = {
+    const configHeader_t header = {
         .format = EEPROM_CONF_VERSION,
     };
+    uint16_t crc = 0;
+    if (!writeConfigData(&streamer, &crc, &header, sizeof(header))) {
+        return false;
+    }
 
-    if (config_streamer_write(&streamer, (uint8_t *)&header, sizeof(header)) < 0) {
+    // Makes the checksum of each full copy unique, so segments appended to an
+    // earlier one never validate against it
+    const configRecord_t generationRecord = {
+        .size = sizeof(configRecord_t) + sizeof(generation),
+        .pgn = CONFIG_GENERATION_PGN,
+    };
+    if (!writeConfigData(&streamer, &crc, &generationRecord, sizeof(generationRecord)) ||
+        !writeConfigData(&streamer, &crc, &generation, sizeof(generation))) {
         return false;
     }
-    uint16_t crc = crc16_ccitt_update(0, (uint8_t *)&header, sizeof(header));
+
     PG_FOREACH(reg) {
-        const uint16_t regSize = pgSize(reg);
-        configRecord_t record = {
-            .size = sizeof(configRecord_t) + regSize,
-            .pgn = pgN(reg),
-            .version = pgVersion(reg),
-            .flags = 0
-        };
-
-        if (pgIsSystem(reg)) {
-            // write the only instance
-            record.flags |= CR_CLASSICATION_SYSTEM;
-            if (config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record)) < 0) {
-                return false;
-            }
-            crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
-            if (config_streamer_write(&streamer, reg->address, regSize) < 0) {
+        for (int profileIndex = 0; profileIndex < configRecordProfileCount(reg); profileIndex++) {
+            if (!writeConfigRecord(&streamer, &crc, reg, profileIndex)) {
                 return false;
             }
-            crc = crc16_ccitt_update(crc, reg->address, regSize);
-        } else {
-            // write one instance for each profile
-            for (uint8_t profileIndex = 0; profileIndex < MAX_PROFILE_COUNT; profileIndex++) {
-                record.flags = 0;
-
-                record.flags |= ((profileIndex + 1) & CR_CLASSIFICATION_MASK);
-                if (config_streamer_write(&streamer, (uint8_t *)&record, sizeof(record)) < 0) {
-                    return false;
-                }
-                crc = crc16_ccitt_update(crc, (uint8_t *)&record, sizeof(record));
-                const uint8_t *address = reg->address + (regSize * profileIndex);
-                if (config_streamer_write(&streamer, address, regSize) < 0) {
-                    return false;
-                }
-                crc = crc16_ccitt_update(crc, address, regSize);
+        }
+    }
+
+    return finishConfigCopy(&streamer, crc);
+}
+
+static bool configRecordChanged(const configStore_t *store, const pgRegistry_t *reg, int profileIndex)
+{
+    const configRecord_t *record = findEEPROM(store, reg, configRecordClassification(reg, profileIndex));
+    const uint16_t regSize = pgSize(reg);
+
+    return !record || record->size != sizeof(configRecord_t) + regSize || record->version != pgVersion(reg) ||
+        memcmp(record->pg, reg->address + (regSize * profileIndex), regSize) != 0;
+}
+
+static bool isConfigAreaErased(const uint8_t *p, int size)
+{
+    for (int ii = 0; ii < size; ii++) {
+        if (p[ii] != CONFIG_STREAMER_ERASED_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Appends a segment with the PG instances that differ from their latest stored
+// record. Returns false if the segment doesn't fit after the last copy or it
+// couldn't be written, in which case a new full copy is needed.
+static bool appendSettingsToEEPROM(const configStore_t *store)
+{
+    int changedSize = 0;
+    PG_FOREACH(reg) {
+        for (int profileIndex = 0; profileIndex < configRecordProfileCount(reg); profileIndex++) {
+            if (configRecordChanged(store, reg, profileIndex)) {
+                changedSize += sizeof(configRecord_t) + pgSize(reg);
             }
         }
     }
 
-    configFooter_t footer = {
-        .terminator = 0,
-    };
+    if (changedSize == 0) {
+        // Nothing to write
+        return true;
+    }
 
-    if (config_streamer_write(&streamer, (uint8_t *)&footer, sizeof(footer)) < 0) {
+    // Streamers erase pages as they enter them and the rest of the page after
+    // the last copy was erased along with it, unless an append was interrupted.
+    // That leaves data at the start of the segment. A segment starting a page
+    // gets it erased, whatever an earlier full copy left in it.
+    const uint8_t *segment = alignConfigCopy(store->end);
+    const uint8_t *segmentEnd = alignConfigCopy(segment + changedSize + sizeof(configFooter_t) + sizeof(uint16_t));
+    if (segmentEnd > &__config_end) {
         return false;
     }
-    crc = crc16_ccitt_update(crc, (uint8_t *)&footer, sizeof(footer));
-
-    // append checksum now
-    if (config_streamer_write(&streamer, (uint8_t *)&crc, sizeof(crc)) < 0) {
+    if (!config_streamer_is_page_start((uintptr_t)segment) && !isConfigAreaErased(segment, CONFIG_STREAMER_BUFFER_SIZE)) {
         return false;
     }
 
-    if (config_streamer_flush(&streamer) < 0) {
-        return false;
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
+
+    config_streamer_start(&streamer, (uintptr_t)segment, &__config_end - segment);
+
+    uint16_t crc = store->checksum;
+    PG_FOREACH(reg) {
+        for (int profileIndex = 0; profileIndex < configRecordProfileCount(reg); profileIndex++) {
+            if (configRecordChanged(store, reg, profileIndex) && !writeConfigRecord(&streamer, &crc, reg, profileIndex)) {
+                return false;
+            }
+        }
     }
 
-    bool success = config_streamer_finish(&streamer) == 0;
+    return finishConfigCopy(&streamer, crc);
+}
 
-    return success;
+static bool saveSettingsToEEPROM(void)
+{
+    configStore_t store;
+    uint16_t generation = 0;
+
+    if (scanConfigStore(&store)) {
+        if (appendSettingsToEEPROM(&store)) {
+            return true;
+        }
+        generation = store.generation + 1;
+    }
+
+    return writeSettingsToEEPROM(generation);
 }
 
 void writeConfigToEEPROM(void)
@@ -318,7 +524,7 @@ void writeConfigToEEPROM(void)
     bool success = false;
     // write it
     for (int attempt = 0; attempt < 3 && !success; attempt++) {
-        if (writeSettingsToEEPROM()) {
+        if (saveSettingsToEEPROM()) {
             success = true;
 #ifdef CONFIG_IN_EXTERNAL_FLASH
             // copy it back from flash to the in-memory buffer.
@@ -29,6 +29,7 @@ SLOW_RAM uint8_t eepromData[EEPROM_SIZE];
 extern void config_streamer_impl_unlock(void);
 extern void config_streamer_impl_lock(void);
 extern int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer);
+extern bool config_streamer_impl_is_page_start(uintptr_t address);
 
 void config_streamer_init(config_streamer_t *c)
 {
@@ -37,7 +38,8 @@ void config_streamer_init(config_streamer_t *c)
 
 void config_streamer_start(config_streamer_t *c, uintptr_t base, int size)
 {
-    // base must start at FLASH_PAGE_SIZE boundary when using embedded flash.
+    // base must be aligned to the streamer buffer size. Pages are erased as the streamer
+    // enters them, so a base inside a page must only be followed by erased space in it.
     c->address = base;
     c->size = size;
     c->end = base + size;
@@ -66,6 +68,12 @@ int config_streamer_write(config_streamer_t *c, const uint8_t *p, uint32_t size)
     return c->err;
 }
 
+// Returns true if the streamer erases the page starting at address when it enters it
+bool config_streamer_is_page_start(uintptr_t address)
+{
+    return config_streamer_impl_is_page_start(address);
+}
+
 int config_streamer_status(config_streamer_t *c)
 {
     return c->err;
@@ -36,6 +36,13 @@ typedef uint64_t config_streamer_buffer_align_type_t;
 typedef uint32_t config_streamer_buffer_align_type_t;
 #endif
 
+// Value of config storage that can be written without erasing it first
+#if defined(CONFIG_IN_RAM)
+#define CONFIG_STREAMER_ERASED_BYTE 0x00
+#else
+#define CONFIG_STREAMER_ERASED_BYTE 0xFF
+#endif
+
 typedef struct config_streamer_s {
     uintptr_t address;
     uintptr_t end;
@@ -57,6 +64,7 @@ int config_streamer_flush(config_streamer_t *c);
 
 int config_streamer_finish(config_streamer_t *c);
 int config_streamer_status(config_streamer_t *c);
+bool config_streamer_is_page_start(uintptr_t address);
 
 #if defined(CONFIG_IN_FILE)
 bool configFileSetPath(char* path);
@@ -40,13 +40,18 @@ void config_streamer_impl_lock(void)
     flash_lock();
 }
 
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return address % FLASH_PAGE_SIZE == 0;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (c->err != 0) {
         return c->err;
     }
     // Erases sectors from the start address
-    if (c->address % FLASH_PAGE_SIZE == 0) {
+    if (config_streamer_impl_is_page_start(c->address)) {
         const flash_status_type status =flash_sector_erase(c->address);
 		   if (status != FLASH_OPERATE_DONE) {
 			   return -1;
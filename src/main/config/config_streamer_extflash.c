@@ -39,6 +39,12 @@ void config_streamer_impl_lock(void)
     streamerLocked = true;
 }
 
+// The config partition starts on a sector boundary
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return (address - (uintptr_t)&eepromData[0]) % flashGetGeometry()->sectorSize == 0;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (streamerLocked) {
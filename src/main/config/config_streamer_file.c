@@ -95,6 +95,11 @@ void config_streamer_impl_lock(void)
     }
 }
 
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return (address - (uintptr_t)eepromData) % FLASH_PAGE_SIZE == 0;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (streamerLocked) {
@@ -102,6 +107,10 @@ int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer
     }
 
     if ((c->address >= (uintptr_t)eepromData) && (c->address < (uintptr_t)ARRAYEND(eepromData))) {
+        // Erase pages as they are entered, like the flash streamers do
+        if (config_streamer_impl_is_page_start(c->address)) {
+            memset((void *)c->address, CONFIG_STREAMER_ERASED_BYTE, FLASH_PAGE_SIZE);
+        }
         *((uint32_t*)c->address) = *buffer;
         fprintf(stderr, "[EEPROM] Program word  %p = %08x\n", (void*)c->address, *((uint32_t*)c->address));
     } else {
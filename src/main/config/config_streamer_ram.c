@@ -34,13 +34,19 @@ void config_streamer_impl_lock(void)
     streamerLocked = true;
 }
 
+// The whole config area is cleared when a full copy starts
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return address == (uintptr_t)&eepromData[0];
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (streamerLocked) {
         return -1;
     }
 
-    if (c->address == (uintptr_t)&eepromData[0]) {
+    if (config_streamer_impl_is_page_start(c->address)) {
         ZERO_FARRAY(eepromData);
     }
 
@@ -81,13 +81,18 @@ void config_streamer_impl_lock(void)
     FLASH_Lock();
 }
 
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return address % FLASH_PAGE_SIZE == 0;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (c->err != 0) {
         return c->err;
     }
 
-    if (c->address % FLASH_PAGE_SIZE == 0) {
+    if (config_streamer_impl_is_page_start(c->address)) {
         const FLASH_Status status = FLASH_EraseSector(getFLASHSectorForEEPROM(c->address), VoltageRange_3);
         if (status != FLASH_COMPLETE) {
             return -1;
@@ -108,13 +108,18 @@ void config_streamer_impl_lock(void)
     HAL_FLASH_Lock();
 }
 
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return address % FLASH_PAGE_SIZE == 0;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (c->err != 0) {
         return c->err;
     }
 
-    if (c->address % FLASH_PAGE_SIZE == 0) {
+    if (config_streamer_impl_is_page_start(c->address)) {
         FLASH_EraseInitTypeDef EraseInitStruct = {
             .TypeErase     = FLASH_TYPEERASE_SECTORS,
             .VoltageRange  = FLASH_VOLTAGE_RANGE_3, // 2.7-3.6V
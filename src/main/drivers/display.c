@@ -93,6 +93,7 @@ void displayClearScreen(displayPort_t *instance)
 {
     instance->vTable->clearScreen(instance);
     instance->cleared = true;
+    instance->clearCount++;
     instance->cursorRow = -1;
 }
 
@@ -114,6 +115,7 @@ void displayGrab(displayPort_t *instance)
 {
     instance->vTable->grab(instance);
     instance->vTable->clearScreen(instance);
+    instance->clearCount++;
     ++instance->grabCount;
 }
 
@@ -123,6 +125,7 @@ void displayRelease(displayPort_t *instance)
     // displayPort_t is changing owner. Clear it, since
     // the new owner might expect a clear canvas.
     instance->vTable->clearScreen(instance);
+    instance->clearCount++;
     --instance->grabCount;
 }
 
@@ -318,6 +321,7 @@ void displayInit(displayPort_t *instance, const displayPortVTable_t *vTable)
     instance->vTable->clearScreen(instance);
     instance->useFullscreen = false;
     instance->cleared = true;
+    instance->clearCount = 0;
     instance->grabCount = 0;
     instance->cursorRow = -1;
     instance->cachedSupportedTextAttributes = TEXT_ATTRIBUTES_NONE;
@@ -78,6 +78,7 @@ typedef struct displayPort_s {
     // CMS state
     bool useFullscreen;
     bool cleared;
+    uint8_t clearCount; // Incremented every time the screen contents are discarded
     int8_t cursorRow;
     int8_t grabCount;
     textAttributes_t cachedSupportedTextAttributes;
@@ -192,10 +192,11 @@ static void w25n01g_deviceReset(void)
 
 bool w25n01g_isReady(void)
 {
-    uint8_t status = w25n01g_readRegister(W25N01G_STAT_REG);
-
     // If couldBeBusy is false, don't bother to poll the flash chip for its status
-    couldBeBusy = couldBeBusy && ((status & W25N01G_STATUS_FLAG_BUSY) != 0);
+    if (couldBeBusy) {
+        uint8_t status = w25n01g_readRegister(W25N01G_STAT_REG);
+        couldBeBusy = (status & W25N01G_STATUS_FLAG_BUSY) != 0;
+    }
 
     return !couldBeBusy;
 }
@@ -221,13 +222,14 @@ bool w25n01g_waitForReady(timeMs_t timeoutMillis)
 /**
  * The flash requires this write enable command to be sent before commands that would cause
  * a write like program and erase.
+ *
+ * Unlike on NOR chips, loading data into the page buffer doesn't make the device busy. Only
+ * program execute and erase do, and those set the busy timeout themselves, so there's no need
+ * to poll the status register after a write enable or a data load.
  */
 static void w25n01g_writeEnable(void)
 {
     w25n01g_performOneByteCommand(W25N01G_INSTRUCTION_WRITE_ENABLE);
-
-    // Assume that we're about to do some writing, so the device is just about to become busy
-    couldBeBusy = true;
 }
 
 bool w25n01g_detect(uint32_t chipID)
@@ -302,8 +304,6 @@ static void w25n01g_programDataLoad(uint16_t columnAddress, const uint8_t *data,
 
     busTransferDescriptor_t transferDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = length, .rxBuf = NULL, .txBuf = (uint8_t *)data}};
     busTransferMultiple(busDev, transferDescr, ARRAYLEN(transferDescr));
-
-    w25n01g_setTimeout(W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
 }
 
 static void w25n01g_randomProgramDataLoad(uint16_t columnAddress, const uint8_t *data, int length)
@@ -314,8 +314,6 @@ static void w25n01g_randomProgramDataLoad(uint16_t columnAddress, const uint8_t
 
     busTransferDescriptor_t transferDescr[] = {{.length = sizeof(cmd), .rxBuf = NULL, .txBuf = cmd}, {.length = length, .rxBuf = NULL, .txBuf = (uint8_t *)data}};
     busTransferMultiple(busDev, transferDescr, ARRAYLEN(transferDescr));
-
-    w25n01g_setTimeout(W25N01G_TIMEOUT_PAGE_PROGRAM_MS);
 }
 
 static void w25n01g_programExecute(uint32_t pageAddress)
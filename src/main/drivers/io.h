@@ -93,6 +93,7 @@
 # define IOCFG_OUT_PP         0
 # define IOCFG_OUT_OD         0
 # define IOCFG_AF_PP          0
+# define IOCFG_AF_PP_FAST     0
 # define IOCFG_AF_OD          0
 # define IOCFG_AF_OD_UP       0
 # define IOCFG_IPD            0
@@ -35,6 +35,7 @@
 #include "build/build_config.h"
 #include "build/debug.h"
 
+#include "common/bitarray.h"
 #include "common/color.h"
 #include "common/colorconversion.h"
 
@@ -47,7 +48,20 @@
 #define WS2811_BIT_COMPARE_1 ((WS2811_PERIOD * 2) / 3)
 #define WS2811_BIT_COMPARE_0 (WS2811_PERIOD / 3)
 
-static DMA_RAM timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
+#define WS2811_BITS_PER_NIBBLE 4
+
+// DMA compare values for the 4 bits of a nibble, MSB first
+#define WS2811_NIBBLE_BIT(n, bit) (((n) & (1 << (bit))) ? WS2811_BIT_COMPARE_1 : WS2811_BIT_COMPARE_0)
+#define WS2811_NIBBLE(n) { WS2811_NIBBLE_BIT(n, 3), WS2811_NIBBLE_BIT(n, 2), WS2811_NIBBLE_BIT(n, 1), WS2811_NIBBLE_BIT(n, 0) }
+
+static const timerDMASafeType_t ws2811NibbleCompare[16][WS2811_BITS_PER_NIBBLE] = {
+    WS2811_NIBBLE(0x0), WS2811_NIBBLE(0x1), WS2811_NIBBLE(0x2), WS2811_NIBBLE(0x3),
+    WS2811_NIBBLE(0x4), WS2811_NIBBLE(0x5), WS2811_NIBBLE(0x6), WS2811_NIBBLE(0x7),
+    WS2811_NIBBLE(0x8), WS2811_NIBBLE(0x9), WS2811_NIBBLE(0xA), WS2811_NIBBLE(0xB),
+    WS2811_NIBBLE(0xC), WS2811_NIBBLE(0xD), WS2811_NIBBLE(0xE), WS2811_NIBBLE(0xF),
+};
+
+STATIC_UNIT_TESTED DMA_RAM timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
 
 static IO_t ws2811IO = IO_NONE;
 static TCH_t * ws2811TCH = NULL;
@@ -55,9 +69,26 @@ static bool ws2811Initialised = false;
 
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
 
+/*
+ * LEDs written since the last ws2811UpdateStrip() and the colors currently
+ * encoded in the DMA buffer (valid where ledEncoded is set). Only LEDs that
+ * really changed are converted and encoded again.
+ */
+static BITARRAY_DECLARE(ledDirty, WS2811_LED_STRIP_LENGTH);
+static BITARRAY_DECLARE(ledEncoded, WS2811_LED_STRIP_LENGTH);
+static hsvColor_t ledEncodedColor[WS2811_LED_STRIP_LENGTH];
+
+static bool hsvColorEqual(const hsvColor_t *a, const hsvColor_t *b)
+{
+    return a->h == b->h && a->s == b->s && a->v == b->v;
+}
+
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
-    ledColorBuffer[index] = *color;
+    if (!hsvColorEqual(&ledColorBuffer[index], color)) {
+        ledColorBuffer[index] = *color;
+        bitArraySet(ledDirty, index);
+    }
 }
 
 void getLedHsv(uint16_t index, hsvColor_t *color)
@@ -67,12 +98,15 @@ void getLedHsv(uint16_t index, hsvColor_t *color)
 
 void setLedValue(uint16_t index, const uint8_t value)
 {
-    ledColorBuffer[index].v = value;
+    if (ledColorBuffer[index].v != value) {
+        ledColorBuffer[index].v = value;
+        bitArraySet(ledDirty, index);
+    }
 }
 
 void scaleLedValue(uint16_t index, const uint8_t scalePercent)
 {
-    ledColorBuffer[index].v = ((uint16_t)ledColorBuffer[index].v * scalePercent / 100);
+    setLedValue(index, ((uint16_t)ledColorBuffer[index].v * scalePercent / 100));
 }
 
 void setStripColor(const hsvColor_t *color)
@@ -124,6 +158,10 @@ void ws2811LedStripInit(void)
     memset(&ledStripDMABuffer, 0, sizeof(ledStripDMABuffer));
     ws2811Initialised = true;
 
+    // Data part of the buffer was cleared, encode every LED again
+    BITARRAY_CLR_ALL(ledEncoded);
+    BITARRAY_SET_ALL(ledDirty);
+
     ws2811UpdateStrip();
 }
 
@@ -133,15 +171,23 @@ bool isWS2811LedStripReady(void)
 }
 
 STATIC_UNIT_TESTED uint16_t dmaBufferOffset;
-static int16_t ledIndex;
+
+static void encodeLEDDMAByte(timerDMASafeType_t *dst, uint8_t value)
+{
+    memcpy(dst, ws2811NibbleCompare[value >> 4], sizeof(ws2811NibbleCompare[0]));
+    memcpy(dst + WS2811_BITS_PER_NIBBLE, ws2811NibbleCompare[value & 0x0F], sizeof(ws2811NibbleCompare[0]));
+}
 
 STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
 {
-    uint32_t grb = (color->rgb.g << 16) | (color->rgb.r << 8) | (color->rgb.b);
+    timerDMASafeType_t *dst = &ledStripDMABuffer[dmaBufferOffset];
 
-    for (int8_t index = 23; index >= 0; index--) {
-        ledStripDMABuffer[dmaBufferOffset++] = (grb & (1 << index)) ? WS2811_BIT_COMPARE_1 : WS2811_BIT_COMPARE_0;
-    }
+    // GRB order, MSB first
+    encodeLEDDMAByte(dst, color->rgb.g);
+    encodeLEDDMAByte(dst + 8, color->rgb.r);
+    encodeLEDDMAByte(dst + 16, color->rgb.b);
+
+    dmaBufferOffset += WS2811_BITS_PER_LED;
 }
 
 /*
@@ -150,23 +196,25 @@ STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
  */
 void ws2811UpdateStrip(void)
 {
-    static rgbColor24bpp_t *rgb24;
-
     // don't wait - risk of infinite block, just get an update next time round
     if (timerPWMDMAInProgress(ws2811TCH)) {
         return;
     }
 
-    dmaBufferOffset = 0;                // reset buffer memory index
-    ledIndex = 0;                       // reset led index
-
     // fill transmit buffer with correct compare values to achieve
-    // correct pulse widths according to color values
-    while (ledIndex < WS2811_LED_STRIP_LENGTH)
-    {
-        rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
-        fastUpdateLEDDMABuffer(rgb24);
-        ledIndex++;
+    // correct pulse widths according to color values of the changed LEDs
+    for (int ledIndex = BITARRAY_FIND_FIRST_SET(ledDirty, 0); ledIndex >= 0; ledIndex = BITARRAY_FIND_FIRST_SET(ledDirty, ledIndex + 1)) {
+        bitArrayClr(ledDirty, ledIndex);
+
+        // Written and then restored by a later layer
+        if (bitArrayGet(ledEncoded, ledIndex) && hsvColorEqual(&ledEncodedColor[ledIndex], &ledColorBuffer[ledIndex])) {
+            continue;
+        }
+
+        ledEncodedColor[ledIndex] = ledColorBuffer[ledIndex];
+        bitArraySet(ledEncoded, ledIndex);
+        dmaBufferOffset = ledIndex * WS2811_BITS_PER_LED;
+        fastUpdateLEDDMABuffer(hsvToRgb24(&ledColorBuffer[ledIndex]));
     }
 
     // Initiate hardware transfer
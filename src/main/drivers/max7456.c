@@ -34,6 +34,7 @@
 #include "build/debug.h"
 
 #include "common/bitarray.h"
+#include "common/maths.h"
 #include "common/printf.h"
 #include "common/utils.h"
 
@@ -193,6 +194,17 @@ static BITARRAY_DECLARE(screenIsDirty, MAX7456_BUFFER_CHARS_PAL);
 //max chars to update in one idle
 #define MAX_CHARS2UPDATE        10
 #define BYTES_PER_CHAR2UPDATE   (7 * 2) // SPI regs + values for them
+// SPI bytes sent in one idle, the worst case of MAX_CHARS2UPDATE characters
+// written one by one. Runs streamed in auto-increment mode fit many more.
+#define MAX_BYTES2UPDATE        (MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE)
+// A run in auto-increment mode costs DMAH + DMAL + DMM + the END_STRING
+// terminator plus one DMDI write per character, while a single character
+// costs DMAH + DMAL + DMDI. Resending up to AUTOINC_MAX_GAP unchanged
+// characters is cheaper than starting a new run after them.
+#define AUTOINC_RUN_OVERHEAD    (4 * 2)
+#define AUTOINC_CHAR_BYTES      (1 * 2)
+#define SINGLE_CHAR_BYTES       (3 * 2)
+#define AUTOINC_MAX_GAP         3
 
 typedef struct max7456Registers_s {
     uint8_t vm0;
@@ -483,18 +495,42 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff, uint8_t mode)
     }
 }
 
+// Returns the number of characters starting at the dirty one at pos that
+// can be streamed in a single auto-increment run: same attributes, no
+// extended characters and no END_STRING, which would terminate the run.
+// Short gaps of unchanged characters are included when more dirty ones
+// follow. The number of dirty characters in the run is stored in dirtyCount.
+static unsigned max7456DirtyRunLength(unsigned pos, uint8_t charMode, unsigned *dirtyCount)
+{
+    unsigned length = 0;
+    unsigned dirty = 0;
+
+    for (unsigned end = pos; end < ARRAYLEN(osdCharacterGridBuffer) && end - pos - length <= AUTOINC_MAX_GAP; end++) {
+        uint16_t val = osdCharacterGridBuffer[end];
+        if (MODE_BYTE(val) != charMode || CHAR_BYTE(val) == END_STRING) {
+            break;
+        }
+        if (bitArrayGet(screenIsDirty, end)) {
+            length = end - pos + 1;
+            dirty++;
+        }
+    }
+
+    *dirtyCount = dirty;
+    return length;
+}
+
 // Must be called with the lock held. Returns whether any new characters
 // were drawn.
 static bool max7456DrawScreenPartial(void)
 {
-    uint8_t spiBuff[MAX_CHARS2UPDATE * BYTES_PER_CHAR2UPDATE];
+    uint8_t spiBuff[MAX_BYTES2UPDATE];
     int bufPtr = 0;
     size_t pos;
-    uint_fast16_t updatedCharCount;
     uint8_t charMode;
     int next;
 
-    for (pos = 0, updatedCharCount = 0; pos < ARRAYLEN(osdCharacterGridBuffer);) {
+    for (pos = 0; pos < ARRAYLEN(osdCharacterGridBuffer);) {
         next = BITARRAY_FIND_FIRST_SET(screenIsDirty, pos);
         if (next < 0) {
             // No more dirty chars.
@@ -512,6 +548,10 @@ static bool max7456DrawScreenPartial(void)
         charMode = MODE_BYTE(osdCharacterGridBuffer[pos]);
         uint8_t chr = CHAR_BYTE(osdCharacterGridBuffer[pos]);
         if (CHAR_MODE_IS_EXT(charMode)) {
+            if ((size_t)bufPtr + BYTES_PER_CHAR2UPDATE > sizeof(spiBuff)) {
+                break;
+            }
+
             if (!DMM_IS_8BIT_MODE(state.registers.dmm)) {
                 state.registers.dmm |= DMM_8BIT_MODE;
                 bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
@@ -530,25 +570,55 @@ static bool max7456DrawScreenPartial(void)
             bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
             bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, chr);
 
-        } else {
-            if (DMM_IS_8BIT_MODE(state.registers.dmm) || (DMM_CHAR_MODE_MASK & state.registers.dmm) != charMode) {
-                state.registers.dmm &= ~DMM_8BIT_MODE;
-                state.registers.dmm = (state.registers.dmm & ~DMM_CHAR_MODE_MASK) | charMode;
-                // Send the attributes for the character run. They
-                // will be applied to all characters until we change
-                // the DMM register.
-                bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+            bitArrayClr(screenIsDirty, pos);
+            pos++;
+            continue;
+        }
+
+        const uint8_t dmm = (state.registers.dmm & ~(DMM_8BIT_MODE | DMM_CHAR_MODE_MASK)) | charMode;
+        unsigned dirtyCount;
+        unsigned runLength = max7456DirtyRunLength(pos, charMode, &dirtyCount);
+
+        if (AUTOINC_RUN_OVERHEAD + runLength * AUTOINC_CHAR_BYTES < dirtyCount * SINGLE_CHAR_BYTES) {
+            // Split runs that don't fit, the rest goes out in the next idle
+            const int maxRunLength = ((int)sizeof(spiBuff) - bufPtr - AUTOINC_RUN_OVERHEAD) / AUTOINC_CHAR_BYTES;
+            if (maxRunLength <= AUTOINC_MAX_GAP) {
+                break;
             }
+            runLength = MIN(runLength, (unsigned)maxRunLength);
 
+            // Stream the run: set the start address once and let the
+            // chip increment it. The attributes in DMM apply to every
+            // character and END_STRING leaves auto-increment mode.
             bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAH, ph);
             bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
-            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, chr);
+            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, dmm | DMM_AUTOINCREMENT);
+            for (unsigned ii = 0; ii < runLength; ii++, pos++) {
+                bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, CHAR_BYTE(osdCharacterGridBuffer[pos]));
+                bitArrayClr(screenIsDirty, pos);
+            }
+            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, END_STRING);
+            state.registers.dmm = dmm;
+            continue;
         }
 
-        bitArrayClr(screenIsDirty, pos);
-        if (++updatedCharCount == MAX_CHARS2UPDATE) {
+        if ((size_t)bufPtr + BYTES_PER_CHAR2UPDATE > sizeof(spiBuff)) {
             break;
         }
+
+        if (state.registers.dmm != dmm) {
+            state.registers.dmm = dmm;
+            // Send the attributes for the character run. They
+            // will be applied to all characters until we change
+            // the DMM register.
+            bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMM, state.registers.dmm);
+        }
+
+        bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAH, ph);
+        bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMAL, pl);
+        bufPtr = max7456PrepareBuffer(spiBuff, sizeof(spiBuff), bufPtr, MAX7456ADD_DMDI, chr);
+
+        bitArrayClr(screenIsDirty, pos);
         // Start next search at next bit
         pos++;
     }
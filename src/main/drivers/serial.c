@@ -71,6 +71,19 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+int serialReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    if (instance->vTable->readBuf) {
+        return instance->vTable->readBuf(instance, data, count);
+    }
+
+    int read = 0;
+    while (read < count && serialRxBytesWaiting(instance)) {
+        data[read++] = serialRead(instance);
+    }
+    return read;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -88,6 +88,9 @@ struct serialPortVTable {
 
     uint8_t (*serialRead)(serialPort_t *instance);
 
+    // Optional function to read a block of received bytes, returns the number of bytes read.
+    int (*readBuf)(serialPort_t *instance, uint8_t *data, int count);
+
     // Specified baud rate may not be allowed by an implementation, use serialGetBaudRate to determine actual baud rate in use.
     void (*serialSetBaudRate)(serialPort_t *instance, uint32_t baudRate);
 
@@ -111,6 +114,7 @@ uint32_t serialRxBytesWaiting(const serialPort_t *instance);
 uint32_t serialTxBytesFree(const serialPort_t *instance);
 void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count);
 uint8_t serialRead(serialPort_t *instance);
+int serialReadBuf(serialPort_t *instance, uint8_t *data, int count);
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_t mode);
 bool isSerialTransmitBufferEmpty(const serialPort_t *instance);
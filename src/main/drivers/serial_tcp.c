@@ -39,11 +39,14 @@
 #include <errno.h>
 #include <netinet/tcp.h>
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/serial.h"
 #include "drivers/serial_tcp.h"
 
+STATIC_ASSERT((TCP_BUFFER_SIZE & (TCP_BUFFER_SIZE - 1)) == 0, tcp_buffer_size_must_be_power_of_two);
+
 static const struct serialPortVTable tcpVTable[];
 static tcpPort_t tcpPorts[SERIAL_PORT_COUNT];
 
@@ -61,10 +64,6 @@ static tcpPort_t *tcpReConfigure(tcpPort_t *port, uint32_t id)
         return port;
     }
 
-    if (pthread_mutex_init(&port->receiveMutex, NULL) != 0){
-        return NULL;
-    }
-
     uint16_t tcpPort = BASE_IP_ADDRESS + id - 1;
     if (lookupAddress(NULL, tcpPort, SOCK_STREAM, (struct sockaddr*)&port->sockAddress, &sockaddrlen) != 0) {
             return NULL;
@@ -148,7 +147,21 @@ int tcpReceive(tcpPort_t *port)
     }
 
     uint8_t buffer[TCP_BUFFER_SIZE];
-    ssize_t recvSize = recv(port->clientSocketFd, buffer, TCP_BUFFER_SIZE, 0);
+    size_t recvLimit = TCP_BUFFER_SIZE;
+
+    if (!port->serialPort.rxCallback) {
+        // Never read more than fits into the ring, the rest stays in the socket
+        // and the kernel applies backpressure to the sender.
+        const unsigned tail = atomic_load_explicit(&port->rxTail, memory_order_acquire);
+        const unsigned head = atomic_load_explicit(&port->rxHead, memory_order_relaxed);
+        recvLimit = TCP_BUFFER_SIZE - (head - tail);
+        if (recvLimit == 0) {
+            usleep(1000);
+            return 0;
+        }
+    }
+
+    ssize_t recvSize = recv(port->clientSocketFd, buffer, recvLimit, 0);
 
     // recv() under cygwin does not recognise the closed connection under certain circumstances, but returns ECONNRESET as an error.
     if (port->isClientConnected && (recvSize == 0 || ( recvSize == -1 && errno == ECONNRESET))) {
@@ -162,16 +175,17 @@ int tcpReceive(tcpPort_t *port)
         return 0;
     }
 
-    for (ssize_t i = 0; i < recvSize; i++) {
-
-        if (port->serialPort.rxCallback) {
+    if (port->serialPort.rxCallback) {
+        for (ssize_t i = 0; i < recvSize; i++) {
             port->serialPort.rxCallback((uint16_t)buffer[i], port->serialPort.rxCallbackData);
-        } else {
-            pthread_mutex_lock(&port->receiveMutex);
-            port->serialPort.rxBuffer[port->serialPort.rxBufferHead] = buffer[i];
-            port->serialPort.rxBufferHead = (port->serialPort.rxBufferHead + 1) % port->serialPort.rxBufferSize;
-            pthread_mutex_unlock(&port->receiveMutex);
         }
+    } else if (recvSize > 0) {
+        unsigned head = atomic_load_explicit(&port->rxHead, memory_order_relaxed);
+        for (ssize_t i = 0; i < recvSize; i++) {
+            port->rxBuffer[head++ & (TCP_BUFFER_SIZE - 1)] = buffer[i];
+        }
+        // Publish the whole chunk at once
+        atomic_store_explicit(&port->rxHead, head, memory_order_release);
     }
 
     if (recvSize < 0) {
@@ -207,28 +221,47 @@ serialPort_t *tcpOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
     port->serialPort.baudRate = baudRate;
     port->serialPort.options = options;
 
-    int err = pthread_create(&port->receiveThread, NULL, tcpReceiveThread, (void*)port);
-    if (err < 0){
-        fprintf(stderr, "[SOCKET] Unable to create receive thread for UART%d\n", id);
-        return NULL;
+    // The port may be reopened, but there must only ever be one producer
+    if (!port->isReceiveThreadStarted) {
+        atomic_store(&port->rxHead, 0);
+        atomic_store(&port->rxTail, 0);
+
+        int err = pthread_create(&port->receiveThread, NULL, tcpReceiveThread, (void*)port);
+        if (err != 0){
+            fprintf(stderr, "[SOCKET] Unable to create receive thread for UART%d\n", port->id);
+            return NULL;
+        }
+        port->isReceiveThreadStarted = true;
     }
     return (serialPort_t*)port;
 }
 
 uint8_t tcpRead(serialPort_t *instance)
 {
-    uint8_t ch;
     tcpPort_t *port = (tcpPort_t*)instance;
-    pthread_mutex_lock(&port->receiveMutex);
-
-    ch = port->serialPort.rxBuffer[port->serialPort.rxBufferTail];
-    port->serialPort.rxBufferTail = (port->serialPort.rxBufferTail + 1) % port->serialPort.rxBufferSize;
+    const unsigned tail = atomic_load_explicit(&port->rxTail, memory_order_relaxed);
 
-    pthread_mutex_unlock(&port->receiveMutex);
+    const uint8_t ch = port->rxBuffer[tail & (TCP_BUFFER_SIZE - 1)];
+    atomic_store_explicit(&port->rxTail, tail + 1, memory_order_release);
 
     return ch;
 }
 
+int tcpReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    tcpPort_t *port = (tcpPort_t*)instance;
+    const unsigned head = atomic_load_explicit(&port->rxHead, memory_order_acquire);
+    const unsigned tail = atomic_load_explicit(&port->rxTail, memory_order_relaxed);
+    const unsigned len = MIN((unsigned)count, head - tail);
+
+    for (unsigned ii = 0; ii < len; ii++) {
+        data[ii] = port->rxBuffer[(tail + ii) & (TCP_BUFFER_SIZE - 1)];
+    }
+    atomic_store_explicit(&port->rxTail, tail + len, memory_order_release);
+
+    return len;
+}
+
 void tcpWritBuf(serialPort_t *instance, const void *data, int count)
 {
     tcpPort_t *port = (tcpPort_t*)instance;
@@ -248,19 +281,11 @@ void tcpWrite(serialPort_t *instance, uint8_t ch)
 uint32_t tcpTotalRxBytesWaiting(const serialPort_t *instance)
 {
     tcpPort_t *port = (tcpPort_t*)instance;
-    uint32_t count;
-
-    pthread_mutex_lock(&port->receiveMutex);
-
-    if (port->serialPort.rxBufferHead >= port->serialPort.rxBufferTail) {
-        count = port->serialPort.rxBufferHead - port->serialPort.rxBufferTail;
-    } else {
-        count = port->serialPort.rxBufferSize + port->serialPort.rxBufferHead - port->serialPort.rxBufferTail;
-    }
 
-    pthread_mutex_unlock(&port->receiveMutex);
+    const unsigned head = atomic_load_explicit(&port->rxHead, memory_order_acquire);
+    const unsigned tail = atomic_load_explicit(&port->rxTail, memory_order_relaxed);
 
-    return count;
+    return head - tail;
 }
 
 uint32_t tcpTotalTxBytesFree(const serialPort_t *instance)
@@ -305,6 +330,7 @@ static const struct serialPortVTable tcpVTable[] = {
         .serialTotalRxWaiting = tcpTotalRxBytesWaiting,
         .serialTotalTxFree = tcpTotalTxBytesFree,
         .serialRead = tcpRead,
+        .readBuf = tcpReadBuf,
         .serialSetBaudRate = tcpSetBaudRate,
         .isSerialTransmitBufferEmpty = isTcpTransmitBufferEmpty,
         .setMode = tcpSetMode,
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -34,11 +35,15 @@ typedef struct
 {
     serialPort_t serialPort;
 
+    // Single producer (receive thread) / single consumer (main loop) ring.
+    // Indices are free running and masked on access.
     uint8_t rxBuffer[TCP_BUFFER_SIZE];
+    atomic_uint rxHead;
+    atomic_uint rxTail;
 
     uint8_t id;
     bool isInitalized;
-    pthread_mutex_t receiveMutex;
+    bool isReceiveThreadStarted;
     pthread_t receiveThread;
     int socketFd;
     int clientSocketFd;
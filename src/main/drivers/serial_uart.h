@@ -79,5 +79,6 @@ void uartWrite(serialPort_t *instance, uint8_t ch);
 uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance);
 uint32_t uartTotalTxBytesFree(const serialPort_t *instance);
 uint8_t uartRead(serialPort_t *instance);
+int uartReadBuf(serialPort_t *instance, uint8_t *data, int count);
 void uartSetBaudRate(serialPort_t *s, uint32_t baudRate);
 bool isUartTransmitBufferEmpty(const serialPort_t *s);
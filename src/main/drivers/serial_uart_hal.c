@@ -22,12 +22,14 @@
 */
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdlib.h>
 
 #include "platform.h"
 
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 #include "drivers/io.h"
 #include "drivers/nvic.h"
@@ -233,6 +235,26 @@ uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
+int uartReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    int read = 0;
+
+    // Copy at most two contiguous runs, up to the end of the ring and from its start
+    while (read < count && s->port.rxBufferTail != s->port.rxBufferHead) {
+        const uint32_t head = s->port.rxBufferHead;
+        const uint32_t tail = s->port.rxBufferTail;
+        const uint32_t available = (head > tail) ? head - tail : s->port.rxBufferSize - tail;
+        const uint32_t len = MIN(available, (uint32_t)(count - read));
+
+        memcpy(&data[read], (const uint8_t *)&s->port.rxBuffer[tail], len);
+        read += len;
+        s->port.rxBufferTail = (tail + len >= s->port.rxBufferSize) ? 0 : tail + len;
+    }
+
+    return read;
+}
+
 void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
@@ -263,6 +285,7 @@ const struct serialPortVTable uartVTable[] = {
         .serialTotalRxWaiting = uartTotalRxBytesWaiting,
         .serialTotalTxFree = uartTotalTxBytesFree,
         .serialRead = uartRead,
+        .readBuf = uartReadBuf,
         .serialSetBaudRate = uartSetBaudRate,
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
@@ -56,7 +56,7 @@ typedef uint32_t timCNT_t;
 #define HARDWARE_TIMER_DEFINITION_COUNT 14
 #elif defined(AT32F43x)
 #define HARDWARE_TIMER_DEFINITION_COUNT 15
-#elif defined(SITL_BUILD)
+#elif defined(SITL_BUILD) || defined(UNIT_TEST)
 #define HARDWARE_TIMER_DEFINITION_COUNT 0
 #else
 #error "Unknown CPU defined"
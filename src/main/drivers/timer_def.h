@@ -108,6 +108,8 @@
 #elif defined(AT32F43x)
     #include "timer_def_at32f43x.h"
 #elif defined(SITL_BUILD)
+#elif defined(UNIT_TEST)
+    #define timerDMASafeType_t  uint32_t
 #else
     #error "Unknown CPU defined"
 #endif
@@ -154,6 +154,7 @@ static const char * const featureNames[] = {
     "SUPEREXPO", "VTX", "", "", "", "PWM_OUTPUT_ENABLE",
     "OSD", "FW_LAUNCH", "FW_AUTOTRIM", NULL
 };
+#define FEATURE_NAME_COUNT (ARRAYLEN(featureNames) - 1)
 
 #ifdef USE_BLACKBOX
 static const char * const blackboxIncludeFlagNames[] = {
@@ -474,18 +475,18 @@ static bool valuePtrEqualsDefault(const setting_t *value, const void *ptr, const
     return result;
 }
 
-static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
+static bool dumpPgValue(const setting_t *value, const pgRegistry_t *pg, uint8_t profileIndex, uint8_t dumpMask)
 {
     char name[SETTING_MAX_NAME_LENGTH];
     const char *format = "set %s = ";
     const char *defaultFormat = "#set %s = ";
-    // During a dump, the PGs have been backed up to their "copy"
-    // regions and the actual values have been reset to its
-    // defaults. This means that settingGetValuePointer() will
-    // return the default value while settingGetCopyValuePointer()
-    // will return the actual value.
-    const void *valuePointer = settingGetCopyValuePointer(value);
-    const void *defaultValuePointer = settingGetValuePointer(value);
+    // During a dump, the PGs hold their actual values while their
+    // "copy" regions have been loaded with the defaults (see
+    // loadDefaultConfigCopies()). Values are looked up by profile
+    // index, so dumping a profile doesn't need to activate it.
+    const uint16_t offset = settingGetProfileValueOffset(value, profileIndex);
+    const void *valuePointer = pg->address + offset;
+    const void *defaultValuePointer = pg->copy + offset;
     const bool equalsDefault = valuePtrEqualsDefault(value, valuePointer, defaultValuePointer);
     if (((dumpMask & DO_DIFF) == 0) || !equalsDefault) {
         settingGetName(value, name);
@@ -502,18 +503,9 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
         cliPrintf(format, name);
         printValuePointer(value, valuePointer, 0);
         cliPrintLinefeed();
+        return true;
     }
-}
-
-static void dumpAllValues(uint16_t valueSection, uint8_t dumpMask)
-{
-    for (unsigned i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-        const setting_t *value = settingGet(i);
-        bufWriterFlush(cliWriter);
-        if (SETTING_SECTION(value) == valueSection) {
-            dumpPgValue(value, dumpMask);
-        }
-    }
+    return false;
 }
 
 static void cliPrintVar(const setting_t *var, uint32_t full)
@@ -660,11 +652,14 @@ static void cliAssert(char *cmdline)
 }
 #endif
 
-static void printAux(uint8_t dumpMask, const modeActivationCondition_t *modeActivationConditions, const modeActivationCondition_t *defaultModeActivationConditions)
+static void printAux(uint8_t dumpMask, const modeActivationCondition_t *modeActivationConditions, const modeActivationCondition_t *defaultModeActivationConditions, int16_t showIndex)
 {
     const char *format = "aux %u %u %u %u %u";
     // print out aux channel settings
     for (uint32_t i = 0; i < MAX_MODE_ACTIVATION_CONDITION_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const modeActivationCondition_t *mac = &modeActivationConditions[i];
         bool equalsDefault = false;
         if (defaultModeActivationConditions) {
@@ -699,7 +694,7 @@ static void cliAux(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printAux(DUMP_MASTER, modeActivationConditions(0), NULL);
+        printAux(DUMP_MASTER, modeActivationConditions(0), NULL, -1);
     } else {
         ptr = cmdline;
         i = fastA2I(ptr++);
@@ -736,13 +731,16 @@ static void cliAux(char *cmdline)
     }
 }
 
-static void printSerial(uint8_t dumpMask, const serialConfig_t *serialConfig, const serialConfig_t *serialConfigDefault)
+static void printSerial(uint8_t dumpMask, const serialConfig_t *serialConfig, const serialConfig_t *serialConfigDefault, int16_t showIndex)
 {
     const char *format = "serial %d %d %ld %ld %ld %ld";
     for (uint32_t i = 0; i < SERIAL_PORT_COUNT; i++) {
         if (!serialIsPortAvailable(serialConfig->portConfigs[i].identifier)) {
             continue;
         };
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (serialConfigDefault) {
             equalsDefault = serialConfig->portConfigs[i].identifier == serialConfigDefault->portConfigs[i].identifier
@@ -774,7 +772,7 @@ static void printSerial(uint8_t dumpMask, const serialConfig_t *serialConfig, co
 static void cliSerial(char *cmdline)
 {
     if (isEmpty(cmdline)) {
-        printSerial(DUMP_MASTER, serialConfig(), NULL);
+        printSerial(DUMP_MASTER, serialConfig(), NULL, -1);
         return;
     }
     serialPortConfig_t portConfig;
@@ -939,11 +937,14 @@ static void cliSerialPassthrough(char *cmdline)
 }
 #endif
 
-static void printAdjustmentRange(uint8_t dumpMask, const adjustmentRange_t *adjustmentRanges, const adjustmentRange_t *defaultAdjustmentRanges)
+static void printAdjustmentRange(uint8_t dumpMask, const adjustmentRange_t *adjustmentRanges, const adjustmentRange_t *defaultAdjustmentRanges, int16_t showIndex)
 {
     const char *format = "adjrange %u %u %u %u %u %u %u";
     // print out adjustment ranges channel settings
     for (uint32_t i = 0; i < MAX_ADJUSTMENT_RANGE_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const adjustmentRange_t *ar = &adjustmentRanges[i];
         bool equalsDefault = false;
         if (defaultAdjustmentRanges) {
@@ -982,7 +983,7 @@ static void cliAdjustmentRange(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printAdjustmentRange(DUMP_MASTER, adjustmentRanges(0), NULL);
+        printAdjustmentRange(DUMP_MASTER, adjustmentRanges(0), NULL, -1);
     } else {
         ptr = cmdline;
         i = fastA2I(ptr++);
@@ -1036,7 +1037,7 @@ static void cliAdjustmentRange(char *cmdline)
     }
 }
 
-static void printMotorMix(uint8_t dumpMask, const motorMixer_t *primaryMotorMixer, const motorMixer_t *defaultprimaryMotorMixer)
+static void printMotorMix(uint8_t dumpMask, const motorMixer_t *primaryMotorMixer, const motorMixer_t *defaultprimaryMotorMixer, int16_t showIndex)
 {
     const char *format = "mmix %d %s %s %s %s";
     char buf0[FTOA_BUFFER_SIZE];
@@ -1046,6 +1047,9 @@ static void printMotorMix(uint8_t dumpMask, const motorMixer_t *primaryMotorMixe
     for (uint32_t i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
         if (primaryMotorMixer[i].throttle == 0.0f)
             break;
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const float thr = primaryMotorMixer[i].throttle;
         const float roll = primaryMotorMixer[i].roll;
         const float pitch = primaryMotorMixer[i].pitch;
@@ -1080,7 +1084,7 @@ static void cliMotorMix(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printMotorMix(DUMP_MASTER, primaryMotorMixer(0), NULL);
+        printMotorMix(DUMP_MASTER, primaryMotorMixer(0), NULL, -1);
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         // erase custom mixer
         for (uint32_t i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
@@ -1113,7 +1117,7 @@ static void cliMotorMix(char *cmdline)
             if (check != 4) {
                 cliShowParseError();
             } else {
-                printMotorMix(DUMP_MASTER, primaryMotorMixer(0), NULL);
+                printMotorMix(DUMP_MASTER, primaryMotorMixer(0), NULL, -1);
             }
         } else {
             cliShowArgumentRangeError("index", 0, MAX_SUPPORTED_MOTORS - 1);
@@ -1121,10 +1125,13 @@ static void cliMotorMix(char *cmdline)
     }
 }
 
-static void printRxRange(uint8_t dumpMask, const rxChannelRangeConfig_t *channelRangeConfigs, const rxChannelRangeConfig_t *defaultChannelRangeConfigs)
+static void printRxRange(uint8_t dumpMask, const rxChannelRangeConfig_t *channelRangeConfigs, const rxChannelRangeConfig_t *defaultChannelRangeConfigs, int16_t showIndex)
 {
     const char *format = "rxrange %u %u %u";
     for (uint32_t i = 0; i < NON_AUX_CHANNEL_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultChannelRangeConfigs) {
             equalsDefault = channelRangeConfigs[i].min == defaultChannelRangeConfigs[i].min
@@ -1149,7 +1156,7 @@ static void cliRxRange(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printRxRange(DUMP_MASTER, rxChannelRangeConfigs(0), NULL);
+        printRxRange(DUMP_MASTER, rxChannelRangeConfigs(0), NULL, -1);
     } else if (sl_strcasecmp(cmdline, "reset") == 0) {
         resetAllRxChannelRangeConfigurations();
     } else {
@@ -1186,10 +1193,13 @@ static void cliRxRange(char *cmdline)
 }
 
 #ifdef USE_TEMPERATURE_SENSOR
-static void printTempSensor(uint8_t dumpMask, const tempSensorConfig_t *tempSensorConfigs, const tempSensorConfig_t *defaultTempSensorConfigs)
+static void printTempSensor(uint8_t dumpMask, const tempSensorConfig_t *tempSensorConfigs, const tempSensorConfig_t *defaultTempSensorConfigs, int16_t showIndex)
 {
     const char *format = "temp_sensor %u %u %s %d %d %u %s";
     for (uint8_t i = 0; i < MAX_TEMP_SENSORS; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         bool equalsDefault = false;
         char label[5], hex_address[17];
         strncpy(label, tempSensorConfigs[i].label, TEMPERATURE_LABEL_LEN);
@@ -1227,7 +1237,7 @@ static void printTempSensor(uint8_t dumpMask, const tempSensorConfig_t *tempSens
 static void cliTempSensor(char *cmdline)
 {
     if (isEmpty(cmdline)) {
-        printTempSensor(DUMP_MASTER, tempSensorConfig(0), NULL);
+        printTempSensor(DUMP_MASTER, tempSensorConfig(0), NULL, -1);
     } else if (sl_strcasecmp(cmdline, "reset") == 0) {
         resetTempSensorConfig();
     } else {
@@ -1301,10 +1311,13 @@ static void cliTempSensor(char *cmdline)
 #endif
 
 #if defined(USE_SAFE_HOME)
-static void printSafeHomes(uint8_t dumpMask, const navSafeHome_t *navSafeHome, const navSafeHome_t *defaultSafeHome)
+static void printSafeHomes(uint8_t dumpMask, const navSafeHome_t *navSafeHome, const navSafeHome_t *defaultSafeHome, int16_t showIndex)
 {
     const char *format = "safehome %u %u %d %d"; // uint8_t enabled, int32_t lat; int32_t lon
     for (uint8_t i = 0; i < MAX_SAFE_HOMES; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultSafeHome) {
             equalsDefault = navSafeHome[i].enabled == defaultSafeHome[i].enabled
@@ -1321,7 +1334,7 @@ static void printSafeHomes(uint8_t dumpMask, const navSafeHome_t *navSafeHome, c
 static void cliSafeHomes(char *cmdline)
 {
     if (isEmpty(cmdline)) {
-        printSafeHomes(DUMP_MASTER, safeHomeConfig(0), NULL);
+        printSafeHomes(DUMP_MASTER, safeHomeConfig(0), NULL, -1);
     } else if (sl_strcasecmp(cmdline, "reset") == 0) {
         resetSafeHomes();
     } else {
@@ -1362,11 +1375,16 @@ static void cliSafeHomes(char *cmdline)
 
 #endif
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
-static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, const navWaypoint_t *defaultNavWaypoint)
+static void printWaypoints(uint8_t dumpMask, const navWaypoint_t *navWaypoint, const navWaypoint_t *defaultNavWaypoint, int16_t showIndex)
 {
-    cliPrintLinef("#wp %d %svalid", posControl.waypointCount, posControl.waypointListValid ? "" : "in"); //int8_t bool
+    if (showIndex <= 0) {
+        cliPrintLinef("#wp %d %svalid", posControl.waypointCount, posControl.waypointListValid ? "" : "in"); //int8_t bool
+    }
     const char *format = "wp %u %u %d %d %d %d %d %d %u"; //uint8_t action; int32_t lat; int32_t lon; int32_t alt; int16_t p1 int16_t p2 int16_t p3; uint8_t flag
     for (uint8_t i = 0; i < NAV_MAX_WAYPOINTS; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         bool equalsDefault = false;
         if (defaultNavWaypoint) {
             equalsDefault = navWaypoint[i].action == defaultNavWaypoint[i].action
@@ -1409,7 +1427,7 @@ static void cliWaypoints(char *cmdline)
     static int8_t multiMissionWPCounter = 0;
 #endif
     if (isEmpty(cmdline)) {
-        printWaypoints(DUMP_MASTER, posControl.waypointList, NULL);
+        printWaypoints(DUMP_MASTER, posControl.waypointList, NULL, -1);
     } else if (sl_strcasecmp(cmdline, "reset") == 0) {
         resetWaypointList();
     } else if (sl_strcasecmp(cmdline, "load") == 0) {
@@ -1545,12 +1563,15 @@ static void cliWaypoints(char *cmdline)
 #endif
 
 #ifdef USE_LED_STRIP
-static void printLed(uint8_t dumpMask, const ledConfig_t *ledConfigs, const ledConfig_t *defaultLedConfigs)
+static void printLed(uint8_t dumpMask, const ledConfig_t *ledConfigs, const ledConfig_t *defaultLedConfigs, int16_t showIndex)
 {
     const char *format = "led %u %s";
     char ledConfigBuffer[20];
     char ledConfigDefaultBuffer[20];
     for (uint32_t i = 0; i < LED_MAX_STRIP_LENGTH; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         ledConfig_t ledConfig = ledConfigs[i];
         generateLedConfig(&ledConfig, ledConfigBuffer, sizeof(ledConfigBuffer));
         bool equalsDefault = false;
@@ -1570,7 +1591,7 @@ static void cliLed(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printLed(DUMP_MASTER, ledStripConfig()->ledConfigs, NULL);
+        printLed(DUMP_MASTER, ledStripConfig()->ledConfigs, NULL, -1);
     } else {
         ptr = cmdline;
         i = fastA2I(ptr);
@@ -1585,10 +1606,13 @@ static void cliLed(char *cmdline)
     }
 }
 
-static void printColor(uint8_t dumpMask, const hsvColor_t *colors, const hsvColor_t *defaultColors)
+static void printColor(uint8_t dumpMask, const hsvColor_t *colors, const hsvColor_t *defaultColors, int16_t showIndex)
 {
     const char *format = "color %u %d,%u,%u";
     for (uint32_t i = 0; i < LED_CONFIGURABLE_COLOR_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const hsvColor_t *color = &colors[i];
         bool equalsDefault = false;
         if (defaultColors) {
@@ -1605,7 +1629,7 @@ static void printColor(uint8_t dumpMask, const hsvColor_t *colors, const hsvColo
 static void cliColor(char *cmdline)
 {
     if (isEmpty(cmdline)) {
-        printColor(DUMP_MASTER, ledStripConfig()->colors, NULL);
+        printColor(DUMP_MASTER, ledStripConfig()->colors, NULL, -1);
     } else {
         const char *ptr = cmdline;
         const int i = fastA2I(ptr);
@@ -1620,10 +1644,14 @@ static void cliColor(char *cmdline)
     }
 }
 
-static void printModeColor(uint8_t dumpMask, const ledStripConfig_t *ledStripConfig, const ledStripConfig_t *defaultLedStripConfig)
+// showIndex selects a mode, LED_MODE_COUNT the special colors
+static void printModeColor(uint8_t dumpMask, const ledStripConfig_t *ledStripConfig, const ledStripConfig_t *defaultLedStripConfig, int16_t showIndex)
 {
     const char *format = "mode_color %u %u %u";
     for (uint32_t i = 0; i < LED_MODE_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         for (uint32_t j = 0; j < LED_DIRECTION_COUNT; j++) {
             int colorIndex = ledStripConfig->modeColors[i].color[j];
             bool equalsDefault = false;
@@ -1637,6 +1665,9 @@ static void printModeColor(uint8_t dumpMask, const ledStripConfig_t *ledStripCon
     }
 
     for (uint32_t j = 0; j < LED_SPECIAL_COLOR_COUNT; j++) {
+        if (showIndex != -1 && showIndex != LED_MODE_COUNT) {
+            break;
+        }
         const int colorIndex = ledStripConfig->specialColors.color[j];
         bool equalsDefault = false;
         if (defaultLedStripConfig) {
@@ -1653,7 +1684,7 @@ static void cliModeColor(char *cmdline)
     char * saveptr;
 
     if (isEmpty(cmdline)) {
-        printModeColor(DUMP_MASTER, ledStripConfig(), NULL);
+        printModeColor(DUMP_MASTER, ledStripConfig(), NULL, -1);
     } else {
         enum {MODE = 0, FUNCTION, COLOR, ARGS_COUNT};
         int args[ARGS_COUNT];
@@ -1701,11 +1732,14 @@ static void cliDelay(char* cmdLine) {
 
 }
 
-static void printServo(uint8_t dumpMask, const servoParam_t *servoParam, const servoParam_t *defaultServoParam)
+static void printServo(uint8_t dumpMask, const servoParam_t *servoParam, const servoParam_t *defaultServoParam, int16_t showIndex)
 {
     // print out servo settings
     const char *format = "servo %u %d %d %d %d";
     for (uint32_t i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const servoParam_t *servoConf = &servoParam[i];
         bool equalsDefault = false;
         if (defaultServoParam) {
@@ -1743,7 +1777,7 @@ static void cliServo(char *cmdline)
     const char *ptr;
 
     if (isEmpty(cmdline)) {
-        printServo(DUMP_MASTER, servoParams(0), NULL);
+        printServo(DUMP_MASTER, servoParams(0), NULL, -1);
     } else {
         int validArgumentCount = 0;
 
@@ -1802,7 +1836,7 @@ static void cliServo(char *cmdline)
     }
 }
 
-static void printServoMix(uint8_t dumpMask, const servoMixer_t *customServoMixers, const servoMixer_t *defaultCustomServoMixers)
+static void printServoMix(uint8_t dumpMask, const servoMixer_t *customServoMixers, const servoMixer_t *defaultCustomServoMixers, int16_t showIndex)
 {
     const char *format = "smix %d %d %d %d %d %d";
     for (uint32_t i = 0; i < MAX_SERVO_RULES; i++) {
@@ -1810,6 +1844,9 @@ static void printServoMix(uint8_t dumpMask, const servoMixer_t *customServoMixer
         if (customServoMixer.rate == 0) {
             break;
         }
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
 
         bool equalsDefault = false;
         if (defaultCustomServoMixers) {
@@ -1858,7 +1895,7 @@ static void cliServoMix(char *cmdline)
     uint8_t len = strlen(cmdline);
 
     if (len == 0) {
-        printServoMix(DUMP_MASTER, customServoMixers(0), NULL);
+        printServoMix(DUMP_MASTER, customServoMixers(0), NULL, -1);
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         // erase custom mixer
         pgResetCopy(customServoMixersMutable(0), PG_SERVO_MIXER);
@@ -1961,6 +1998,7 @@ static void processCliLogic(char *cmdline, int16_t lcIndex) {
         }
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         pgResetCopy(logicConditionsMutable(0), PG_LOGIC_CONDITIONS);
+        logicConditionInvalidate();
     } else {
         enum {
             INDEX = 0,
@@ -2006,6 +2044,7 @@ static void processCliLogic(char *cmdline, int16_t lcIndex) {
             logicConditionsMutable(i)->operandB.type = args[OPERAND_B_TYPE];
             logicConditionsMutable(i)->operandB.value = args[OPERAND_B_VALUE];
             logicConditionsMutable(i)->flags = args[FLAGS];
+            logicConditionInvalidate();
 
             processCliLogic("", i);
         } else {
@@ -2018,10 +2057,13 @@ static void cliLogic(char *cmdline) {
     processCliLogic(cmdline, -1);
 }
 
-static void printGvar(uint8_t dumpMask, const globalVariableConfig_t *gvars, const globalVariableConfig_t *defaultGvars)
+static void printGvar(uint8_t dumpMask, const globalVariableConfig_t *gvars, const globalVariableConfig_t *defaultGvars, int16_t showIndex)
 {
     const char *format = "gvar %d %d %d %d";
     for (uint32_t i = 0; i < MAX_GLOBAL_VARIABLES; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const globalVariableConfig_t gvar = gvars[i];
 
         bool equalsDefault = false;
@@ -2054,7 +2096,7 @@ static void cliGvar(char *cmdline) {
     uint8_t len = strlen(cmdline);
 
     if (len == 0) {
-        printGvar(DUMP_MASTER, globalVariableConfigs(0), NULL);
+        printGvar(DUMP_MASTER, globalVariableConfigs(0), NULL, -1);
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         pgResetCopy(globalVariableConfigsMutable(0), PG_GLOBAL_VARIABLE_CONFIG);
     } else {
@@ -2094,10 +2136,13 @@ static void cliGvar(char *cmdline) {
     }
 }
 
-static void printPid(uint8_t dumpMask, const programmingPid_t *programmingPids, const programmingPid_t *defaultProgrammingPids)
+static void printPid(uint8_t dumpMask, const programmingPid_t *programmingPids, const programmingPid_t *defaultProgrammingPids, int16_t showIndex)
 {
     const char *format = "pid %d %d %d %d %d %d %d %d %d %d";
     for (uint32_t i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const programmingPid_t pid = programmingPids[i];
 
         bool equalsDefault = false;
@@ -2148,7 +2193,7 @@ static void cliPid(char *cmdline) {
     uint8_t len = strlen(cmdline);
 
     if (len == 0) {
-        printPid(DUMP_MASTER, programmingPids(0), NULL);
+        printPid(DUMP_MASTER, programmingPids(0), NULL, -1);
     } else if (sl_strncasecmp(cmdline, "reset", 5) == 0) {
         pgResetCopy(programmingPidsMutable(0), PG_LOGIC_CONDITIONS);
     } else {
@@ -2314,6 +2359,12 @@ static void cliFlashInfo(char *cmdline)
             FLASH_PARTITION_SECTOR_COUNT(flashPartition) * layout->sectorSize,
             flashfsGetOffset()
     );
+
+    const flashfsStats_t *stats = flashfsGetStats();
+    cliPrintLinef("FlashFS droppedWrites=%u, droppedBytes=%u, busyDeferrals=%u, stallTime=%uus, bufferPeak=%u/%u",
+            stats->droppedWrites, stats->droppedBytes, stats->busyDeferrals, stats->stallTimeUs,
+            stats->bufferPeak, flashfsGetWriteBufferSize()
+    );
 #endif
 }
 
@@ -2503,6 +2554,7 @@ static void cliOsdLayout(char *cmdline)
         case 5:
             // Layout, item, pos and visibility. Set the item.
             osdLayoutsConfigMutable()->item_pos[layout][item] = OSD_POS(col, row) | (visible ? OSD_VISIBLE_FLAG : 0);
+            osdStartFullRedraw();
             break;
         default:
             // Unhandled
@@ -2513,7 +2565,9 @@ static void cliOsdLayout(char *cmdline)
 
 #endif
 
-static void printFeature(uint8_t dumpMask, const featureConfig_t *featureConfig, const featureConfig_t *featureConfigDefault)
+// showIndex selects a feature to disable, or FEATURE_NAME_COUNT plus
+// a feature to reenable
+static void printFeature(uint8_t dumpMask, const featureConfig_t *featureConfig, const featureConfig_t *featureConfigDefault, int16_t showIndex)
 {
     uint32_t mask = featureConfig->enabledFeatures;
     uint32_t defaultMask = featureConfigDefault->enabledFeatures;
@@ -2522,6 +2576,8 @@ static void printFeature(uint8_t dumpMask, const featureConfig_t *featureConfig,
             break;
         if (featureNames[i][0] == '\0')
             continue;
+        if (showIndex != -1 && showIndex != (int)i)
+            continue;
         const char *format = "feature -%s";
         cliDefaultPrintLinef(dumpMask, (defaultMask | ~mask) & (1 << i), format, featureNames[i]);
         cliDumpPrintLinef(dumpMask, (~defaultMask | mask) & (1 << i), format, featureNames[i]);
@@ -2531,6 +2587,8 @@ static void printFeature(uint8_t dumpMask, const featureConfig_t *featureConfig,
             break;
         if (featureNames[i][0] == '\0')
             continue;
+        if (showIndex != -1 && showIndex != (int)(FEATURE_NAME_COUNT + i))
+            continue;
         const char *format = "feature %s";
         if (defaultMask & (1 << i)) {
             cliDefaultPrintLinef(dumpMask, (~defaultMask | mask) & (1 << i), format, featureNames[i]);
@@ -2607,7 +2665,7 @@ static void cliFeature(char *cmdline)
 }
 
 #ifdef USE_BLACKBOX
-static void printBlackbox(uint8_t dumpMask, const blackboxConfig_t *config, const blackboxConfig_t *configDefault)
+static void printBlackbox(uint8_t dumpMask, const blackboxConfig_t *config, const blackboxConfig_t *configDefault, int16_t showIndex)
 {
 
     UNUSED(configDefault);
@@ -2618,6 +2676,9 @@ static void printBlackbox(uint8_t dumpMask, const blackboxConfig_t *config, cons
         if (blackboxIncludeFlagNames[i] == NULL) {
             break;
         }
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
 
         const char *formatOn = "blackbox %s";
         const char *formatOff = "blackbox -%s";
@@ -2695,12 +2756,15 @@ static void cliBlackbox(char *cmdline)
 #endif
 
 #if defined(BEEPER) || defined(USE_DSHOT)
-static void printBeeper(uint8_t dumpMask, const beeperConfig_t *beeperConfig, const beeperConfig_t *beeperConfigDefault)
+static void printBeeper(uint8_t dumpMask, const beeperConfig_t *beeperConfig, const beeperConfig_t *beeperConfigDefault, int16_t showIndex)
 {
     const uint8_t beeperCount = beeperTableEntryCount();
     const uint32_t mask = beeperConfig->beeper_off_flags;
     const uint32_t defaultMask = beeperConfigDefault->beeper_off_flags;
     for (int i = 0; i < beeperCount - 2; i++) {
+        if (showIndex != -1 && showIndex != (int)i) {
+            continue;
+        }
         const char *formatOff = "beeper -%s";
         const char *formatOn = "beeper %s";
         cliDefaultPrintLinef(dumpMask, ~(mask ^ defaultMask) & (1 << i), mask & (1 << i) ? formatOn : formatOff, beeperNameForTableIndex(i));
@@ -3008,19 +3072,6 @@ static void cliProfile(char *cmdline)
     }
 }
 
-static void cliDumpProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigProfile(profileIndex);
-    cliPrintHashLine("profile");
-    cliPrintLinef("profile %d\r\n", getConfigProfile() + 1);
-    dumpAllValues(PROFILE_VALUE, dumpMask);
-    dumpAllValues(CONTROL_RATE_VALUE, dumpMask);
-}
-
 static void cliBatteryProfile(char *cmdline)
 {
     // CLI profile index is 1-based
@@ -3036,18 +3087,6 @@ static void cliBatteryProfile(char *cmdline)
     }
 }
 
-static void cliDumpBatteryProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_BATTERY_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigBatteryProfile(profileIndex);
-    cliPrintHashLine("battery_profile");
-    cliPrintLinef("battery_profile %d\r\n", getConfigBatteryProfile() + 1);
-    dumpAllValues(BATTERY_CONFIG_VALUE, dumpMask);
-}
-
 #ifdef USE_CLI_BATCH
 static void cliPrintCommandBatchWarning(const char *warning)
 {
@@ -3192,72 +3231,70 @@ static void cliSet(char *cmdline)
             eqptr++;
         }
 
-        for (uint32_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-            val = settingGet(i);
-            // ensure exact match when setting to prevent setting variables with shorter names
-            if (settingNameIsExactMatch(val, name, cmdline, variableNameLength)) {
-                const setting_type_e type = SETTING_TYPE(val);
-                if (type == VAR_STRING) {
-                    // Convert strings to uppercase. Lower case is not supported by the OSD.
-                    sl_toupperptr(eqptr);
-                    // if setting the craftname, remove any quotes around the name.  This allows leading spaces in the name
-                    if ((strcmp(name, "name") == 0 || strcmp(name, "pilot_name") == 0) && (eqptr[0] == '"' && eqptr[strlen(eqptr)-1] == '"')) {
-                        settingSetString(val, eqptr + 1, strlen(eqptr)-2);
-                    } else {
-                        settingSetString(val, eqptr, strlen(eqptr));
-                    }
-                    return;
+        // ensure exact match when setting to prevent setting variables with shorter names
+        val = settingFindIgnoringCase(cmdline, variableNameLength, name);
+        if (val) {
+            const setting_type_e type = SETTING_TYPE(val);
+            if (type == VAR_STRING) {
+                // Convert strings to uppercase. Lower case is not supported by the OSD.
+                sl_toupperptr(eqptr);
+                // if setting the craftname, remove any quotes around the name.  This allows leading spaces in the name
+                if ((strcmp(name, "name") == 0 || strcmp(name, "pilot_name") == 0) && (eqptr[0] == '"' && eqptr[strlen(eqptr)-1] == '"')) {
+                    settingSetString(val, eqptr + 1, strlen(eqptr)-2);
+                } else {
+                    settingSetString(val, eqptr, strlen(eqptr));
                 }
-                const setting_mode_e mode = SETTING_MODE(val);
-                bool changeValue = false;
-                int_float_value_t tmp = {0};
-                switch (mode) {
-                case MODE_DIRECT: {
-                        if (*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
-                            float valuef = fastA2F(eqptr);
-                            // note: compare float values
-                            if (valuef >= (float)settingGetMin(val) && valuef <= (float)settingGetMax(val)) {
-
-                                if (type == VAR_FLOAT)
-                                    tmp.float_value = valuef;
-                                else if (type == VAR_UINT32)
-                                    tmp.uint_value = fastA2UL(eqptr);
-                                else
-                                    tmp.int_value = fastA2I(eqptr);
-
-                                changeValue = true;
-                            }
+                return;
+            }
+            const setting_mode_e mode = SETTING_MODE(val);
+            bool changeValue = false;
+            int_float_value_t tmp = {0};
+            switch (mode) {
+            case MODE_DIRECT: {
+                    if (*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
+                        float valuef = fastA2F(eqptr);
+                        // note: compare float values
+                        if (valuef >= (float)settingGetMin(val) && valuef <= (float)settingGetMax(val)) {
+
+                            if (type == VAR_FLOAT)
+                                tmp.float_value = valuef;
+                            else if (type == VAR_UINT32)
+                                tmp.uint_value = fastA2UL(eqptr);
+                            else
+                                tmp.int_value = fastA2I(eqptr);
+
+                            changeValue = true;
                         }
                     }
-                    break;
-                case MODE_LOOKUP: {
-                        const lookupTableEntry_t *tableEntry = settingLookupTable(val);
-                        bool matched = false;
-                        for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
-                            matched = sl_strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
-
-                            if (matched) {
-                                tmp.int_value = tableValueIndex;
-                                changeValue = true;
-                            }
+                }
+                break;
+            case MODE_LOOKUP: {
+                    const lookupTableEntry_t *tableEntry = settingLookupTable(val);
+                    bool matched = false;
+                    for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
+                        matched = sl_strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
+
+                        if (matched) {
+                            tmp.int_value = tableValueIndex;
+                            changeValue = true;
                         }
                     }
-                    break;
                 }
+                break;
+            }
 
-                if (changeValue) {
-                    cliSetIntFloatVar(val, tmp);
-
-                    cliPrintf("%s set to ", name);
-                    cliPrintVar(val, 0);
-                } else {
-                    cliPrintError("Invalid value. ");
-                    cliPrintVarRange(val);
-                    cliPrintLinefeed();
-                }
+            if (changeValue) {
+                cliSetIntFloatVar(val, tmp);
 
-                return;
+                cliPrintf("%s set to ", name);
+                cliPrintVar(val, 0);
+            } else {
+                cliPrintError("Invalid value. ");
+                cliPrintVarRange(val);
+                cliPrintLinefeed();
             }
+
+            return;
         }
         cliPrintErrorLine("Invalid name");
     } else {
@@ -3410,6 +3447,15 @@ static void cliStatus(char *cmdline)
     const int systemRate = getTaskDeltaTime(TASK_SYSTEM) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_SYSTEM)));
     cliPrintLinef(", cycle time: %d, PID rate: %d, RX rate: %d, System rate: %d",  (uint16_t)cycleTime, pidRate, rxRate, systemRate);
 #if !defined(CLI_MINIMAL_VERBOSITY)
+    const rxLatencyStats_t *rxLatency = rxGetLatencyStats();
+    if (rxLatency->stage[RX_LATENCY_PROCESSED].count > 0) {
+        const rxLatency_t *processed = &rxLatency->stage[RX_LATENCY_PROCESSED];
+        const rxLatency_t *setpoint = &rxLatency->stage[RX_LATENCY_SETPOINT];
+        cliPrintLinef("RX frame interval: %u us, latency avg/max to RX task: %u/%u us, to setpoint: %u/%u us",
+            (unsigned)(rxLatency->frameIntervalMovingSum / RX_LATENCY_MOVING_SUM_COUNT),
+            (unsigned)(processed->movingSum / RX_LATENCY_MOVING_SUM_COUNT), (unsigned)processed->max,
+            (unsigned)(setpoint->movingSum / RX_LATENCY_MOVING_SUM_COUNT), (unsigned)setpoint->max);
+    }
     cliPrint("Arming disabled flags:");
     uint32_t flags = armingFlags & ARMING_DISABLED_ALL_FLAGS;
     while (flags) {
@@ -3474,9 +3520,62 @@ static void cliStatus(char *cmdline)
     }
 }
 
+#ifdef USE_SCHEDULER_HISTOGRAMS
+static void cliPrintTaskHistogramPercentile(const taskHistogram_t *histogram, unsigned percent)
+{
+    const unsigned bucket = taskHistogramPercentileBucket(histogram, percent);
+    if (bucket == TASK_HISTOGRAM_BUCKET_COUNT - 1) {
+        cliPrintf(" >=%5u", (uint32_t)taskHistogramBucketLimit(bucket - 1));
+    } else {
+        cliPrintf("  <%5u", (uint32_t)taskHistogramBucketLimit(bucket));
+    }
+}
+
+static void cliTasksHistogram(const char *cmdline)
+{
+    static const char * const histogramNames[TASK_HISTOGRAM_TYPE_COUNT] = { "exec", "late", "block" };
+
+    if (cmdline && sl_strcasecmp(cmdline, "reset") == 0) {
+        schedulerResetTaskHistograms();
+        return;
+    }
+
+    cliPrintLinef("Task histograms        type   p50/us   p90/us   p99/us   max/us");
+    for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(taskId, &taskInfo);
+        if (!taskInfo.isEnabled) {
+            continue;
+        }
+
+        for (taskHistogramType_e type = 0; type < TASK_HISTOGRAM_TYPE_COUNT; type++) {
+            taskHistogram_t histogram;
+            if (!getTaskHistogram(taskId, type, &histogram)) {
+                continue;
+            }
+
+            cliPrintf("%2d - %12s  %8s", taskId, taskInfo.taskName, histogramNames[type]);
+            cliPrintTaskHistogramPercentile(&histogram, 50);
+            cliPrintTaskHistogramPercentile(&histogram, 90);
+            cliPrintTaskHistogramPercentile(&histogram, 99);
+            cliPrintTaskHistogramPercentile(&histogram, 100);
+            cliPrintLinefeed();
+        }
+    }
+}
+#endif
+
 static void cliTasks(char *cmdline)
 {
+#ifdef USE_SCHEDULER_HISTOGRAMS
+    if (sl_strncasecmp(cmdline, "histogram", 9) == 0) {
+        cliTasksHistogram(nextArg(cmdline));
+        return;
+    }
+#else
     UNUSED(cmdline);
+#endif
+
     int maxLoadSum = 0;
     int averageLoadSum = 0;
     cfCheckFuncInfo_t checkFuncInfo;
@@ -3553,6 +3652,68 @@ static void cliResource(char *cmdline)
     }
 }
 
+// Dumps are generated a few lines at a time from cliProcess(), so a large
+// "dump all" doesn't stall the main loop waiting for the serial port to
+// drain. Each run of the CLI task keeps generating output while there is
+// room in the TX buffer and the time slice hasn't been used up.
+#define CLI_DUMP_MIN_TX_FREE        128
+#define CLI_DUMP_TIME_SLICE_US      1000
+
+typedef enum {
+    DUMP_STEP_NONE = 0,
+    DUMP_STEP_HEADER,
+    DUMP_STEP_MOTOR_MIX,
+    DUMP_STEP_SERVO_MIX,
+    DUMP_STEP_SERVO,
+    DUMP_STEP_SAFEHOME,
+    DUMP_STEP_FEATURE,
+    DUMP_STEP_BEEPER,
+    DUMP_STEP_BLACKBOX,
+    DUMP_STEP_MAP,
+    DUMP_STEP_SERIAL,
+    DUMP_STEP_LED,
+    DUMP_STEP_LED_COLOR,
+    DUMP_STEP_LED_MODE_COLOR,
+    DUMP_STEP_AUX,
+    DUMP_STEP_ADJRANGE,
+    DUMP_STEP_RXRANGE,
+    DUMP_STEP_TEMP_SENSOR,
+    DUMP_STEP_WAYPOINTS,
+    DUMP_STEP_OSD_LAYOUT,
+    DUMP_STEP_LOGIC,
+    DUMP_STEP_GVAR,
+    DUMP_STEP_PID,
+    DUMP_STEP_MASTER_VALUES,
+    DUMP_STEP_PROFILE,
+    DUMP_STEP_BATTERY_PROFILE,
+    DUMP_STEP_FOOTER,
+    DUMP_STEP_DONE,
+} cliDumpStep_e;
+
+typedef struct cliDumpState_s {
+    cliDumpStep_e step;
+    bool stepStarted;
+    uint8_t dumpMask;
+    bool batchModeEnabled;
+    uint8_t profileIndexSave;
+    uint8_t batteryProfileIndexSave;
+    // Profiles dumped by DUMP_STEP_PROFILE and DUMP_STEP_BATTERY_PROFILE
+    uint8_t profileIndex;
+    uint8_t profileEnd;
+    uint8_t batteryProfileIndex;
+    uint8_t batteryProfileEnd;
+    // Settings cursor, see dumpValuesStep()
+    uint16_t valueSection;
+    uint8_t group;
+    const pgRegistry_t *pg;
+    uint16_t setting;
+    uint16_t groupEnd;
+    // Entry of the list section printed next, see dumpListStart()
+    int16_t entry;
+} cliDumpState_t;
+
+static cliDumpState_t cliDumpState;
+
 static void backupConfigs(void)
 {
     // make copies of configs to do differencing
@@ -3565,37 +3726,23 @@ static void backupConfigs(void)
     }
 }
 
-static void restoreConfigs(void)
+static void swapConfigsWithCopies(void)
 {
     PG_FOREACH(pg) {
-        if (pgIsProfile(pg)) {
-            memcpy(pg->address, pg->copy, pgSize(pg) * MAX_PROFILE_COUNT);
-        } else {
-            memcpy(pg->address, pg->copy, pgSize(pg));
+        const size_t size = pgIsProfile(pg) ? pgSize(pg) * MAX_PROFILE_COUNT : pgSize(pg);
+        for (size_t ii = 0; ii < size; ii++) {
+            const uint8_t tmp = pg->address[ii];
+            pg->address[ii] = pg->copy[ii];
+            pg->copy[ii] = tmp;
         }
     }
 }
 
-static void printConfig(const char *cmdline, bool doDiff)
+// Loads the defaults into the PG copies while keeping the actual
+// configuration active, so the FC keeps running normally while the
+// dump is being generated.
+static void loadDefaultConfigCopies(void)
 {
-    uint8_t dumpMask = DUMP_MASTER;
-    const char *options;
-    if ((options = checkCommand(cmdline, "master"))) {
-        dumpMask = DUMP_MASTER; // only
-    } else if ((options = checkCommand(cmdline, "profile"))) {
-        dumpMask = DUMP_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
-        dumpMask = DUMP_BATTERY_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "all"))) {
-        dumpMask = DUMP_ALL;   // all profiles and rates
-    } else {
-        options = cmdline;
-    }
-
-    if (doDiff) {
-        dumpMask = dumpMask | DO_DIFF;
-    }
-
     const int currentProfileIndexSave = getConfigProfile();
     const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
     backupConfigs();
@@ -3604,23 +3751,99 @@ static void printConfig(const char *cmdline, bool doDiff)
     // restore the profile indices, since they should not be reset for proper comparison
     setConfigProfile(currentProfileIndexSave);
     setConfigBatteryProfile(currentBatteryProfileIndexSave);
+    // bring back the actual values, leaving the defaults in the copies. The
+    // active profile pointers refer to the PG storage, so they remain valid.
+    swapConfigsWithCopies();
+#ifdef USE_LED_STRIP
+    reevaluateLedConfig();
+#endif
+}
 
-    if (checkCommand(options, "showdefaults")) {
-        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
+// Returns true when all the values of the given profile (or the whole
+// PG for master values) are equal to their defaults, so a diff can skip
+// the whole group without looking at individual settings.
+static bool pgValuesEqualDefault(const pgRegistry_t *pg, const setting_t *value, uint8_t profileIndex)
+{
+    const size_t profileSize = settingGetProfileSize(value);
+    const size_t offset = profileSize * profileIndex;
+    return memcmp(pg->address + offset, pg->copy + offset, profileSize ? profileSize : pgSize(pg)) == 0;
+}
+
+static void dumpValuesStart(uint16_t valueSection)
+{
+    cliDumpState.valueSection = valueSection;
+    cliDumpState.group = 0;
+    cliDumpState.setting = 1;
+    cliDumpState.groupEnd = 0;
+}
+
+// Prints the next value from the section being dumped, walking the
+// settings one PG at a time. Returns true once all of them have been
+// visited.
+static bool dumpValuesStep(uint8_t profileIndex)
+{
+    for (;;) {
+        if (cliDumpState.setting > cliDumpState.groupEnd) {
+            pgn_t pgn;
+            uint16_t start;
+            if (!settingsGetParameterGroup(cliDumpState.group++, &pgn, &start, &cliDumpState.groupEnd)) {
+                return true;
+            }
+            const setting_t *first = settingGet(start);
+            cliDumpState.pg = pgFind(pgn);
+            cliDumpState.setting = start;
+            if (SETTING_SECTION(first) != cliDumpState.valueSection ||
+                ((cliDumpState.dumpMask & DO_DIFF) && pgValuesEqualDefault(cliDumpState.pg, first, profileIndex))) {
+                // Skip the whole group
+                cliDumpState.setting = cliDumpState.groupEnd + 1;
+            }
+            continue;
+        }
+        const setting_t *value = settingGet(cliDumpState.setting++);
+        if (dumpPgValue(value, cliDumpState.pg, profileIndex, cliDumpState.dumpMask)) {
+            return false;
+        }
     }
+}
 
-#ifdef USE_CLI_BATCH
-    bool batchModeEnabled = false;
-#endif
+static void dumpNextStep(void)
+{
+    cliDumpState.step++;
+    cliDumpState.stepStarted = false;
+}
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+// List sections print one entry per step, a whole list wouldn't fit
+// the TX buffer. Returns true on the first entry, so the section header
+// gets printed once.
+static bool dumpListStart(void)
+{
+    if (cliDumpState.stepStarted) {
+        return false;
+    }
+    cliDumpState.entry = 0;
+    cliDumpState.stepStarted = true;
+    return true;
+}
+
+// Moves on to the next entry, returns false once all count have been printed
+static bool dumpListNext(int16_t count)
+{
+    return ++cliDumpState.entry < count;
+}
+
+static void printConfigStep(void)
+{
+    const uint8_t dumpMask = cliDumpState.dumpMask;
+
+    switch (cliDumpState.step) {
+    case DUMP_STEP_HEADER:
         cliPrintHashLine("version");
         cliVersion(NULL);
 
 #ifdef USE_CLI_BATCH
         cliPrintHashLine("start the command batch");
         cliPrintLine("batch start");
-        batchModeEnabled = true;
+        cliDumpState.batchModeEnabled = true;
 #endif
 
         if ((dumpMask & (DUMP_ALL | DO_DIFF)) == (DUMP_ALL | DO_DIFF)) {
@@ -3633,142 +3856,378 @@ static void printConfig(const char *cmdline, bool doDiff)
 
         cliPrintHashLine("resources");
         //printResource(dumpMask, &defaultConfig);
+        break;
 
-        cliPrintHashLine("Mixer: motor mixer");
-        cliDumpPrintLinef(dumpMask, primaryMotorMixer_CopyArray[0].throttle == 0.0f, "\r\nmmix reset\r\n");
-
-        printMotorMix(dumpMask, primaryMotorMixer_CopyArray, primaryMotorMixer(0));
+    case DUMP_STEP_MOTOR_MIX:
+        if (dumpListStart()) {
+            cliPrintHashLine("Mixer: motor mixer");
+            cliDumpPrintLinef(dumpMask, primaryMotorMixer(0)->throttle == 0.0f, "\r\nmmix reset\r\n");
+        }
+        printMotorMix(dumpMask, primaryMotorMixer(0), primaryMotorMixer_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_SUPPORTED_MOTORS)) {
+            return;
+        }
+        break;
 
+    case DUMP_STEP_SERVO_MIX:
         // print custom servo mixer if exists
-        cliPrintHashLine("Mixer: servo mixer");
-        cliDumpPrintLinef(dumpMask, customServoMixers_CopyArray[0].rate == 0, "smix reset\r\n");
-        printServoMix(dumpMask, customServoMixers_CopyArray, customServoMixers(0));
+        if (dumpListStart()) {
+            cliPrintHashLine("Mixer: servo mixer");
+            cliDumpPrintLinef(dumpMask, customServoMixers(0)->rate == 0, "smix reset\r\n");
+        }
+        printServoMix(dumpMask, customServoMixers(0), customServoMixers_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_SERVO_RULES)) {
+            return;
+        }
+        break;
 
+    case DUMP_STEP_SERVO:
         // print servo parameters
-        cliPrintHashLine("Outputs [servo]");
-        printServo(dumpMask, servoParams_CopyArray, servoParams(0));
+        if (dumpListStart()) {
+            cliPrintHashLine("Outputs [servo]");
+        }
+        printServo(dumpMask, servoParams(0), servoParams_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_SUPPORTED_SERVOS)) {
+            return;
+        }
+        break;
 
 #if defined(USE_SAFE_HOME)
-        cliPrintHashLine("safehome");
-        printSafeHomes(dumpMask, safeHomeConfig_CopyArray, safeHomeConfig(0));
+    case DUMP_STEP_SAFEHOME:
+        if (dumpListStart()) {
+            cliPrintHashLine("safehome");
+        }
+        printSafeHomes(dumpMask, safeHomeConfig(0), safeHomeConfig_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_SAFE_HOMES)) {
+            return;
+        }
+        break;
 #endif
 
-        cliPrintHashLine("features");
-        printFeature(dumpMask, &featureConfig_Copy, featureConfig());
+    case DUMP_STEP_FEATURE:
+        if (dumpListStart()) {
+            cliPrintHashLine("features");
+        }
+        printFeature(dumpMask, featureConfig(), &featureConfig_Copy, cliDumpState.entry);
+        if (dumpListNext(2 * FEATURE_NAME_COUNT)) {
+            return;
+        }
+        break;
 
 #if defined(BEEPER) || defined(USE_DSHOT)
-        cliPrintHashLine("beeper");
-        printBeeper(dumpMask, &beeperConfig_Copy, beeperConfig());
+    case DUMP_STEP_BEEPER:
+        if (dumpListStart()) {
+            cliPrintHashLine("beeper");
+        }
+        printBeeper(dumpMask, beeperConfig(), &beeperConfig_Copy, cliDumpState.entry);
+        if (dumpListNext(beeperTableEntryCount() - 2)) {
+            return;
+        }
+        break;
 #endif
 
 #ifdef USE_BLACKBOX
-        cliPrintHashLine("blackbox");
-        printBlackbox(dumpMask, &blackboxConfig_Copy, blackboxConfig());
+    case DUMP_STEP_BLACKBOX:
+        if (dumpListStart()) {
+            cliPrintHashLine("blackbox");
+        }
+        printBlackbox(dumpMask, blackboxConfig(), &blackboxConfig_Copy, cliDumpState.entry);
+        if (dumpListNext(ARRAYLEN(blackboxIncludeFlagNames) - 1)) {
+            return;
+        }
+        break;
 #endif
 
+    case DUMP_STEP_MAP:
         cliPrintHashLine("Receiver: Channel map");
-        printMap(dumpMask, &rxConfig_Copy, rxConfig());
+        printMap(dumpMask, rxConfig(), &rxConfig_Copy);
+        break;
 
-        cliPrintHashLine("Ports");
-        printSerial(dumpMask, &serialConfig_Copy, serialConfig());
+    case DUMP_STEP_SERIAL:
+        if (dumpListStart()) {
+            cliPrintHashLine("Ports");
+        }
+        printSerial(dumpMask, serialConfig(), &serialConfig_Copy, cliDumpState.entry);
+        if (dumpListNext(SERIAL_PORT_COUNT)) {
+            return;
+        }
+        break;
 
 #ifdef USE_LED_STRIP
-        cliPrintHashLine("LEDs");
-        printLed(dumpMask, ledStripConfig_Copy.ledConfigs, ledStripConfig()->ledConfigs);
+    case DUMP_STEP_LED:
+        if (dumpListStart()) {
+            cliPrintHashLine("LEDs");
+        }
+        printLed(dumpMask, ledStripConfig()->ledConfigs, ledStripConfig_Copy.ledConfigs, cliDumpState.entry);
+        if (dumpListNext(LED_MAX_STRIP_LENGTH)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("LED color");
-        printColor(dumpMask, ledStripConfig_Copy.colors, ledStripConfig()->colors);
+    case DUMP_STEP_LED_COLOR:
+        if (dumpListStart()) {
+            cliPrintHashLine("LED color");
+        }
+        printColor(dumpMask, ledStripConfig()->colors, ledStripConfig_Copy.colors, cliDumpState.entry);
+        if (dumpListNext(LED_CONFIGURABLE_COLOR_COUNT)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("LED mode_color");
-        printModeColor(dumpMask, &ledStripConfig_Copy, ledStripConfig());
+    case DUMP_STEP_LED_MODE_COLOR:
+        if (dumpListStart()) {
+            cliPrintHashLine("LED mode_color");
+        }
+        printModeColor(dumpMask, ledStripConfig(), &ledStripConfig_Copy, cliDumpState.entry);
+        if (dumpListNext(LED_MODE_COUNT + 1)) {
+            return;
+        }
+        break;
 #endif
 
-        cliPrintHashLine("Modes [aux]");
-        printAux(dumpMask, modeActivationConditions_CopyArray, modeActivationConditions(0));
+    case DUMP_STEP_AUX:
+        if (dumpListStart()) {
+            cliPrintHashLine("Modes [aux]");
+        }
+        printAux(dumpMask, modeActivationConditions(0), modeActivationConditions_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_MODE_ACTIVATION_CONDITION_COUNT)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("Adjustments [adjrange]");
-        printAdjustmentRange(dumpMask, adjustmentRanges_CopyArray, adjustmentRanges(0));
+    case DUMP_STEP_ADJRANGE:
+        if (dumpListStart()) {
+            cliPrintHashLine("Adjustments [adjrange]");
+        }
+        printAdjustmentRange(dumpMask, adjustmentRanges(0), adjustmentRanges_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_ADJUSTMENT_RANGE_COUNT)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("Receiver rxrange");
-        printRxRange(dumpMask, rxChannelRangeConfigs_CopyArray, rxChannelRangeConfigs(0));
+    case DUMP_STEP_RXRANGE:
+        if (dumpListStart()) {
+            cliPrintHashLine("Receiver rxrange");
+        }
+        printRxRange(dumpMask, rxChannelRangeConfigs(0), rxChannelRangeConfigs_CopyArray, cliDumpState.entry);
+        if (dumpListNext(NON_AUX_CHANNEL_COUNT)) {
+            return;
+        }
+        break;
 
 #ifdef USE_TEMPERATURE_SENSOR
-        cliPrintHashLine("temp_sensor");
-        printTempSensor(dumpMask, tempSensorConfig_CopyArray, tempSensorConfig(0));
+    case DUMP_STEP_TEMP_SENSOR:
+        if (dumpListStart()) {
+            cliPrintHashLine("temp_sensor");
+        }
+        printTempSensor(dumpMask, tempSensorConfig(0), tempSensorConfig_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_TEMP_SENSORS)) {
+            return;
+        }
+        break;
 #endif
 
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
-        cliPrintHashLine("Mission Control Waypoints [wp]");
-        printWaypoints(dumpMask, posControl.waypointList, nonVolatileWaypointList(0));
+    case DUMP_STEP_WAYPOINTS:
+        if (dumpListStart()) {
+            cliPrintHashLine("Mission Control Waypoints [wp]");
+        }
+        printWaypoints(dumpMask, posControl.waypointList, nonVolatileWaypointList_CopyArray, cliDumpState.entry);
+        if (dumpListNext(NAV_MAX_WAYPOINTS)) {
+            return;
+        }
+        break;
 #endif
 
 #ifdef USE_OSD
-        cliPrintHashLine("OSD [osd_layout]");
-        printOsdLayout(dumpMask, &osdLayoutsConfig_Copy, osdLayoutsConfig(), -1, -1);
+    case DUMP_STEP_OSD_LAYOUT:
+        // One item per step, a full dump has a few hundred osd_layout lines
+        if (dumpListStart()) {
+            cliPrintHashLine("OSD [osd_layout]");
+        }
+        printOsdLayout(dumpMask, osdLayoutsConfig(), &osdLayoutsConfig_Copy,
+            cliDumpState.entry / OSD_ITEM_COUNT, cliDumpState.entry % OSD_ITEM_COUNT);
+        if (dumpListNext(OSD_LAYOUT_COUNT * OSD_ITEM_COUNT)) {
+            return;
+        }
+        break;
 #endif
 
 #ifdef USE_PROGRAMMING_FRAMEWORK
-        cliPrintHashLine("Programming: logic");
-        printLogic(dumpMask, logicConditions_CopyArray, logicConditions(0), -1);
+    case DUMP_STEP_LOGIC:
+        if (dumpListStart()) {
+            cliPrintHashLine("Programming: logic");
+        }
+        printLogic(dumpMask, logicConditions(0), logicConditions_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_LOGIC_CONDITIONS)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("Programming: global variables");
-        printGvar(dumpMask, globalVariableConfigs_CopyArray, globalVariableConfigs(0));
+    case DUMP_STEP_GVAR:
+        if (dumpListStart()) {
+            cliPrintHashLine("Programming: global variables");
+        }
+        printGvar(dumpMask, globalVariableConfigs(0), globalVariableConfigs_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_GLOBAL_VARIABLES)) {
+            return;
+        }
+        break;
 
-        cliPrintHashLine("Programming: PID controllers");
-        printPid(dumpMask, programmingPids_CopyArray, programmingPids(0));
+    case DUMP_STEP_PID:
+        if (dumpListStart()) {
+            cliPrintHashLine("Programming: PID controllers");
+        }
+        printPid(dumpMask, programmingPids(0), programmingPids_CopyArray, cliDumpState.entry);
+        if (dumpListNext(MAX_PROGRAMMING_PID_COUNT)) {
+            return;
+        }
+        break;
 #endif
 
-        cliPrintHashLine("master");
-        dumpAllValues(MASTER_VALUE, dumpMask);
+    case DUMP_STEP_MASTER_VALUES:
+        if (!cliDumpState.stepStarted) {
+            cliPrintHashLine("master");
+            dumpValuesStart(MASTER_VALUE);
+            cliDumpState.stepStarted = true;
+        }
+        if (!dumpValuesStep(0)) {
+            return;
+        }
+        break;
 
-        if (dumpMask & DUMP_ALL) {
-            // dump all profiles
-            const int currentProfileIndexSave = getConfigProfile();
-            const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
-            for (int ii = 0; ii < MAX_PROFILE_COUNT; ++ii) {
-                cliDumpProfile(ii, dumpMask);
+    case DUMP_STEP_PROFILE:
+        if (cliDumpState.profileIndex >= cliDumpState.profileEnd) {
+            break;
+        }
+        if (!cliDumpState.stepStarted) {
+            cliPrintHashLine("profile");
+            cliPrintLinef("profile %d\r\n", cliDumpState.profileIndex + 1);
+            dumpValuesStart(PROFILE_VALUE);
+            cliDumpState.stepStarted = true;
+        }
+        if (dumpValuesStep(cliDumpState.profileIndex)) {
+            if (cliDumpState.valueSection == PROFILE_VALUE) {
+                dumpValuesStart(CONTROL_RATE_VALUE);
+            } else {
+                cliDumpState.profileIndex++;
+                cliDumpState.stepStarted = false;
             }
-            for (int ii = 0; ii < MAX_BATTERY_PROFILE_COUNT; ++ii) {
-                cliDumpBatteryProfile(ii, dumpMask);
+        }
+        return;
+
+    case DUMP_STEP_BATTERY_PROFILE:
+        if (cliDumpState.batteryProfileIndex >= cliDumpState.batteryProfileEnd) {
+            if (dumpMask & DUMP_ALL) {
+                cliPrintHashLine("restore original profile selection");
+                cliPrintLinef("profile %d", cliDumpState.profileIndexSave + 1);
+                cliPrintLinef("battery_profile %d", cliDumpState.batteryProfileIndexSave + 1);
+
+                cliDumpState.batchModeEnabled = false;
             }
-            setConfigProfile(currentProfileIndexSave);
-            setConfigBatteryProfile(currentBatteryProfileIndexSave);
+            break;
+        }
+        if (!cliDumpState.stepStarted) {
+            cliPrintHashLine("battery_profile");
+            cliPrintLinef("battery_profile %d\r\n", cliDumpState.batteryProfileIndex + 1);
+            dumpValuesStart(BATTERY_CONFIG_VALUE);
+            cliDumpState.stepStarted = true;
+        }
+        if (dumpValuesStep(cliDumpState.batteryProfileIndex)) {
+            cliDumpState.batteryProfileIndex++;
+            cliDumpState.stepStarted = false;
+        }
+        return;
 
-            cliPrintHashLine("restore original profile selection");
-            cliPrintLinef("profile %d", currentProfileIndexSave + 1);
-            cliPrintLinef("battery_profile %d", currentBatteryProfileIndexSave + 1);
+    case DUMP_STEP_FOOTER:
+        if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+            cliPrintHashLine("save configuration\r\nsave");
+        }
 
 #ifdef USE_CLI_BATCH
-            batchModeEnabled = false;
-#endif
-        } else {
-            // dump just the current profiles
-            cliDumpProfile(getConfigProfile(), dumpMask);
-            cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+        if (cliDumpState.batchModeEnabled) {
+            cliPrintHashLine("end the command batch");
+            cliPrintLine("batch end");
         }
+#endif
+        break;
+
+    default:
+        // Section not compiled in
+        break;
     }
 
-    if (dumpMask & DUMP_PROFILE) {
-        cliDumpProfile(getConfigProfile(), dumpMask);
+    dumpNextStep();
+}
+
+// Returns true while there's still output left to generate
+static bool printConfigContinue(void)
+{
+    const timeUs_t startTime = micros();
+    do {
+        printConfigStep();
+        bufWriterFlush(cliWriter);
+        if (cliDumpState.step == DUMP_STEP_DONE) {
+            cliDumpState.step = DUMP_STEP_NONE;
+            return false;
+        }
+    } while (serialTxBytesFree(cliPort) >= CLI_DUMP_MIN_TX_FREE && cmpTimeUs(micros(), startTime) < CLI_DUMP_TIME_SLICE_US);
+    return true;
+}
+
+static void printConfig(const char *cmdline, bool doDiff)
+{
+    uint8_t dumpMask = DUMP_MASTER;
+    const char *options;
+    if ((options = checkCommand(cmdline, "master"))) {
+        dumpMask = DUMP_MASTER; // only
+    } else if ((options = checkCommand(cmdline, "profile"))) {
+        dumpMask = DUMP_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
+        dumpMask = DUMP_BATTERY_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "all"))) {
+        dumpMask = DUMP_ALL;   // all profiles and rates
+    } else {
+        options = cmdline;
     }
 
-    if (dumpMask & DUMP_BATTERY_PROFILE) {
-        cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+    if (doDiff) {
+        dumpMask = dumpMask | DO_DIFF;
     }
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
-        cliPrintHashLine("save configuration\r\nsave");
+    if (checkCommand(options, "showdefaults")) {
+        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
     }
 
-#ifdef USE_CLI_BATCH
-    if (batchModeEnabled) {
-        cliPrintHashLine("end the command batch");
-        cliPrintLine("batch end");
+    loadDefaultConfigCopies();
+
+    memset(&cliDumpState, 0, sizeof(cliDumpState));
+    cliDumpState.dumpMask = dumpMask;
+    cliDumpState.profileIndexSave = getConfigProfile();
+    cliDumpState.batteryProfileIndexSave = getConfigBatteryProfile();
+
+    if (dumpMask & DUMP_ALL) {
+        // dump all profiles
+        cliDumpState.profileEnd = MAX_PROFILE_COUNT;
+        cliDumpState.batteryProfileEnd = MAX_BATTERY_PROFILE_COUNT;
+    } else {
+        // dump just the current profiles
+        if (dumpMask & (DUMP_MASTER | DUMP_PROFILE)) {
+            cliDumpState.profileIndex = cliDumpState.profileIndexSave;
+            cliDumpState.profileEnd = cliDumpState.profileIndex + 1;
+        }
+        if (dumpMask & (DUMP_MASTER | DUMP_BATTERY_PROFILE)) {
+            cliDumpState.batteryProfileIndex = cliDumpState.batteryProfileIndexSave;
+            cliDumpState.batteryProfileEnd = cliDumpState.batteryProfileIndex + 1;
+        }
     }
-#endif
 
-    // restore configs from copies
-    restoreConfigs();
+    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+        cliDumpState.step = DUMP_STEP_HEADER;
+    } else {
+        cliDumpState.step = DUMP_STEP_PROFILE;
+    }
+    // Output is generated by cliProcess()
 }
 
 static void cliDump(char *cmdline)
@@ -3939,7 +4398,11 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("sd_info", "sdcard info", NULL, cliSdInfo),
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
+#ifdef USE_SCHEDULER_HISTOGRAMS
+    CLI_COMMAND_DEF("tasks", "show task stats", "[histogram [reset]]", cliTasks),
+#else
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
+#endif
 #ifdef USE_TEMPERATURE_SENSOR
     CLI_COMMAND_DEF("temp_sensor", "change temp sensor settings", NULL, cliTempSensor),
 #endif
@@ -3979,6 +4442,14 @@ void cliProcess(void)
     // Be a little bit tricky.  Flush the last inputs buffer, if any.
     bufWriterFlush(cliWriter);
 
+    if (cliDumpState.step != DUMP_STEP_NONE) {
+        // Any input is left waiting until the dump is complete
+        if (printConfigContinue()) {
+            return;
+        }
+        cliPrompt();
+    }
+
     while (serialRxBytesWaiting(cliPort)) {
         uint8_t c = serialRead(cliPort);
         if (c == '\t' || c == '?') {
@@ -4063,6 +4534,10 @@ void cliProcess(void)
             if (!cliMode)
                 return;
 
+            // dump and diff print the prompt once they're done
+            if (cliDumpState.step != DUMP_STEP_NONE)
+                return;
+
             cliPrompt();
         } else if (c == 127) {
             // backspace
@@ -4087,6 +4562,7 @@ void cliEnter(serialPort_t *serialPort)
 
     cliMode = true;
     cliPort = serialPort;
+    cliDumpState.step = DUMP_STEP_NONE;
     setPrintfSerialPort(cliPort);
     cliWriter = bufWriterInit(cliWriteBuffer, sizeof(cliWriteBuffer), (bufWrite_t)serialWriteBufShim, serialPort);
 
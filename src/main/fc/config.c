@@ -76,6 +76,8 @@
 
 #include "navigation/navigation.h"
 
+#include "programming/logic_condition.h"
+
 #ifndef DEFAULT_FEATURES
 #define DEFAULT_FEATURES 0
 #endif
@@ -319,6 +321,10 @@ static void activateConfig(void)
     pidInit();
 
     navigationUsePIDs();
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    logicConditionInvalidate();
+#endif
 }
 
 void readEEPROM(void)
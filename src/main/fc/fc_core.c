@@ -853,7 +853,8 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     }
 
 #if defined(SITL_BUILD)
-    if (lockMainPID()) {
+    // Only process new simulator frames
+    if (simSensorStateApply()) {
 #endif
 
     gyroFilter();
@@ -874,6 +875,7 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     }
 
     if (isRXDataNew) {
+        rxSetpointUpdated(micros());
         updateWaypointsAndNavigationMode();
     }
     isRXDataNew = false;
@@ -31,6 +31,7 @@
 
 #include "common/axis.h"
 #include "common/color.h"
+#include "common/crc.h"
 #include "common/log.h"
 #include "common/maths.h"
 #include "common/memory.h"
@@ -195,6 +196,7 @@ void init(void)
 
     systemState = SYSTEM_STATE_INITIALISING;
     printfSupportInit();
+    crcInit();
 
     // Initialize system and CPU clocks to their initial values
     systemInit();
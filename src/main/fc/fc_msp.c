@@ -338,6 +338,20 @@ static void serializeDataflashReadReply(sbuf_t *dst, uint32_t address, uint16_t
 }
 #endif
 
+#define MSP_LOGIC_CONDITION_SIZE 15
+
+static void mspFcWriteLogicCondition(sbuf_t *dst, uint8_t idx)
+{
+    sbufWriteU8(dst, logicConditions(idx)->enabled);
+    sbufWriteU8(dst, logicConditions(idx)->activatorId);
+    sbufWriteU8(dst, logicConditions(idx)->operation);
+    sbufWriteU8(dst, logicConditions(idx)->operandA.type);
+    sbufWriteU32(dst, logicConditions(idx)->operandA.value);
+    sbufWriteU8(dst, logicConditions(idx)->operandB.type);
+    sbufWriteU32(dst, logicConditions(idx)->operandB.value);
+    sbufWriteU8(dst, logicConditions(idx)->flags);
+}
+
 /*
  * Returns true if the command was processd, false otherwise.
  * May set mspPostProcessFunc to a function to be called once the command has been processed
@@ -525,14 +539,7 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
 #ifdef USE_PROGRAMMING_FRAMEWORK
     case MSP2_INAV_LOGIC_CONDITIONS:
         for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
-            sbufWriteU8(dst, logicConditions(i)->enabled);
-            sbufWriteU8(dst, logicConditions(i)->activatorId);
-            sbufWriteU8(dst, logicConditions(i)->operation);
-            sbufWriteU8(dst, logicConditions(i)->operandA.type);
-            sbufWriteU32(dst, logicConditions(i)->operandA.value);
-            sbufWriteU8(dst, logicConditions(i)->operandB.type);
-            sbufWriteU32(dst, logicConditions(i)->operandB.value);
-            sbufWriteU8(dst, logicConditions(i)->flags);
+            mspFcWriteLogicCondition(dst, i);
         }
         break;
     case MSP2_INAV_LOGIC_CONDITIONS_STATUS:
@@ -1594,23 +1601,74 @@ static mspResult_e mspFcSafeHomeOutCommand(sbuf_t *dst, sbuf_t *src)
 static mspResult_e mspFcLogicConditionCommand(sbuf_t *dst, sbuf_t *src) {
     const uint8_t idx = sbufReadU8(src);
     if (idx < MAX_LOGIC_CONDITIONS) {
-        sbufWriteU8(dst, logicConditions(idx)->enabled);
-        sbufWriteU8(dst, logicConditions(idx)->activatorId);
-        sbufWriteU8(dst, logicConditions(idx)->operation);
-        sbufWriteU8(dst, logicConditions(idx)->operandA.type);
-        sbufWriteU32(dst, logicConditions(idx)->operandA.value);
-        sbufWriteU8(dst, logicConditions(idx)->operandB.type);
-        sbufWriteU32(dst, logicConditions(idx)->operandB.value);
-        sbufWriteU8(dst, logicConditions(idx)->flags);
+        mspFcWriteLogicCondition(dst, idx);
         return MSP_RESULT_ACK;
     } else {
         return MSP_RESULT_ERROR;
     }
 }
 
-static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
+#ifdef USE_SCHEDULER_HISTOGRAMS
+static mspResult_e mspFcTaskHistogramCommand(sbuf_t *dst, sbuf_t *src)
+{
+    if (sbufBytesRemaining(src) < 1) {
+        // Return the number of tasks and histogram layout
+        sbufWriteU8(dst, TASK_COUNT);
+        sbufWriteU8(dst, TASK_HISTOGRAM_TYPE_COUNT);
+        sbufWriteU8(dst, TASK_HISTOGRAM_BUCKET_COUNT);
+        return MSP_RESULT_ACK;
+    }
+
+    const uint8_t taskId = sbufReadU8(src);
+    if (taskId >= TASK_COUNT) {
+        return MSP_RESULT_ERROR;
+    }
+
+    cfTaskInfo_t taskInfo;
+    getTaskInfo(taskId, &taskInfo);
+
+    sbufWriteU8(dst, taskId);
+    sbufWriteU8(dst, taskInfo.isEnabled);
+    sbufWriteU32(dst, taskInfo.desiredPeriod);
+
+    for (taskHistogramType_e type = 0; type < TASK_HISTOGRAM_TYPE_COUNT; type++) {
+        taskHistogram_t histogram;
+        const bool available = getTaskHistogram(taskId, type, &histogram);
+        sbufWriteU8(dst, available);
+        for (unsigned ii = 0; ii < TASK_HISTOGRAM_BUCKET_COUNT; ii++) {
+            sbufWriteU16(dst, available ? histogram.bucket[ii] : 0);
+        }
+    }
+
+    return MSP_RESULT_ACK;
+}
+#endif
+
+static void mspFcRxLatencyCommand(sbuf_t *dst, sbuf_t *src)
+{
+    const rxLatencyStats_t *stats = rxGetLatencyStats();
+
+    sbufWriteU32(dst, stats->frameIntervalMovingSum / RX_LATENCY_MOVING_SUM_COUNT);
+    sbufWriteU8(dst, RX_LATENCY_STAGE_COUNT);
+    for (rxLatencyStage_e stage = 0; stage < RX_LATENCY_STAGE_COUNT; stage++) {
+        const rxLatency_t *latency = &stats->stage[stage];
+        sbufWriteU32(dst, latency->count);
+        sbufWriteU32(dst, latency->last);
+        sbufWriteU32(dst, latency->min);
+        sbufWriteU32(dst, latency->movingSum / RX_LATENCY_MOVING_SUM_COUNT);
+        sbufWriteU32(dst, latency->max);
+    }
+
+    // Optional request byte, non-zero resets the statistics once reported
+    if (sbufBytesRemaining(src) >= 1 && sbufReadU8(src)) {
+        rxResetLatencyStats();
+    }
+}
+
+#define MSP_WAYPOINT_SIZE 21
+
+static void mspFcWriteWaypoint(sbuf_t *dst, uint8_t msp_wp_no)
 {
-    const uint8_t msp_wp_no = sbufReadU8(src);    // get the wp number
     navWaypoint_t msp_wp;
     getWaypoint(msp_wp_no, &msp_wp);
     sbufWriteU8(dst, msp_wp_no);      // wp_no
@@ -1624,6 +1682,12 @@ static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
     sbufWriteU8(dst, msp_wp.flag);    // flags
 }
 
+static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
+{
+    const uint8_t msp_wp_no = sbufReadU8(src);    // get the wp number
+    mspFcWriteWaypoint(dst, msp_wp_no);
+}
+
 #ifdef USE_FLASHFS
 static void mspFcDataFlashReadCommand(sbuf_t *dst, sbuf_t *src)
 {
@@ -2048,6 +2112,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             logicConditionsMutable(tmp_u8)->operandB.type = sbufReadU8(src);
             logicConditionsMutable(tmp_u8)->operandB.value = sbufReadU32(src);
             logicConditionsMutable(tmp_u8)->flags = sbufReadU8(src);
+            logicConditionInvalidate();
         } else
             return MSP_RESULT_ERROR;
         break;
@@ -3249,6 +3314,172 @@ static bool mspParameterGroupsCommand(sbuf_t *dst, sbuf_t *src)
     return true;
 }
 
+/*
+ * Bulk reads return a range of entries in as many frames as needed. The
+ * request is an optional [u16 first][u16 last] (inclusive), every frame
+ * starts with [u16 first][u16 count][u8 flags] followed by the entries and
+ * MSP_BULK_FLAG_MORE set when the range continues in another frame. The
+ * request for the next frame is left in the reply continuation, so transports
+ * that stream continuations send the whole range from a single request.
+ */
+#define MSP_BULK_HEADER_SIZE    5
+#define MSP_BULK_FLAG_MORE      (1 << 0)
+
+// Writes the entry at index, returns false without writing if it doesn't fit
+typedef bool (*mspBulkEntryWriteFnPtr)(sbuf_t *dst, uint16_t index);
+
+static void mspReadBulkRange(sbuf_t *src, int *first, int *last)
+{
+    uint16_t value;
+    if (sbufReadU16Safe(&value, src)) {
+        *first = MAX(*first, (int)value);
+    }
+    if (sbufReadU16Safe(&value, src)) {
+        *last = MIN(*last, (int)value);
+    }
+}
+
+static mspResult_e mspFcBulkReadCommand(mspPacket_t *reply, int first, int last, mspBulkEntryWriteFnPtr writeEntry)
+{
+    sbuf_t *dst = &reply->buf;
+    if (sbufBytesRemaining(dst) < MSP_BULK_HEADER_SIZE) {
+        return MSP_RESULT_ERROR;
+    }
+
+    uint8_t * const header = sbufPtr(dst);
+    sbuf_t frame = {
+        .ptr = header + MSP_BULK_HEADER_SIZE,
+        .end = MIN(dst->end, header + MSP_BULK_FRAME_SIZE),
+    };
+
+    int index = first;
+    while (index <= last && writeEntry(&frame, index)) {
+        index++;
+    }
+    if (index == first && index <= last) {
+        // Entry bigger than a frame
+        return MSP_RESULT_ERROR;
+    }
+
+    const bool more = index <= last;
+    sbufWriteU16(dst, first);
+    sbufWriteU16(dst, index - first);
+    sbufWriteU8(dst, more ? MSP_BULK_FLAG_MORE : 0);
+    dst->ptr = frame.ptr;
+
+    if (more) {
+        sbuf_t next = { .ptr = reply->continuation, .end = ARRAYEND(reply->continuation) };
+        sbufWriteU16(&next, index);
+        sbufWriteU16(&next, last);
+        reply->continuationSize = next.ptr - reply->continuation;
+    }
+    return MSP_RESULT_ACK;
+}
+
+static bool mspWriteSettingValue(sbuf_t *dst, uint16_t index)
+{
+    const setting_t *setting = settingGet(index);
+    const size_t size = settingGetValueSize(setting);
+    if (sbufBytesRemaining(dst) < (int)size + 1) {
+        return false;
+    }
+    sbufWriteU8(dst, size);
+    sbufWriteData(dst, settingGetValuePointer(setting), size);
+    return true;
+}
+
+static mspResult_e mspFcSettingsBulkCommand(mspPacket_t *reply, sbuf_t *src)
+{
+    int first = 0;
+    int last = SETTINGS_TABLE_COUNT - 1;
+
+    if (sbufBytesRemaining(src) == 2) {
+        // A single u16 selects the settings of a parameter group
+        uint16_t start;
+        uint16_t end;
+        if (!settingsGetParameterGroupIndexes(sbufReadU16(src), &start, &end)) {
+            return MSP_RESULT_ERROR;
+        }
+        first = start;
+        last = end;
+    } else {
+        mspReadBulkRange(src, &first, &last);
+    }
+    return mspFcBulkReadCommand(reply, first, last, mspWriteSettingValue);
+}
+
+static bool mspFcWriteWaypointEntry(sbuf_t *dst, uint16_t index)
+{
+    if (sbufBytesRemaining(dst) < MSP_WAYPOINT_SIZE) {
+        return false;
+    }
+    mspFcWriteWaypoint(dst, index);
+    return true;
+}
+
+static bool mspFcWriteLogicConditionEntry(sbuf_t *dst, uint16_t index)
+{
+    if (sbufBytesRemaining(dst) < MSP_LOGIC_CONDITION_SIZE) {
+        return false;
+    }
+    mspFcWriteLogicCondition(dst, index);
+    return true;
+}
+
+#ifdef USE_OSD
+// Items of all layouts, index is layout * OSD_ITEM_COUNT + item
+static bool mspFcWriteOsdItemEntry(sbuf_t *dst, uint16_t index)
+{
+    if (sbufBytesRemaining(dst) < 2) {
+        return false;
+    }
+    sbufWriteU16(dst, osdLayoutsConfig()->item_pos[index / OSD_ITEM_COUNT][index % OSD_ITEM_COUNT]);
+    return true;
+}
+#endif
+
+/*
+ * Returns true if the command was a bulk read. These need the reply packet
+ * to leave the request for their next frame in it.
+ */
+static bool mspFcProcessBulkCommand(uint16_t cmdMSP, mspPacket_t *reply, sbuf_t *src, mspResult_e *ret)
+{
+    int first = 0;
+    int last;
+
+    switch (cmdMSP) {
+    case MSP2_COMMON_SETTINGS_BULK:
+        *ret = mspFcSettingsBulkCommand(reply, src);
+        break;
+
+    case MSP2_INAV_WAYPOINTS_BULK:
+        // Mission waypoints are numbered from 1
+        first = 1;
+        last = getWaypointCount();
+        mspReadBulkRange(src, &first, &last);
+        *ret = mspFcBulkReadCommand(reply, first, last, mspFcWriteWaypointEntry);
+        break;
+
+    case MSP2_INAV_LOGIC_CONDITIONS_BULK:
+        last = MAX_LOGIC_CONDITIONS - 1;
+        mspReadBulkRange(src, &first, &last);
+        *ret = mspFcBulkReadCommand(reply, first, last, mspFcWriteLogicConditionEntry);
+        break;
+
+#ifdef USE_OSD
+    case MSP2_INAV_OSD_ITEMS_BULK:
+        last = OSD_LAYOUT_COUNT * OSD_ITEM_COUNT - 1;
+        mspReadBulkRange(src, &first, &last);
+        *ret = mspFcBulkReadCommand(reply, first, last, mspFcWriteOsdItemEntry);
+        break;
+#endif
+
+    default:
+        return false;
+    }
+    return true;
+}
+
 #ifdef USE_SIMULATOR
 bool isOSDTypeSupportedBySimulator(void)
 {
@@ -3465,6 +3696,15 @@ bool mspFCProcessInOutCommand(uint16_t cmdMSP, sbuf_t *dst, sbuf_t *src, mspResu
         *ret = mspFcSafeHomeOutCommand(dst, src);
         break;
 #endif
+#ifdef USE_SCHEDULER_HISTOGRAMS
+    case MSP2_INAV_TASK_HISTOGRAM:
+        *ret = mspFcTaskHistogramCommand(dst, src);
+        break;
+#endif
+    case MSP2_INAV_RX_LATENCY:
+        mspFcRxLatencyCommand(dst, src);
+        *ret = MSP_RESULT_ACK;
+        break;
 
 #ifdef USE_SIMULATOR
     case MSP_SIMULATOR:
@@ -3696,6 +3936,7 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     const uint16_t cmdMSP = cmd->cmd;
     // initialize reply by default
     reply->cmd = cmd->cmd;
+    reply->continuationSize = 0;
 
     if (MSP2_IS_SENSOR_MESSAGE(cmdMSP)) {
         ret = mspProcessSensorCommand(cmdMSP, src);
@@ -3704,6 +3945,8 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     } else if (cmdMSP == MSP_SET_PASSTHROUGH) {
         mspFcSetPassthroughCommand(dst, src, mspPostProcessFn);
         ret = MSP_RESULT_ACK;
+    } else if (mspFcProcessBulkCommand(cmdMSP, reply, src, &ret)) {
+        // ret set by the bulk handler
     } else {
         if (!mspFCProcessInOutCommand(cmdMSP, dst, src, &ret)) {
             ret = mspFcProcessInCommand(cmdMSP, src);
@@ -3713,6 +3956,7 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     // Process DONT_REPLY flag
     if (cmd->flags & MSP_FLAG_DONT_REPLY) {
         ret = MSP_RESULT_NO_REPLY;
+        reply->continuationSize = 0;
     }
 
     reply->result = ret;
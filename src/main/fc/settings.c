@@ -14,46 +14,48 @@
 #include "flight/rpm_filter.h"
 #include "settings_generated.c"
 
+STATIC_ASSERT(sizeof(settingNamesWords) * 8 <= UINT16_MAX, settings_words_too_long);
+
+static uint8_t settingGetWordChar(unsigned bit)
+{
+	const unsigned byte = bit / 8;
+	uint16_t bits = settingNamesWords[byte] << 8;
+	if (byte + 1 < sizeof(settingNamesWords)) {
+		bits |= settingNamesWords[byte + 1];
+	}
+	return (bits >> (16 - SETTINGS_WORDS_BITS_PER_CHAR - (bit % 8))) & (0xff >> (8 - SETTINGS_WORDS_BITS_PER_CHAR));
+}
+
 static bool settingGetWord(char *buf, int idx)
 {
 	if (idx == 0) {
 		return false;
 	}
-	const uint8_t *ptr = settingNamesWords;
-	char *bufPtr = buf;
-	int used_bits = 0;
-	int word = 1;
-	for(;;) {
-		int shift = 8 - SETTINGS_WORDS_BITS_PER_CHAR - used_bits;
-		char chr;
-		if (shift > 0) {
-			chr = (*ptr >> shift) & (0xff >> (8 - SETTINGS_WORDS_BITS_PER_CHAR));
-		} else {
-			chr = (*ptr & (0xff >> (8 - (SETTINGS_WORDS_BITS_PER_CHAR + shift)))) << -shift;
-			ptr++;
-			chr |= (*ptr) >> (8 + shift);
+	// Start from the closest preceding word with a known offset, so
+	// decoding a name never scans the dictionary from its start
+	const unsigned word = idx - 1;
+	unsigned bit = settingNamesWordOffsets[word / SETTINGS_WORDS_OFFSET_STEP];
+	for (unsigned ii = 0; ii < word % SETTINGS_WORDS_OFFSET_STEP; ii++) {
+		while (settingGetWordChar(bit) != 0) {
+			bit += SETTINGS_WORDS_BITS_PER_CHAR;
 		}
-		if (word == idx) {
-			if (chr == 0) {
-				// Finished copying the word
-				*bufPtr++ = '\0';
-				break;
-			}
-			char c;
-			if (chr < 27) {
-				c = 'a' + (chr - 1);
-			} else {
-				c = wordSymbols[chr - 27];
-			}
-			*bufPtr++ = c;
+		// Skip the word terminator
+		bit += SETTINGS_WORDS_BITS_PER_CHAR;
+	}
+	for (;;) {
+		uint8_t chr = settingGetWordChar(bit);
+		if (chr == 0) {
+			// Finished copying the word
+			break;
+		}
+		if (chr < 27) {
+			*buf++ = 'a' + (chr - 1);
 		} else {
-			if (chr == 0) {
-				// Word end
-				word++;
-			}
+			*buf++ = wordSymbols[chr - 27];
 		}
-		used_bits = (used_bits + SETTINGS_WORDS_BITS_PER_CHAR) % 8;
+		bit += SETTINGS_WORDS_BITS_PER_CHAR;
 	}
+	*buf = '\0';
 	return true;
 }
 
@@ -105,23 +107,43 @@ bool settingNameContains(const setting_t *val, char *buf, const char *cmdline)
 	return strstr(buf, cmdline) != NULL;
 }
 
-bool settingNameIsExactMatch(const setting_t *val, char *buf, const char *cmdline, uint8_t var_name_length)
+// FNV-1a, must be kept in sync with NameHash in utils/settings.rb.
+// Setting names are lowercase, so hashing is case insensitive.
+static uint32_t settingNameHash(const char *name, size_t length, uint32_t seed)
 {
-	settingGetName(val, buf);
-	return sl_strncasecmp(cmdline, buf, strlen(buf)) == 0 && var_name_length == strlen(buf);
+	uint32_t hash = 2166136261u ^ seed;
+	for (size_t ii = 0; ii < length; ii++) {
+		hash ^= (uint8_t)sl_tolower(name[ii]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Returns the only setting that might be named name, it still needs
+// to be compared since name might not be a valid setting.
+static const setting_t *settingNameHashLookup(const char *name, size_t length)
+{
+	const uint32_t bucket = settingNameHash(name, length, 0) % SETTING_NAME_HASH_BUCKETS;
+	const uint32_t slot = settingNameHash(name, length, settingNameHashSeeds[bucket]) % SETTING_NAME_HASH_SLOTS;
+	return &settingsTable[settingNameHashSlots[slot]];
 }
 
 const setting_t *settingFind(const char *name)
 {
 	char buf[SETTING_MAX_NAME_LENGTH];
-	for (int ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
-		const setting_t *setting = &settingsTable[ii];
-		settingGetName(setting, buf);
-		if (strcmp(buf, name) == 0) {
-			return setting;
-		}
+	const setting_t *setting = settingNameHashLookup(name, strlen(name));
+	settingGetName(setting, buf);
+	return strcmp(buf, name) == 0 ? setting : NULL;
+}
+
+const setting_t *settingFindIgnoringCase(const char *name, size_t length, char *buf)
+{
+	if (length >= SETTING_MAX_NAME_LENGTH) {
+		return NULL;
 	}
-	return NULL;
+	const setting_t *setting = settingNameHashLookup(name, length);
+	settingGetName(setting, buf);
+	return strlen(buf) == length && sl_strncasecmp(name, buf, length) == 0 ? setting : NULL;
 }
 
 const setting_t *settingGet(unsigned index)
@@ -228,17 +250,36 @@ pgn_t settingGetPgn(const setting_t *val)
 	return -1;
 }
 
+size_t settingGetProfileSize(const setting_t *val)
+{
+    switch (SETTING_SECTION(val)) {
+    case MASTER_VALUE:
+        return 0;
+    case PROFILE_VALUE:
+        return sizeof(pidProfile_t);
+    case CONTROL_RATE_VALUE:
+        return sizeof(controlRateConfig_t);
+    case BATTERY_CONFIG_VALUE:
+        return sizeof(batteryProfile_t);
+    }
+    return 0;
+}
+
+uint16_t settingGetProfileValueOffset(const setting_t *val, uint8_t profileIndex)
+{
+    return val->offset + settingGetProfileSize(val) * profileIndex;
+}
+
 static uint16_t getValueOffset(const setting_t *value)
 {
     switch (SETTING_SECTION(value)) {
     case MASTER_VALUE:
         return value->offset;
     case PROFILE_VALUE:
-        return value->offset + sizeof(pidProfile_t) * getConfigProfile();
     case CONTROL_RATE_VALUE:
-        return value->offset + sizeof(controlRateConfig_t) * getConfigProfile();
+        return settingGetProfileValueOffset(value, getConfigProfile());
     case BATTERY_CONFIG_VALUE:
-        return value->offset + sizeof(batteryProfile_t) * getConfigBatteryProfile();
+        return settingGetProfileValueOffset(value, getConfigBatteryProfile());
     }
     return 0;
 }
@@ -249,12 +290,6 @@ void *settingGetValuePointer(const setting_t *val)
     return pg->address + getValueOffset(val);
 }
 
-const void * settingGetCopyValuePointer(const setting_t *val)
-{
-    const pgRegistry_t *pg = pgFind(settingGetPgn(val));
-    return pg->copy + getValueOffset(val);
-}
-
 setting_min_t settingGetMin(const setting_t *val)
 {
 	if (SETTING_MODE(val) == MODE_LOOKUP) {
@@ -344,3 +379,24 @@ bool settingsGetParameterGroupIndexes(pgn_t pg, uint16_t *start, uint16_t *end)
 	}
 	return false;
 }
+
+bool settingsGetParameterGroup(unsigned group, pgn_t *pgn, uint16_t *start, uint16_t *end)
+{
+	if (group >= SETTINGS_PGN_COUNT) {
+		return false;
+	}
+	unsigned acc = 0;
+	for (unsigned ii = 0; ii < group; ii++) {
+		acc += settingsPgnCounts[ii];
+	}
+	if (pgn) {
+		*pgn = settingsPgn[group];
+	}
+	if (start) {
+		*start = acc;
+	}
+	if (end) {
+		*end = acc + settingsPgnCounts[group] - 1;
+	}
+	return true;
+}
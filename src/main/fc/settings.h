@@ -73,10 +73,13 @@ static inline setting_mode_e SETTING_MODE(const setting_t *s) { return (setting_
 
 void settingGetName(const setting_t *val, char *buf);
 bool settingNameContains(const setting_t *val, char *buf, const char *cmdline);
-bool settingNameIsExactMatch(const setting_t *val, char *buf, const char *cmdline, uint8_t var_name_length);
 // Returns a setting_t with the exact name (case sensitive), or
 // NULL if no setting with that name exists.
 const setting_t *settingFind(const char *name);
+// Returns the setting named by the first length characters of name,
+// ignoring case, or NULL if there's none. buf receives the setting
+// name and must be at least SETTING_MAX_NAME_LENGTH bytes.
+const setting_t *settingFindIgnoringCase(const char *name, size_t length, char *buf);
 // Returns the setting at the given index, or NULL if
 // the index is greater than the total count.
 const setting_t *settingGet(unsigned index);
@@ -92,11 +95,13 @@ pgn_t settingGetPgn(const setting_t *val);
 // Returns a pointer to the actual value stored by
 // the setting_t. The returned value might be modified.
 void * settingGetValuePointer(const setting_t *val);
-// Returns a pointer to the backed up copy of the value. Note that
-// this will contain random garbage unless a copy of the parameter
-// group for the value has been manually performed. Currently, this
-// is only used by cli.c during config dumps.
-const void * settingGetCopyValuePointer(const setting_t *val);
+// Returns the size of each profile inside the parameter group storage
+// of the setting, or 0 for MASTER_VALUE settings.
+size_t settingGetProfileSize(const setting_t *val);
+// Returns the offset of the value inside its parameter group storage
+// for the given profile index, regardless of the active profile. For
+// BATTERY_CONFIG_VALUE settings profileIndex is a battery profile index.
+uint16_t settingGetProfileValueOffset(const setting_t *val, uint8_t profileIndex);
 // Returns the minimum valid value for the given setting_t. setting_min_t
 // depends on the target and build options, but will always be a signed
 // integer (e.g. intxx_t,)
@@ -129,3 +134,6 @@ setting_max_t settingGetStringMaxLength(const setting_t *val);
 // Retrieve the setting indexes for the given PG. If the PG is not
 // found, these function returns false.
 bool settingsGetParameterGroupIndexes(pgn_t pg, uint16_t *start, uint16_t *end);
+// Retrieve the PG and the setting indexes for the n-th group of settings,
+// in settings table order. Returns false when group >= SETTINGS_PGN_COUNT.
+bool settingsGetParameterGroup(unsigned group, pgn_t *pgn, uint16_t *start, uint16_t *end);
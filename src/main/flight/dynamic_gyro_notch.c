@@ -34,12 +34,6 @@
 
 void dynamicGyroNotchFiltersInit(dynamicGyroNotchState_t *state) {
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-            state->filtersApplyFn[axis][i] = nullFilterApply;
-        }
-    }
-
     state->dynNotchQ = gyroConfig()->dynamicGyroNotchQ / 100.0f;
     state->enabled = gyroConfig()->dynamicGyroNotchEnabled;
     state->looptime = getLooptime();
@@ -48,13 +42,9 @@ void dynamicGyroNotchFiltersInit(dynamicGyroNotchState_t *state) {
         /*
          * Step 1 - init all filters even if they will not be used further down the road
          */
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            //Any initial notch Q is valid sice it will be updated immediately after
-            for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-                biquadFilterInit(&state->filters[axis][i], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, state->looptime, 1.0f, FILTER_NOTCH);
-                state->filtersApplyFn[axis][i] = (filterApplyFnPtr)biquadFilterApplyDF1;
-            }
-        
+        //Any initial notch Q is valid sice it will be updated immediately after
+        for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
+            biquadFilter3Init(&state->filters[i], DYNAMIC_NOTCH_DEFAULT_CENTER_HZ, state->looptime, 1.0f, FILTER_NOTCH);
         }
 
     }
@@ -69,24 +59,17 @@ void dynamicGyroNotchFiltersUpdate(dynamicGyroNotchState_t *state, int axis, flo
 
             // Filter update happens only if peak was detected 
             if (frequency[i] > 0.0f) {
-                biquadFilterUpdate(&state->filters[axis][i], frequency[i], state->looptime, state->dynNotchQ, FILTER_NOTCH);
+                biquadFilter3UpdateAxis(&state->filters[i], axis, frequency[i], state->looptime, state->dynNotchQ, FILTER_NOTCH);
             }
         }
     }
 }
 
-float dynamicGyroNotchFiltersApply(dynamicGyroNotchState_t *state, int axis, float input) {
-    float output = input; 
-
-    /*
-     * We always apply all filters. If a filter dimension is disabled, one of
-     * the function pointers will be a null apply function
-     */
-    for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-        output = state->filtersApplyFn[axis][i]((filter_t *)&state->filters[axis][i], output);
-    }
-
-    return output;
+/*
+ * Filters X/Y/Z in place. Must be called only when the dynamic notch is enabled
+ */
+void dynamicGyroNotchFiltersApply(dynamicGyroNotchState_t *state, float *gyroADCf) {
+    biquadFilter3BankApplyDF1(state->filters, DYN_NOTCH_PEAK_COUNT, gyroADCf);
 }
 
 #endif
\ No newline at end of file
@@ -40,10 +40,10 @@ typedef struct dynamicGyroNotchState_s {
     uint32_t looptime;
     uint8_t enabled;
     
-    biquadFilter_t filters[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
-    filterApplyFnPtr filtersApplyFn[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
+    // One 3-axis filter per peak, each axis has its own center frequency
+    biquadFilter3_t filters[DYN_NOTCH_PEAK_COUNT];
 } dynamicGyroNotchState_t;
 
 void dynamicGyroNotchFiltersInit(dynamicGyroNotchState_t *state);
 void dynamicGyroNotchFiltersUpdate(dynamicGyroNotchState_t *state, int axis, float frequency[]);
-float dynamicGyroNotchFiltersApply(dynamicGyroNotchState_t *state, int axis, float input);
+void dynamicGyroNotchFiltersApply(dynamicGyroNotchState_t *state, float *gyroADCf);
@@ -49,26 +49,19 @@ enum {
     STEP_ARM_CFFT_F32,
     STEP_BITREVERSAL_AND_STAGE_RFFT_F32,
     STEP_MAGNITUDE_AND_FREQUENCY,
-    STEP_UPDATE_FILTERS_AND_HANNING,
-    STEP_COUNT
+    STEP_UPDATE_FILTERS_AND_WINDOW,
+    STEP_COUNT,
+    STEP_WAIT_FOR_WINDOW = STEP_COUNT,  // Not part of the cycle, entered only when FFT_WINDOW_HOP samples are not available yet
 };
 
 // The FFT splits the frequency domain into an number of bins
-// A sampling frequency of 1000 and max frequency of 500 at a window size of 32 gives 16 frequency bins each 31.25Hz wide
-// Eg [0,31), [31,62), [62, 93) etc
-// for gyro loop >= 4KHz, sample rate 2000 defines FFT range to 1000Hz, 16 bins each 62.5 Hz wide
-// NB  FFT_WINDOW_SIZE is set to 32 in gyroanalyse.h
+// A sampling frequency of 1000 and max frequency of 500 at a window size of 64 gives 32 frequency bins each 15.6Hz wide
+// Eg [0,15.6), [15.6,31.2), [31.2, 46.8) etc
+// NB  FFT_WINDOW_SIZE and FFT_SAMPLING_DENOMINATOR are set per MCU class in gyroanalyse.h
 #define FFT_BIN_COUNT             (FFT_WINDOW_SIZE / 2)
 // smoothing frequency for FFT centre frequency
 #define DYN_NOTCH_SMOOTH_FREQ_HZ  25
 
-/*
- * Slow down gyro sample acquisition. This lowers the max frequency but increases the resolution.
- * On default 500us looptime and denominator 1, max frequency is 1000Hz with a resolution of 31.25Hz
- * On default 500us looptime and denominator 2, max frequency is 500Hz with a resolution of 15.6Hz
- */
-#define FFT_SAMPLING_DENOMINATOR 2
-
 void gyroDataAnalyseStateInit(
     gyroAnalyseState_t *state, 
     uint16_t minFrequency,
@@ -82,14 +75,26 @@ void gyroDataAnalyseStateInit(
 
     state->fftStartBin = state->minFrequency / lrintf(state->fftResolution);
 
+#if FFT_PEAK_INTERPOLATION == FFT_PEAK_INTERPOLATION_PARABOLIC
     for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
         state->hanningWindow[i] = (0.5f - 0.5f * cos_approx(2 * M_PIf * i / (FFT_WINDOW_SIZE - 1)));
     }
+#endif
 
     arm_rfft_fast_init_f32(&state->fftInstance, FFT_WINDOW_SIZE);
 
-    // Frequency filter is executed every 12 cycles. 4 steps per cycle, 3 axises
-    const uint32_t filterUpdateUs = targetLooptimeUs * STEP_COUNT * XYZ_AXIS_COUNT;
+    /*
+     * Channels are staggered by one step, so with concurrent analysis at most one axis
+     * completes per loop while the hop does not hold a channel back
+     */
+    for (int c = 0; c < FFT_ANALYSER_CHANNELS; c++) {
+        state->channels[c].axis = c;
+        state->channels[c].updateStep = c;
+    }
+
+    // Every axis gets a new frequency once per update cycle of its channel
+    const uint32_t cycleLoops = MAX(STEP_COUNT, FFT_WINDOW_HOP * FFT_SAMPLING_DENOMINATOR);
+    const uint32_t filterUpdateUs = targetLooptimeUs * cycleLoops * (XYZ_AXIS_COUNT / FFT_ANALYSER_CHANNELS);
 
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         
@@ -103,10 +108,10 @@ void gyroDataAnalyseStateInit(
 
 void gyroDataAnalysePush(gyroAnalyseState_t *state, const int axis, const float sample)
 {
-    state->currentSample[axis] = sample;
+    state->currentSample[axis] += sample;
 }
 
-static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state);
+static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel);
 
 /*
  * Collect gyro data, to be analysed in gyroDataAnalyseUpdate function
@@ -114,34 +119,39 @@ static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state);
 void gyroDataAnalyse(gyroAnalyseState_t *state)
 {
     state->filterUpdateExecute = false; //This will be changed to true only if new data is present
+    state->filterUpdateAxes = 0;
 
-    static uint8_t samplingIndex = 0;
+    state->samplingIndex++;
 
-    if (samplingIndex == 0) {
+    if (state->samplingIndex == FFT_SAMPLING_DENOMINATOR) {
         // calculate mean value of accumulated samples
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            state->downsampledGyroData[axis][state->circularBufferIdx] = state->currentSample[axis];
+            state->downsampledGyroData[axis][state->circularBufferIdx] = state->currentSample[axis] / FFT_SAMPLING_DENOMINATOR;
+            state->currentSample[axis] = 0.0f;
         }
 
         state->circularBufferIdx = (state->circularBufferIdx + 1) % FFT_WINDOW_SIZE;
+        state->sampleCount++;
+        state->samplingIndex = 0;
     }
 
-    samplingIndex = (samplingIndex + 1) % FFT_SAMPLING_DENOMINATOR;
-
-    gyroDataAnalyseUpdate(state);
+    for (int c = 0; c < FFT_ANALYSER_CHANNELS; c++) {
+        gyroDataAnalyseUpdate(state, &state->channels[c]);
+    }
 }
 
 void stage_rfft_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut);
-void arm_cfft_radix8by4_f32(arm_cfft_instance_f32 *S, float32_t *p1);
 void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable);
 
-static float computeParabolaMean(gyroAnalyseState_t *state, uint8_t peakBinIndex) {
+#if FFT_PEAK_INTERPOLATION == FFT_PEAK_INTERPOLATION_PARABOLIC
+
+static float computeParabolaMean(gyroAnalyseChannel_t *channel, uint8_t peakBinIndex) {
     float preciseBin = peakBinIndex;
 
     // Height of peak bin (y1) and shoulder bins (y0, y2)
-    const float y0 = state->fftData[peakBinIndex - 1];
-    const float y1 = state->fftData[peakBinIndex];
-    const float y2 = state->fftData[peakBinIndex - 1];
+    const float y0 = channel->fftData[peakBinIndex - 1];
+    const float y1 = channel->fftData[peakBinIndex];
+    const float y2 = channel->fftData[peakBinIndex + 1];
 
     // Estimate true peak position aka. preciseBin (fit parabola y(x) over y0, y1 and y2, solve dy/dx=0 for x)
     const float denom = 2.0f * (y0 - 2 * y1 + y2);
@@ -153,36 +163,156 @@ static float computeParabolaMean(gyroAnalyseState_t *state, uint8_t peakBinIndex
     return preciseBin;
 }
 
+/*
+ * Take the latest FFT_WINDOW_SIZE samples of the channel axis in time order and apply the Hanning window
+ */
+static void loadWindow(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel)
+{
+    const float *samples = state->downsampledGyroData[channel->axis];
+
+    for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
+        channel->fftData[i] = samples[(state->circularBufferIdx + i) % FFT_WINDOW_SIZE] * state->hanningWindow[i];
+    }
+}
+
+/*
+ * Bin magnitudes of the Hanning windowed spectrum
+ */
+static void computeMagnitudes(gyroAnalyseChannel_t *channel)
+{
+    arm_cmplx_mag_f32(channel->rfftData, channel->fftData, FFT_BIN_COUNT);
+}
+
+#else
+
+// Real and imaginary part of a bin of the packed rfft output, the Nyquist bin is stored in the imaginary part of DC
+static void rfftBin(const float *rfftData, int bin, float *re, float *im)
+{
+    if (bin == 0) {
+        *re = rfftData[0];
+        *im = 0.0f;
+    } else if (bin == FFT_BIN_COUNT) {
+        *re = rfftData[1];
+        *im = 0.0f;
+    } else {
+        *re = rfftData[2 * bin];
+        *im = rfftData[2 * bin + 1];
+    }
+}
+
+static float quinnTau(float x)
+{
+    // sqrt(6) / 24 and sqrt(2 / 3)
+    return 0.25f * logf(3 * x * x + 6 * x + 1) - 0.10206207f * logf((x + 1 - 0.81649658f) / (x + 1 + 0.81649658f));
+}
+
+/*
+ * Quinn's second estimator. Works on the complex spectrum of the rectangular window, the
+ * Hanning window is applied in the frequency domain for peak detection only
+ */
+static float computeQuinnBin(gyroAnalyseChannel_t *channel, uint8_t peakBinIndex)
+{
+    float re, im, reL, imL, reR, imR;
+    rfftBin(channel->rfftData, peakBinIndex, &re, &im);
+    rfftBin(channel->rfftData, peakBinIndex - 1, &reL, &imL);
+    rfftBin(channel->rfftData, peakBinIndex + 1, &reR, &imR);
+
+    const float magSq = re * re + im * im;
+    if (magSq == 0.0f) {
+        return peakBinIndex;
+    }
+
+    const float ap = (reR * re + imR * im) / magSq;
+    const float am = (reL * re + imL * im) / magSq;
+    if (ap == 1.0f || am == 1.0f) {
+        return peakBinIndex;
+    }
+
+    const float dp = -ap / (1.0f - ap);
+    const float dm = am / (1.0f - am);
+    const float d = (dp + dm) / 2.0f + quinnTau(dp * dp) - quinnTau(dm * dm);
+
+    return peakBinIndex + constrainf(d, -0.5f, 0.5f);
+}
+
+/*
+ * Take the latest FFT_WINDOW_SIZE samples of the channel axis in time order, rectangular window
+ */
+static void loadWindow(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel)
+{
+    const float *samples = state->downsampledGyroData[channel->axis];
+
+    for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
+        channel->fftData[i] = samples[(state->circularBufferIdx + i) % FFT_WINDOW_SIZE];
+    }
+}
+
+/*
+ * Bin magnitudes of the Hanning windowed spectrum. A periodic Hanning window is a 3 tap
+ * convolution in the frequency domain: 0.5 * X[k] - 0.25 * (X[k - 1] + X[k + 1])
+ */
+static void computeMagnitudes(gyroAnalyseChannel_t *channel)
+{
+    for (int bin = 0; bin < FFT_BIN_COUNT; bin++) {
+        float re, im, reL, imL, reR, imR;
+        rfftBin(channel->rfftData, bin, &re, &im);
+        // Spectrum of a real signal is conjugate symmetric, X[-1] = conj(X[1])
+        rfftBin(channel->rfftData, bin == 0 ? 1 : bin - 1, &reL, &imL);
+        if (bin == 0) {
+            imL = -imL;
+        }
+        rfftBin(channel->rfftData, bin + 1, &reR, &imR);
+
+        const float hannRe = 0.5f * re - 0.25f * (reL + reR);
+        const float hannIm = 0.5f * im - 0.25f * (imL + imR);
+        channel->fftData[bin] = fast_fsqrtf(hannRe * hannRe + hannIm * hannIm);
+    }
+}
+
+#endif
+
+static bool windowAvailable(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel)
+{
+    return state->sampleCount - channel->windowSampleCount >= FFT_WINDOW_HOP;
+}
+
+static void startCycle(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel)
+{
+    loadWindow(state, channel);
+    channel->windowSampleCount = state->sampleCount;
+}
+
 /*
  * Analyse last gyro data from the last FFT_WINDOW_SIZE milliseconds
  */
-static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
+static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, gyroAnalyseChannel_t *channel)
 {
 
     arm_cfft_instance_f32 *Sint = &(state->fftInstance.Sint);
+    uint8_t nextStep = channel->updateStep + 1;
 
-    switch (state->updateStep) {
+    switch (channel->updateStep) {
         case STEP_ARM_CFFT_F32:
         {
-            // Important this works only with FFT windows size of 64 elements!
-            arm_cfft_radix8by4_f32(Sint, state->fftData);
+            // Butterflies only, bit reversal is done in the next step
+            arm_cfft_f32(Sint, channel->fftData, 0, 0);
             break;
         }
         case STEP_BITREVERSAL_AND_STAGE_RFFT_F32:
         {
-            arm_bitreversal_32((uint32_t*) state->fftData, Sint->bitRevLength, Sint->pBitRevTable);
-            stage_rfft_f32(&state->fftInstance, state->fftData, state->rfftData);
+            arm_bitreversal_32((uint32_t*) channel->fftData, Sint->bitRevLength, Sint->pBitRevTable);
+            stage_rfft_f32(&state->fftInstance, channel->fftData, channel->rfftData);
             break;
         }
         case STEP_MAGNITUDE_AND_FREQUENCY:
         {
             // 8us
-            arm_cmplx_mag_f32(state->rfftData, state->fftData, FFT_BIN_COUNT);
+            computeMagnitudes(channel);
 
             //Zero the data structure
             for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
-                state->peaks[i].bin = 0;
-                state->peaks[i].value = 0.0f;
+                channel->peaks[i].bin = 0;
+                channel->peaks[i].value = 0.0f;
             }
 
             // Find peaks
@@ -191,20 +321,20 @@ static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
                  * Peak is defined if the current bin is greater than the previous bin and the next bin
                  */
                 if (
-                    state->fftData[bin] > state->fftData[bin - 1] && 
-                    state->fftData[bin] > state->fftData[bin + 1]
+                    channel->fftData[bin] > channel->fftData[bin - 1] && 
+                    channel->fftData[bin] > channel->fftData[bin + 1]
                 ) {
                     /*
                      * We are only interested in N biggest peaks
                      * Check previously found peaks and update the structure if necessary
                      */
                     for (int p = 0; p < DYN_NOTCH_PEAK_COUNT; p++) {
-                        if (state->fftData[bin] > state->peaks[p].value) {
+                        if (channel->fftData[bin] > channel->peaks[p].value) {
                             for (int k = DYN_NOTCH_PEAK_COUNT - 1; k > p; k--) {
-                                state->peaks[k] = state->peaks[k - 1];
+                                channel->peaks[k] = channel->peaks[k - 1];
                             }
-                            state->peaks[p].bin = bin;
-                            state->peaks[p].value = state->fftData[bin];
+                            channel->peaks[p].bin = bin;
+                            channel->peaks[p].value = channel->fftData[bin];
                             break;
                         }
                     }
@@ -217,31 +347,36 @@ static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
                 for (int k = 0; k < p; k++) {
                     // Swap peaks but ignore swapping void peaks (bin = 0). This leaves
                     // void peaks at the end of peaks array without moving them
-                    if (state->peaks[k].bin > state->peaks[k + 1].bin && state->peaks[k + 1].bin != 0) {
-                        peak_t temp = state->peaks[k];
-                        state->peaks[k] = state->peaks[k + 1];
-                        state->peaks[k + 1] = temp;
+                    if (channel->peaks[k].bin > channel->peaks[k + 1].bin && channel->peaks[k + 1].bin != 0) {
+                        peak_t temp = channel->peaks[k];
+                        channel->peaks[k] = channel->peaks[k + 1];
+                        channel->peaks[k + 1] = temp;
                     }
                 }
             }
 
             break;
         }
-        case STEP_UPDATE_FILTERS_AND_HANNING:
+        case STEP_UPDATE_FILTERS_AND_WINDOW:
         {
+            const uint8_t axis = channel->axis;
 
             /*
              * Update frequencies
              */
             for (int i = 0; i < DYN_NOTCH_PEAK_COUNT; i++) {
 
-                if (state->peaks[i].bin > 0) {
-                    const int bin = constrain(state->peaks[i].bin, state->fftStartBin, FFT_BIN_COUNT - 1);
-                    float frequency = computeParabolaMean(state, bin) * state->fftResolution;
+                if (channel->peaks[i].bin > 0) {
+                    const int bin = constrain(channel->peaks[i].bin, state->fftStartBin, FFT_BIN_COUNT - 1);
+#if FFT_PEAK_INTERPOLATION == FFT_PEAK_INTERPOLATION_PARABOLIC
+                    float frequency = computeParabolaMean(channel, bin) * state->fftResolution;
+#else
+                    float frequency = computeQuinnBin(channel, bin) * state->fftResolution;
+#endif
 
-                    state->centerFrequency[state->updateAxis][i] = pt1FilterApply(&state->detectedFrequencyFilter[state->updateAxis][i], frequency);
+                    state->centerFrequency[axis][i] = pt1FilterApply(&state->detectedFrequencyFilter[axis][i], frequency);
                 } else {
-                    state->centerFrequency[state->updateAxis][i] = 0.0f;
+                    state->centerFrequency[axis][i] = 0.0f;
                 }
             }
 
@@ -249,18 +384,34 @@ static NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state)
              * Filters will be updated inside dynamicGyroNotchFiltersUpdate()
              */
             state->filterUpdateExecute = true;
-            state->filterUpdateAxis = state->updateAxis;
-
-            //Switch to the next axis
-            state->updateAxis = (state->updateAxis + 1) % XYZ_AXIS_COUNT;
-            
-            // apply hanning window to gyro samples and store result in fftData
-            // hanning starts and ends with 0, could be skipped for minor speed improvement
-            arm_mult_f32(state->downsampledGyroData[state->updateAxis], state->hanningWindow, state->fftData, FFT_WINDOW_SIZE);
+            state->filterUpdateAxes |= BIT(axis);
+
+            //Switch to the next axis, concurrent channels stay on their own axis
+            if (FFT_ANALYSER_CHANNELS == 1) {
+                channel->axis = (axis + 1) % XYZ_AXIS_COUNT;
+            }
+
+            if (windowAvailable(state, channel)) {
+                startCycle(state, channel);
+                nextStep = STEP_ARM_CFFT_F32;
+            } else {
+                nextStep = STEP_WAIT_FOR_WINDOW;
+            }
+            break;
+        }
+        case STEP_WAIT_FOR_WINDOW:
+        {
+            if (windowAvailable(state, channel)) {
+                startCycle(state, channel);
+                nextStep = STEP_ARM_CFFT_F32;
+            } else {
+                nextStep = STEP_WAIT_FOR_WINDOW;
+            }
+            break;
         }
     }
 
-    state->updateStep = (state->updateStep + 1) % STEP_COUNT;
+    channel->updateStep = nextStep;
 }
 
 #endif // USE_DYNAMIC_FILTERS
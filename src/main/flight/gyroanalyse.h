@@ -23,43 +23,92 @@
 #ifdef USE_DYNAMIC_FILTERS
 
 #include "arm_math.h"
+#include "common/axis.h"
 #include "common/filter.h"
 
 /*
- * Current code works only with 64 window size. Changing it do a different size would require
- * adapting the gyroDataAnalyseUpdate in STEP_ARM_CFFT_F32 step
+ * Analyser configuration. Defaults are picked per MCU class, targets can override any of them.
+ *
+ * FFT_WINDOW_SIZE              Analysed sliding window length, power of 2 from 32 to 128
+ * FFT_SAMPLING_DENOMINATOR     Decimation, number of gyro samples averaged into one analysed sample
+ * FFT_WINDOW_HOP               Minimum number of new analysed samples between two windows of the same
+ *                              analyser channel. Windows overlap by FFT_WINDOW_SIZE - FFT_WINDOW_HOP
+ *                              samples, 1 gives the maximum overlap the update cycle allows
+ * FFT_ANALYSER_CHANNELS        1 analyses one axis at a time, round robin. XYZ_AXIS_COUNT analyses
+ *                              every axis in its own channel, concurrently
+ * FFT_PEAK_INTERPOLATION       Sub-bin peak estimator, parabola fit over the Hann window magnitudes or
+ *                              Quinn's second estimator over the rectangular window spectrum
  */
-#define FFT_WINDOW_SIZE 64
+#define FFT_PEAK_INTERPOLATION_PARABOLIC    0
+#define FFT_PEAK_INTERPOLATION_QUINN        1
+
+#if defined(STM32H7)
+// Enough headroom for a longer window at full loop rate and all axes tracked at once
+#ifndef FFT_WINDOW_SIZE
+#define FFT_WINDOW_SIZE             128
+#endif
+#ifndef FFT_SAMPLING_DENOMINATOR
+#define FFT_SAMPLING_DENOMINATOR    1
+#endif
+#ifndef FFT_ANALYSER_CHANNELS
+#define FFT_ANALYSER_CHANNELS       XYZ_AXIS_COUNT
+#endif
+#ifndef FFT_PEAK_INTERPOLATION
+#define FFT_PEAK_INTERPOLATION      FFT_PEAK_INTERPOLATION_QUINN
+#endif
+#else
+#ifndef FFT_WINDOW_SIZE
+#define FFT_WINDOW_SIZE             64
+#endif
+#ifndef FFT_SAMPLING_DENOMINATOR
+#define FFT_SAMPLING_DENOMINATOR    2
+#endif
+#ifndef FFT_ANALYSER_CHANNELS
+#define FFT_ANALYSER_CHANNELS       1
+#endif
+#ifndef FFT_PEAK_INTERPOLATION
+#define FFT_PEAK_INTERPOLATION      FFT_PEAK_INTERPOLATION_PARABOLIC
+#endif
+#endif
+
+#ifndef FFT_WINDOW_HOP
+#define FFT_WINDOW_HOP              1
+#endif
 
 typedef struct peak_s {
     int bin;
     float value;
 } peak_t;
 
+typedef struct gyroAnalyseChannel_s {
+    uint8_t axis;
+    uint8_t updateStep;
+    uint32_t windowSampleCount;     // sampleCount when the window being analysed was taken
+
+    float fftData[FFT_WINDOW_SIZE];
+    float rfftData[FFT_WINDOW_SIZE];
+    peak_t peaks[DYN_NOTCH_PEAK_COUNT];
+} gyroAnalyseChannel_t;
+
 typedef struct gyroAnalyseState_s {
     // accumulator for oversampled data => no aliasing and less noise
     float currentSample[XYZ_AXIS_COUNT];
+    uint8_t samplingIndex;
 
     // downsampled gyro data circular buffer for frequency analysis
     uint8_t circularBufferIdx;
+    uint32_t sampleCount;
     float downsampledGyroData[XYZ_AXIS_COUNT][FFT_WINDOW_SIZE];
 
-    // update state machine step information
-    uint8_t updateStep;
-    uint8_t updateAxis;
+    gyroAnalyseChannel_t channels[FFT_ANALYSER_CHANNELS];
 
     arm_rfft_fast_instance_f32 fftInstance;
-    float fftData[FFT_WINDOW_SIZE];
-    float rfftData[FFT_WINDOW_SIZE];
 
     pt1Filter_t detectedFrequencyFilter[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
     float centerFrequency[XYZ_AXIS_COUNT][DYN_NOTCH_PEAK_COUNT];
-    
-    peak_t peaks[DYN_NOTCH_PEAK_COUNT];
 
     bool filterUpdateExecute;
-    uint8_t filterUpdateAxis;
-    uint16_t filterUpdateFrequency;
+    uint8_t filterUpdateAxes;       // Bitmask of the axes with a new centerFrequency
 
     uint16_t fftSamplingRateHz;
     uint8_t fftStartBin;
@@ -67,11 +116,15 @@ typedef struct gyroAnalyseState_s {
     uint16_t minFrequency;
     uint16_t maxFrequency;
 
+#if FFT_PEAK_INTERPOLATION == FFT_PEAK_INTERPOLATION_PARABOLIC
     // Hanning window, see https://en.wikipedia.org/wiki/Window_function#Hann_.28Hanning.29_window
     float hanningWindow[FFT_WINDOW_SIZE];
+#endif
 } gyroAnalyseState_t;
 
 STATIC_ASSERT(FFT_WINDOW_SIZE <= (uint8_t) -1, window_size_greater_than_underlying_type);
+STATIC_ASSERT(FFT_WINDOW_SIZE >= 32 && (FFT_WINDOW_SIZE & (FFT_WINDOW_SIZE - 1)) == 0, window_size_not_supported_by_rfft);
+STATIC_ASSERT(FFT_ANALYSER_CHANNELS == 1 || FFT_ANALYSER_CHANNELS == XYZ_AXIS_COUNT, analyser_channels_not_supported);
 
 void gyroDataAnalyseStateInit(
     gyroAnalyseState_t *state, 
@@ -60,10 +60,10 @@ typedef struct
     float minHz;
     float maxHz;
     uint8_t harmonics;
-    biquadFilter_t filters[XYZ_AXIS_COUNT][MAX_SUPPORTED_MOTORS][RPM_FILTER_HARMONICS];
+    biquadFilter3_t filters[MAX_SUPPORTED_MOTORS][RPM_FILTER_HARMONICS];
 } rpmFilterBank_t;
 
-typedef float (*rpmFilterApplyFnPtr)(rpmFilterBank_t *filter, uint8_t axis, float input);
+typedef void (*rpmFilterApplyFnPtr)(rpmFilterBank_t *filter, float *samples);
 typedef void (*rpmFilterUpdateFnPtr)(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency);
 
 static EXTENDED_FASTRAM pt1Filter_t motorFrequencyFilter[MAX_SUPPORTED_MOTORS];
@@ -71,11 +71,10 @@ static EXTENDED_FASTRAM rpmFilterBank_t gyroRpmFilters;
 static EXTENDED_FASTRAM rpmFilterApplyFnPtr rpmGyroApplyFn;
 static EXTENDED_FASTRAM rpmFilterUpdateFnPtr rpmGyroUpdateFn;
 
-float nullRpmFilterApply(rpmFilterBank_t *filter, uint8_t axis, float input)
+void nullRpmFilterApply(rpmFilterBank_t *filter, float *samples)
 {
     UNUSED(filter);
-    UNUSED(axis);
-    return input;
+    UNUSED(samples);
 }
 
 void nullRpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency) {
@@ -84,22 +83,15 @@ void nullRpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseF
     UNUSED(baseFrequency);
 }
 
-float rpmFilterApply(rpmFilterBank_t *filterBank, uint8_t axis, float input)
+/*
+ * All three axes are filtered in one pass over the harmonic notches of each motor
+ */
+void rpmFilterApply(rpmFilterBank_t *filterBank, float *samples)
 {
-    float output = input;
-
     for (uint8_t motor = 0; motor < getMotorCount(); motor++)
     {
-        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
-        {
-            output = biquadFilterApplyDF1(
-                &filterBank->filters[axis][motor][harmonicIndex],
-                output
-            );
-        }
+        biquadFilter3BankApplyDF1(filterBank->filters[motor], filterBank->harmonics, samples);
     }
-
-    return output;
 }
 
 static void rpmFilterInit(rpmFilterBank_t *filter, uint16_t q, uint8_t minHz, uint8_t harmonics)
@@ -112,24 +104,21 @@ static void rpmFilterInit(rpmFilterBank_t *filter, uint16_t q, uint8_t minHz, ui
      */
     filter->maxHz = 0.48f * 1000000.0f / getLooptime();
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++)
+    for (int motor = 0; motor < getMotorCount(); motor++)
     {
-        for (int motor = 0; motor < getMotorCount(); motor++)
-        {
 
-            /*
-             * Harmonics are indexed from 1 where 1 means base frequency
-             * C indexes arrays from 0, so we need to shift
-             */
-            for (int harmonicIndex = 0; harmonicIndex < harmonics; harmonicIndex++)
-            {
-                biquadFilterInit(
-                    &filter->filters[axis][motor][harmonicIndex],
-                    filter->minHz * (harmonicIndex + 1),
-                    getLooptime(),
-                    filter->q,
-                    FILTER_NOTCH);
-            }
+        /*
+         * Harmonics are indexed from 1 where 1 means base frequency
+         * C indexes arrays from 0, so we need to shift
+         */
+        for (int harmonicIndex = 0; harmonicIndex < harmonics; harmonicIndex++)
+        {
+            biquadFilter3Init(
+                &filter->filters[motor][harmonicIndex],
+                filter->minHz * (harmonicIndex + 1),
+                getLooptime(),
+                filter->q,
+                FILTER_NOTCH);
         }
     }
 }
@@ -140,20 +129,18 @@ void disableRpmFilters(void) {
 
 void rpmFilterUpdate(rpmFilterBank_t *filterBank, uint8_t motor, float baseFrequency)
 {
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++)
+    for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
     {
-        for (int harmonicIndex = 0; harmonicIndex < filterBank->harmonics; harmonicIndex++)
-        {
-            float harmonicFrequency = baseFrequency * (harmonicIndex + 1);
-            harmonicFrequency = constrainf(harmonicFrequency, filterBank->minHz, filterBank->maxHz);
-
-            biquadFilterUpdate(
-                &filterBank->filters[axis][motor][harmonicIndex],
-                harmonicFrequency,
-                getLooptime(),
-                filterBank->q,
-                FILTER_NOTCH);
-        }
+        float harmonicFrequency = baseFrequency * (harmonicIndex + 1);
+        harmonicFrequency = constrainf(harmonicFrequency, filterBank->minHz, filterBank->maxHz);
+
+        // Motor noise is the same on all axes, coefficients are computed once for X/Y/Z
+        biquadFilter3Update(
+            &filterBank->filters[motor][harmonicIndex],
+            harmonicFrequency,
+            getLooptime(),
+            filterBank->q,
+            FILTER_NOTCH);
     }
 }
 
@@ -195,9 +182,9 @@ void rpmFilterUpdateTask(timeUs_t currentTimeUs)
     }
 }
 
-float rpmFilterGyroApply(uint8_t axis, float input)
+void rpmFilterGyroApply(float *gyroADCf)
 {
-    return rpmGyroApplyFn(&gyroRpmFilters, axis, input);
+    rpmGyroApplyFn(&gyroRpmFilters, gyroADCf);
 }
 
 #endif
@@ -117,6 +117,35 @@ static bool servoFilterIsSet;
 static servoMetadata_t servoMetadata[MAX_SUPPORTED_SERVOS];
 static rateLimitFilter_t servoSpeedLimitFilter[MAX_SERVO_RULES];
 
+/*
+ * Servo mixer rules compiled by loadCustomServoMixer(). Rules are grouped
+ * per output servo (keeping their relative order) and only the input sources
+ * referenced by at least one rule are gathered by servoMixer().
+ */
+typedef struct servoMixerStep_s {
+    uint8_t ruleIndex;                      // index into currentServoMixer, owns the speed limit filter
+    uint8_t inputSource;
+    int16_t rate;
+    float speedLimit;                       // us/s, 0 = unlimited
+#ifdef USE_PROGRAMMING_FRAMEWORK
+    int8_t conditionId;
+#endif
+} servoMixerStep_t;
+
+typedef struct servoMixerOutput_s {
+    uint8_t servoIndex;
+    uint8_t firstStep;
+    uint8_t stepCount;
+    bool hasThrottleInput;                  // output is held at mincommand while disarmed
+} servoMixerOutput_t;
+
+static uint8_t servoMixerInputCount;
+static uint8_t servoMixerInputs[INPUT_SOURCE_COUNT];
+static uint8_t servoMixerOutputCount;
+static servoMixerOutput_t servoMixerOutputs[MAX_SUPPORTED_SERVOS];
+static uint32_t servoMixerOutputMask;
+static servoMixerStep_t servoMixerSteps[MAX_SERVO_RULES];
+
 STATIC_FASTRAM pt1Filter_t rotRateFilter;
 STATIC_FASTRAM pt1Filter_t targetRateFilter;
 
@@ -170,6 +199,62 @@ int getServoCount(void)
     }
 }
 
+static void compileServoMixer(void)
+{
+    bool inputUsed[INPUT_SOURCE_COUNT] = { false };
+
+    servoMixerInputCount = 0;
+    servoMixerOutputCount = 0;
+    servoMixerOutputMask = 0;
+
+    uint8_t stepCount = 0;
+    for (int servoIndex = 0; servoIndex < MAX_SUPPORTED_SERVOS; servoIndex++) {
+        servoMixerOutput_t *output = &servoMixerOutputs[servoMixerOutputCount];
+
+        output->servoIndex = servoIndex;
+        output->firstStep = stepCount;
+        output->stepCount = 0;
+        output->hasThrottleInput = false;
+
+        for (int i = 0; i < servoRuleCount; i++) {
+            const servoMixer_t *rule = &currentServoMixer[i];
+
+            if (rule->targetChannel != servoIndex || rule->inputSource >= INPUT_SOURCE_COUNT) {
+                continue;
+            }
+
+            servoMixerStep_t *step = &servoMixerSteps[stepCount++];
+            step->ruleIndex = i;
+            step->inputSource = rule->inputSource;
+            step->rate = rule->rate;
+            // 1 speed unit is 10us/s
+            step->speedLimit = rule->speed * 10;
+#ifdef USE_PROGRAMMING_FRAMEWORK
+            step->conditionId = rule->conditionId;
+#endif
+            output->stepCount++;
+
+            if (rule->inputSource == INPUT_STABILIZED_THROTTLE || rule->inputSource == INPUT_RC_THROTTLE) {
+                output->hasThrottleInput = true;
+            }
+
+            inputUsed[rule->inputSource] = true;
+        }
+
+        if (output->stepCount) {
+            servoMixerOutputMask |= 1U << servoIndex;
+            servoMixerOutputCount++;
+        }
+    }
+
+    // Stabilized roll, pitch and yaw are always computed, servoMixer() derives the split inputs from them
+    for (int source = 0; source < INPUT_SOURCE_COUNT; source++) {
+        if (inputUsed[source] && source != INPUT_STABILIZED_ROLL && source != INPUT_STABILIZED_PITCH && source != INPUT_STABILIZED_YAW) {
+            servoMixerInputs[servoMixerInputCount++] = source;
+        }
+    }
+}
+
 void loadCustomServoMixer(void)
 {
     // reset settings
@@ -195,6 +280,8 @@ void loadCustomServoMixer(void)
         memcpy(&currentServoMixer[i], customServoMixers(i), sizeof(servoMixer_t));
         servoRuleCount++;
     }
+
+    compileServoMixer();
 }
 
 static void filterServos(void)
@@ -266,143 +353,165 @@ void servoMixer(float dT)
         }
     }
 
-    input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
-    input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
-    input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
-    input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
-    input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
-    input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
-
-    input[INPUT_FEATURE_FLAPS] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
-
-    input[INPUT_MAX] = 500;
-#ifdef USE_PROGRAMMING_FRAMEWORK
-    input[INPUT_GVAR_0] = constrain(gvGet(0), -1000, 1000);
-    input[INPUT_GVAR_1] = constrain(gvGet(1), -1000, 1000);
-    input[INPUT_GVAR_2] = constrain(gvGet(2), -1000, 1000);
-    input[INPUT_GVAR_3] = constrain(gvGet(3), -1000, 1000);
-    input[INPUT_GVAR_4] = constrain(gvGet(4), -1000, 1000);
-    input[INPUT_GVAR_5] = constrain(gvGet(5), -1000, 1000);
-    input[INPUT_GVAR_6] = constrain(gvGet(6), -1000, 1000);
-    input[INPUT_GVAR_7] = constrain(gvGet(7), -1000, 1000);
-#endif
-
-    if (IS_RC_MODE_ACTIVE(BOXCAMSTAB)) {
-        input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -900, 900, -500, +500);
-        input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
-    } else {
-        input[INPUT_GIMBAL_PITCH] = 0;
-        input[INPUT_GIMBAL_ROLL] = 0;
-    }
-
-    input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
-
-    // center the RC input value around the RC middle value
-    // by subtracting the RC middle value from the RC input value, we get:
-    // data - middle = input
-    // 2000 - 1500 = +500
-    // 1500 - 1500 = 0
-    // 1000 - 1500 = -500
-#define GET_RX_CHANNEL_INPUT(x) (rxGetChannelValue(x) - PWM_RANGE_MIDDLE)
-    input[INPUT_RC_ROLL]     = GET_RX_CHANNEL_INPUT(ROLL);
-    input[INPUT_RC_PITCH]    = GET_RX_CHANNEL_INPUT(PITCH);
-    input[INPUT_RC_YAW]      = GET_RX_CHANNEL_INPUT(YAW);
-    input[INPUT_RC_THROTTLE] = GET_RX_CHANNEL_INPUT(THROTTLE);
-    input[INPUT_RC_CH5]      = GET_RX_CHANNEL_INPUT(AUX1);
-    input[INPUT_RC_CH6]      = GET_RX_CHANNEL_INPUT(AUX2);
-    input[INPUT_RC_CH7]      = GET_RX_CHANNEL_INPUT(AUX3);
-    input[INPUT_RC_CH8]      = GET_RX_CHANNEL_INPUT(AUX4);
-    input[INPUT_RC_CH9]      = GET_RX_CHANNEL_INPUT(AUX5);
-    input[INPUT_RC_CH10]     = GET_RX_CHANNEL_INPUT(AUX6);
-    input[INPUT_RC_CH11]     = GET_RX_CHANNEL_INPUT(AUX7);
-    input[INPUT_RC_CH12]     = GET_RX_CHANNEL_INPUT(AUX8);
-    input[INPUT_RC_CH13]     = GET_RX_CHANNEL_INPUT(AUX9);
-    input[INPUT_RC_CH14]     = GET_RX_CHANNEL_INPUT(AUX10);
-    input[INPUT_RC_CH15]     = GET_RX_CHANNEL_INPUT(AUX11);
-    input[INPUT_RC_CH16]     = GET_RX_CHANNEL_INPUT(AUX12);
-#undef GET_RX_CHANNEL_INPUT
-
 #ifdef USE_SIMULATOR
 	simulatorData.input[INPUT_STABILIZED_ROLL] = input[INPUT_STABILIZED_ROLL];
 	simulatorData.input[INPUT_STABILIZED_PITCH] = input[INPUT_STABILIZED_PITCH];
 	simulatorData.input[INPUT_STABILIZED_YAW] = input[INPUT_STABILIZED_YAW];
-	simulatorData.input[INPUT_STABILIZED_THROTTLE] = input[INPUT_STABILIZED_THROTTLE];
+	simulatorData.input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;
 #endif
 
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-        servo[i] = 0;
-    }
+    // Gather only the inputs referenced by the mixer rules
+    for (int i = 0; i < servoMixerInputCount; i++) {
+        const uint8_t source = servoMixerInputs[i];
+
+        switch (source) {
+        case INPUT_STABILIZED_ROLL_PLUS:
+            input[source] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
+            break;
+        case INPUT_STABILIZED_ROLL_MINUS:
+            input[source] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
+            break;
+        case INPUT_STABILIZED_PITCH_PLUS:
+            input[source] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
+            break;
+        case INPUT_STABILIZED_PITCH_MINUS:
+            input[source] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
+            break;
+        case INPUT_STABILIZED_YAW_PLUS:
+            input[source] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
+            break;
+        case INPUT_STABILIZED_YAW_MINUS:
+            input[source] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+            break;
+        case INPUT_FEATURE_FLAPS:
+            input[source] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
+            break;
+        case INPUT_MAX:
+            input[source] = 500;
+            break;
+        case INPUT_GIMBAL_PITCH:
+            input[source] = IS_RC_MODE_ACTIVE(BOXCAMSTAB) ? scaleRange(attitude.values.pitch, -900, 900, -500, +500) : 0;
+            break;
+        case INPUT_GIMBAL_ROLL:
+            input[source] = IS_RC_MODE_ACTIVE(BOXCAMSTAB) ? scaleRange(attitude.values.roll, -1800, 1800, -500, +500) : 0;
+            break;
+        case INPUT_STABILIZED_THROTTLE:
+            input[source] = mixerThrottleCommand - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
+            break;
 
-    // mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
+        // center the RC input value around the RC middle value
+        // by subtracting the RC middle value from the RC input value, we get:
+        // data - middle = input
+        // 2000 - 1500 = +500
+        // 1500 - 1500 = 0
+        // 1000 - 1500 = -500
+        case INPUT_RC_ROLL:
+        case INPUT_RC_PITCH:
+        case INPUT_RC_YAW:
+        case INPUT_RC_THROTTLE:
+        case INPUT_RC_CH5:
+        case INPUT_RC_CH6:
+        case INPUT_RC_CH7:
+        case INPUT_RC_CH8:
+            input[source] = rxGetChannelValue(ROLL + source - INPUT_RC_ROLL) - PWM_RANGE_MIDDLE;
+            break;
+        case INPUT_RC_CH9:
+        case INPUT_RC_CH10:
+        case INPUT_RC_CH11:
+        case INPUT_RC_CH12:
+        case INPUT_RC_CH13:
+        case INPUT_RC_CH14:
+        case INPUT_RC_CH15:
+        case INPUT_RC_CH16:
+            input[source] = rxGetChannelValue(AUX5 + source - INPUT_RC_CH9) - PWM_RANGE_MIDDLE;
+            break;
 
-        /*
-         * Check if conditions for a rule are met, not all conditions apply all the time
-         */
-    #ifdef USE_PROGRAMMING_FRAMEWORK
-        if (!logicConditionGetValue(currentServoMixer[i].conditionId)) {
-            continue; 
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        case INPUT_GVAR_0:
+        case INPUT_GVAR_1:
+        case INPUT_GVAR_2:
+        case INPUT_GVAR_3:
+        case INPUT_GVAR_4:
+        case INPUT_GVAR_5:
+        case INPUT_GVAR_6:
+        case INPUT_GVAR_7:
+            input[source] = constrain(gvGet(source - INPUT_GVAR_0), -1000, 1000);
+            break;
+#endif
+        default:
+            input[source] = 0;
+            break;
         }
-    #endif
+    }
 
-        const uint8_t target = currentServoMixer[i].targetChannel;
-        const uint8_t from = currentServoMixer[i].inputSource;
+    // mix servos according to the compiled rules
+    for (int i = 0; i < servoMixerOutputCount; i++) {
+        const servoMixerOutput_t *output = &servoMixerOutputs[i];
+        const uint8_t target = output->servoIndex;
+        int32_t mix = 0;
 
-        /*
-         * Apply mixer speed limit. 1 [one] speed unit is defined as 10us/s:
-         * 0 = no limiting
-         * 1 = 10us/s -> full servo sweep (from 1000 to 2000) is performed in 100s
-         * 10 = 100us/s -> full sweep (from 1000 to 2000)  is performed in 10s
-         * 100 = 1000us/s -> full sweep in 1s
-         */
-        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[i], input[from], currentServoMixer[i].speed * 10, dT);
+        for (int j = output->firstStep; j < output->firstStep + output->stepCount; j++) {
+            const servoMixerStep_t *step = &servoMixerSteps[j];
 
-        servo[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
-    }
+            /*
+             * Check if conditions for a rule are met, not all conditions apply all the time
+             */
+#ifdef USE_PROGRAMMING_FRAMEWORK
+            if (!logicConditionGetValue(step->conditionId)) {
+                continue;
+            }
+#endif
 
-    /*
-     * When not armed, apply servo low position to all outputs that include a throttle or stabilizet throttle in the mix
-     */
-    if (!ARMING_FLAG(ARMED)) {
-        for (int i = 0; i < servoRuleCount; i++) {
-            const uint8_t target = currentServoMixer[i].targetChannel;
-            const uint8_t from = currentServoMixer[i].inputSource;
+            /*
+             * Apply mixer speed limit. 1 [one] speed unit is defined as 10us/s:
+             * 0 = no limiting
+             * 1 = 10us/s -> full servo sweep (from 1000 to 2000) is performed in 100s
+             * 10 = 100us/s -> full sweep (from 1000 to 2000)  is performed in 10s
+             * 100 = 1000us/s -> full sweep in 1s
+             */
+            const int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[step->ruleIndex], input[step->inputSource], step->speedLimit, dT);
 
-            if (from == INPUT_STABILIZED_THROTTLE || from == INPUT_RC_THROTTLE) {
-                servo[target] = motorConfig()->mincommand;
-            }
+            mix += ((int32_t)inputLimited * step->rate) / 100;
         }
-    }
 
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        /*
+         * When not armed, apply servo low position to all outputs that include a throttle or stabilizet throttle in the mix
+         */
+        if (output->hasThrottleInput && !ARMING_FLAG(ARMED)) {
+            mix = motorConfig()->mincommand;
+        }
 
         /*
          * Apply servo rate
          */
-        servo[i] = ((int32_t)servoParams(i)->rate * servo[i]) / 100L;
+        int16_t value = ((int32_t)servoParams(target)->rate * (int16_t)mix) / 100L;
 
         /*
          * Perform acumulated servo output scaling to match servo min and max values
          * Important: is servo rate is > 100%, total servo output might be bigger than
          * min/max
          */
-        if (servo[i] > 0) {
-            servo[i] = (int16_t) (servo[i] * servoMetadata[i].scaleMax);
+        if (value > 0) {
+            value = (int16_t) (value * servoMetadata[target].scaleMax);
         } else {
-            servo[i] = (int16_t) (servo[i] * servoMetadata[i].scaleMin);
+            value = (int16_t) (value * servoMetadata[target].scaleMin);
         }
 
         /*
-         * Add a servo midpoint to the calculation
+         * Add a servo midpoint to the calculation and constrain servo position to
+         * min/max to prevent servo damage. If servo was saturated above min/max,
+         * that means that user most probably allowed the situation when smix weight
+         * sum for an output was above 100
          */
-        servo[i] += servoParams(i)->middle;
+        value += servoParams(target)->middle;
+        servo[target] = constrain(value, servoParams(target)->min, servoParams(target)->max);
+    }
 
-        /*
-         * Constrain servo position to min/max to prevent servo damage
-         * If servo was saturated above min/max, that means that user most probably
-         * allowed the situation when smix weight sum for an output was above 100
-         */
-        servo[i] = constrain(servo[i], servoParams(i)->min, servoParams(i)->max);
+    // Servos without rules rest at their midpoint
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        if (!(servoMixerOutputMask & (1U << i))) {
+            servo[i] = constrain(servoParams(i)->middle, servoParams(i)->min, servoParams(i)->max);
+        }
     }
 }
 
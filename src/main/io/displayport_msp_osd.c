@@ -34,6 +34,7 @@
 #include "common/printf.h"
 #include "common/time.h"
 #include "common/bitarray.h"
+#include "common/maths.h"
 
 #include "cms/cms.h"
 
@@ -66,6 +67,14 @@ typedef enum {          // defines are from hdzero code
 #define TX_BUFFER_SIZE 1024
 #define VTX_TIMEOUT 1000 // 1 second timer
 
+#define MSP_V1_FRAME_OVERHEAD 6         // $M> + size + cmd + crc
+#define MSP_DP_WRITE_STRING_HEADER 4    // subcmd + row + col + attributes
+// Dirty runs separated by fewer clean characters than the overhead of
+// another MSP frame are merged, resending the clean ones is cheaper
+#define MSP_DP_RUN_MERGE_GAP (MSP_V1_FRAME_OVERHEAD + MSP_DP_WRITE_STRING_HEADER)
+// Full frame refreshes are spread over several draws, a few rows at a time
+#define FULLFRAME_ROWS_PER_DRAW 2
+
 static mspProcessCommandFnPtr mspProcessCommand;
 static mspPort_t mspPort;
 static displayPort_t mspOsdDisplayPort;
@@ -102,7 +111,10 @@ static uint8_t screen[SCREENSIZE];
 static BITARRAY_DECLARE(fontPage, SCREENSIZE);  // font page for each character on the screen
 static BITARRAY_DECLARE(dirty, SCREENSIZE);     // change status for each character on the screen
 static BITARRAY_DECLARE(blinkChar, SCREENSIZE); // Does the character blink?
+static BITARRAY_DECLARE(touched, SCREENSIZE);   // Changed since its row was last part of a full frame refresh
 static bool screenCleared;
+static uint16_t drawResumePos;          // Where to continue sending dirty characters after the link saturated
+static uint8_t fullFrameRow = UINT8_MAX; // Next row of the full frame refresh in progress, if any
 static uint8_t screenRows, screenCols;
 static videoSystem_e osdVideoSystem;
 
@@ -169,6 +181,8 @@ static void init(void)
     BITARRAY_CLR_ALL(fontPage);
     BITARRAY_CLR_ALL(dirty);
     BITARRAY_CLR_ALL(blinkChar);
+    BITARRAY_CLR_ALL(touched);
+    drawResumePos = 0;
 }
 
 static int clearScreen(displayPort_t *displayPort)
@@ -220,6 +234,7 @@ static int setChar(const uint16_t pos, const uint16_t c, textAttributes_t attr)
             (page) ? bitArraySet(fontPage, pos) : bitArrayClr(fontPage, pos);
             (TEXT_ATTRIBUTES_HAVE_BLINK(attr)) ? bitArraySet(blinkChar, pos) : bitArrayClr(blinkChar, pos);
             bitArraySet(dirty, pos);
+            bitArraySet(touched, pos);
         }
     }
     return 0;
@@ -254,47 +269,77 @@ static int drawScreen(displayPort_t *displayPort) // 250Hz
         return 0;
     }
 
-    if (osdConfig()->msp_displayport_fullframe_interval >= 0 && (millis() > sendSubFrameMs)) {
-        // For full frame update, first clear the OSD completely
-        uint8_t refreshSubcmd[1];
-        refreshSubcmd[0] = MSP_DP_CLEAR_SCREEN;
-        output(displayPort, MSP_DISPLAYPORT, refreshSubcmd, sizeof(refreshSubcmd));
-        
-        // Then dirty the characters that are not blank, to send all data on this draw.
-        for (unsigned int pos = 0; pos < sizeof(screen); pos++) {
-            if (screen[pos] != SYM_BLANK) {
-                bitArraySet(dirty, pos);
+    if (osdConfig()->msp_displayport_fullframe_interval >= 0 && fullFrameRow >= screenRows && (millis() > sendSubFrameMs)) {
+        fullFrameRow = 0;
+        sendSubFrameMs = (osdConfig()->msp_displayport_fullframe_interval > 0) ? (millis() + DS2MS(osdConfig()->msp_displayport_fullframe_interval)) : 0;
+    }
+
+    if (fullFrameRow < screenRows) {
+        // Resend a few rows per draw instead of clearing the VTX canvas and
+        // sending the whole screen at once. Besides the visible characters,
+        // anything changed since the previous refresh is resent too, so
+        // characters that were erased but whose update got lost are repaired.
+        const uint8_t lastRow = MIN(fullFrameRow + FULLFRAME_ROWS_PER_DRAW, screenRows);
+        for (; fullFrameRow < lastRow; fullFrameRow++) {
+            const unsigned rowStart = fullFrameRow * COLS;
+            for (unsigned pos = rowStart; pos < rowStart + screenCols; pos++) {
+                if (screen[pos] != SYM_BLANK || bitArrayGet(touched, pos)) {
+                    bitArraySet(dirty, pos);
+                    bitArrayClr(touched, pos);
+                }
             }
         }
-            
-        sendSubFrameMs = (osdConfig()->msp_displayport_fullframe_interval > 0) ? (millis() + DS2MS(osdConfig()->msp_displayport_fullframe_interval)) : 0;
     }
 
-    uint8_t subcmd[COLS + 4];
+    // Only queue what the TX buffer can take, frames that don't fit would
+    // be dropped. Whatever is left stays dirty and goes out on the next draw.
+    int txBudget = (int)mspSerialTxBytesFree(mspPort.port) - (MSP_V1_FRAME_OVERHEAD + 1);
+
+    uint8_t subcmd[COLS + MSP_DP_WRITE_STRING_HEADER];
     uint8_t updateCount = 0;
     subcmd[0] = MSP_DP_WRITE_STRING;
 
-    int next = BITARRAY_FIND_FIRST_SET(dirty, 0);
-    while (next >= 0) {
-        // Look for sequential dirty characters on the same line for the same font page
-        int pos = next;
-        uint8_t row = pos / COLS;
-        uint8_t col = pos % COLS;
-        uint8_t attributes = 0;
-        int endOfLine = row * COLS + screenCols;
-        bool page = bitArrayGet(fontPage, pos);
-        bool blink = bitArrayGet(blinkChar, pos);
-
-        uint8_t len = 4;
-        do {
-            bitArrayClr(dirty, pos);
-            subcmd[len++] = isBfCompatibleVideoSystem(osdConfig()) ? getBfCharacter(screen[pos++], page): screen[pos++];
+    int next = BITARRAY_FIND_FIRST_SET(dirty, drawResumePos);
+    if (next < 0) {
+        next = BITARRAY_FIND_FIRST_SET(dirty, 0);
+    }
+    drawResumePos = 0;
 
+    while (next >= 0) {
+        // Look for dirty characters on the same line for the same font page and blink
+        // state, bridging short runs of unchanged characters.
+        const int start = next;
+        const uint8_t row = start / COLS;
+        const uint8_t col = start % COLS;
+        const int endOfLine = row * COLS + screenCols;
+        const bool page = bitArrayGet(fontPage, start);
+        const bool blink = bitArrayGet(blinkChar, start);
+
+        int end = start + 1;
+        for (int pos = end; pos < endOfLine && (pos - end) < MSP_DP_RUN_MERGE_GAP; pos++) {
+            if (bitArrayGet(fontPage, pos) != page || bitArrayGet(blinkChar, pos) != blink) {
+                break;
+            }
             if (bitArrayGet(dirty, pos)) {
-                next = pos;
+                end = pos + 1;
             }
-        } while (next == pos && next < endOfLine && bitArrayGet(fontPage, next) == page && bitArrayGet(blinkChar, next) == blink);
+        }
+
+        const int maxLength = txBudget - (MSP_V1_FRAME_OVERHEAD + MSP_DP_WRITE_STRING_HEADER);
+        if (maxLength <= 0) {
+            drawResumePos = start;
+            break;
+        }
+        end = MIN(end, start + maxLength);
+        const int frameLength = MSP_V1_FRAME_OVERHEAD + MSP_DP_WRITE_STRING_HEADER + (end - start);
 
+        uint8_t len = MSP_DP_WRITE_STRING_HEADER;
+        for (int pos = start; pos < end; pos++) {
+            bitArrayClr(dirty, pos);
+            subcmd[len++] = isBfCompatibleVideoSystem(osdConfig()) ? getBfCharacter(screen[pos], page): screen[pos];
+        }
+
+        uint8_t attributes = 0;
         if (!isBfCompatibleVideoSystem(osdConfig())) {
             attributes |= (page << DISPLAYPORT_MSP_ATTR_FONTPAGE);
         }
@@ -307,8 +352,13 @@ static int drawScreen(displayPort_t *displayPort) // 250Hz
         subcmd[2] = col;
         subcmd[3] = attributes;
         output(displayPort, MSP_DISPLAYPORT, subcmd, len);
+        txBudget -= frameLength;
         updateCount++;
-        next = BITARRAY_FIND_FIRST_SET(dirty, pos);
+
+        next = BITARRAY_FIND_FIRST_SET(dirty, end);
+        if (next < 0) {
+            next = BITARRAY_FIND_FIRST_SET(dirty, 0);
+        }
     }
 
     if (updateCount > 0 || screenCleared) {
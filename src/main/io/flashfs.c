@@ -35,6 +35,7 @@
 #if defined(USE_FLASHFS)
 
 #include "drivers/flash.h"
+#include "drivers/time.h"
 
 #include "io/flashfs.h"
 
@@ -49,11 +50,13 @@ static uint8_t flashWriteBuffer[FLASHFS_WRITE_BUFFER_SIZE];
  *
  * When the circular buffer is empty, head == tail
  */
-static uint8_t bufferHead = 0, bufferTail = 0;
+static uint16_t bufferHead = 0, bufferTail = 0;
 
 // The position of the buffer's tail in the overall flash address space:
 static uint32_t tailAddress = 0;
 
+static flashfsStats_t flashfsStats;
+
 static void flashfsClearBuffer(void)
 {
     bufferTail = bufferHead = 0;
@@ -74,6 +77,7 @@ void flashfsEraseCompletely(void)
     flashPartitionErase(flashPartition);
     flashfsClearBuffer();
     flashfsSetTailAddress(0);
+    memset(&flashfsStats, 0, sizeof(flashfsStats));
 }
 
 void flashfsClose(void)
@@ -141,6 +145,14 @@ static uint32_t flashfsTransmitBufferUsed(void)
     return FLASHFS_WRITE_BUFFER_SIZE - bufferTail + bufferHead;
 }
 
+static void flashfsUpdateBufferPeak(void)
+{
+    const uint32_t used = flashfsTransmitBufferUsed();
+    if (used > flashfsStats.bufferPeak) {
+        flashfsStats.bufferPeak = used;
+    }
+}
+
 /**
  * Get the size of the largest single write that flashfs could ever accept without blocking or data loss.
  */
@@ -189,9 +201,11 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
     }
 
     if (!sync && !flashIsReady()) {
+        flashfsStats.busyDeferrals++;
         return 0;
     }
 
+    const timeUs_t startTime = sync ? micros() : 0;
     uint32_t bytesTotalRemaining = bytesTotal;
 
     while (bytesTotalRemaining > 0) {
@@ -255,6 +269,10 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
             break;
     }
 
+    if (sync) {
+        flashfsStats.stallTimeUs += cmpTimeUs(micros(), startTime);
+    }
+
     return bytesTotal - bytesTotalRemaining;
 }
 
@@ -382,6 +400,8 @@ void flashfsWriteByte(uint8_t byte)
         bufferHead = 0;
     }
 
+    flashfsUpdateBufferPeak();
+
     if (flashfsTransmitBufferUsed() >= FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN) {
         flashfsFlushAsync();
     }
@@ -439,6 +459,8 @@ void flashfsWrite(const uint8_t *data, unsigned int len, bool sync)
                  * Silently drop the data the user asked to write (i.e. no-op) since we can't buffer it and they
                  * requested async.
                  */
+                flashfsStats.droppedWrites++;
+                flashfsStats.droppedBytes += bufferSizes[2];
             }
 
             return;
@@ -469,6 +491,8 @@ void flashfsWrite(const uint8_t *data, unsigned int len, bool sync)
 
         bufferHead = len;
     }
+
+    flashfsUpdateBufferPeak();
 }
 
 /**
@@ -571,6 +595,11 @@ bool flashfsIsEOF(void)
     return tailAddress >= flashfsGetSize();
 }
 
+const flashfsStats_t *flashfsGetStats(void)
+{
+    return &flashfsStats;
+}
+
 /**
  * Call after initializing the flash chip in order to set up the filesystem.
  */
@@ -21,12 +21,28 @@
 
 #include "drivers/flash.h"
 
+#ifndef FLASHFS_WRITE_BUFFER_SIZE
+#ifdef USE_FLASH_W25N01G
+// Big enough to hold the data logged while the NAND executes a page program
+// (tPP up to 700us), during which it can't accept more data.
+#define FLASHFS_WRITE_BUFFER_SIZE 512
+#else
 #define FLASHFS_WRITE_BUFFER_SIZE 128
+#endif
+#endif
 #define FLASHFS_WRITE_BUFFER_USABLE (FLASHFS_WRITE_BUFFER_SIZE - 1)
 
 // Automatically trigger a flush when this much data is in the buffer
 #define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN 64
 
+typedef struct flashfsStats_s {
+    uint32_t droppedWrites;     // Asynchronous writes discarded because the buffer was full
+    uint32_t droppedBytes;
+    uint32_t busyDeferrals;     // Asynchronous flushes deferred because the flash was busy
+    uint32_t stallTimeUs;       // Time spent blocked in synchronous writes
+    uint16_t bufferPeak;        // Highest write buffer usage seen
+} flashfsStats_t;
+
 void flashfsEraseCompletely(void);
 void flashfsEraseRange(uint32_t start, uint32_t end);
 
@@ -53,3 +69,5 @@ void flashfsInit(void);
 
 bool flashfsIsReady(void);
 bool flashfsIsEOF(void);
+
+const flashfsStats_t *flashfsGetStats(void);
@@ -46,13 +46,14 @@
 #include "io/serial.h"
 #include "io/gps.h"
 #include "io/gps_private.h"
+#include "io/gps_ublox.h"
 
 #include "scheduler/protothreads.h"
 
 #define GPS_CFG_CMD_TIMEOUT_MS              200
 #define GPS_VERSION_RETRY_TIMES             2
-#define MAX_UBLOX_PAYLOAD_SIZE              256
-#define UBLOX_BUFFER_SIZE                   MAX_UBLOX_PAYLOAD_SIZE
+#define UBX_FRAME_OFFSET                    2       // puts the payload of a frame at the start of the buffer on a 4-byte boundary
+#define UBLOX_RX_BUFFER_SIZE                (UBX_FRAME_OFFSET + UBX_HEADER_SIZE + MAX_UBLOX_PAYLOAD_SIZE + UBX_CHECKSUM_SIZE + 64)
 #define UBLOX_SBAS_MESSAGE_LENGTH           16
 
 #define UBX_DYNMODEL_PEDESTRIAN 3
@@ -293,8 +294,8 @@ typedef struct {
 } ubx_ack_ack;
 
 enum {
-    PREAMBLE1 = 0xB5,
-    PREAMBLE2 = 0x62,
+    PREAMBLE1 = UBX_PREAMBLE1,
+    PREAMBLE2 = UBX_PREAMBLE2,
     CLASS_NAV = 0x01,
     CLASS_ACK = 0x05,
     CLASS_CFG = 0x06,
@@ -346,16 +347,9 @@ enum {
     UBX_ACK_GOT_NAK = 2
 } ubx_ack_state;
 
-// Packet checksum accumulators
-static uint8_t _ck_a;
-static uint8_t _ck_b;
-
-// State machine state
-static bool _skip_packet;
-static uint8_t _step;
+// Frame being decoded
 static uint8_t _msg_id;
 static uint16_t _payload_length;
-static uint16_t _payload_counter;
 
 static uint8_t next_fix_type;
 static uint8_t _class;
@@ -390,8 +384,7 @@ static union {
     uint8_t bytes[58];
 } send_buffer;
 
-// Receive buffer
-static union {
+typedef union {
     ubx_nav_posllh posllh;
     ubx_nav_status status;
     ubx_nav_solution solution;
@@ -401,10 +394,20 @@ static union {
     ubx_mon_ver ver;
     ubx_nav_timeutc timeutc;
     ubx_ack_ack ack;
-    uint8_t bytes[UBLOX_BUFFER_SIZE];
-} _buffer;
+    uint8_t bytes[MAX_UBLOX_PAYLOAD_SIZE];
+} ubx_rx_payload;
 
-void _update_checksum(uint8_t *data, uint8_t len, uint8_t *ck_a, uint8_t *ck_b)
+// Receive buffer. Bytes are read from the serial port in chunks and frames
+// are decoded in place, a frame is only moved when its payload would be
+// misaligned.
+static union {
+    uint32_t align;
+    uint8_t bytes[UBLOX_RX_BUFFER_SIZE];
+} _rxBuffer;
+static uint16_t _rxLength;      // bytes held, counted from UBX_FRAME_OFFSET
+static bool _rxPending;         // parsing stopped at a new solution, frames may be left
+
+static void _update_checksum(const uint8_t *data, unsigned len, uint8_t *ck_a, uint8_t *ck_b)
 {
     while (len--) {
         *ck_a += *data;
@@ -600,51 +603,51 @@ static uint32_t gpsDecodeHardwareVersion(const char * szBuf, unsigned nBufSize)
     return UBX_HW_VERSION_UNKNOWN;
 }
 
-static bool gpsParceFrameUBLOX(void)
+static bool gpsParceFrameUBLOX(const ubx_rx_payload *payload)
 {
     switch (_msg_id) {
     case MSG_POSLLH:
-        gpsSol.llh.lon = _buffer.posllh.longitude;
-        gpsSol.llh.lat = _buffer.posllh.latitude;
-        gpsSol.llh.alt = _buffer.posllh.altitude_msl / 10;  //alt in cm
-        gpsSol.eph = gpsConstrainEPE(_buffer.posllh.horizontal_accuracy / 10);
-        gpsSol.epv = gpsConstrainEPE(_buffer.posllh.vertical_accuracy / 10);
+        gpsSol.llh.lon = payload->posllh.longitude;
+        gpsSol.llh.lat = payload->posllh.latitude;
+        gpsSol.llh.alt = payload->posllh.altitude_msl / 10;  //alt in cm
+        gpsSol.eph = gpsConstrainEPE(payload->posllh.horizontal_accuracy / 10);
+        gpsSol.epv = gpsConstrainEPE(payload->posllh.vertical_accuracy / 10);
         gpsSol.flags.validEPE = true;
         if (next_fix_type != GPS_NO_FIX)
             gpsSol.fixType = next_fix_type;
         _new_position = true;
         break;
     case MSG_STATUS:
-        next_fix_type = gpsMapFixType(_buffer.status.fix_status & NAV_STATUS_FIX_VALID, _buffer.status.fix_type);
+        next_fix_type = gpsMapFixType(payload->status.fix_status & NAV_STATUS_FIX_VALID, payload->status.fix_type);
         if (next_fix_type == GPS_NO_FIX)
             gpsSol.fixType = GPS_NO_FIX;
         break;
     case MSG_SOL:
-        next_fix_type = gpsMapFixType(_buffer.solution.fix_status & NAV_STATUS_FIX_VALID, _buffer.solution.fix_type);
+        next_fix_type = gpsMapFixType(payload->solution.fix_status & NAV_STATUS_FIX_VALID, payload->solution.fix_type);
         if (next_fix_type == GPS_NO_FIX)
             gpsSol.fixType = GPS_NO_FIX;
-        gpsSol.numSat = _buffer.solution.satellites;
-        gpsSol.hdop = gpsConstrainHDOP(_buffer.solution.position_DOP);
+        gpsSol.numSat = payload->solution.satellites;
+        gpsSol.hdop = gpsConstrainHDOP(payload->solution.position_DOP);
         break;
     case MSG_VELNED:
-        gpsSol.groundSpeed = _buffer.velned.speed_2d;    // cm/s
-        gpsSol.groundCourse = (uint16_t) (_buffer.velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
-        gpsSol.velNED[X] = _buffer.velned.ned_north;
-        gpsSol.velNED[Y] = _buffer.velned.ned_east;
-        gpsSol.velNED[Z] = _buffer.velned.ned_down;
+        gpsSol.groundSpeed = payload->velned.speed_2d;    // cm/s
+        gpsSol.groundCourse = (uint16_t) (payload->velned.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+        gpsSol.velNED[X] = payload->velned.ned_north;
+        gpsSol.velNED[Y] = payload->velned.ned_east;
+        gpsSol.velNED[Z] = payload->velned.ned_down;
         gpsSol.flags.validVelNE = true;
         gpsSol.flags.validVelD = true;
         _new_speed = true;
         break;
     case MSG_TIMEUTC:
-        if (UBX_VALID_GPS_DATE_TIME(_buffer.timeutc.valid)) {
-            gpsSol.time.year = _buffer.timeutc.year;
-            gpsSol.time.month = _buffer.timeutc.month;
-            gpsSol.time.day = _buffer.timeutc.day;
-            gpsSol.time.hours = _buffer.timeutc.hour;
-            gpsSol.time.minutes = _buffer.timeutc.min;
-            gpsSol.time.seconds = _buffer.timeutc.sec;
-            gpsSol.time.millis = _buffer.timeutc.nano / (1000*1000);
+        if (UBX_VALID_GPS_DATE_TIME(payload->timeutc.valid)) {
+            gpsSol.time.year = payload->timeutc.year;
+            gpsSol.time.month = payload->timeutc.month;
+            gpsSol.time.day = payload->timeutc.day;
+            gpsSol.time.hours = payload->timeutc.hour;
+            gpsSol.time.minutes = payload->timeutc.min;
+            gpsSol.time.seconds = payload->timeutc.sec;
+            gpsSol.time.millis = payload->timeutc.nano / (1000*1000);
 
             gpsSol.flags.validTime = true;
         } else {
@@ -652,32 +655,32 @@ static bool gpsParceFrameUBLOX(void)
         }
         break;
     case MSG_PVT:
-        next_fix_type = gpsMapFixType(_buffer.pvt.fix_status & NAV_STATUS_FIX_VALID, _buffer.pvt.fix_type);
+        next_fix_type = gpsMapFixType(payload->pvt.fix_status & NAV_STATUS_FIX_VALID, payload->pvt.fix_type);
         gpsSol.fixType = next_fix_type;
-        gpsSol.llh.lon = _buffer.pvt.longitude;
-        gpsSol.llh.lat = _buffer.pvt.latitude;
-        gpsSol.llh.alt = _buffer.pvt.altitude_msl / 10;  //alt in cm
-        gpsSol.velNED[X]=_buffer.pvt.ned_north / 10;  // to cm/s
-        gpsSol.velNED[Y]=_buffer.pvt.ned_east / 10;   // to cm/s
-        gpsSol.velNED[Z]=_buffer.pvt.ned_down / 10;   // to cm/s
-        gpsSol.groundSpeed = _buffer.pvt.speed_2d / 10;    // to cm/s
-        gpsSol.groundCourse = (uint16_t) (_buffer.pvt.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
-        gpsSol.numSat = _buffer.pvt.satellites;
-        gpsSol.eph = gpsConstrainEPE(_buffer.pvt.horizontal_accuracy / 10);
-        gpsSol.epv = gpsConstrainEPE(_buffer.pvt.vertical_accuracy / 10);
-        gpsSol.hdop = gpsConstrainHDOP(_buffer.pvt.position_DOP);
+        gpsSol.llh.lon = payload->pvt.longitude;
+        gpsSol.llh.lat = payload->pvt.latitude;
+        gpsSol.llh.alt = payload->pvt.altitude_msl / 10;  //alt in cm
+        gpsSol.velNED[X]=payload->pvt.ned_north / 10;  // to cm/s
+        gpsSol.velNED[Y]=payload->pvt.ned_east / 10;   // to cm/s
+        gpsSol.velNED[Z]=payload->pvt.ned_down / 10;   // to cm/s
+        gpsSol.groundSpeed = payload->pvt.speed_2d / 10;    // to cm/s
+        gpsSol.groundCourse = (uint16_t) (payload->pvt.heading_2d / 10000);     // Heading 2D deg * 100000 rescaled to deg * 10
+        gpsSol.numSat = payload->pvt.satellites;
+        gpsSol.eph = gpsConstrainEPE(payload->pvt.horizontal_accuracy / 10);
+        gpsSol.epv = gpsConstrainEPE(payload->pvt.vertical_accuracy / 10);
+        gpsSol.hdop = gpsConstrainHDOP(payload->pvt.position_DOP);
         gpsSol.flags.validVelNE = true;
         gpsSol.flags.validVelD = true;
         gpsSol.flags.validEPE = true;
 
-        if (UBX_VALID_GPS_DATE_TIME(_buffer.pvt.valid)) {
-            gpsSol.time.year = _buffer.pvt.year;
-            gpsSol.time.month = _buffer.pvt.month;
-            gpsSol.time.day = _buffer.pvt.day;
-            gpsSol.time.hours = _buffer.pvt.hour;
-            gpsSol.time.minutes = _buffer.pvt.min;
-            gpsSol.time.seconds = _buffer.pvt.sec;
-            gpsSol.time.millis = _buffer.pvt.nano / (1000*1000);
+        if (UBX_VALID_GPS_DATE_TIME(payload->pvt.valid)) {
+            gpsSol.time.year = payload->pvt.year;
+            gpsSol.time.month = payload->pvt.month;
+            gpsSol.time.day = payload->pvt.day;
+            gpsSol.time.hours = payload->pvt.hour;
+            gpsSol.time.minutes = payload->pvt.min;
+            gpsSol.time.seconds = payload->pvt.sec;
+            gpsSol.time.millis = payload->pvt.nano / (1000*1000);
 
             gpsSol.flags.validTime = true;
         } else {
@@ -689,12 +692,12 @@ static bool gpsParceFrameUBLOX(void)
         break;
     case MSG_VER:
         if (_class == CLASS_MON) {
-            gpsState.hwVersion = gpsDecodeHardwareVersion(_buffer.ver.hwVersion, sizeof(_buffer.ver.hwVersion));
-            if  ((gpsState.hwVersion >= UBX_HW_VERSION_UBLOX8) && (_buffer.ver.swVersion[9] > '2')) {
+            gpsState.hwVersion = gpsDecodeHardwareVersion(payload->ver.hwVersion, sizeof(payload->ver.hwVersion));
+            if  ((gpsState.hwVersion >= UBX_HW_VERSION_UBLOX8) && (payload->ver.swVersion[9] > '2')) {
                 // check extensions;
                 // after hw + sw vers; each is 30 bytes
                 for(int j = 40; j < _payload_length; j += 30) {
-                    if (strnstr((const char *)(_buffer.bytes+j), "GAL", 30)) {
+                    if (strnstr((const char *)(payload->bytes + j), "GAL", 30)) {
                         capGalileo = true;
                         break;
                     }
@@ -703,12 +706,12 @@ static bool gpsParceFrameUBLOX(void)
         }
         break;
     case MSG_ACK_ACK:
-        if ((_ack_state == UBX_ACK_WAITING) && (_buffer.ack.msg == _ack_waiting_msg)) {
+        if ((_ack_state == UBX_ACK_WAITING) && (payload->ack.msg == _ack_waiting_msg)) {
             _ack_state = UBX_ACK_GOT_ACK;
         }
         break;
     case MSG_ACK_NACK:
-        if ((_ack_state == UBX_ACK_WAITING) && (_buffer.ack.msg == _ack_waiting_msg)) {
+        if ((_ack_state == UBX_ACK_WAITING) && (payload->ack.msg == _ack_waiting_msg)) {
             _ack_state = UBX_ACK_GOT_NAK;
         }
         break;
@@ -726,93 +729,96 @@ static bool gpsParceFrameUBLOX(void)
     return false;
 }
 
-static bool gpsNewFrameUBLOX(uint8_t data)
+// Returns the offset of the first possible frame in data: a sync char 1
+// followed by sync char 2 or ending the data, or len if there is none.
+// Payload rarely contains the sync char, so the data is scanned a word at
+// a time and only words that do are looked at byte by byte.
+static unsigned ubloxFindSync(const uint8_t *data, unsigned len)
 {
+    unsigned pos = 0;
+
+    while (pos < len) {
+        for (; pos + sizeof(uint32_t) <= len; pos += sizeof(uint32_t)) {
+            uint32_t word;
+            memcpy(&word, &data[pos], sizeof(word));
+            word ^= PREAMBLE1 * 0x01010101U;
+            if ((word - 0x01010101U) & ~word & 0x80808080U) {
+                break;  // at least one byte is PREAMBLE1
+            }
+        }
+
+        while (pos < len && data[pos] != PREAMBLE1) {
+            pos++;
+        }
+
+        if (pos + 1 >= len || data[pos + 1] == PREAMBLE2) {
+            return pos;
+        }
+        pos++;
+    }
+
+    return len;
+}
+
+// Decodes the complete frames held in the receive buffer and keeps the
+// bytes from the next possible frame on. Stops after a frame that
+// completes a new solution, so it's used before the next one is decoded.
+static bool gpsParseBufferUBLOX(void)
+{
+    uint8_t *rx = &_rxBuffer.bytes[UBX_FRAME_OFFSET];
+    unsigned pos = 0;
     bool parsed = false;
 
-    switch (_step) {
-        case 0: // Sync char 1 (0xB5)
-            if (PREAMBLE1 == data) {
-                _skip_packet = false;
-                _step++;
-            }
+    while (!parsed) {
+        pos += ubloxFindSync(&rx[pos], _rxLength - pos);
+        if (_rxLength - pos < UBX_HEADER_SIZE) {
             break;
-        case 1: // Sync char 2 (0x62)
-            if (PREAMBLE2 != data) {
-                _step = 0;
-                break;
-            }
-            _step++;
-            break;
-        case 2: // Class
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;   // reset the checksum accumulators
-            break;
-        case 3: // Id
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _msg_id = data;
-            break;
-        case 4: // Payload length (part 1)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length = data; // payload length low byte
-            break;
-        case 5: // Payload length (part 2)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length |= (uint16_t)(data << 8);
-            if (_payload_length > MAX_UBLOX_PAYLOAD_SIZE ) {
-                // we can't receive the whole packet, just log the error and start searching for the next packet.
-                gpsStats.errors++;
-                _step = 0;
-                break;
-            }
-            // prepare to receive payload
-            _payload_counter = 0;
-            if (_payload_length == 0) {
-                _step = 7;
-            }
-            break;
-        case 6:
-            _ck_b += (_ck_a += data);       // checksum byte
-            if (_payload_counter < MAX_UBLOX_PAYLOAD_SIZE) {
-                _buffer.bytes[_payload_counter] = data;
-            }
-            // NOTE: check counter BEFORE increasing so that a payload_size of 65535 is correctly handled.  This can happen if garbage data is received.
-            if (_payload_counter ==  _payload_length - 1) {
-                _step++;
-            }
-            _payload_counter++;
-            break;
-        case 7:
-            _step++;
-            if (_ck_a != data) {
-                _skip_packet = true;          // bad checksum
-                gpsStats.errors++;
-                _step = 0;
-            }
+        }
+
+        const uint16_t payloadLength = rx[pos + 4] | (rx[pos + 5] << 8);
+        if (payloadLength > MAX_UBLOX_PAYLOAD_SIZE) {
+            // we can't receive the whole packet, just log the error and start searching for the next packet.
+            gpsStats.errors++;
+            pos++;
+            continue;
+        }
+
+        const unsigned frameLength = UBX_HEADER_SIZE + payloadLength + UBX_CHECKSUM_SIZE;
+        if (_rxLength - pos < frameLength) {
             break;
-        case 8:
-            _step = 0;
+        }
 
-            if (_ck_b != data) {
-                gpsStats.errors++;
-                break;              // bad checksum
-            }
+        // Checksum covers class, id, length and payload
+        uint8_t ck_a = 0;
+        uint8_t ck_b = 0;
+        _update_checksum(&rx[pos + 2], payloadLength + 4, &ck_a, &ck_b);
+        if (ck_a != rx[pos + frameLength - 2] || ck_b != rx[pos + frameLength - 1]) {
+            gpsStats.errors++;
+            pos++;
+            continue;
+        }
 
-            gpsStats.packetCount++;
+        gpsStats.packetCount++;
 
-            if (_skip_packet) {
-                break;
-            }
+        if (pos & 3) {
+            memmove(rx, &rx[pos], _rxLength - pos);
+            _rxLength -= pos;
+            pos = 0;
+        }
 
-            if (gpsParceFrameUBLOX()) {
-                parsed = true;
-            }
+        _class = rx[pos + 2];
+        _msg_id = rx[pos + 3];
+        _payload_length = payloadLength;
+        parsed = gpsParceFrameUBLOX((const ubx_rx_payload *)&rx[pos + UBX_HEADER_SIZE]);
+        pos += frameLength;
     }
 
+    if (pos > 0) {
+        memmove(rx, &rx[pos], _rxLength - pos);
+        _rxLength -= pos;
+    }
+
+    _rxPending = parsed;
     return parsed;
 }
 
@@ -978,16 +984,18 @@ STATIC_PROTOTHREAD(gpsProtocolReceiverThread)
     ptBegin(gpsProtocolReceiverThread);
 
     while (1) {
-        // Wait until there are bytes to consume
-        ptWait(serialRxBytesWaiting(gpsState.gpsPort));
-
-        // Consume bytes until buffer empty of until we have full message received
-        while (serialRxBytesWaiting(gpsState.gpsPort)) {
-            uint8_t newChar = serialRead(gpsState.gpsPort);
-            if (gpsNewFrameUBLOX(newChar)) {
-                ptSemaphoreSignal(semNewDataReady);
-                break;
-            }
+        // Wait until there are bytes to consume or frames left from the last pass
+        ptWait(serialRxBytesWaiting(gpsState.gpsPort) || _rxPending);
+
+        // Take everything received so far and decode it up to the next solution
+        _rxLength += serialReadBuf(gpsState.gpsPort, &_rxBuffer.bytes[UBX_FRAME_OFFSET + _rxLength],
+                                   sizeof(_rxBuffer.bytes) - UBX_FRAME_OFFSET - _rxLength);
+
+        if (gpsParseBufferUBLOX()) {
+            ptSemaphoreSignal(semNewDataReady);
+
+            // Let the state thread consume the solution before the next one is decoded
+            ptYield();
         }
     }
 
@@ -1060,6 +1068,8 @@ STATIC_PROTOTHREAD(gpsProtocolStateThread)
 
 void gpsRestartUBLOX(void)
 {
+    _rxLength = 0;
+    _rxPending = false;
     ptSemaphoreInit(semNewDataReady);
     ptRestart(ptGetHandle(gpsProtocolReceiverThread));
     ptRestart(ptGetHandle(gpsProtocolStateThread));
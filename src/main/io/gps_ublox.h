@@ -0,0 +1,25 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// UBX frame layout
+#define UBX_PREAMBLE1                       0xB5
+#define UBX_PREAMBLE2                       0x62
+#define UBX_HEADER_SIZE                     6       // sync chars, class, id and payload length
+#define UBX_CHECKSUM_SIZE                   2
+#define MAX_UBLOX_PAYLOAD_SIZE              256
@@ -184,6 +184,30 @@ static bool refreshWaitForResumeCmdRelease;
 
 static bool fullRedraw = false;
 
+// Elements are redrawn only when their inputs or their rendered output
+// change. Even unchanged elements are rewritten every
+// OSD_ELEMENT_CACHE_MAX_ROUNDS passes over the active list, so anything
+// overdrawn by the AHI or by overlapping elements gets repaired.
+#define OSD_ELEMENT_CACHE_MAX_ROUNDS 8
+
+typedef struct osdElementCache_s {
+    uint32_t inputKey;      // Hash of the declared inputs, see osdGetElementInputKey()
+    uint16_t outputKey;     // Hash of the text, attributes and position last written
+    uint8_t drawnRound;     // osdElementRound when the element was last drawn
+    bool valid;
+} osdElementCache_t;
+
+static osdElementCache_t osdElementCache[OSD_ITEM_COUNT];
+static uint8_t osdElementRound;
+static uint8_t osdElementCacheClearCount;
+static uint8_t osdCachedElement = OSD_ITEM_COUNT; // Element currently drawn from the active list
+
+// Visible and available elements of the current layout, in drawing order
+static uint8_t osdActiveElements[OSD_ITEM_COUNT];
+static uint8_t osdActiveElementCount;
+static bool osdActiveElementsDirty = true;
+STATIC_ASSERT(OSD_ITEM_COUNT <= UINT8_MAX, osd_item_count_must_fit_in_uint8);
+
 static uint8_t armState;
 
 typedef struct osdMapData_s {
@@ -1599,10 +1623,10 @@ static void osdDisplayAdjustableDecimalValue(uint8_t elemPosX, uint8_t elemPosY,
     displayWriteWithAttr(osdDisplayPort, elemPosX + strlen(str) + 1 + valueOffset, elemPosY, buff, elemAttr);
 }
 
-int8_t getGeoWaypointNumber(int8_t waypointIndex)
+int16_t getGeoWaypointNumber(int16_t waypointIndex)
 {
-    static int8_t lastWaypointIndex = 1;
-    static int8_t geoWaypointIndex;
+    static int16_t lastWaypointIndex = 1;
+    static int16_t geoWaypointIndex;
 
     if (waypointIndex != lastWaypointIndex) {
         lastWaypointIndex = geoWaypointIndex = waypointIndex;
@@ -1652,6 +1676,32 @@ void osdDisplaySwitchIndicator(const char *swName, int rcValue, char *buff) {
     buff[ptr] = '\0';
 }
 
+static uint16_t osdElementOutputKey(uint8_t x, uint8_t y, const char *buff, textAttributes_t attr)
+{
+    // FNV-1a, folded to 16 bits
+    uint32_t hash = 2166136261U;
+    hash = (hash ^ x) * 16777619U;
+    hash = (hash ^ y) * 16777619U;
+    hash = (hash ^ attr) * 16777619U;
+    while (*buff) {
+        hash = (hash ^ (uint8_t)*buff++) * 16777619U;
+    }
+    return (hash >> 16) ^ (hash & 0xFFFF);
+}
+
+static void osdWriteElement(uint8_t item, uint8_t x, uint8_t y, const char *buff, textAttributes_t attr)
+{
+    if (item == osdCachedElement) {
+        osdElementCache_t *cache = &osdElementCache[item];
+        const uint16_t outputKey = osdElementOutputKey(x, y, buff, attr);
+        if (cache->valid && cache->outputKey == outputKey) {
+            return;
+        }
+        cache->outputKey = outputKey;
+    }
+    displayWriteWithAttr(osdDisplayPort, x, y, buff, attr);
+}
+
 static bool osdDrawSingleElement(uint8_t item)
 {
     uint16_t pos = osdLayoutsConfig()->item_pos[currentLayout][item];
@@ -3463,7 +3513,121 @@ static bool osdDrawSingleElement(uint8_t item)
         return false;
     }
 
-    displayWriteWithAttr(osdDisplayPort, elemPosX, elemPosY, buff, elemAttr);
+    osdWriteElement(item, elemPosX, elemPosY, buff, elemAttr);
+    return true;
+}
+
+static uint32_t osdHashInput(uint32_t hash, int32_t value)
+{
+    return (hash ^ (uint32_t)value) * 16777619U;
+}
+
+/*
+ * Declares the data each element depends on, so it can be skipped
+ * without formatting it while its inputs don't change. Returns false
+ * for elements without declared dependencies, which are redrawn
+ * every time their turn comes. Settings that change the output
+ * (units, alarms...) are not part of the key: changing them through
+ * MSP, CMS or CLI triggers a full redraw.
+ */
+static bool osdGetElementInputKey(uint8_t item, uint32_t *key)
+{
+    uint32_t hash = 2166136261U;
+
+    switch (item) {
+    case OSD_RSSI_VALUE:
+        hash = osdHashInput(hash, osdConvertRSSI());
+        break;
+
+    case OSD_MAIN_BATT_VOLTAGE:
+    case OSD_SAG_COMPENSATED_MAIN_BATT_VOLTAGE:
+        hash = osdHashInput(hash, item == OSD_MAIN_BATT_VOLTAGE ? getBatteryRawVoltage() : getBatterySagCompensatedVoltage());
+        hash = osdHashInput(hash, calculateBatteryPercentage());
+        hash = osdHashInput(hash, getBatteryState());
+        hash = osdHashInput(hash, checkBatteryVoltageState());
+        break;
+
+    case OSD_BATTERY_REMAINING_PERCENT:
+        hash = osdHashInput(hash, calculateBatteryPercentage());
+        hash = osdHashInput(hash, getBatteryState());
+        break;
+
+    case OSD_CURRENT_DRAW:
+        hash = osdHashInput(hash, getAmperage());
+        break;
+
+    case OSD_POWER:
+        hash = osdHashInput(hash, getPower());
+        hash = osdHashInput(hash, getAmperage());
+        break;
+
+    case OSD_MAH_DRAWN:
+        hash = osdHashInput(hash, getMAhDrawn());
+        hash = osdHashInput(hash, getBatteryState());
+        break;
+
+#ifdef USE_GPS
+    case OSD_GPS_SATS:
+        hash = osdHashInput(hash, gpsSol.numSat);
+        hash = osdHashInput(hash, STATE(GPS_FIX));
+        hash = osdHashInput(hash, getHwGPSStatus());
+        break;
+
+    case OSD_GPS_SPEED:
+        hash = osdHashInput(hash, gpsSol.groundSpeed);
+        break;
+
+    case OSD_3D_SPEED:
+        hash = osdHashInput(hash, osdGet3DSpeed());
+        break;
+
+    case OSD_GPS_LAT:
+        hash = osdHashInput(hash, gpsSol.llh.lat);
+        break;
+
+    case OSD_GPS_LON:
+        hash = osdHashInput(hash, gpsSol.llh.lon);
+        break;
+
+    case OSD_HOME_DIST:
+        hash = osdHashInput(hash, GPS_distanceToHome);
+        break;
+
+    case OSD_TRIP_DIST:
+        hash = osdHashInput(hash, getTotalTravelDistance());
+        break;
+#endif
+
+    case OSD_ALTITUDE:
+        hash = osdHashInput(hash, osdGetAltitude());
+        break;
+
+    case OSD_ALTITUDE_MSL:
+        hash = osdHashInput(hash, osdGetAltitudeMsl());
+        break;
+
+    case OSD_HEADING:
+        hash = osdHashInput(hash, osdIsHeadingValid());
+        hash = osdHashInput(hash, osdGetHeading());
+        break;
+
+    case OSD_VARIO_NUM:
+        hash = osdHashInput(hash, (int16_t)getEstimatedActualVelocity(Z));
+        break;
+
+    case OSD_ATTITUDE_ROLL:
+        hash = osdHashInput(hash, attitude.values.roll);
+        break;
+
+    case OSD_ATTITUDE_PITCH:
+        hash = osdHashInput(hash, attitude.values.pitch);
+        break;
+
+    default:
+        return false;
+    }
+
+    *key = hash;
     return true;
 }
 
@@ -3574,14 +3738,94 @@ uint8_t osdIncElementIndex(uint8_t elementIndex)
     return elementIndex;
 }
 
-void osdDrawNextElement(void)
+static void osdInvalidateElementCache(void)
 {
-    static uint8_t elementIndex = 0;
-    // Flag for end of loop, also prevents infinite loop when no elements are enabled
-    uint8_t index = elementIndex;
+    for (unsigned ii = 0; ii < ARRAYLEN(osdElementCache); ii++) {
+        osdElementCache[ii].valid = false;
+    }
+    osdElementCacheClearCount = osdDisplayPort->clearCount;
+}
+
+static void osdUpdateActiveElements(void)
+{
+    // The feature and sensor checks in osdIncElementIndex() only change on
+    // layout, configuration or arming changes, so evaluate them once here
+    // instead of on every element step.
+    const uint16_t *itemPos = osdLayoutsConfig()->item_pos[currentLayout];
+    uint8_t item = 0;
+
+    osdActiveElementCount = 0;
     do {
-        elementIndex = osdIncElementIndex(elementIndex);
-    } while (!osdDrawSingleElement(elementIndex) && index != elementIndex);
+        if (OSD_VISIBLE(itemPos[item])) {
+            osdActiveElements[osdActiveElementCount++] = item;
+        }
+        item = osdIncElementIndex(item);
+    } while (item != 0);
+
+    osdActiveElementsDirty = false;
+}
+
+// Returns true if the element needs to be formatted and written again
+static bool osdElementNeedsRedraw(uint8_t item, uint32_t *inputKey)
+{
+    const osdElementCache_t *cache = &osdElementCache[item];
+    const bool hasInputKey = osdGetElementInputKey(item, inputKey);
+
+    if (!cache->valid || (uint8_t)(osdElementRound - cache->drawnRound) >= OSD_ELEMENT_CACHE_MAX_ROUNDS) {
+        return true;
+    }
+
+    return !hasInputKey || *inputKey != cache->inputKey;
+}
+
+void osdDrawNextElement(void)
+{
+    static uint8_t activeIndex = 0;
+
+    // Layout changes, arming and CMS exits all clear the screen
+    if (osdElementCacheClearCount != osdDisplayPort->clearCount) {
+        osdInvalidateElementCache();
+        osdActiveElementsDirty = true;
+    }
+
+    if (osdActiveElementsDirty) {
+        osdUpdateActiveElements();
+        activeIndex = 0;
+    }
+
+    // Draw the next element that changed. Unchanged elements are
+    // skipped without formatting them, so they don't use up the
+    // drawing slot of this iteration.
+    for (unsigned ii = 0; ii < osdActiveElementCount; ii++) {
+        const uint8_t item = osdActiveElements[activeIndex];
+        if (++activeIndex >= osdActiveElementCount) {
+            activeIndex = 0;
+            osdElementRound++;
+        }
+
+        uint32_t inputKey = 0;
+        if (!osdElementNeedsRedraw(item, &inputKey)) {
+            continue;
+        }
+
+        osdElementCache_t *cache = &osdElementCache[item];
+        if ((uint8_t)(osdElementRound - cache->drawnRound) >= OSD_ELEMENT_CACHE_MAX_ROUNDS) {
+            // Periodic refresh, rewrite even if the output didn't change
+            cache->valid = false;
+        }
+
+        osdCachedElement = item;
+        const bool drawn = osdDrawSingleElement(item);
+        osdCachedElement = OSD_ITEM_COUNT;
+
+        cache->inputKey = inputKey;
+        cache->drawnRound = osdElementRound;
+        cache->valid = true;
+
+        if (drawn) {
+            break;
+        }
+    }
 
     // Draw artificial horizon + tracking telemtry last
     osdDrawSingleElement(OSD_ARTIFICIAL_HORIZON);
@@ -4785,6 +5029,7 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
     if (buff != NULL) {
         const char *message = NULL;
         char messageBuf[MAX(SETTING_MAX_NAME_LENGTH, OSD_MESSAGE_LENGTH+1)];
+        char missionMessageBuf[OSD_MESSAGE_LENGTH+1];
         // We might have up to 5 messages to show.
         const char *messages[5];
         unsigned messageCount = 0;
@@ -4805,6 +5050,20 @@ textAttributes_t osdGetSystemMessage(char *buff, size_t buff_size, bool isCenter
                     osdFormatDistanceSymbol(buf, posControl.wpDistance, 0);
                     tfp_sprintf(messageBuf, "TO WP %u/%u (%s)", getGeoWaypointNumber(posControl.activeWaypointIndex), posControl.geoWaypointCount, buf);
                     messages[messageCount++] = messageBuf;
+
+                    // Distance and time left for the whole mission
+                    uint32_t missionDistance;
+                    if (getMissionRemainingDistance(&missionDistance)) {
+                        osdFormatDistanceSymbol(buf, missionDistance, 0);
+                        if (gpsSol.groundSpeed >= 100) {
+                            char etaBuf[8];
+                            osdFormatTime(etaBuf, missionDistance / gpsSol.groundSpeed, SYM_FLIGHT_MINS_REMAINING, SYM_FLIGHT_HOURS_REMAINING);
+                            tfp_sprintf(missionMessageBuf, "MISSION %s %s", buf, etaBuf);
+                        } else {
+                            tfp_sprintf(missionMessageBuf, "MISSION %s", buf);
+                        }
+                        messages[messageCount++] = missionMessageBuf;
+                    }
                 } else if (NAV_Status.state == MW_NAV_STATE_HOLD_TIMED) {
                     if (navConfig()->general.waypoint_enforce_altitude && !posControl.wpAltitudeReached) {
                         messages[messageCount++] = OSD_MESSAGE_STR(OSD_MSG_ADJUSTING_WP_ALT);
@@ -67,5 +67,8 @@ int main(void)
     while (true) {
         scheduler();
         processLoopback();
+#if defined(SITL_BUILD)
+        sitlClockIdle();
+#endif
     }
 }
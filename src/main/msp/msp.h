@@ -37,11 +37,22 @@ typedef enum {
     MSP_RESULT_NO_REPLY = 0
 } mspResult_e;
 
+// Multi-frame (bulk) replies: each frame carries at most MSP_BULK_FRAME_SIZE
+// bytes of payload and the handler leaves in the reply the request that
+// produces the next frame. Transports that don't support continuations just
+// send the first frame, the host can request the rest itself.
+// Sized so two frames with their header and checksum fit a 256 byte UART TX
+// buffer, the next frame is queued while the previous one is transmitted.
+#define MSP_BULK_FRAME_SIZE     112
+#define MSP_CONTINUATION_SIZE   4
+
 typedef struct mspPacket_s {
     sbuf_t buf;
     int16_t cmd;
     uint8_t flags;
     int16_t result;
+    uint8_t continuation[MSP_CONTINUATION_SIZE];    // request for the next frame of a bulk reply
+    uint8_t continuationSize;                       // 0 when the reply is complete
 } mspPacket_t;
 
 typedef enum {
@@ -33,3 +33,5 @@
 #define MSP2_COMMON_SET_RADAR_POS       0x100B //SET radar position information
 #define MSP2_COMMON_SET_RADAR_ITD       0x100C //SET radar information to display
 
+#define MSP2_COMMON_SETTINGS_BULK       0x100D  //in/out message    Returns the values of a range of settings, by index or PG, in several frames
+
@@ -89,3 +89,10 @@
 #define MSP2_INAV_LED_STRIP_CONFIG_EX           0x2048
 #define MSP2_INAV_SET_LED_STRIP_CONFIG_EX       0x2049
 
+#define MSP2_INAV_TASK_HISTOGRAM                0x204A
+#define MSP2_INAV_RX_LATENCY                    0x204B
+
+#define MSP2_INAV_WAYPOINTS_BULK                0x204C
+#define MSP2_INAV_LOGIC_CONDITIONS_BULK         0x204D
+#define MSP2_INAV_OSD_ITEMS_BULK                0x204E
+
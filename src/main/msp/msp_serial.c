@@ -37,6 +37,12 @@
 #include "msp/msp.h"
 #include "msp/msp_serial.h"
 
+// Pipelined requests answered and bulk reply frames sent per call, bounds the time spent on a port
+#define MSP_PORT_MAX_COMMANDS_PER_CALL      4
+#define MSP_PORT_MAX_BULK_FRAMES_PER_CALL   4
+// TX space needed before the next frame of a bulk reply is sent
+#define MSP_PORT_FRAME_TX_SPACE             (MSP_BULK_FRAME_SIZE + MSP_MAX_HEADER_SIZE + 2)
+
 static mspPort_t mspPorts[MAX_MSP_PORT_COUNT];
 
 
@@ -411,15 +417,38 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
     mspPostProcessFnPtr mspPostProcessFn = NULL;
     const mspResult_e status = mspProcessCommandFn(&command, &reply, &mspPostProcessFn);
 
+    msp->continuationPending = false;
     if (status != MSP_RESULT_NO_REPLY) {
         sbufSwitchToReader(&reply.buf, outBufHead); // change streambuf direction
-        mspSerialEncode(msp, &reply, msp->mspVersion);
+        if (mspSerialEncode(msp, &reply, msp->mspVersion) && reply.continuationSize) {
+            // Bulk reply continues, the next frame is requested by its continuation. Nothing
+            // else is parsed until the reply completes, so command, flags and version stay valid
+            memcpy(msp->inBuf, reply.continuation, reply.continuationSize);
+            msp->dataSize = reply.continuationSize;
+            msp->continuationPending = true;
+        }
     }
 
     msp->c_state = MSP_IDLE;
     return mspPostProcessFn;
 }
 
+static bool mspSerialTxHasSpace(serialPort_t *port)
+{
+    return isSerialTransmitBufferEmpty(port) || serialTxBytesFree(port) >= MSP_PORT_FRAME_TX_SPACE;
+}
+
+static void mspSerialProcessContinuation(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    for (int frames = 0; msp->continuationPending && frames < MSP_PORT_MAX_BULK_FRAMES_PER_CALL; frames++) {
+        if (!mspSerialTxHasSpace(msp->port)) {
+            break;
+        }
+        // Bulk handlers don't set a post process function
+        mspSerialProcessReceivedCommand(msp, mspProcessCommandFn);
+    }
+}
+
 static void mspEvaluateNonMspData(mspPort_t * mspPort, uint8_t receivedChar)
 {
     if (receivedChar == '#') {
@@ -462,32 +491,56 @@ void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e
 {
     mspPostProcessFnPtr mspPostProcessFn = NULL;
 
-    if (serialRxBytesWaiting(mspPort->port)) {
+    // A bulk reply in progress goes out before the next request is looked at,
+    // so replies keep the order of the requests
+    if (mspPort->continuationPending) {
+        mspSerialProcessContinuation(mspPort, mspProcessCommandFn);
+        if (mspPort->continuationPending) {
+            return;
+        }
+    }
+
+    const bool rxBytesWaiting = serialRxBytesWaiting(mspPort->port);
+    if (rxBytesWaiting) {
         // There are bytes incoming - abort pending request
         mspPort->lastActivityMs = millis();
         mspPort->pendingRequest = MSP_PENDING_NONE;
+    }
 
-        // Process incoming bytes
-        while (serialRxBytesWaiting(mspPort->port)) {
+    // Process incoming bytes. Hosts may pipeline requests, answer a few of them per call.
+    // A reply may be bigger than the free TX space and mspSerialSendFrame() would drop it,
+    // so a request is only answered once the TX buffer is empty. Until then it stays in
+    // the port and parsing stops, the next one is answered once the previous reply is out
+    int commandCount = 0;
+    while (!mspPostProcessFn && !mspPort->continuationPending && commandCount < MSP_PORT_MAX_COMMANDS_PER_CALL) {
+        if (mspPort->c_state == MSP_COMMAND_RECEIVED) {
+            if (!isSerialTransmitBufferEmpty(mspPort->port)) {
+                break;
+            }
+            mspPostProcessFn = mspSerialProcessReceivedCommand(mspPort, mspProcessCommandFn);
+            commandCount++;
+        }
+        else if (serialRxBytesWaiting(mspPort->port)) {
             const uint8_t c = serialRead(mspPort->port);
             const bool consumed = mspSerialProcessReceivedData(mspPort, c);
 
             if (!consumed && evaluateNonMspData == MSP_EVALUATE_NON_MSP_DATA) {
                 mspEvaluateNonMspData(mspPort, c);
             }
-
-            if (mspPort->c_state == MSP_COMMAND_RECEIVED) {
-                mspPostProcessFn = mspSerialProcessReceivedCommand(mspPort, mspProcessCommandFn);
-                break; // process one command at a time so as not to block.
-            }
         }
-
-        if (mspPostProcessFn) {
-            waitForSerialPortToFinishTransmitting(mspPort->port);
-            mspPostProcessFn(mspPort->port);
+        else {
+            break;
         }
     }
-    else {
+
+    mspSerialProcessContinuation(mspPort, mspProcessCommandFn);
+
+    if (mspPostProcessFn) {
+        waitForSerialPortToFinishTransmitting(mspPort->port);
+        mspPostProcessFn(mspPort->port);
+    }
+
+    if (!rxBytesWaiting) {
         mspProcessPendingRequest(mspPort);
     }
 }
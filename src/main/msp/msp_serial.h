@@ -96,6 +96,7 @@ typedef struct mspPort_s {
     uint16_t cmdMSP;
     uint8_t checksum1;
     uint8_t checksum2;
+    bool continuationPending;   // inBuf holds the request for the next frame of a bulk reply
 } mspPort_t;
 
 
@@ -54,6 +54,7 @@
 
 #include "navigation/navigation.h"
 #include "navigation/navigation_private.h"
+#include "navigation/navigation_mission_index.h"
 
 #include "rx/rx.h"
 
@@ -256,6 +257,8 @@ void resetGCSFlags(void);
 static void setupJumpCounters(void);
 static void resetJumpCounter(void);
 static void clearJumpCounters(void);
+static void buildMissionIndex(void);
+static void invalidateMissionIndex(void);
 
 static void calculateAndSetActiveWaypoint(const navWaypoint_t * waypoint);
 static void calculateAndSetActiveWaypointToLocalPosition(const fpVector3_t * pos);
@@ -1314,12 +1317,14 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_RTH_TRACKBACK(navigatio
     }
 
     if (posControl.flags.estPosStatus >= EST_USABLE) {
-        const int32_t distFromStartTrackback = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.rthTBLastSavedIndex]) / 100;
+        fpVector3_t trackbackStartPos;
+        rthTrackbackGetPoint(&posControl.rthTrackback, posControl.rthTrackback.count - 1, &trackbackStartPos);
+        const int32_t distFromStartTrackback = calculateDistanceToDestination(&trackbackStartPos) / 100;
         const bool cancelTrackback = distFromStartTrackback > navConfig()->general.rth_trackback_distance ||
                                      (rthAltControlStickOverrideCheck(ROLL) && !posControl.flags.forcedRTHActivated);
 
         if (posControl.activeRthTBPointIndex < 0 || cancelTrackback) {
-            posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = -1;
+            posControl.activeRthTBPointIndex = -1;
             posControl.flags.rthTrackbackActive = false;
             return NAV_FSM_EVENT_SWITCH_TO_NAV_STATE_RTH_INITIALIZE;    // procede to home after final trackback point
         }
@@ -1327,13 +1332,9 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_RTH_TRACKBACK(navigatio
         if (isWaypointReached(&posControl.activeWaypoint.pos, &posControl.activeWaypoint.bearing)) {
             posControl.activeRthTBPointIndex--;
 
-            if (posControl.rthTBWrapAroundCounter > -1 && posControl.activeRthTBPointIndex < 0) {
-                posControl.activeRthTBPointIndex = NAV_RTH_TRACKBACK_POINTS - 1;
-            }
-            calculateAndSetActiveWaypointToLocalPosition(rthGetTrackbackPos());
-
-            if (posControl.activeRthTBPointIndex - posControl.rthTBWrapAroundCounter == 0) {
-                posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = -1;
+            // Once past the oldest point the next update heads home
+            if (posControl.activeRthTBPointIndex >= 0) {
+                calculateAndSetActiveWaypointToLocalPosition(rthGetTrackbackPos());
             }
         } else {
             setDesiredPosition(rthGetTrackbackPos(), 0, NAV_POS_UPDATE_XY | NAV_POS_UPDATE_Z | NAV_POS_UPDATE_BEARING);
@@ -1528,6 +1529,8 @@ static navigationFSMEvent_t navOnEnteringState_NAV_STATE_WAYPOINT_INITIALIZE(nav
         wpHeadingControl.mode = NAV_WP_HEAD_MODE_NONE;
     }
 
+    buildMissionIndex();
+
     if (navConfig()->general.flags.waypoint_mission_restart == WP_MISSION_SWITCH) {
         posControl.wpMissionRestart = posControl.activeWaypointIndex > posControl.startWpIndex ? !posControl.wpMissionRestart : false;
     } else {
@@ -2641,7 +2644,9 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
  * == RTH Trackback ==
  * Saves track during flight which is used during RTH to back track
  * along arrival route rather than immediately heading directly toward home.
- * Max desired trackback distance set by user or limited by number of available points.
+ * Max desired trackback distance set by user. When the point store fills up the track
+ * is simplified, dropping the points that deviate least from it, so it always reaches
+ * back to where recording started.
  * Reverts to normal RTH heading direct to home when end of track reached.
  * Trackpoints logged with precedence for course/altitude changes. Distance based changes
  * only logged if no course/altitude changes logged over an extended distance.
@@ -2659,8 +2664,7 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
         return;
     }
 
-    // Record trackback points based on significant change in course/altitude until
-    // points limit reached. Overwrite older points from then on.
+    // Record trackback points based on significant change in course/altitude
     if (posControl.flags.estPosStatus >= EST_USABLE && posControl.flags.estAltStatus >= EST_USABLE) {
         static int32_t previousTBTripDist;      // cm
         static int16_t previousTBCourse;        // degrees
@@ -2668,6 +2672,16 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
         static uint8_t distanceCounter = 0;
         bool saveTrackpoint = forceSaveTrackPoint;
         bool GPSCourseIsValid = isGPSHeadingValid();
+        fpVector3_t lastTrackpoint;
+
+        if (posControl.activeRthTBPointIndex >= 0) {
+            // A trackback cancelled part way leaves the points it already flew back over
+            // after the active one, drop them so new points continue from the active one
+            if (posControl.activeRthTBPointIndex < posControl.rthTrackback.count - 1) {
+                rthTrackbackTruncate(&posControl.rthTrackback, posControl.activeRthTBPointIndex + 1);
+            }
+            rthTrackbackGetPoint(&posControl.rthTrackback, posControl.activeRthTBPointIndex, &lastTrackpoint);
+        }
 
         // start recording when some distance from home, 50m seems reasonable.
         if (posControl.activeRthTBPointIndex < 0) {
@@ -2689,11 +2703,11 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
                 } else if (distanceCounter >= 9) {
                     // Distance based trackpoint logged if at least 10 distance increments occur without altitude or course change
                     // and deviation from projected course path > 20m
-                    float distToPrevPoint = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.activeRthTBPointIndex]);
+                    float distToPrevPoint = calculateDistanceToDestination(&lastTrackpoint);
 
                     fpVector3_t virtualCoursePoint;
-                    virtualCoursePoint.x = posControl.rthTBPointsList[posControl.activeRthTBPointIndex].x + distToPrevPoint * cos_approx(DEGREES_TO_RADIANS(previousTBCourse));
-                    virtualCoursePoint.y = posControl.rthTBPointsList[posControl.activeRthTBPointIndex].y + distToPrevPoint * sin_approx(DEGREES_TO_RADIANS(previousTBCourse));
+                    virtualCoursePoint.x = lastTrackpoint.x + distToPrevPoint * cos_approx(DEGREES_TO_RADIANS(previousTBCourse));
+                    virtualCoursePoint.y = lastTrackpoint.y + distToPrevPoint * sin_approx(DEGREES_TO_RADIANS(previousTBCourse));
 
                     saveTrackpoint = calculateDistanceToDestination(&virtualCoursePoint) > METERS_TO_CENTIMETERS(20);
                 }
@@ -2701,7 +2715,7 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
                 previousTBTripDist = posControl.totalTripDistance;
             } else if (!GPSCourseIsValid) {
                 // if no reliable course revert to basic distance logging based on direct distance from last point - set to 20m
-                saveTrackpoint = calculateDistanceToDestination(&posControl.rthTBPointsList[posControl.activeRthTBPointIndex]) > METERS_TO_CENTIMETERS(20);
+                saveTrackpoint = calculateDistanceToDestination(&lastTrackpoint) > METERS_TO_CENTIMETERS(20);
                 previousTBTripDist = posControl.totalTripDistance;
             }
 
@@ -2711,19 +2725,14 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
             }
         }
 
-        // when trackpoint store full, overwrite from start of store using 'rthTBWrapAroundCounter' to track overwrite position
+        // the store simplifies the track when full, so the new point is always the last one
         if (saveTrackpoint) {
-            if (posControl.activeRthTBPointIndex == (NAV_RTH_TRACKBACK_POINTS - 1)) {   // wraparound to start
-                posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex = 0;
-            } else {
-                posControl.activeRthTBPointIndex++;
-                if (posControl.rthTBWrapAroundCounter > -1) {   // track wraparound overwrite position after store first filled
-                    posControl.rthTBWrapAroundCounter = posControl.activeRthTBPointIndex;
-                }
+            if (posControl.activeRthTBPointIndex < 0) {
+                rthTrackbackReset(&posControl.rthTrackback);
             }
-            posControl.rthTBPointsList[posControl.activeRthTBPointIndex] = posControl.actualState.abs.pos;
+            rthTrackbackAddPoint(&posControl.rthTrackback, &posControl.actualState.abs.pos);
+            posControl.activeRthTBPointIndex = posControl.rthTrackback.count - 1;
 
-            posControl.rthTBLastSavedIndex = posControl.activeRthTBPointIndex;
             previousTBAltitude = CENTIMETERS_TO_METERS(posControl.actualState.abs.pos.z);
             previousTBCourse = GPSCourseIsValid ? DECIDEGREES_TO_DEGREES(gpsSol.groundCourse) : previousTBCourse;
             distanceCounter = 0;
@@ -2733,12 +2742,16 @@ static bool rthAltControlStickOverrideCheck(unsigned axis)
 
 static fpVector3_t * rthGetTrackbackPos(void)
 {
+    static fpVector3_t trackbackPos;
+    fpVector3_t trackbackStartPos;
+
+    rthTrackbackGetPoint(&posControl.rthTrackback, posControl.activeRthTBPointIndex, &trackbackPos);
+    rthTrackbackGetPoint(&posControl.rthTrackback, posControl.rthTrackback.count - 1, &trackbackStartPos);
+
     // ensure trackback altitude never lower than altitude of start point
-    if (posControl.rthTBPointsList[posControl.activeRthTBPointIndex].z < posControl.rthTBPointsList[posControl.rthTBLastSavedIndex].z) {
-        posControl.rthTBPointsList[posControl.activeRthTBPointIndex].z = posControl.rthTBPointsList[posControl.rthTBLastSavedIndex].z;
-    }
+    trackbackPos.z = MAX(trackbackPos.z, trackbackStartPos.z);
 
-    return &posControl.rthTBPointsList[posControl.activeRthTBPointIndex];
+    return &trackbackPos;
 }
 
 /*-----------------------------------------------------------
@@ -2990,6 +3003,49 @@ static void clearJumpCounters(void)
     }
 }
 
+/*-----------------------------------------------------------
+ * Mission index
+ * Built when a mission is started. Holds the distance left along the
+ * mission from every waypoint, so the remaining mission distance is
+ * available without walking the waypoint list on each request.
+ *-----------------------------------------------------------*/
+static navMissionIndex_t missionIndex;
+
+static void mapMissionWaypointToLocalPosition(fpVector3_t * localPos, const navWaypoint_t * waypoint)
+{
+    mapWaypointToLocalPosition(localPos, waypoint, GEO_ALT_RELATIVE);
+}
+
+static void buildMissionIndex(void)
+{
+    if (!posControl.gpsOrigin.valid) {
+        invalidateMissionIndex();
+        return;
+    }
+
+    missionIndexBuild(&missionIndex, posControl.waypointList, posControl.startWpIndex,
+                      posControl.startWpIndex + posControl.waypointCount - 1,
+                      &posControl.rthState.homePosition.pos, mapMissionWaypointToLocalPosition);
+}
+
+static void invalidateMissionIndex(void)
+{
+    missionIndexInvalidate(&missionIndex);
+}
+
+/* Returns the distance left along the active mission in cm, including the
+ * remaining repetitions of its loops. Nested loops are only counted once.
+ * Returns false when no mission is being flown or it loops forever. */
+bool getMissionRemainingDistance(uint32_t *distance)
+{
+    if (!(navGetStateFlags(posControl.navState) & NAV_AUTO_WP)) {
+        return false;
+    }
+
+    return missionIndexGetRemainingDistance(&missionIndex, posControl.waypointList,
+                                            posControl.activeWaypointIndex, posControl.wpDistance, distance);
+}
+
 
 
 /*-----------------------------------------------------------
@@ -3152,12 +3208,13 @@ void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData)
     else if ((wpNumber >= 1) && (wpNumber <= NAV_MAX_WAYPOINTS) && !ARMING_FLAG(ARMED)) {
         if (wpData->action == NAV_WP_ACTION_WAYPOINT || wpData->action == NAV_WP_ACTION_JUMP || wpData->action == NAV_WP_ACTION_RTH || wpData->action == NAV_WP_ACTION_HOLD_TIME || wpData->action == NAV_WP_ACTION_LAND || wpData->action == NAV_WP_ACTION_SET_POI || wpData->action == NAV_WP_ACTION_SET_HEAD ) {
             // Only allow upload next waypoint (continue upload mission) or first waypoint (new mission)
-            static int8_t nonGeoWaypointCount = 0;
+            static int16_t nonGeoWaypointCount = 0;
 
             if (wpNumber == (posControl.waypointCount + 1) || wpNumber == 1) {
                 if (wpNumber == 1) {
                     resetWaypointList();
                 }
+                invalidateMissionIndex();
                 posControl.waypointList[wpNumber - 1] = *wpData;
                 if(wpData->action == NAV_WP_ACTION_SET_POI || wpData->action == NAV_WP_ACTION_SET_HEAD || wpData->action == NAV_WP_ACTION_JUMP) {
                     nonGeoWaypointCount += 1;
@@ -3179,6 +3236,7 @@ void setWaypoint(uint8_t wpNumber, const navWaypoint_t * wpData)
 
 void resetWaypointList(void)
 {
+    invalidateMissionIndex();
     posControl.waypointCount = 0;
     posControl.waypointListValid = false;
     posControl.geoWaypointCount = 0;
@@ -3217,6 +3275,7 @@ void selectMultiMissionIndex(int8_t increment)
 void loadSelectedMultiMission(uint8_t missionIndex)
 {
     uint8_t missionCount = 1;
+    invalidateMissionIndex();
     posControl.waypointCount = 0;
     posControl.geoWaypointCount = 0;
 
@@ -3278,7 +3337,7 @@ bool updateWpMissionChange(void)
     return false;   // block WP mode while changing mission when armed
 }
 
-bool checkMissionCount(int8_t waypoint)
+bool checkMissionCount(int16_t waypoint)
 {
     if (nonVolatileWaypointList(waypoint)->flag == NAV_WP_FLAG_LAST) {
         posControl.multiMissionCount += 1;  // count up no missions in multi mission WP file
@@ -3475,7 +3534,7 @@ bool isWaypointNavTrackingActive(void)
     // is set from current position not previous WP. Works for WP Restart intermediate WP as well as first mission WP.
     // (NAV_WP_MODE flag isn't set until WP initialisation is finished, i.e. after calculateAndSetActiveWaypoint called)
 
-    return FLIGHT_MODE(NAV_WP_MODE) || (posControl.flags.rthTrackbackActive && posControl.activeRthTBPointIndex != posControl.rthTBLastSavedIndex);
+    return FLIGHT_MODE(NAV_WP_MODE) || (posControl.flags.rthTrackbackActive && posControl.activeRthTBPointIndex != posControl.rthTrackback.count - 1);
 }
 
 /*-----------------------------------------------------------
@@ -3542,7 +3601,6 @@ void applyWaypointNavigationAndAltitudeHold(void)
         // Reset RTH trackback
         posControl.activeRthTBPointIndex = -1;
         posControl.flags.rthTrackbackActive = false;
-        posControl.rthTBWrapAroundCounter = -1;
 
         return;
     }
@@ -4222,7 +4280,7 @@ void navigationInit(void)
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE)
     /* configure WP missions at boot */
 #ifdef USE_MULTI_MISSION
-    for (int8_t i = 0; i < NAV_MAX_WAYPOINTS; i++) {    // check number missions in NVM
+    for (int i = 0; i < NAV_MAX_WAYPOINTS; i++) {    // check number missions in NVM
         if (checkMissionCount(i)) {
             break;
         }
@@ -184,6 +184,7 @@ typedef struct positionEstimationConfig_s {
     uint8_t allow_dead_reckoning;
 
     uint16_t max_surface_altitude;
+    uint16_t gps_delay_ms;      // Age of a GPS solution when it's received (ms)
 
     float w_z_baro_p;   // Weight (cutoff frequency) for barometer altitude measurements
 
@@ -576,6 +577,7 @@ geoAltitudeConversionMode_e waypointMissionAltConvMode(geoAltitudeDatumFlag_e da
 /* Distance/bearing calculation */
 bool navCalculatePathToDestination(navDestinationPath_t *result, const fpVector3_t * destinationPos);   // NOT USED
 uint32_t distanceToFirstWP(void);
+bool getMissionRemainingDistance(uint32_t *distance);
 
 /* Failsafe-forced RTH mode */
 void activateForcedRTH(void);
@@ -0,0 +1,148 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "navigation/navigation_mission_index.h"
+
+static bool isGeoWaypoint(const navWaypoint_t * waypoint)
+{
+    return !(waypoint->action == NAV_WP_ACTION_SET_POI ||
+             waypoint->action == NAV_WP_ACTION_SET_HEAD ||
+             waypoint->action == NAV_WP_ACTION_JUMP);
+}
+
+static uint32_t calculateDistanceBetweenWaypoints(const navWaypoint_t *waypoints, int16_t fromIndex, int16_t toIndex,
+                                                  const fpVector3_t *homePos, missionIndexWaypointPosFnPtr getWaypointPos)
+{
+    fpVector3_t fromPos;
+    fpVector3_t toPos;
+
+    // An RTH waypoint has no position of its own, it's flown to home
+    if (waypoints[fromIndex].action == NAV_WP_ACTION_RTH) {
+        fromPos = *homePos;
+    } else {
+        getWaypointPos(&fromPos, &waypoints[fromIndex]);
+    }
+    if (waypoints[toIndex].action == NAV_WP_ACTION_RTH) {
+        toPos = *homePos;
+    } else {
+        getWaypointPos(&toPos, &waypoints[toIndex]);
+    }
+
+    return calc_length_pythagorean_2D(toPos.x - fromPos.x, toPos.y - fromPos.y);
+}
+
+void missionIndexInvalidate(navMissionIndex_t *index)
+{
+    index->valid = false;
+    index->jumpCount = 0;
+}
+
+void missionIndexBuild(navMissionIndex_t *index, const navWaypoint_t *waypoints, int16_t firstWp, int16_t lastWp,
+                       const fpVector3_t *homePos, missionIndexWaypointPosFnPtr getWaypointPos)
+{
+    uint32_t distanceToEnd = 0;
+    int16_t nextGeoWp = -1;
+
+    missionIndexInvalidate(index);
+
+    // An RTH waypoint ends the mission, the ones after it are never flown
+    for (int16_t wp = firstWp; wp < lastWp; wp++) {
+        if (waypoints[wp].action == NAV_WP_ACTION_RTH) {
+            lastWp = wp;
+            break;
+        }
+    }
+    index->lastWp = lastWp;
+
+    // Accumulate the legs backwards from the last waypoint. Non geo
+    // waypoints get the distance of the next geo waypoint.
+    for (int16_t wp = lastWp; wp >= firstWp; wp--) {
+        if (isGeoWaypoint(&waypoints[wp])) {
+            if (nextGeoWp >= 0) {
+                distanceToEnd += calculateDistanceBetweenWaypoints(waypoints, wp, nextGeoWp, homePos, getWaypointPos);
+            }
+            nextGeoWp = wp;
+        }
+        index->distanceToEnd[wp] = distanceToEnd;
+    }
+
+    // A JUMP repeats the leg from the last geo waypoint before it back to the
+    // first geo waypoint at its target, plus everything in between.
+    int16_t lastGeoWp = -1;
+    for (int16_t wp = firstWp; wp <= lastWp; wp++) {
+        const navWaypoint_t *waypoint = &waypoints[wp];
+        if (isGeoWaypoint(waypoint)) {
+            lastGeoWp = wp;
+            continue;
+        }
+        if (waypoint->action != NAV_WP_ACTION_JUMP || lastGeoWp < 0) {
+            continue;
+        }
+        if (index->jumpCount == NAV_MISSION_INDEX_MAX_JUMPS) {
+            return;     // Too many loops to keep track of, leave the index invalid
+        }
+
+        int16_t loopStartWp = waypoint->p1 + firstWp;
+        while (loopStartWp < lastGeoWp && !isGeoWaypoint(&waypoints[loopStartWp])) {
+            loopStartWp++;
+        }
+
+        navMissionIndexJump_t *jump = &index->jumps[index->jumpCount++];
+        jump->wpIndex = wp;
+        jump->loopDistance = 0;
+        if (loopStartWp <= lastGeoWp) {
+            jump->loopDistance = calculateDistanceBetweenWaypoints(waypoints, lastGeoWp, loopStartWp, homePos, getWaypointPos) +
+                                 index->distanceToEnd[loopStartWp] - index->distanceToEnd[lastGeoWp];
+        }
+    }
+
+    index->valid = true;
+}
+
+/* Returns the distance left along the mission in cm, from the active waypoint
+ * activeWpDistance away, including the remaining repetitions of its loops.
+ * Nested loops are only counted once. Returns false when the index is not
+ * valid or the mission loops forever. */
+bool missionIndexGetRemainingDistance(const navMissionIndex_t *index, const navWaypoint_t *waypoints,
+                                      int16_t activeWp, uint32_t activeWpDistance, uint32_t *distance)
+{
+    if (!index->valid || activeWp > index->lastWp) {
+        return false;
+    }
+
+    uint32_t remaining = activeWpDistance + index->distanceToEnd[activeWp];
+
+    for (unsigned i = 0; i < index->jumpCount; i++) {
+        const navMissionIndexJump_t *jump = &index->jumps[i];
+        if (jump->wpIndex < activeWp) {
+            continue;
+        }
+        // p3 holds the repetitions left, -1 for a loop without end
+        const int16_t repetitionsLeft = waypoints[jump->wpIndex].p3;
+        if (repetitionsLeft < 0) {
+            return false;
+        }
+        remaining += repetitionsLeft * jump->loopDistance;
+    }
+
+    *distance = remaining;
+    return true;
+}
@@ -0,0 +1,52 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/vector.h"
+
+#include "navigation/navigation.h"
+
+#define NAV_MISSION_INDEX_MAX_JUMPS     8
+
+typedef struct navMissionIndexJump_s {
+    int16_t     wpIndex;            // Index of the JUMP waypoint
+    uint32_t    loopDistance;       // cm, flown once per repetition of the loop
+} navMissionIndexJump_t;
+
+// Distance left along the mission from every waypoint, so the remaining
+// mission distance is available without walking the waypoint list on
+// each request. An RTH waypoint ends the mission with the leg home.
+typedef struct navMissionIndex_s {
+    bool                    valid;
+    uint8_t                 jumpCount;
+    int16_t                 lastWp;                             // Last waypoint flown, the RTH one if the mission has one
+    uint32_t                distanceToEnd[NAV_MAX_WAYPOINTS];   // cm, from each waypoint to the end with jumps not taken
+    navMissionIndexJump_t   jumps[NAV_MISSION_INDEX_MAX_JUMPS];
+} navMissionIndex_t;
+
+// Local position of a geo waypoint
+typedef void (*missionIndexWaypointPosFnPtr)(fpVector3_t *pos, const navWaypoint_t *waypoint);
+
+void missionIndexInvalidate(navMissionIndex_t *index);
+void missionIndexBuild(navMissionIndex_t *index, const navWaypoint_t *waypoints, int16_t firstWp, int16_t lastWp,
+                       const fpVector3_t *homePos, missionIndexWaypointPosFnPtr getWaypointPos);
+bool missionIndexGetRemainingDistance(const navMissionIndex_t *index, const navWaypoint_t *waypoints,
+                                      int16_t activeWp, uint32_t activeWpDistance, uint32_t *distance);
@@ -55,7 +55,7 @@
 
 navigationPosEstimator_t posEstimator;
 
-PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 5);
+PG_REGISTER_WITH_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig, PG_POSITION_ESTIMATION_CONFIG, 6);
 
 PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         // Inertial position estimator parameters
@@ -68,6 +68,7 @@ PG_RESET_TEMPLATE(positionEstimationConfig_t, positionEstimationConfig,
         .allow_dead_reckoning = SETTING_INAV_ALLOW_DEAD_RECKONING_DEFAULT,
 
         .max_surface_altitude = SETTING_INAV_MAX_SURFACE_ALTITUDE_DEFAULT,
+        .gps_delay_ms = SETTING_INAV_GPS_DELAY_DEFAULT,
 
         .w_xyz_acc_p = SETTING_INAV_W_XYZ_ACC_P_DEFAULT,
 
@@ -527,6 +528,72 @@ static uint32_t calculateCurrentValidityFlags(timeUs_t currentTimeUs)
     return newFlags;
 }
 
+static void estimationHistoryReset(void)
+{
+    posEstimator.history.head = 0;
+    posEstimator.history.count = 0;
+}
+
+/* Record the estimate at a fixed rate, so corrections can be calculated against
+ * the estimate at the time a measurement was actually taken */
+static void estimationHistoryUpdate(timeUs_t currentTimeUs)
+{
+    navPositionEstimatorHistory_t * history = &posEstimator.history;
+
+    if (history->count > 0) {
+        const uint8_t newest = (history->head + INAV_HISTORY_SIZE - 1) % INAV_HISTORY_SIZE;
+        if (currentTimeUs - history->entries[newest].time < INAV_HISTORY_INTERVAL_US) {
+            return;
+        }
+    }
+
+    navPositionEstimatorHistoryEntry_t * entry = &history->entries[history->head];
+    entry->time = currentTimeUs;
+    entry->pos = posEstimator.est.pos;
+    entry->vel = posEstimator.est.vel;
+
+    history->head = (history->head + 1) % INAV_HISTORY_SIZE;
+    history->count = MIN(history->count + 1, INAV_HISTORY_SIZE);
+}
+
+/* Corrections shift the whole estimated trajectory, keep the recorded history on it.
+ * Otherwise a correction would be applied again until the measurement catches up */
+static void estimationHistoryApplyCorrection(const fpVector3_t * posCorr, const fpVector3_t * velCorr)
+{
+    for (unsigned i = 0; i < posEstimator.history.count; i++) {
+        navPositionEstimatorHistoryEntry_t * entry = &posEstimator.history.entries[i];
+        vectorAdd(&entry->pos, &entry->pos, posCorr);
+        vectorAdd(&entry->vel, &entry->vel, velCorr);
+    }
+}
+
+/* Estimated position and velocity at the time of a measurement. Starts from the newest recorded
+ * state not newer than the measurement (or the oldest one) and propagates it with its velocity */
+static void estimationGetDelayedState(timeUs_t measurementTimeUs, fpVector3_t * pos, fpVector3_t * vel)
+{
+    const navPositionEstimatorHistory_t * history = &posEstimator.history;
+    const navPositionEstimatorHistoryEntry_t * entry = NULL;
+
+    for (unsigned i = 1; i <= history->count; i++) {
+        entry = &history->entries[(history->head + INAV_HISTORY_SIZE - i) % INAV_HISTORY_SIZE];
+        if ((timeDelta_t)(measurementTimeUs - entry->time) >= 0) {
+            break;
+        }
+    }
+
+    if (entry == NULL || (timeDelta_t)(measurementTimeUs - posEstimator.est.lastUpdateTime) >= 0) {
+        *pos = posEstimator.est.pos;
+        *vel = posEstimator.est.vel;
+        return;
+    }
+
+    const float dt = US2S((timeDelta_t)(measurementTimeUs - entry->time));
+    pos->x = entry->pos.x + entry->vel.x * dt;
+    pos->y = entry->pos.y + entry->vel.y * dt;
+    pos->z = entry->pos.z + entry->vel.z * dt;
+    *vel = entry->vel;
+}
+
 static void estimationPredict(estimationContext_t * ctx)
 {
     const float accWeight = navGetAccelerometerWeight();
@@ -557,6 +624,11 @@ static void estimationPredict(estimationContext_t * ctx)
 static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
 {   
     bool correctionCalculated = false;
+    fpVector3_t gpsDelayedPos, gpsDelayedVel;
+
+    if (ctx->newFlags & EST_GPS_Z_VALID) {
+        estimationGetDelayedState(posEstimator.gps.lastUpdateTime - MS2US(positionEstimationConfig()->gps_delay_ms), &gpsDelayedPos, &gpsDelayedVel);
+    }
 
     if (ctx->newFlags & EST_BARO_VALID) {
         timeUs_t currentTimeUs = micros();
@@ -582,15 +654,17 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
                                             (((ctx->newFlags & EST_SURFACE_VALID) && posEstimator.surface.alt < 20.0f && posEstimator.state.isBaroGroundValid) ||
                                              ((ctx->newFlags & EST_BARO_VALID) && posEstimator.state.isBaroGroundValid && posEstimator.baro.alt < posEstimator.state.baroGroundAlt));
 
-        // Altitude
-        const float baroAltResidual = (isAirCushionEffectDetected ? posEstimator.state.baroGroundAlt : posEstimator.baro.alt) - posEstimator.est.pos.z;
+        // Altitude, compare averaged baro against the estimate from the time it represents
+        fpVector3_t baroDelayedPos, baroDelayedVel;
+        estimationGetDelayedState(posEstimator.baro.lastUpdateTime - INAV_BARO_AVERAGE_DELAY_US, &baroDelayedPos, &baroDelayedVel);
+        const float baroAltResidual = (isAirCushionEffectDetected ? posEstimator.state.baroGroundAlt : posEstimator.baro.alt) - baroDelayedPos.z;
         ctx->estPosCorr.z += baroAltResidual * positionEstimationConfig()->w_z_baro_p * ctx->dt;
         ctx->estVelCorr.z += baroAltResidual * sq(positionEstimationConfig()->w_z_baro_p) * ctx->dt;
 
         // If GPS is available - also use GPS climb rate
         if (ctx->newFlags & EST_GPS_Z_VALID) {
             // Trust GPS velocity only if residual/error is less than 2.5 m/s, scale weight according to gaussian distribution
-            const float gpsRocResidual = posEstimator.gps.vel.z - posEstimator.est.vel.z;
+            const float gpsRocResidual = posEstimator.gps.vel.z - gpsDelayedVel.z;
             const float gpsRocScaler = bellCurve(gpsRocResidual, 250.0f);
             ctx->estVelCorr.z += gpsRocResidual * positionEstimationConfig()->w_z_gps_v * gpsRocScaler * ctx->dt;
         }
@@ -617,11 +691,11 @@ static bool estimationCalculateCorrection_Z(estimationContext_t * ctx)
         }
         else {
             // Altitude
-            const float gpsAltResudual = posEstimator.gps.pos.z - posEstimator.est.pos.z;
+            const float gpsAltResudual = posEstimator.gps.pos.z - gpsDelayedPos.z;
 
             ctx->estPosCorr.z += gpsAltResudual * positionEstimationConfig()->w_z_gps_p * ctx->dt;
             ctx->estVelCorr.z += gpsAltResudual * sq(positionEstimationConfig()->w_z_gps_p) * ctx->dt;
-            ctx->estVelCorr.z += (posEstimator.gps.vel.z - posEstimator.est.vel.z) * positionEstimationConfig()->w_z_gps_v * ctx->dt;
+            ctx->estVelCorr.z += (posEstimator.gps.vel.z - gpsDelayedVel.z) * positionEstimationConfig()->w_z_gps_v * ctx->dt;
             ctx->newEPV = updateEPE(posEstimator.est.epv, ctx->dt, MAX(posEstimator.gps.epv, gpsAltResudual), positionEstimationConfig()->w_z_gps_p);
 
             // Accelerometer bias
@@ -656,10 +730,14 @@ static bool estimationCalculateCorrection_XY_GPS(estimationContext_t * ctx)
             ctx->newEPH = posEstimator.gps.eph;
         }
         else {
-            const float gpsPosXResidual = posEstimator.gps.pos.x - posEstimator.est.pos.x;
-            const float gpsPosYResidual = posEstimator.gps.pos.y - posEstimator.est.pos.y;
-            const float gpsVelXResidual = posEstimator.gps.vel.x - posEstimator.est.vel.x;
-            const float gpsVelYResidual = posEstimator.gps.vel.y - posEstimator.est.vel.y;
+            // GPS solution describes where we were when it was measured, compare it to the estimate from then
+            fpVector3_t estDelayedPos, estDelayedVel;
+            estimationGetDelayedState(posEstimator.gps.lastUpdateTime - MS2US(positionEstimationConfig()->gps_delay_ms), &estDelayedPos, &estDelayedVel);
+
+            const float gpsPosXResidual = posEstimator.gps.pos.x - estDelayedPos.x;
+            const float gpsPosYResidual = posEstimator.gps.pos.y - estDelayedPos.y;
+            const float gpsVelXResidual = posEstimator.gps.vel.x - estDelayedVel.x;
+            const float gpsVelYResidual = posEstimator.gps.vel.y - estDelayedVel.y;
             const float gpsPosResidualMag = calc_length_pythagorean_2D(gpsPosXResidual, gpsPosYResidual);
 
             //const float gpsWeightScaler = scaleRangef(bellCurve(gpsPosResidualMag, INAV_GPS_ACCEPTANCE_EPE), 0.0f, 1.0f, 0.1f, 1.0f);
@@ -725,6 +803,7 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
         posEstimator.est.eph = positionEstimationConfig()->max_eph_epv + 0.001f;
         posEstimator.est.epv = positionEstimationConfig()->max_eph_epv + 0.001f;
         posEstimator.flags = 0;
+        estimationHistoryReset();
         return;
     }
 
@@ -765,6 +844,8 @@ static void updateEstimatedTopic(timeUs_t currentTimeUs)
     // Apply corrections
     vectorAdd(&posEstimator.est.pos, &posEstimator.est.pos, &ctx.estPosCorr);
     vectorAdd(&posEstimator.est.vel, &posEstimator.est.vel, &ctx.estVelCorr);
+    estimationHistoryApplyCorrection(&ctx.estPosCorr, &ctx.estVelCorr);
+    estimationHistoryUpdate(currentTimeUs);
 
     /* Correct accelerometer bias */
     if (positionEstimationConfig()->w_acc_bias > 0.0f) {
@@ -895,6 +976,8 @@ void initializePositionEstimator(void)
         posEstimator.est.vel.v[axis] = 0;
     }
 
+    estimationHistoryReset();
+
     pt1FilterInit(&posEstimator.baro.avgFilter, INAV_BARO_AVERAGE_HZ, 0.0f);
     pt1FilterInit(&posEstimator.surface.avgFilter, INAV_SURFACE_AVERAGE_HZ, 0.0f);
 }
@@ -51,6 +51,11 @@
 // Time constants for calculating Baro/Sonar averages. Should be the same value to impose same amount of group delay
 #define INAV_BARO_AVERAGE_HZ                1.0f
 #define INAV_SURFACE_AVERAGE_HZ             1.0f
+#define INAV_BARO_AVERAGE_DELAY_US          ((timeUs_t)(1e6f / (2.0f * M_PIf * INAV_BARO_AVERAGE_HZ)))  // Group delay of the baro average
+
+// Estimate history, long enough to cover GPS delay plus the age of a 4Hz solution
+#define INAV_HISTORY_SIZE                   20
+#define INAV_HISTORY_INTERVAL_US            20000
 
 #define INAV_ACC_CLIPPING_RC_CONSTANT           (0.010f)    // Reduce acc weight for ~10ms after clipping
 
@@ -150,6 +155,18 @@ typedef enum {
     EST_Z_VALID                 = (1 << 6),
 } navPositionEstimationFlags_e;
 
+typedef struct {
+    timeUs_t    time;
+    fpVector3_t pos;
+    fpVector3_t vel;
+} navPositionEstimatorHistoryEntry_t;
+
+typedef struct {
+    navPositionEstimatorHistoryEntry_t entries[INAV_HISTORY_SIZE];
+    uint8_t     head;           // Next entry to be written
+    uint8_t     count;
+} navPositionEstimatorHistory_t;
+
 typedef struct {
     timeUs_t    baroGroundTimeout;
     float       baroGroundAlt;
@@ -172,6 +189,7 @@ typedef struct {
 
     // Estimate
     navPositionEstimatorESTIMATE_t  est;
+    navPositionEstimatorHistory_t   history;
 
     // Extra state variables
     navPositionEstimatorSTATE_t state;
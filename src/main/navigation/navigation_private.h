@@ -26,6 +26,7 @@
 #include "common/vector.h"
 #include "fc/runtime_config.h"
 #include "navigation/navigation.h"
+#include "navigation/navigation_rth_trackback.h"
 
 #define MIN_POSITION_UPDATE_RATE_HZ         5       // Minimum position update rate at which XYZ controllers would be applied
 #define NAV_THROTTLE_CUTOFF_FREQENCY_HZ     4       // low-pass filter on throttle output
@@ -45,8 +46,6 @@
 #define MC_LAND_DESCEND_THROTTLE            40      // RC pwm units (us)
 #define MC_LAND_SAFE_SURFACE                5.0f    // cm
 
-#define NAV_RTH_TRACKBACK_POINTS            50      // max number RTH trackback points
-
 #define MAX_POSITION_UPDATE_INTERVAL_US     HZ2US(MIN_POSITION_UPDATE_RATE_HZ)        // convenience macro
 _Static_assert(MAX_POSITION_UPDATE_INTERVAL_US <= TIMEDELTA_MAX, "deltaMicros can overflow!");
 
@@ -381,22 +380,22 @@ typedef struct {
     /* Waypoint list */
     navWaypoint_t               waypointList[NAV_MAX_WAYPOINTS];
     bool                        waypointListValid;
-    int8_t                      waypointCount;              // number of WPs in loaded mission
-    int8_t                      startWpIndex;               // index of first waypoint in mission
-    int8_t                      geoWaypointCount;           // total geospatial WPs in mission
+    int16_t                     waypointCount;              // number of WPs in loaded mission
+    int16_t                     startWpIndex;               // index of first waypoint in mission
+    int16_t                     geoWaypointCount;           // total geospatial WPs in mission
     bool                        wpMissionRestart;           // mission restart from first waypoint
 
     /* WP Mission planner */
     int8_t                      wpMissionPlannerStatus;     // WP save status for setting in flight WP mission planner
-    int8_t                      wpPlannerActiveWPIndex;
+    int16_t                     wpPlannerActiveWPIndex;
 #ifdef USE_MULTI_MISSION
     /* Multi Missions */
     int8_t                      multiMissionCount;          // number of missions in multi mission entry
     int8_t                      loadedMultiMissionIndex;    // index of selected multi mission
-    int8_t                      totalMultiMissionWpCount;   // total number of waypoints in all multi missions
+    int16_t                     totalMultiMissionWpCount;   // total number of waypoints in all multi missions
 #endif
     navWaypointPosition_t       activeWaypoint;             // Local position, current bearing and turn angle to next WP, filled on waypoint activation
-    int8_t                      activeWaypointIndex;
+    int16_t                     activeWaypointIndex;
     float                       wpInitialAltitude;          // Altitude at start of WP
     float                       wpInitialDistance;          // Distance when starting flight to WP
     float                       wpDistance;                 // Distance to active WP
@@ -404,10 +403,8 @@ typedef struct {
     bool                        wpAltitudeReached;          // WP altitude achieved
 
     /* RTH Trackback */
-    fpVector3_t                 rthTBPointsList[NAV_RTH_TRACKBACK_POINTS];
-    int8_t                      rthTBLastSavedIndex;        // last trackback point index saved
-    int8_t                      activeRthTBPointIndex;
-    int8_t                      rthTBWrapAroundCounter;     // stores trackpoint array overwrite index position
+    rthTrackback_t              rthTrackback;               // recorded track, oldest point first
+    int16_t                     activeRthTBPointIndex;      // -1 if no track recorded
 
     /* Internals & statistics */
     int16_t                     rcAdjustment[4];
@@ -0,0 +1,134 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "navigation/navigation_rth_trackback.h"
+
+static int16_t rthTrackbackQuantize(float value, float resolution)
+{
+    return (int16_t)roundf(constrainf(value / resolution, INT16_MIN, INT16_MAX));
+}
+
+void rthTrackbackReset(rthTrackback_t *tb)
+{
+    tb->count = 0;
+    tb->tolerance = 0;
+}
+
+// Keeps only the oldest count points, e.g. to drop the points already
+// flown back over by a trackback that was cancelled before reaching the
+// start of the track, so recording resumes from where the aircraft is.
+void rthTrackbackTruncate(rthTrackback_t *tb, unsigned count)
+{
+    if (count < tb->count) {
+        tb->count = count;
+    }
+}
+
+void rthTrackbackGetPoint(const rthTrackback_t *tb, unsigned index, fpVector3_t *pos)
+{
+    const rthTrackbackPoint_t *point = &tb->points[index];
+
+    pos->x = point->x * RTH_TRACKBACK_XY_RESOLUTION;
+    pos->y = point->y * RTH_TRACKBACK_XY_RESOLUTION;
+    pos->z = point->z * RTH_TRACKBACK_Z_RESOLUTION;
+}
+
+// Distance from a point to the segment joining its neighbours, i.e. the
+// error introduced by dropping it from the track
+static float rthTrackbackPointDeviation(const rthTrackback_t *tb, unsigned index)
+{
+    fpVector3_t prev, point, next;
+
+    rthTrackbackGetPoint(tb, index - 1, &prev);
+    rthTrackbackGetPoint(tb, index, &point);
+    rthTrackbackGetPoint(tb, index + 1, &next);
+
+    const float segX = next.x - prev.x;
+    const float segY = next.y - prev.y;
+    const float segZ = next.z - prev.z;
+    const float relX = point.x - prev.x;
+    const float relY = point.y - prev.y;
+    const float relZ = point.z - prev.z;
+
+    const float segLengthSq = sq(segX) + sq(segY) + sq(segZ);
+    float t = 0;
+    if (segLengthSq > 0) {
+        t = constrainf((relX * segX + relY * segY + relZ * segZ) / segLengthSq, 0.0f, 1.0f);
+    }
+
+    return calc_length_pythagorean_3D(relX - t * segX, relY - t * segY, relZ - t * segZ);
+}
+
+// Drops the least significant points until the store is down to its
+// compaction target and every remaining point deviates at least
+// RTH_TRACKBACK_MIN_DEVIATION from the path through its neighbours.
+// The first and last points are always kept.
+static void rthTrackbackCompact(rthTrackback_t *tb)
+{
+    float deviation[RTH_TRACKBACK_POINTS];
+
+    for (unsigned ii = 1; ii + 1 < tb->count; ii++) {
+        deviation[ii] = rthTrackbackPointDeviation(tb, ii);
+    }
+
+    while (tb->count > 2) {
+        unsigned minIndex = 1;
+        for (unsigned ii = 2; ii + 1 < tb->count; ii++) {
+            if (deviation[ii] < deviation[minIndex]) {
+                minIndex = ii;
+            }
+        }
+
+        if (tb->count <= RTH_TRACKBACK_COMPACT_TARGET && deviation[minIndex] >= RTH_TRACKBACK_MIN_DEVIATION) {
+            break;
+        }
+
+        tb->tolerance = MAX(tb->tolerance, deviation[minIndex]);
+
+        const unsigned tail = tb->count - minIndex - 1;
+        memmove(&tb->points[minIndex], &tb->points[minIndex + 1], tail * sizeof(tb->points[0]));
+        memmove(&deviation[minIndex], &deviation[minIndex + 1], tail * sizeof(deviation[0]));
+        tb->count--;
+
+        // Only the neighbours of the dropped point are affected
+        if (minIndex > 1) {
+            deviation[minIndex - 1] = rthTrackbackPointDeviation(tb, minIndex - 1);
+        }
+        if (minIndex + 1 < tb->count) {
+            deviation[minIndex] = rthTrackbackPointDeviation(tb, minIndex);
+        }
+    }
+}
+
+void rthTrackbackAddPoint(rthTrackback_t *tb, const fpVector3_t *pos)
+{
+    if (tb->count == RTH_TRACKBACK_POINTS) {
+        rthTrackbackCompact(tb);
+    }
+
+    rthTrackbackPoint_t *point = &tb->points[tb->count++];
+    point->x = rthTrackbackQuantize(pos->x, RTH_TRACKBACK_XY_RESOLUTION);
+    point->y = rthTrackbackQuantize(pos->y, RTH_TRACKBACK_XY_RESOLUTION);
+    point->z = rthTrackbackQuantize(pos->z, RTH_TRACKBACK_Z_RESOLUTION);
+}
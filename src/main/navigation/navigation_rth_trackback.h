@@ -0,0 +1,52 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/vector.h"
+
+#define RTH_TRACKBACK_POINTS                100     // max number of stored trackback points
+#define RTH_TRACKBACK_XY_RESOLUTION         200.0f  // cm per unit of the stored horizontal position, +/-65km range
+#define RTH_TRACKBACK_Z_RESOLUTION          10.0f   // cm per unit of the stored altitude, +/-3276m range
+#define RTH_TRACKBACK_COMPACT_TARGET        (RTH_TRACKBACK_POINTS * 3 / 4)  // points kept after compacting a full store
+#define RTH_TRACKBACK_MIN_DEVIATION         500.0f  // cm, points closer than this to the simplified path are always dropped
+
+// Trackback point in local coordinates, quantized to halve the RAM
+// used by a full fpVector3_t
+typedef struct rthTrackbackPoint_s {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+} rthTrackbackPoint_t;
+
+// Flown path, oldest point first. When the store fills up, the points
+// which deviate least from the path through their neighbours are dropped,
+// so the track always reaches back to where recording started with its
+// resolution degrading gracefully instead of losing the oldest points.
+typedef struct rthTrackback_s {
+    rthTrackbackPoint_t points[RTH_TRACKBACK_POINTS];
+    uint8_t             count;
+    float               tolerance;      // cm, largest deviation of a dropped point from the simplified path
+} rthTrackback_t;
+
+void rthTrackbackReset(rthTrackback_t *tb);
+void rthTrackbackAddPoint(rthTrackback_t *tb, const fpVector3_t *pos);
+void rthTrackbackTruncate(rthTrackback_t *tb, unsigned count);
+void rthTrackbackGetPoint(const rthTrackback_t *tb, unsigned index, fpVector3_t *pos);
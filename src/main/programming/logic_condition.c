@@ -85,6 +85,46 @@ void pgResetFn_logicConditions(logicCondition_t *instance)
 
 logicConditionState_t logicConditionStates[MAX_LOGIC_CONDITIONS];
 
+/*
+ * Logic conditions are compiled by logicConditionCompile() into a program
+ * that contains only the enabled conditions, ordered so that activators and
+ * LC operands are evaluated before the conditions that use them. Operands
+ * are resolved at compile time: constants become immediates, LC operands
+ * read the state directly and sensor-like operands used by more than one
+ * condition are fetched only once per update.
+ */
+typedef enum {
+    LOGIC_COMPILED_OPERAND_IMMEDIATE = 0,
+    LOGIC_COMPILED_OPERAND_LC,
+    LOGIC_COMPILED_OPERAND_CACHED,
+    LOGIC_COMPILED_OPERAND_FETCH,
+} logicCompiledOperandKind_e;
+
+typedef struct logicCompiledOperand_s {
+    int32_t value;              // Immediate value, LC index or operand for fetched operands
+    uint8_t kind;               // logicCompiledOperandKind_e
+    uint8_t type;               // logicOperandType_e, for cached and fetched operands
+    uint8_t slot;               // Cache slot, for cached operands
+} logicCompiledOperand_t;
+
+typedef struct logicConditionInstruction_s {
+    logicCompiledOperand_t operandA;
+    logicCompiledOperand_t operandB;
+    uint8_t index;
+    int8_t activatorId;         // -1 when the condition has no activator
+    uint8_t operation;
+    uint8_t flags;
+} logicConditionInstruction_t;
+
+#define LOGIC_CONDITION_OPERAND_CACHE_SIZE MAX_LOGIC_CONDITIONS
+
+static EXTENDED_FASTRAM logicConditionInstruction_t logicConditionProgram[MAX_LOGIC_CONDITIONS];
+static EXTENDED_FASTRAM uint8_t logicConditionProgramLength;
+static EXTENDED_FASTRAM bool logicConditionProgramValid;
+
+static EXTENDED_FASTRAM int32_t operandCacheValues[LOGIC_CONDITION_OPERAND_CACHE_SIZE];
+static EXTENDED_FASTRAM uint64_t operandCacheValidMask;
+
 static int logicConditionCompute(
     int32_t currentValue,
     logicOperation_e operation,
@@ -479,38 +519,67 @@ static int logicConditionCompute(
     }
 }
 
-void logicConditionProcess(uint8_t i) {
+static int logicConditionGetCompiledOperandValue(const logicCompiledOperand_t *operand)
+{
+    switch (operand->kind) {
+        case LOGIC_COMPILED_OPERAND_IMMEDIATE:
+            return operand->value;
 
-    const int activatorValue = logicConditionGetValue(logicConditions(i)->activatorId);
+        case LOGIC_COMPILED_OPERAND_LC:
+            return logicConditionStates[operand->value].value;
+
+        case LOGIC_COMPILED_OPERAND_CACHED:
+            {
+                const uint64_t slotMask = (uint64_t)1 << operand->slot;
+                if (!(operandCacheValidMask & slotMask)) {
+                    operandCacheValues[operand->slot] = logicConditionGetOperandValue(operand->type, operand->value);
+                    operandCacheValidMask |= slotMask;
+                }
+                return operandCacheValues[operand->slot];
+            }
+
+        default:
+            return logicConditionGetOperandValue(operand->type, operand->value);
+    }
+}
+
+static void logicConditionExecute(const logicConditionInstruction_t *instruction)
+{
+    const uint8_t i = instruction->index;
+
+    /*
+     * Activator is evaluated before this condition unless they form a cycle.
+     * When it's false the operands are not fetched at all, and the conditions
+     * activated by this one will see it as false too
+     */
+    if (!logicConditionGetValue(instruction->activatorId)) {
+        logicConditionStates[i].value = false;
+        return;
+    }
+
+    /*
+     * Process condition only when latch flag is not set
+     * Latched LCs can only go from OFF to ON, not the other way
+     */
+    if (!(logicConditionStates[i].flags & LOGIC_CONDITION_FLAG_LATCH)) {
+        const int operandAValue = logicConditionGetCompiledOperandValue(&instruction->operandA);
+        const int operandBValue = logicConditionGetCompiledOperandValue(&instruction->operandB);
+        const int newValue = logicConditionCompute(
+            logicConditionStates[i].value,
+            instruction->operation,
+            operandAValue,
+            operandBValue,
+            i
+        );
+
+        logicConditionStates[i].value = newValue;
 
-    if (logicConditions(i)->enabled && activatorValue && !cliMode) {
-        
         /*
-         * Process condition only when latch flag is not set
-         * Latched LCs can only go from OFF to ON, not the other way
+         * if value evaluates as true, put a latch on logic condition
          */
-        if (!(logicConditionStates[i].flags & LOGIC_CONDITION_FLAG_LATCH)) {
-            const int operandAValue = logicConditionGetOperandValue(logicConditions(i)->operandA.type, logicConditions(i)->operandA.value);
-            const int operandBValue = logicConditionGetOperandValue(logicConditions(i)->operandB.type, logicConditions(i)->operandB.value);
-            const int newValue = logicConditionCompute(
-                logicConditionStates[i].value, 
-                logicConditions(i)->operation, 
-                operandAValue, 
-                operandBValue,
-                i
-            );
-        
-            logicConditionStates[i].value = newValue;
-
-            /*
-             * if value evaluates as true, put a latch on logic condition
-             */
-            if (logicConditions(i)->flags & LOGIC_CONDITION_FLAG_LATCH && newValue) {
-                logicConditionStates[i].flags |= LOGIC_CONDITION_FLAG_LATCH;
-            }
+        if (instruction->flags & LOGIC_CONDITION_FLAG_LATCH && newValue) {
+            logicConditionStates[i].flags |= LOGIC_CONDITION_FLAG_LATCH;
         }
-    } else {
-        logicConditionStates[i].value = false;
     }
 }
 
@@ -930,6 +999,169 @@ int logicConditionGetValue(int8_t conditionId) {
     }
 }
 
+static bool logicConditionIsCompiled(int id)
+{
+    return id >= 0 && id < MAX_LOGIC_CONDITIONS && logicConditions(id)->enabled && logicConditions(id)->activatorId < MAX_LOGIC_CONDITIONS;
+}
+
+static bool logicOperandIsCacheable(const logicOperand_t *operand)
+{
+    switch (operand->type) {
+        case LOGIC_CONDITION_OPERAND_TYPE_FLIGHT_MODE:
+        case LOGIC_CONDITION_OPERAND_TYPE_WAYPOINTS:
+            return true;
+
+        case LOGIC_CONDITION_OPERAND_TYPE_FLIGHT:
+            // These can be changed by the conditions themselves during the update
+            return operand->value != LOGIC_CONDITION_OPERAND_FLIGHT_LOITER_RADIUS &&
+                operand->value != LOGIC_CONDITION_OPERAND_FLIGHT_ACTIVE_PROFILE;
+
+        default:
+            // RC channels, GVARs and LCs can be overridden or written by conditions, PIDs are cheap to read
+            return false;
+    }
+}
+
+static int logicOperandUseCount(const logicOperand_t *operand)
+{
+    int count = 0;
+
+    for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+        if (!logicConditionIsCompiled(i)) {
+            continue;
+        }
+        const logicOperand_t *a = &logicConditions(i)->operandA;
+        const logicOperand_t *b = &logicConditions(i)->operandB;
+        count += (a->type == operand->type && a->value == operand->value);
+        count += (b->type == operand->type && b->value == operand->value);
+    }
+
+    return count;
+}
+
+static void logicConditionCompileOperand(logicCompiledOperand_t *compiled, const logicOperand_t *operand, uint8_t *cacheSlots)
+{
+    compiled->value = operand->value;
+    compiled->type = operand->type;
+    compiled->slot = 0;
+
+    if (operand->type == LOGIC_CONDITION_OPERAND_TYPE_VALUE) {
+        compiled->kind = LOGIC_COMPILED_OPERAND_IMMEDIATE;
+    } else if (operand->type == LOGIC_CONDITION_OPERAND_TYPE_LC) {
+        if (operand->value >= 0 && operand->value < MAX_LOGIC_CONDITIONS) {
+            compiled->kind = LOGIC_COMPILED_OPERAND_LC;
+        } else {
+            compiled->kind = LOGIC_COMPILED_OPERAND_IMMEDIATE;
+            compiled->value = 0;
+        }
+    } else if (logicOperandIsCacheable(operand) && logicOperandUseCount(operand) > 1) {
+        // Reuse the slot of an already compiled operand with the same source, including operand A of this condition
+        for (int i = 0; i <= logicConditionProgramLength; i++) {
+            const logicCompiledOperand_t *other[] = { &logicConditionProgram[i].operandA, &logicConditionProgram[i].operandB };
+            for (unsigned j = 0; j < ARRAYLEN(other); j++) {
+                if (other[j] != compiled && other[j]->kind == LOGIC_COMPILED_OPERAND_CACHED &&
+                    other[j]->type == operand->type && other[j]->value == operand->value) {
+                    compiled->kind = LOGIC_COMPILED_OPERAND_CACHED;
+                    compiled->slot = other[j]->slot;
+                    return;
+                }
+            }
+        }
+        // Every cached source is used at least twice, so slots can't run out
+        compiled->kind = LOGIC_COMPILED_OPERAND_CACHED;
+        compiled->slot = (*cacheSlots)++;
+    } else {
+        compiled->kind = LOGIC_COMPILED_OPERAND_FETCH;
+    }
+}
+
+/*
+ * Builds the program executed by logicConditionUpdateTask() from the logic
+ * conditions config
+ */
+static void logicConditionCompile(void)
+{
+    bool emitted[MAX_LOGIC_CONDITIONS] = { false };
+    uint8_t cacheSlots = 0;
+
+    logicConditionProgramLength = 0;
+
+    for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+        if (!logicConditionIsCompiled(i)) {
+            // Not executed anymore, make sure it doesn't keep its last value
+            logicConditionStates[i].value = false;
+            emitted[i] = true;
+        }
+    }
+
+    while (true) {
+        /*
+         * Emit the lowest numbered condition whose activator and LC operands
+         * have been emitted already, so conditions that only reference lower
+         * numbers keep their order. If there's none, the remaining conditions
+         * form a cycle and the lowest numbered one goes first.
+         */
+        int next = -1;
+        int firstRemaining = -1;
+        for (int i = 0; i < MAX_LOGIC_CONDITIONS && next < 0; i++) {
+            if (emitted[i]) {
+                continue;
+            }
+            if (firstRemaining < 0) {
+                firstRemaining = i;
+            }
+
+            const logicCondition_t *lc = logicConditions(i);
+            const int deps[] = {
+                lc->activatorId,
+                lc->operandA.type == LOGIC_CONDITION_OPERAND_TYPE_LC ? lc->operandA.value : -1,
+                lc->operandB.type == LOGIC_CONDITION_OPERAND_TYPE_LC ? lc->operandB.value : -1,
+            };
+            bool ready = true;
+            for (unsigned d = 0; d < ARRAYLEN(deps); d++) {
+                if (deps[d] >= 0 && deps[d] < MAX_LOGIC_CONDITIONS && deps[d] != i && !emitted[deps[d]]) {
+                    ready = false;
+                }
+            }
+            if (ready) {
+                next = i;
+            }
+        }
+
+        if (next < 0) {
+            next = firstRemaining;
+        }
+        if (next < 0) {
+            break;
+        }
+
+        const logicCondition_t *lc = logicConditions(next);
+        logicConditionInstruction_t *instruction = &logicConditionProgram[logicConditionProgramLength];
+        instruction->index = next;
+        instruction->activatorId = lc->activatorId < 0 ? -1 : lc->activatorId;
+        instruction->operation = lc->operation;
+        instruction->flags = lc->flags;
+        // Operand B is still the one from the previous program, don't let operand A match it
+        instruction->operandB.kind = LOGIC_COMPILED_OPERAND_FETCH;
+        logicConditionCompileOperand(&instruction->operandA, &lc->operandA, &cacheSlots);
+        logicConditionCompileOperand(&instruction->operandB, &lc->operandB, &cacheSlots);
+
+        logicConditionProgramLength++;
+        emitted[next] = true;
+    }
+
+    logicConditionProgramValid = true;
+}
+
+/*
+ * Must be called whenever logicConditions are changed, the program is
+ * rebuilt on the next update
+ */
+void logicConditionInvalidate(void)
+{
+    logicConditionProgramValid = false;
+}
+
 void logicConditionUpdateTask(timeUs_t currentTimeUs) {
     UNUSED(currentTimeUs);
 
@@ -945,8 +1177,20 @@ void logicConditionUpdateTask(timeUs_t currentTimeUs) {
         flightAxisOverride[i].angleTargetActive = false;
     }
 
-    for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
-        logicConditionProcess(i);
+    if (!logicConditionProgramValid) {
+        logicConditionCompile();
+    }
+
+    if (cliMode) {
+        for (uint8_t i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+            logicConditionStates[i].value = false;
+        }
+    } else {
+        operandCacheValidMask = 0;
+
+        for (uint8_t i = 0; i < logicConditionProgramLength; i++) {
+            logicConditionExecute(&logicConditionProgram[i]);
+        }
     }
 
 #ifdef USE_I2C_IO_EXPANDER
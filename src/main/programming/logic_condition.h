@@ -234,12 +234,11 @@ extern uint64_t logicConditionsGlobalFlags;
 #define LOGIC_CONDITION_GLOBAL_FLAG_ENABLE(mask) (logicConditionsGlobalFlags |= (mask))
 #define LOGIC_CONDITION_GLOBAL_FLAG(mask) (logicConditionsGlobalFlags & (mask))
 
-void logicConditionProcess(uint8_t i);
-
 int logicConditionGetOperandValue(logicOperandType_e type, int operand);
 
 int logicConditionGetValue(int8_t conditionId);
 void logicConditionUpdateTask(timeUs_t currentTimeUs);
+void logicConditionInvalidate(void);
 void logicConditionReset(void);
 
 float getThrottleScale(float globalThrottleScale);
@@ -65,6 +65,8 @@
 #include "rx/mavlink.h"
 #include "rx/sim.h"
 
+#include "scheduler/scheduler.h"
+
 const char rcChannelLetters[] = "AERT";
 
 static uint16_t rssi = 0;                  // range: [0;1023]
@@ -89,6 +91,13 @@ static bool rxFlightChannelsValid = false;
 static uint8_t rxChannelCount;
 
 static timeUs_t rxNextUpdateAtUs = 0;
+static volatile timeUs_t rxSignaledFrameTimeUs = 0;
+static volatile bool rxFrameSignaled = false;
+static timeUs_t rxFrameTimeUs = 0;              // completion time of the last frame reported complete
+static bool rxFrameNew = false;                 // frame not yet consumed by calculateRxChannelsAndUpdateFailsafe()
+static timeUs_t rxProcessedFrameTimeUs = 0;
+static bool rxSetpointLatencyPending = false;
+static rxLatencyStats_t rxLatencyStats;
 static timeUs_t needRxSignalBefore = 0;
 static bool isRxSuspended = false;
 
@@ -412,6 +421,14 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
         rxSignalReceived = (frameStatus & RX_FRAME_FAILSAFE) == 0;
         needRxSignalBefore = currentTimeUs + rxRuntimeConfig.rxSignalTimeout;
         rxDataProcessingRequired = true;
+
+        // Drivers which don't timestamp their frames are accounted from the time they are polled
+        rxFrameTimeUs = currentTimeUs;
+        if (rxFrameSignaled) {
+            rxFrameTimeUs = rxSignaledFrameTimeUs;
+            rxFrameSignaled = false;
+        }
+        rxFrameNew = true;
     }
     else if ((frameStatus & RX_FRAME_FAILSAFE) && rxSignalReceived) {
         // All other receiver statuses are allowed to report failsafe, but not allowed to leave it
@@ -438,6 +455,77 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     return result;
 }
 
+/*
+ * Called by receiver drivers from their ISR once a complete RC frame is
+ * waiting to be decoded, so RX processing doesn't wait for the next poll
+ */
+void rxSignalFrameReceived(timeUs_t frameTimeUs)
+{
+    rxSignaledFrameTimeUs = frameTimeUs;
+    rxFrameSignaled = true;
+    schedulerSignalTask(TASK_RX, frameTimeUs);
+}
+
+static void rxLatencyAdd(rxLatency_t *latency, timeUs_t latencyUs)
+{
+    if (latency->count == 0) {
+        latency->min = latencyUs;
+        latency->max = latencyUs;
+        latency->movingSum = latencyUs * RX_LATENCY_MOVING_SUM_COUNT;
+    } else {
+        latency->min = MIN(latency->min, latencyUs);
+        latency->max = MAX(latency->max, latencyUs);
+        latency->movingSum += latencyUs - latency->movingSum / RX_LATENCY_MOVING_SUM_COUNT;
+    }
+    latency->last = latencyUs;
+    latency->count++;
+}
+
+static timeUs_t rxLatencySince(timeUs_t frameTimeUs, timeUs_t currentTimeUs)
+{
+    return MAX((timeDelta_t)(currentTimeUs - frameTimeUs), 0);
+}
+
+static void rxLatencyFrameProcessed(timeUs_t currentTimeUs)
+{
+    rxLatency_t *processed = &rxLatencyStats.stage[RX_LATENCY_PROCESSED];
+
+    if (processed->count > 0) {
+        const timeUs_t intervalUs = rxLatencySince(rxProcessedFrameTimeUs, rxFrameTimeUs);
+        if (processed->count == 1) {
+            rxLatencyStats.frameIntervalMovingSum = intervalUs * RX_LATENCY_MOVING_SUM_COUNT;
+        } else {
+            rxLatencyStats.frameIntervalMovingSum += intervalUs - rxLatencyStats.frameIntervalMovingSum / RX_LATENCY_MOVING_SUM_COUNT;
+        }
+    }
+
+    rxLatencyAdd(processed, rxLatencySince(rxFrameTimeUs, currentTimeUs));
+    rxProcessedFrameTimeUs = rxFrameTimeUs;
+    rxSetpointLatencyPending = true;
+}
+
+/*
+ * Called by the PID loop when it has applied channel data handed over by the RX task
+ */
+void rxSetpointUpdated(timeUs_t currentTimeUs)
+{
+    if (rxSetpointLatencyPending) {
+        rxSetpointLatencyPending = false;
+        rxLatencyAdd(&rxLatencyStats.stage[RX_LATENCY_SETPOINT], rxLatencySince(rxProcessedFrameTimeUs, currentTimeUs));
+    }
+}
+
+const rxLatencyStats_t *rxGetLatencyStats(void)
+{
+    return &rxLatencyStats;
+}
+
+void rxResetLatencyStats(void)
+{
+    memset(&rxLatencyStats, 0, sizeof(rxLatencyStats));
+    rxSetpointLatencyPending = false;
+}
+
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
 {
     int16_t rcStaging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
@@ -460,6 +548,9 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
     rxDataProcessingRequired = false;
     rxNextUpdateAtUs = currentTimeUs + DELAY_10_HZ;
 
+    const bool frameNew = rxFrameNew;
+    rxFrameNew = false;
+
     // If RX is suspended, do not process any data
     if (isRxSuspended) {
         return true;
@@ -518,6 +609,10 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
         failsafeOnValidDataFailed();
     }
 
+    if (frameNew) {
+        rxLatencyFrameProcessed(currentTimeUs);
+    }
+
     rcSampleIndex++;
     return true;
 }
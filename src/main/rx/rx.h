@@ -193,6 +193,27 @@ typedef uint8_t (*rcFrameStatusFnPtr)(rxRuntimeConfig_t *rxRuntimeConfig);
 typedef bool (*rcProcessFrameFnPtr)(const rxRuntimeConfig_t *rxRuntimeConfig);
 typedef uint16_t (*rcGetLinkQualityPtr)(const rxRuntimeConfig_t *rxRuntimeConfig);
 
+typedef enum {
+    RX_LATENCY_PROCESSED = 0,   // frame completion to RX task decoding the channels
+    RX_LATENCY_SETPOINT,        // frame completion to PID loop applying the new rcCommand
+    RX_LATENCY_STAGE_COUNT
+} rxLatencyStage_e;
+
+typedef struct rxLatency_s {
+    uint32_t count;             // frames measured since boot or reset
+    timeUs_t last;
+    timeUs_t min;
+    timeUs_t max;
+    timeUs_t movingSum;         // moving sum over RX_LATENCY_MOVING_SUM_COUNT frames
+} rxLatency_t;
+
+typedef struct rxLatencyStats_s {
+    timeUs_t frameIntervalMovingSum;
+    rxLatency_t stage[RX_LATENCY_STAGE_COUNT];
+} rxLatencyStats_t;
+
+#define RX_LATENCY_MOVING_SUM_COUNT 32
+
 extern rxRuntimeConfig_t rxRuntimeConfig; //!!TODO remove this extern, only needed once for channelCount
 extern rxLinkStatistics_t rxLinkStatistics;
 void lqTrackerReset(rxLinkQualityTracker_e * lqTracker);
@@ -206,6 +227,10 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime);
 bool rxIsReceivingSignal(void);
 bool rxAreFlightChannelsValid(void);
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs);
+void rxSignalFrameReceived(timeUs_t frameTimeUs);
+void rxSetpointUpdated(timeUs_t currentTimeUs);
+const rxLatencyStats_t *rxGetLatencyStats(void);
+void rxResetLatencyStats(void);
 bool isRxPulseValid(uint16_t pulseDuration);
 
 uint8_t calculateChannelRemapping(const uint8_t *channelMap, uint8_t channelMapEntryCount, uint8_t channelToRemap);
@@ -116,6 +116,7 @@ static void sbusDataReceive(uint16_t c, void *data)
 
                     memcpy((void *)&sbusFrameData->frame, (void *)&sbusFrameData->buffer[0], SBUS_FRAME_SIZE);
                     sbusFrameData->frameDone = true;
+                    rxSignalFrameReceived(currentTimeUs);
                 }
             }
             break;
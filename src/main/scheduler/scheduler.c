@@ -117,6 +117,215 @@ STATIC_INLINE_UNIT_TESTED cfTask_t *queueNext(void)
     return taskQueueArray[++taskQueuePos]; // guaranteed to be NULL at end of queue
 }
 
+#ifdef USE_SCHEDULER_DEADLINE
+/*
+ * Deadline scheduler
+ *
+ * Time-driven tasks are kept in binary min-heaps keyed by their next deadline
+ * (lastExecutedAt + desiredPeriod), so picking the most urgent one is O(1) and
+ * putting it back after execution is O(log N). Realtime and event-driven tasks
+ * are few and are kept in small flat lists that are checked every cycle.
+ * IDLE priority tasks have their own heap and only run if nothing else is due.
+ */
+typedef struct {
+    cfTask_t *tasks[TASK_COUNT];
+    int size;
+} taskHeap_t;
+
+STATIC_FASTRAM_UNIT_TESTED taskHeap_t timedTaskHeap;
+STATIC_FASTRAM_UNIT_TESTED taskHeap_t idleTaskHeap;
+STATIC_FASTRAM cfTask_t *realtimeTasks[TASK_COUNT];
+STATIC_FASTRAM int realtimeTaskCount;
+STATIC_FASTRAM cfTask_t *eventTasks[TASK_COUNT];
+STATIC_FASTRAM int eventTaskCount;
+
+static inline timeUs_t taskDeadline(const cfTask_t *task)
+{
+    return task->lastExecutedAt + task->desiredPeriod;
+}
+
+static inline bool taskDeadlineBefore(const cfTask_t *a, const cfTask_t *b)
+{
+    return (timeDelta_t)(taskDeadline(a) - taskDeadline(b)) < 0;
+}
+
+static inline bool taskIsDue(const cfTask_t *task, timeUs_t currentTimeUs)
+{
+    return (timeDelta_t)(currentTimeUs - taskDeadline(task)) >= 0;
+}
+
+static void heapSiftUp(taskHeap_t *heap, int index)
+{
+    cfTask_t *task = heap->tasks[index];
+    while (index > 0) {
+        const int parent = (index - 1) / 2;
+        if (!taskDeadlineBefore(task, heap->tasks[parent])) {
+            break;
+        }
+        heap->tasks[index] = heap->tasks[parent];
+        index = parent;
+    }
+    heap->tasks[index] = task;
+}
+
+static void heapSiftDown(taskHeap_t *heap, int index)
+{
+    cfTask_t *task = heap->tasks[index];
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && taskDeadlineBefore(heap->tasks[child + 1], heap->tasks[child])) {
+            child++;
+        }
+        if (!taskDeadlineBefore(heap->tasks[child], task)) {
+            break;
+        }
+        heap->tasks[index] = heap->tasks[child];
+        index = child;
+    }
+    heap->tasks[index] = task;
+}
+
+static int heapFind(const taskHeap_t *heap, const cfTask_t *task)
+{
+    for (int ii = 0; ii < heap->size; ii++) {
+        if (heap->tasks[ii] == task) {
+            return ii;
+        }
+    }
+    return -1;
+}
+
+static void heapAdd(taskHeap_t *heap, cfTask_t *task)
+{
+    if (heap->size >= TASK_COUNT || heapFind(heap, task) >= 0) {
+        return;
+    }
+    heap->tasks[heap->size++] = task;
+    heapSiftUp(heap, heap->size - 1);
+}
+
+static void heapRemoveAt(taskHeap_t *heap, int index)
+{
+    heap->size--;
+    if (index < heap->size) {
+        heap->tasks[index] = heap->tasks[heap->size];
+        heapSiftUp(heap, index);
+        heapSiftDown(heap, index);
+    }
+    heap->tasks[heap->size] = NULL;
+}
+
+static void heapUpdate(taskHeap_t *heap, const cfTask_t *task)
+{
+    const int index = heapFind(heap, task);
+    if (index >= 0) {
+        heapSiftUp(heap, index);
+        heapSiftDown(heap, index);
+    }
+}
+
+/*
+ * Counts tasks that are due, only descending into subtrees whose root is due
+ */
+static uint16_t heapCountDue(const taskHeap_t *heap, timeUs_t currentTimeUs)
+{
+    int stack[TASK_COUNT];
+    int stackSize = 0;
+    uint16_t count = 0;
+
+    if (heap->size > 0) {
+        stack[stackSize++] = 0;
+    }
+
+    while (stackSize > 0) {
+        const int index = stack[--stackSize];
+        if (!taskIsDue(heap->tasks[index], currentTimeUs)) {
+            continue;
+        }
+        count++;
+        for (int child = 2 * index + 1; child <= 2 * index + 2 && child < heap->size; child++) {
+            stack[stackSize++] = child;
+        }
+    }
+
+    return count;
+}
+
+static void listAdd(cfTask_t **list, int *count, cfTask_t *task)
+{
+    for (int ii = 0; ii < *count; ii++) {
+        if (list[ii] == task) {
+            return;
+        }
+    }
+    list[(*count)++] = task;
+}
+
+static void listRemove(cfTask_t **list, int *count, const cfTask_t *task)
+{
+    for (int ii = 0; ii < *count; ii++) {
+        if (list[ii] == task) {
+            list[ii] = list[--(*count)];
+            list[*count] = NULL;
+            return;
+        }
+    }
+}
+
+static taskHeap_t *deadlineQueueHeapFor(const cfTask_t *task)
+{
+    return (task->staticPriority == TASK_PRIORITY_IDLE) ? &idleTaskHeap : &timedTaskHeap;
+}
+
+STATIC_UNIT_TESTED void deadlineQueueClear(void)
+{
+    memset(&timedTaskHeap, 0, sizeof(timedTaskHeap));
+    memset(&idleTaskHeap, 0, sizeof(idleTaskHeap));
+    memset(realtimeTasks, 0, sizeof(realtimeTasks));
+    memset(eventTasks, 0, sizeof(eventTasks));
+    realtimeTaskCount = 0;
+    eventTaskCount = 0;
+}
+
+static void deadlineQueueAdd(cfTask_t *task)
+{
+    if (task->checkFunc) {
+        listAdd(eventTasks, &eventTaskCount, task);
+    } else if (task->staticPriority == TASK_PRIORITY_REALTIME) {
+        listAdd(realtimeTasks, &realtimeTaskCount, task);
+    } else {
+        heapAdd(deadlineQueueHeapFor(task), task);
+    }
+}
+
+static void deadlineQueueRemove(cfTask_t *task)
+{
+    if (task->checkFunc) {
+        listRemove(eventTasks, &eventTaskCount, task);
+    } else if (task->staticPriority == TASK_PRIORITY_REALTIME) {
+        listRemove(realtimeTasks, &realtimeTaskCount, task);
+    } else {
+        taskHeap_t *heap = deadlineQueueHeapFor(task);
+        const int index = heapFind(heap, task);
+        if (index >= 0) {
+            heapRemoveAt(heap, index);
+        }
+    }
+}
+
+static void deadlineQueueUpdate(cfTask_t *task)
+{
+    // Task being executed is re-sorted anyway once it returns
+    if (task == currentTask || task->checkFunc || task->staticPriority == TASK_PRIORITY_REALTIME) {
+        return;
+    }
+    heapUpdate(deadlineQueueHeapFor(task), task);
+}
+#endif
+
 void taskSystem(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
@@ -130,6 +339,7 @@ void taskSystem(timeUs_t currentTimeUs)
 }
 
 #define TASK_MOVING_SUM_COUNT           32
+#define TASK_SIGNALED_PRIORITY          UINT16_MAX      // signaled event driven tasks only yield to overdue realtime tasks
 FASTRAM timeUs_t checkFuncMaxExecutionTime;
 FASTRAM timeUs_t checkFuncTotalExecutionTime;
 FASTRAM timeUs_t checkFuncMovingSumExecutionTime;
@@ -153,6 +363,120 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
 }
 
+#ifdef USE_SCHEDULER_HISTOGRAMS
+// Realtime tasks for which the time spent blocked by other tasks is tracked
+static const cfTaskId_e blockedHistogramTasks[] = { TASK_GYRO, TASK_PID };
+
+static taskHistogram_t taskExecutionHistograms[TASK_COUNT];
+static taskHistogram_t taskLatenessHistograms[TASK_COUNT];
+static taskHistogram_t taskBlockedHistograms[ARRAYLEN(blockedHistogramTasks)];
+
+static void taskHistogramAdd(taskHistogram_t *histogram, timeUs_t value)
+{
+    const uint32_t valueUs = MIN(value, (timeUs_t)UINT32_MAX);
+    const unsigned bucket = valueUs ? MIN(32 - __builtin_clz(valueUs), TASK_HISTOGRAM_BUCKET_COUNT - 1) : 0;
+
+    // Keep the shape of the distribution when a bucket saturates
+    if (histogram->bucket[bucket] == UINT16_MAX) {
+        for (unsigned ii = 0; ii < TASK_HISTOGRAM_BUCKET_COUNT; ii++) {
+            histogram->bucket[ii] /= 2;
+        }
+    }
+
+    histogram->bucket[bucket]++;
+}
+
+static void taskHistogramsUpdate(cfTask_t *task, timeUs_t lateness, timeUs_t taskStartTimeUs, timeUs_t taskExecutionTime)
+{
+    const int taskId = task - cfTasks;
+
+    taskHistogramAdd(&taskExecutionHistograms[taskId], taskExecutionTime);
+    taskHistogramAdd(&taskLatenessHistograms[taskId], lateness);
+
+    if (task->staticPriority == TASK_PRIORITY_REALTIME) {
+        return;
+    }
+
+    // Account how long realtime tasks that became due while this task was running had to wait
+    const timeUs_t taskEndTimeUs = taskStartTimeUs + taskExecutionTime;
+    for (unsigned ii = 0; ii < ARRAYLEN(blockedHistogramTasks); ii++) {
+        const cfTask_t *realtimeTask = &cfTasks[blockedHistogramTasks[ii]];
+        if (realtimeTask->lastExecutedAt == 0) {
+            continue;
+        }
+
+        const timeUs_t deadline = realtimeTask->lastExecutedAt + realtimeTask->desiredPeriod;
+        if ((timeDelta_t)(taskEndTimeUs - deadline) > 0) {
+            const timeUs_t blockedSince = ((timeDelta_t)(deadline - taskStartTimeUs) > 0) ? deadline : taskStartTimeUs;
+            taskHistogramAdd(&taskBlockedHistograms[ii], taskEndTimeUs - blockedSince);
+        }
+    }
+}
+
+bool getTaskHistogram(cfTaskId_e taskId, taskHistogramType_e type, taskHistogram_t *histogram)
+{
+    if (taskId >= TASK_COUNT) {
+        return false;
+    }
+
+    switch (type) {
+    case TASK_HISTOGRAM_EXECUTION:
+        *histogram = taskExecutionHistograms[taskId];
+        return true;
+    case TASK_HISTOGRAM_LATENESS:
+        *histogram = taskLatenessHistograms[taskId];
+        return true;
+    case TASK_HISTOGRAM_BLOCKED:
+        for (unsigned ii = 0; ii < ARRAYLEN(blockedHistogramTasks); ii++) {
+            if (blockedHistogramTasks[ii] == taskId) {
+                *histogram = taskBlockedHistograms[ii];
+                return true;
+            }
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Returns exclusive upper limit of the bucket in us
+ */
+timeUs_t taskHistogramBucketLimit(unsigned bucket)
+{
+    return 1U << MIN(bucket, TASK_HISTOGRAM_BUCKET_COUNT - 1U);
+}
+
+/*
+ * Returns index of the bucket containing given percentile of the samples
+ */
+unsigned taskHistogramPercentileBucket(const taskHistogram_t *histogram, unsigned percent)
+{
+    uint32_t total = 0;
+    for (unsigned ii = 0; ii < TASK_HISTOGRAM_BUCKET_COUNT; ii++) {
+        total += histogram->bucket[ii];
+    }
+
+    const uint32_t threshold = (total * percent + 99) / 100;
+    uint32_t sum = 0;
+    for (unsigned ii = 0; ii < TASK_HISTOGRAM_BUCKET_COUNT - 1; ii++) {
+        sum += histogram->bucket[ii];
+        if (sum >= threshold) {
+            return ii;
+        }
+    }
+
+    return TASK_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+void schedulerResetTaskHistograms(void)
+{
+    memset(taskExecutionHistograms, 0, sizeof(taskExecutionHistograms));
+    memset(taskLatenessHistograms, 0, sizeof(taskLatenessHistograms));
+    memset(taskBlockedHistograms, 0, sizeof(taskBlockedHistograms));
+}
+#endif
+
 void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs)
 {
     if (taskId == TASK_SELF) {
@@ -161,6 +485,9 @@ void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs)
     } else if (taskId < TASK_COUNT) {
         cfTask_t *task = &cfTasks[taskId];
         task->desiredPeriod = MAX(SCHEDULER_DELAY_LIMIT, newPeriodUs);  // Limit delay to 100us (10 kHz) to prevent scheduler clogging
+#ifdef USE_SCHEDULER_DEADLINE
+        deadlineQueueUpdate(task);
+#endif
     }
 }
 
@@ -170,8 +497,14 @@ void setTaskEnabled(cfTaskId_e taskId, bool enabled)
         cfTask_t *task = taskId == TASK_SELF ? currentTask : &cfTasks[taskId];
         if (enabled && task->taskFunc) {
             queueAdd(task);
+#ifdef USE_SCHEDULER_DEADLINE
+            deadlineQueueAdd(task);
+#endif
         } else {
             queueRemove(task);
+#ifdef USE_SCHEDULER_DEADLINE
+            deadlineQueueRemove(task);
+#endif
         }
     }
 }
@@ -199,12 +532,234 @@ void schedulerResetTaskStatistics(cfTaskId_e taskId)
     }
 }
 
+/*
+ * Tells the scheduler that an event driven task has work waiting, e.g. a
+ * receiver driver that has just completed a frame. Safe to call from ISR.
+ * The checkFunc still decides whether the task runs, but a signaled task
+ * goes ahead of all time driven tasks and its lateness is measured from
+ * signaledAtUs rather than from when the checkFunc noticed the event.
+ */
+void schedulerSignalTask(cfTaskId_e taskId, timeUs_t signaledAtUs)
+{
+    if (taskId < TASK_COUNT) {
+        cfTask_t *task = &cfTasks[taskId];
+        task->signalPendingAt = signaledAtUs;
+        task->signalPending = true;
+    }
+}
+
+static bool taskTakeSignal(cfTask_t *task, timeUs_t *signaledAtUs)
+{
+    if (!task->signalPending) {
+        return false;
+    }
+
+    *signaledAtUs = task->signalPendingAt;
+    task->signalPending = false;
+    return true;
+}
+
+#if defined(SITL_BUILD)
+/*
+ * Time until the scheduler has something to do, used by the SITL virtual
+ * clock to skip idle time. Event driven tasks can't be predicted, they are
+ * polled at least once per desired period.
+ */
+timeDelta_t schedulerGetTimeUntilNextTask(timeUs_t currentTimeUs)
+{
+    timeDelta_t timeUntilNextTask = TASK_PERIOD_MS(100);
+
+    for (int ii = 0; ii < taskQueueSize; ii++) {
+        const cfTask_t *task = taskQueueArray[ii];
+        timeDelta_t delta;
+
+        if (task->checkFunc) {
+            if (task->dynamicPriority > 0 || task->signalPending) {
+                return 0;
+            }
+            delta = task->desiredPeriod;
+        } else {
+            delta = (timeDelta_t)(task->lastExecutedAt + task->desiredPeriod - currentTimeUs);
+            if (task->staticPriority == TASK_PRIORITY_REALTIME) {
+                // Realtime tasks are due once their period has been exceeded
+                delta++;
+            }
+        }
+
+        if (delta <= 0) {
+            return 0;
+        }
+        timeUntilNextTask = MIN(timeUntilNextTask, delta);
+    }
+
+    return timeUntilNextTask;
+}
+
+// Skipped idle time counts towards the system load as if the loop polled once per microsecond
+void schedulerAddIdleTime(timeDelta_t idleTimeUs)
+{
+    totalWaitingTasksSamples += idleTimeUs;
+}
+#endif
+
 void schedulerInit(void)
 {
     queueClear();
     queueAdd(&cfTasks[TASK_SYSTEM]);
+#ifdef USE_SCHEDULER_DEADLINE
+    deadlineQueueClear();
+    deadlineQueueAdd(&cfTasks[TASK_SYSTEM]);
+#endif
+}
+
+static void schedulerExecuteTask(cfTask_t *selectedTask, timeUs_t currentTimeUs)
+{
+#ifdef USE_SCHEDULER_HISTOGRAMS
+    timeDelta_t lateness = 0;
+    if (selectedTask->checkFunc) {
+        lateness = (timeDelta_t)(currentTimeUs - selectedTask->lastSignaledAt);
+    } else if (selectedTask->lastExecutedAt != 0) {
+        lateness = (timeDelta_t)(currentTimeUs - selectedTask->lastExecutedAt) - selectedTask->desiredPeriod;
+    }
+#endif
+
+    selectedTask->taskLatestDeltaTime = (timeDelta_t)(currentTimeUs - selectedTask->lastExecutedAt);
+    selectedTask->lastExecutedAt = currentTimeUs;
+    selectedTask->dynamicPriority = 0;
+
+    // Execute task
+    const timeUs_t currentTimeBeforeTaskCall = micros();
+    selectedTask->taskFunc(currentTimeBeforeTaskCall);
+    const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
+    selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
+    selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
+    selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
+
+#ifdef USE_SCHEDULER_HISTOGRAMS
+    taskHistogramsUpdate(selectedTask, MAX(lateness, 0), currentTimeBeforeTaskCall, taskExecutionTime);
+#endif
+}
+
+static void schedulerExecuteRealtimeCallbacks(void)
+{
+    // Execute system real-time callbacks and account for them to SYSTEM account
+    const timeUs_t currentTimeBeforeTaskCall = micros();
+    taskRunRealtimeCallbacks(currentTimeBeforeTaskCall);
+    cfTask_t *selectedTask = &cfTasks[TASK_SYSTEM];
+    const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
+    selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
+    selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
+    selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
 }
 
+#ifdef USE_SCHEDULER_DEADLINE
+void FAST_CODE NOINLINE scheduler(void)
+{
+    // Cache currentTime
+    const timeUs_t currentTimeUs = micros();
+
+    // The task to be invoked
+    cfTask_t *selectedTask = NULL;
+    uint16_t selectedTaskDynamicPriority = 0;
+    bool forcedRealTimeTask = false;
+    uint16_t waitingTasks = 0;
+
+    // Realtime tasks take absolute priority, the most overdue one is executed immediately
+    for (int ii = 0; ii < realtimeTaskCount; ii++) {
+        cfTask_t *task = realtimeTasks[ii];
+        if (((timeDelta_t)(currentTimeUs - task->lastExecutedAt)) > task->desiredPeriod) {
+            waitingTasks++;
+            if (!selectedTask || taskDeadlineBefore(task, selectedTask)) {
+                selectedTask = task;
+            }
+        }
+    }
+    forcedRealTimeTask = (selectedTask != NULL);
+
+    // Event driven tasks
+    for (int ii = 0; ii < eventTaskCount; ii++) {
+        cfTask_t *task = eventTasks[ii];
+        const timeUs_t currentTimeBeforeCheckFuncCallUs = micros();
+
+        timeUs_t signaledAtUs = currentTimeBeforeCheckFuncCallUs;
+        const bool signaled = taskTakeSignal(task, &signaledAtUs);
+
+        if (task->dynamicPriority == TASK_SIGNALED_PRIORITY) {
+            // Signaled task held off by a realtime task keeps its precedence
+            waitingTasks++;
+        } else if (task->dynamicPriority > 0) {
+            task->taskAgeCycles = 1 + ((timeDelta_t)(currentTimeUs - task->lastSignaledAt)) / task->desiredPeriod;
+            task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
+            waitingTasks++;
+        } else if (task->checkFunc(currentTimeBeforeCheckFuncCallUs, currentTimeBeforeCheckFuncCallUs - task->lastExecutedAt)) {
+            const timeUs_t checkFuncExecutionTime = micros() - currentTimeBeforeCheckFuncCallUs;
+            checkFuncMovingSumExecutionTime -= checkFuncMovingSumExecutionTime / TASK_MOVING_SUM_COUNT;
+            checkFuncMovingSumExecutionTime += checkFuncExecutionTime;
+            checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
+            checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
+            task->lastSignaledAt = signaledAtUs;
+            task->taskAgeCycles = 1;
+            task->dynamicPriority = 1 + task->staticPriority;
+            waitingTasks++;
+        } else {
+            task->taskAgeCycles = 0;
+        }
+
+        if (signaled && task->dynamicPriority > 0) {
+            task->dynamicPriority = TASK_SIGNALED_PRIORITY;
+        }
+
+        if (!forcedRealTimeTask && task->dynamicPriority > selectedTaskDynamicPriority) {
+            selectedTaskDynamicPriority = task->dynamicPriority;
+            selectedTask = task;
+        }
+    }
+
+    // Time driven tasks, only the one with the earliest deadline competes with signaled event driven tasks
+    const uint16_t dueTimedTasks = heapCountDue(&timedTaskHeap, currentTimeUs);
+    waitingTasks += dueTimedTasks;
+    if (dueTimedTasks > 0 && !forcedRealTimeTask) {
+        cfTask_t *task = timedTaskHeap.tasks[0];
+        task->taskAgeCycles = ((timeDelta_t)(currentTimeUs - task->lastExecutedAt)) / task->desiredPeriod;
+        task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
+        if (task->dynamicPriority > selectedTaskDynamicPriority) {
+            selectedTaskDynamicPriority = task->dynamicPriority;
+            selectedTask = task;
+        }
+    }
+
+    // IDLE tasks are executed only if no other task is waiting
+    const uint16_t dueIdleTasks = heapCountDue(&idleTaskHeap, currentTimeUs);
+    waitingTasks += dueIdleTasks;
+    if (dueIdleTasks > 0 && !selectedTask) {
+        selectedTask = idleTaskHeap.tasks[0];
+    }
+
+    totalWaitingTasksSamples++;
+    totalWaitingTasks += waitingTasks;
+
+    currentTask = selectedTask;
+
+    if (selectedTask) {
+        schedulerExecuteTask(selectedTask, currentTimeUs);
+
+        // Deadline has moved forward, restore heap order
+        if (!selectedTask->checkFunc && selectedTask->staticPriority != TASK_PRIORITY_REALTIME) {
+            taskHeap_t *heap = deadlineQueueHeapFor(selectedTask);
+            if (heap->size > 0 && heap->tasks[0] == selectedTask) {
+                heapSiftDown(heap, 0);
+            } else {
+                // Task queue was modified by the task itself
+                heapUpdate(heap, selectedTask);
+            }
+        }
+    }
+
+    if (!selectedTask || forcedRealTimeTask) {
+        schedulerExecuteRealtimeCallbacks();
+    }
+}
+#else
 void FAST_CODE NOINLINE scheduler(void)
 {
     // Cache currentTime
@@ -222,8 +777,14 @@ void FAST_CODE NOINLINE scheduler(void)
         if (task->checkFunc) {
             const timeUs_t currentTimeBeforeCheckFuncCallUs = micros();
 
+            timeUs_t signaledAtUs = currentTimeBeforeCheckFuncCallUs;
+            const bool signaled = taskTakeSignal(task, &signaledAtUs);
+
             // Increase priority for event driven tasks
-            if (task->dynamicPriority > 0) {
+            if (task->dynamicPriority == TASK_SIGNALED_PRIORITY) {
+                // Signaled task held off by a realtime task keeps its precedence
+                waitingTasks++;
+            } else if (task->dynamicPriority > 0) {
                 task->taskAgeCycles = 1 + ((timeDelta_t)(currentTimeUs - task->lastSignaledAt)) / task->desiredPeriod;
                 task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
                 waitingTasks++;
@@ -233,13 +794,17 @@ void FAST_CODE NOINLINE scheduler(void)
                 checkFuncMovingSumExecutionTime += checkFuncExecutionTime;
                 checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
                 checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
-                task->lastSignaledAt = currentTimeBeforeCheckFuncCallUs;
+                task->lastSignaledAt = signaledAtUs;
                 task->taskAgeCycles = 1;
                 task->dynamicPriority = 1 + task->staticPriority;
                 waitingTasks++;
             } else {
                 task->taskAgeCycles = 0;
             }
+
+            if (signaled && task->dynamicPriority > 0) {
+                task->dynamicPriority = TASK_SIGNALED_PRIORITY;
+            }
         } else if (task->staticPriority == TASK_PRIORITY_REALTIME) {
             //realtime tasks take absolute priority. Any RT tasks that is overdue, should be execute immediately
             if (((timeDelta_t)(currentTimeUs - task->lastExecutedAt)) > task->desiredPeriod) {
@@ -271,27 +836,11 @@ void FAST_CODE NOINLINE scheduler(void)
 
     if (selectedTask) {
         // Found a task that should be run
-        selectedTask->taskLatestDeltaTime = (timeDelta_t)(currentTimeUs - selectedTask->lastExecutedAt);
-        selectedTask->lastExecutedAt = currentTimeUs;
-        selectedTask->dynamicPriority = 0;
-
-        // Execute task
-        const timeUs_t currentTimeBeforeTaskCall = micros();
-        selectedTask->taskFunc(currentTimeBeforeTaskCall);
-        const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
-        selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
-        selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
-        selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
-    } 
-    
+        schedulerExecuteTask(selectedTask, currentTimeUs);
+    }
+
     if (!selectedTask || forcedRealTimeTask) {
-        // Execute system real-time callbacks and account for them to SYSTEM account
-        const timeUs_t currentTimeBeforeTaskCall = micros();
-        taskRunRealtimeCallbacks(currentTimeBeforeTaskCall);
-        selectedTask = &cfTasks[TASK_SYSTEM];
-        const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
-        selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / TASK_MOVING_SUM_COUNT;
-        selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
-        selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
+        schedulerExecuteRealtimeCallbacks();
     }
 }
+#endif
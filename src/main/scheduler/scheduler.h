@@ -46,6 +46,22 @@ typedef struct {
     timeDelta_t     latestDeltaTime;
 } cfTaskInfo_t;
 
+#ifdef USE_SCHEDULER_HISTOGRAMS
+// Log2 buckets: bucket 0 counts 0us, bucket N counts [2^(N-1), 2^N) us, last bucket is open ended
+#define TASK_HISTOGRAM_BUCKET_COUNT     16
+
+typedef enum {
+    TASK_HISTOGRAM_EXECUTION = 0,   // task execution time
+    TASK_HISTOGRAM_LATENESS,        // start time past desiredPeriod (or past signal time for event driven tasks)
+    TASK_HISTOGRAM_BLOCKED,         // time a realtime task was held off by another task overrunning its deadline
+    TASK_HISTOGRAM_TYPE_COUNT
+} taskHistogramType_e;
+
+typedef struct {
+    uint16_t bucket[TASK_HISTOGRAM_BUCKET_COUNT];
+} taskHistogram_t;
+#endif
+
 typedef enum {
     /* Actual tasks */
     TASK_SYSTEM = 0,
@@ -140,6 +156,8 @@ typedef struct {
     uint16_t taskAgeCycles;
     timeUs_t lastExecutedAt;        // last time of invocation
     timeUs_t lastSignaledAt;        // time of invocation event for event-driven tasks
+    volatile bool signalPending;    // event was signaled from driver code, see schedulerSignalTask()
+    volatile timeUs_t signalPendingAt;
     timeDelta_t taskLatestDeltaTime;
 
     /* Statistics */
@@ -157,6 +175,18 @@ void rescheduleTask(cfTaskId_e taskId, timeDelta_t newPeriodUs);
 void setTaskEnabled(cfTaskId_e taskId, bool newEnabledState);
 timeDelta_t getTaskDeltaTime(cfTaskId_e taskId);
 void schedulerResetTaskStatistics(cfTaskId_e taskId);
+void schedulerSignalTask(cfTaskId_e taskId, timeUs_t signaledAtUs);
+#ifdef USE_SCHEDULER_HISTOGRAMS
+bool getTaskHistogram(cfTaskId_e taskId, taskHistogramType_e type, taskHistogram_t *histogram);
+timeUs_t taskHistogramBucketLimit(unsigned bucket);
+unsigned taskHistogramPercentileBucket(const taskHistogram_t *histogram, unsigned percent);
+void schedulerResetTaskHistograms(void);
+#endif
+
+#if defined(SITL_BUILD)
+timeDelta_t schedulerGetTimeUntilNextTask(timeUs_t currentTimeUs);
+void schedulerAddIdleTime(timeDelta_t idleTimeUs);
+#endif
 
 void schedulerInit(void);
 void scheduler(void);
@@ -81,11 +81,12 @@ STATIC_UNIT_TESTED gyroDev_t gyroDev[MAX_GYRO_COUNT];  // Not in FASTRAM since i
 STATIC_FASTRAM int16_t gyroTemperature[MAX_GYRO_COUNT];
 STATIC_FASTRAM_UNIT_TESTED zeroCalibrationVector_t gyroCalibration[MAX_GYRO_COUNT];
 
-STATIC_FASTRAM filterApplyFnPtr gyroLpfApplyFn;
-STATIC_FASTRAM filter_t gyroLpfState[XYZ_AXIS_COUNT];
+// Gyro LPFs share type and cutoff on all axes and are applied to X/Y/Z in one call
+STATIC_FASTRAM filter3ApplyFnPtr gyroLpfApplyFn;
+STATIC_FASTRAM filter3_t gyroLpfState;
 
-STATIC_FASTRAM filterApplyFnPtr gyroLpf2ApplyFn;
-STATIC_FASTRAM filter_t gyroLpf2State[XYZ_AXIS_COUNT];
+STATIC_FASTRAM filter3ApplyFnPtr gyroLpf2ApplyFn;
+STATIC_FASTRAM filter3_t gyroLpf2State;
 
 #ifdef USE_DYNAMIC_FILTERS
 
@@ -233,23 +234,19 @@ STATIC_UNIT_TESTED gyroSensor_e gyroDetect(gyroDev_t *dev, gyroSensor_e gyroHard
     return gyroHardware;
 }
 
-static void initGyroFilter(filterApplyFnPtr *applyFn, filter_t state[], uint8_t type, uint16_t cutoff, uint32_t looptime)
+static void initGyroFilter(filter3ApplyFnPtr *applyFn, filter3_t *state, uint8_t type, uint16_t cutoff, uint32_t looptime)
 {
-    *applyFn = nullFilterApply;
+    *applyFn = nullFilter3Apply;
     if (cutoff > 0) {
         switch (type)
         {
             case FILTER_PT1:
-                *applyFn = (filterApplyFnPtr)pt1FilterApply;
-                for (int axis = 0; axis < 3; axis++) {
-                    pt1FilterInit(&state[axis].pt1, cutoff, US2S(looptime));
-                }
+                *applyFn = (filter3ApplyFnPtr)pt1Filter3Apply;
+                pt1Filter3Init(&state->pt1, cutoff, US2S(looptime));
                 break;
             case FILTER_BIQUAD:
-                *applyFn = (filterApplyFnPtr)biquadFilterApply;
-                for (int axis = 0; axis < 3; axis++) {
-                    biquadFilterInitLPF(&state[axis].biquad, cutoff, looptime);
-                }
+                *applyFn = (filter3ApplyFnPtr)biquadFilter3Apply;
+                biquadFilter3InitLPF(&state->biquad, cutoff, looptime);
                 break;
         }
     }
@@ -258,10 +255,10 @@ static void initGyroFilter(filterApplyFnPtr *applyFn, filter_t state[], uint8_t
 static void gyroInitFilters(void)
 {
     //First gyro LPF running at full gyro frequency 8kHz
-    initGyroFilter(&gyroLpfApplyFn, gyroLpfState, gyroConfig()->gyro_anti_aliasing_lpf_type, gyroConfig()->gyro_anti_aliasing_lpf_hz, getGyroLooptime());
+    initGyroFilter(&gyroLpfApplyFn, &gyroLpfState, gyroConfig()->gyro_anti_aliasing_lpf_type, gyroConfig()->gyro_anti_aliasing_lpf_hz, getGyroLooptime());
 
     //Second gyro LPF runnig and PID frequency - this filter is dynamic when gyro_use_dyn_lpf = ON
-    initGyroFilter(&gyroLpf2ApplyFn, gyroLpf2State, gyroConfig()->gyro_main_lpf_type, gyroConfig()->gyro_main_lpf_hz, getLooptime());
+    initGyroFilter(&gyroLpf2ApplyFn, &gyroLpf2State, gyroConfig()->gyro_main_lpf_type, gyroConfig()->gyro_main_lpf_hz, getLooptime());
 
 #ifdef USE_GYRO_KALMAN
     if (gyroConfig()->kalmanEnabled) {
@@ -448,28 +445,31 @@ void FAST_CODE NOINLINE gyroFilter(void)
         return;
     }
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        float gyroADCf = gyro.gyroADCf[axis];
-
 #ifdef USE_RPM_FILTER
-        gyroADCf = rpmFilterGyroApply(axis, gyroADCf);
+    rpmFilterGyroApply(gyro.gyroADCf);
 #endif
 
-        gyroADCf = gyroLpf2ApplyFn((filter_t *) &gyroLpf2State[axis], gyroADCf);
+    gyroLpf2ApplyFn(&gyroLpf2State, gyro.gyroADCf);
 
 #ifdef USE_DYNAMIC_FILTERS
-        if (dynamicGyroNotchState.enabled) {
-            gyroDataAnalysePush(&gyroAnalyseState, axis, gyroADCf);
-            gyroADCf = dynamicGyroNotchFiltersApply(&dynamicGyroNotchState, axis, gyroADCf);
+    if (dynamicGyroNotchState.enabled) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDataAnalysePush(&gyroAnalyseState, axis, gyro.gyroADCf[axis]);
         }
+        dynamicGyroNotchFiltersApply(&dynamicGyroNotchState, gyro.gyroADCf);
+    }
+#endif
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        float gyroADCf = gyro.gyroADCf[axis];
 
+#ifdef USE_DYNAMIC_FILTERS
         /**
          * Secondary dynamic notch filter. 
          * In some cases, noise amplitude is high enough not to be filtered by the primary filter.
          * This happens on the first frequency with the biggest aplitude
          */
         gyroADCf = secondaryDynamicGyroNotchFiltersApply(&secondaryDynamicGyroNotchState, axis, gyroADCf);
-
 #endif
 
 #ifdef USE_GYRO_KALMAN
@@ -486,18 +486,23 @@ void FAST_CODE NOINLINE gyroFilter(void)
         gyroDataAnalyse(&gyroAnalyseState);
 
         if (gyroAnalyseState.filterUpdateExecute) {
-            dynamicGyroNotchFiltersUpdate(
-                &dynamicGyroNotchState,
-                gyroAnalyseState.filterUpdateAxis,
-                gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
-            );
-
-            secondaryDynamicGyroNotchFiltersUpdate(
-                &secondaryDynamicGyroNotchState, 
-                gyroAnalyseState.filterUpdateAxis,
-                gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
-            );
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                if (!(gyroAnalyseState.filterUpdateAxes & BIT(axis))) {
+                    continue;
+                }
 
+                dynamicGyroNotchFiltersUpdate(
+                    &dynamicGyroNotchState,
+                    axis,
+                    gyroAnalyseState.centerFrequency[axis]
+                );
+
+                secondaryDynamicGyroNotchFiltersUpdate(
+                    &secondaryDynamicGyroNotchState, 
+                    axis,
+                    gyroAnalyseState.centerFrequency[axis]
+                );
+            }
         }
     }
 #endif
@@ -521,20 +526,16 @@ void FAST_CODE NOINLINE gyroUpdate(void)
         return;
     }
 
+    // At this point gyro.gyroADCf contains unfiltered gyro value [deg/s]
+    // Set raw gyro for blackbox purposes
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        // At this point gyro.gyroADCf contains unfiltered gyro value [deg/s]
-        float gyroADCf = gyro.gyroADCf[axis];
-
-        // Set raw gyro for blackbox purposes
-        gyro.gyroRaw[axis] = gyroADCf;
-
-        /*
-         * First gyro LPF is the only filter applied with the full gyro sampling speed
-         */
-        gyroADCf = gyroLpfApplyFn((filter_t *) &gyroLpfState[axis], gyroADCf);
-
-        gyro.gyroADCf[axis] = gyroADCf;
+        gyro.gyroRaw[axis] = gyro.gyroADCf[axis];
     }
+
+    /*
+     * First gyro LPF is the only filter applied with the full gyro sampling speed
+     */
+    gyroLpfApplyFn(&gyroLpfState, gyro.gyroADCf);
 }
 
 bool gyroReadTemperature(void)
@@ -571,13 +572,9 @@ int16_t gyroRateDps(int axis)
 
 void gyroUpdateDynamicLpf(float cutoffFreq) {
     if (gyroConfig()->gyro_main_lpf_type == FILTER_PT1) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            pt1FilterUpdateCutoff(&gyroLpf2State[axis].pt1, cutoffFreq);
-        }
+        pt1Filter3UpdateCutoff(&gyroLpf2State.pt1, cutoffFreq);
     } else if (gyroConfig()->gyro_main_lpf_type == FILTER_BIQUAD) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterUpdate(&gyroLpf2State[axis].biquad, cutoffFreq, getLooptime(), BIQUAD_Q, FILTER_LPF);
-        }
+        biquadFilter3Update(&gyroLpf2State.biquad, cutoffFreq, getLooptime(), BIQUAD_Q, FILTER_LPF);
     }
 }
 
@@ -325,71 +325,62 @@ static void exchangeData(void)
     rfValues.m_currentAircraftStatus = getStringFromResponse(response, "m-currentAircraftStatus");
 
     
-    uint16_t channelValues[RF_MAX_CHANNEL_COUNT];
-    getChannelValues(response, channelValues);
-    rxSimSetChannelValue(channelValues, RF_MAX_CHANNEL_COUNT);
+    simSensorState_t state = { 0 };
+
+    STATIC_ASSERT(RF_MAX_CHANNEL_COUNT <= SIM_MAX_CHANNEL_COUNT, too_many_realflight_channels);
+    if (getChannelValues(response, state.channelValues)) {
+        state.channelCount = RF_MAX_CHANNEL_COUNT;
+    }
     
     float lat, lon;
     fakeCoords(FAKE_LAT, FAKE_LON, rfValues.m_aircraftPositionX_MTR, -rfValues.m_aircraftPositionY_MTR, &lat, &lon);
     
     int16_t course = (int16_t)roundf(convertAzimuth(rfValues.m_azimuth_DEG) * 10);
     int32_t altitude = (int32_t)roundf(rfValues.m_altitudeASL_MTR * 100);
-    gpsFakeSet(
-        GPS_FIX_3D,
-        16,
-        (int32_t)roundf(lat * 10000000),
-        (int32_t)roundf(lon * 10000000),
-        altitude,
-        (int16_t)roundf(rfValues.m_groundspeed_MPS * 100),
-        course,
-        0, 
-        0,
-        0,
-        0
-    );
+    state.numSat = 16;
+    state.lat = (int32_t)roundf(lat * 10000000);
+    state.lon = (int32_t)roundf(lon * 10000000);
+    state.alt = altitude;
+    state.groundSpeed = (int16_t)roundf(rfValues.m_groundspeed_MPS * 100);
+    state.groundCourse = course;
 
     int32_t altitudeOverGround = (int32_t)roundf(rfValues.m_altitudeAGL_MTR * 100);
     if (altitudeOverGround > 0 && altitudeOverGround <= RANGEFINDER_VIRTUAL_MAX_RANGE_CM) {
-        fakeRangefindersSetData(altitudeOverGround);
+        state.rangefinderCm = altitudeOverGround;
     } else {
-        fakeRangefindersSetData(-1);
+        state.rangefinderCm = -1;
     }
 
     const int16_t roll_inav = (int16_t)roundf(rfValues.m_roll_DEG * 10);
     const int16_t pitch_inav = (int16_t)roundf(-rfValues.m_inclination_DEG * 10);
     const int16_t yaw_inav = course;
-    if (!useImu) {
-        imuSetAttitudeRPY(roll_inav, pitch_inav, yaw_inav);
-        imuUpdateAttitude(micros());
-    }
+    state.setAttitude = !useImu;
+    state.roll = roll_inav;
+    state.pitch = pitch_inav;
+    state.yaw = yaw_inav;
 
     // RealFlights acc data is weird if the aircraft has not yet taken off. Fake 1G in horizontale position
-    int16_t accX = 0;
-    int16_t accY = 0;
-    int16_t accZ = 0;
     if (rfValues.m_currentAircraftStatus && strncmp(rfValues.m_currentAircraftStatus, "CAS-WAITINGTOLAUNCH", strlen(rfValues.m_currentAircraftStatus)) == 0) {
-        accX = 0;
-        accY = 0;
-        accZ = (int16_t)(GRAVITY_MSS * 1000.0f);
+        state.acc[X] = 0;
+        state.acc[Y] = 0;
+        state.acc[Z] = (int16_t)(GRAVITY_MSS * 1000.0f);
     } else {
-         accX = constrainToInt16(rfValues.m_accelerationBodyAX_MPS2 * 1000);
-         accY = constrainToInt16(-rfValues.m_accelerationBodyAY_MPS2 * 1000);
-         accZ = constrainToInt16(-rfValues.m_accelerationBodyAZ_MPS2 * 1000);
+        state.acc[X] = constrainToInt16(rfValues.m_accelerationBodyAX_MPS2 * 1000);
+        state.acc[Y] = constrainToInt16(-rfValues.m_accelerationBodyAY_MPS2 * 1000);
+        state.acc[Z] = constrainToInt16(-rfValues.m_accelerationBodyAZ_MPS2 * 1000);
     }
 
-    fakeAccSet(accX, accY, accZ);
+    state.gyro[X] = constrainToInt16(rfValues.m_rollRate_DEGpSEC * 16.0f);
+    state.gyro[Y] = constrainToInt16(-rfValues.m_pitchRate_DEGpSEC * 16.0f);
+    state.gyro[Z] = constrainToInt16(rfValues.m_yawRate_DEGpSEC * 16.0f);
 
-    fakeGyroSet(
-        constrainToInt16(rfValues.m_rollRate_DEGpSEC * 16.0f),
-        constrainToInt16(-rfValues.m_pitchRate_DEGpSEC * 16.0f),
-        constrainToInt16(rfValues.m_yawRate_DEGpSEC * 16.0f)
-    );
+    state.baroPressure = altitudeToPressure(altitude);
+    state.baroTemperature = DEGREES_TO_CENTIDEGREES(21);
+    state.airSpeed = rfValues.m_airspeed_MPS * 100;
 
-    fakeBaroSet(altitudeToPressure(altitude), DEGREES_TO_CENTIDEGREES(21));
-    fakePitotSetAirspeed(rfValues.m_airspeed_MPS * 100);
-
-    fakeBattSensorSetVbat((uint16_t)roundf(rfValues.m_batteryVoltage_VOLTS * 100));
-    fakeBattSensorSetAmperage((uint16_t)roundf(rfValues.m_batteryCurrentDraw_AMPS * 100)); 
+    state.vbat = (uint16_t)roundf(rfValues.m_batteryVoltage_VOLTS * 100);
+    state.hasAmperage = true;
+    state.amperage = (uint16_t)roundf(rfValues.m_batteryCurrentDraw_AMPS * 100);
 
     fpQuaternion_t quat;
     fpVector3_t north;
@@ -398,11 +389,11 @@ static void exchangeData(void)
     north.z = 0;
     computeQuaternionFromRPY(&quat, roll_inav, pitch_inav, yaw_inav);
     transformVectorEarthToBody(&north, &quat);
-    fakeMagSet(
-        constrainToInt16(north.x * 16000.0f),
-        constrainToInt16(north.y * 16000.0f),
-        constrainToInt16(north.z * 16000.0f)
-    );
+    state.mag[X] = constrainToInt16(north.x * 16000.0f);
+    state.mag[Y] = constrainToInt16(north.y * 16000.0f);
+    state.mag[Z] = constrainToInt16(north.z * 16000.0f);
+
+    simSensorStatePublish(&state);
 }
 
 static void* soapWorker(void* arg)
@@ -416,13 +407,11 @@ static void* soapWorker(void* arg)
             startRequest("InjectUAVControllerInterface", "<InjectUAVControllerInterface><a>1</a><b>2</b></InjectUAVControllerInterface>");
             endRequest();        
             exchangeData();
-            ENABLE_ARMING_FLAG(SIMULATOR_MODE_SITL);
             
             isInitalised = true;  
         }
 
         exchangeData();
-        unlockMainPID();
     }
 
     return NULL;
@@ -22,14 +22,43 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
  */
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
+#include "platform.h"
+
 #include "common/quaternion.h"
 
+#include "drivers/accgyro/accgyro_fake.h"
+#include "drivers/barometer/barometer_fake.h"
+#include "drivers/compass/compass_fake.h"
+#include "drivers/pitotmeter/pitotmeter_fake.h"
+#include "drivers/time.h"
+
+#include "fc/runtime_config.h"
+#include "flight/imu.h"
+#include "io/gps.h"
+#include "io/rangefinder.h"
+#include "rx/sim.h"
+#include "sensors/battery_sensor_fake.h"
+
 #include "target/SITL/sim/simHelper.h"
 
+#define SIM_STATE_READ_ATTEMPTS 3
+
+/*
+ * Seqlock: the sequence is odd while the simulator thread is writing. The
+ * main loop retries a torn read a few times and otherwise keeps the previous
+ * state until the next loop, it never waits for the writer.
+ */
+static atomic_uint simStateSequence;
+static simSensorState_t simStateShared;
+static unsigned simStateAppliedSequence;
+static bool simStateInitialized;
+
 inline int16_t constrainToInt16(float value)
 {
     return (int16_t)round(constrain(value, INT16_MIN, INT16_MAX));
@@ -65,3 +94,92 @@ void transformVectorEarthToBody(fpVector3_t *v, const fpQuaternion_t *quat)
     // From earth frame to body frame
     quaternionRotateVector(v, v, quat);
 }
+
+void simSensorStatePublish(const simSensorState_t *state)
+{
+    const unsigned sequence = atomic_load_explicit(&simStateSequence, memory_order_relaxed);
+
+    atomic_store_explicit(&simStateSequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(&simStateShared, state, sizeof(simStateShared));
+
+    atomic_store_explicit(&simStateSequence, sequence + 2, memory_order_release);
+
+    // In lockstep mode this blocks until INAV has run for one simulator step
+    sitlClockStep();
+}
+
+static bool simSensorStateRead(simSensorState_t *state, unsigned *sequence)
+{
+    for (int attempt = 0; attempt < SIM_STATE_READ_ATTEMPTS; attempt++) {
+        const unsigned begin = atomic_load_explicit(&simStateSequence, memory_order_acquire);
+        if (begin & 1) {
+            continue;
+        }
+
+        memcpy(state, &simStateShared, sizeof(*state));
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&simStateSequence, memory_order_relaxed) == begin) {
+            *sequence = begin;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool simSensorStateApply(void)
+{
+    const unsigned published = atomic_load_explicit(&simStateSequence, memory_order_acquire);
+
+    if (published == 0) {
+        // No simulator connected (yet)
+        return true;
+    }
+
+    if (published == simStateAppliedSequence) {
+        return false;
+    }
+
+    simSensorState_t state;
+    unsigned sequence;
+    if (!simSensorStateRead(&state, &sequence)) {
+        return false;
+    }
+    simStateAppliedSequence = sequence;
+
+    if (state.channelCount > 0) {
+        rxSimSetChannelValue(state.channelValues, state.channelCount);
+    }
+
+    gpsFakeSet(GPS_FIX_3D, state.numSat, state.lat, state.lon, state.alt, state.groundSpeed, state.groundCourse, 0, 0, 0, 0);
+    fakeRangefindersSetData(state.rangefinderCm);
+
+    if (state.setAttitude) {
+        imuSetAttitudeRPY(state.roll, state.pitch, state.yaw);
+        imuUpdateAttitude(micros());
+    }
+
+    fakeAccSet(state.acc[X], state.acc[Y], state.acc[Z]);
+    fakeGyroSet(state.gyro[X], state.gyro[Y], state.gyro[Z]);
+    fakeMagSet(state.mag[X], state.mag[Y], state.mag[Z]);
+    fakeBaroSet(state.baroPressure, state.baroTemperature);
+    fakePitotSetAirspeed(state.airSpeed);
+
+    fakeBattSensorSetVbat(state.vbat);
+    if (state.hasAmperage) {
+        fakeBattSensorSetAmperage(state.amperage);
+    }
+
+    if (!simStateInitialized) {
+        ENABLE_ARMING_FLAG(SIMULATOR_MODE_SITL);
+        if (state.accelerometerCalibrated) {
+            ENABLE_STATE(ACCELEROMETER_CALIBRATED);
+        }
+        simStateInitialized = true;
+    }
+
+    return true;
+}
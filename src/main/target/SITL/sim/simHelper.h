@@ -22,6 +22,9 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
  */
 
+#pragma once
+
+#include <stdbool.h>
 #include <stdint.h>
 #include "common/maths.h"
 #include "common/quaternion.h"
@@ -34,4 +37,51 @@
 
 int16_t constrainToInt16(float value);
 void transformVectorEarthToBody(fpVector3_t *v, const fpQuaternion_t *quat);
-void computeQuaternionFromRPY(fpQuaternion_t *quat, int16_t initialRoll, int16_t initialPitch, int16_t initialYaw);
\ No newline at end of file
+void computeQuaternionFromRPY(fpQuaternion_t *quat, int16_t initialRoll, int16_t initialPitch, int16_t initialYaw);
+
+#define SIM_MAX_CHANNEL_COUNT 12
+
+/*
+ * Everything a simulator frame sets on the FC side. The simulator threads
+ * fill it in and publish it, the main loop applies the latest published
+ * state to the fake sensors, so the flight code never races or blocks on
+ * a network thread.
+ */
+typedef struct simSensorState_s {
+    uint16_t channelValues[SIM_MAX_CHANNEL_COUNT];
+    uint8_t channelCount;               // 0 when the frame has no RC data
+
+    int32_t lat;
+    int32_t lon;
+    int32_t alt;
+    int16_t groundSpeed;
+    int16_t groundCourse;
+    uint8_t numSat;
+
+    int32_t rangefinderCm;              // -1 when out of range
+
+    bool setAttitude;                   // Attitude is set from the simulator instead of estimated by the IMU
+    int16_t roll;
+    int16_t pitch;
+    int16_t yaw;
+
+    int16_t acc[3];
+    int16_t gyro[3];
+    int16_t mag[3];
+
+    int32_t baroPressure;
+    int32_t baroTemperature;
+    float airSpeed;
+
+    uint16_t vbat;
+    bool hasAmperage;
+    uint16_t amperage;
+
+    bool accelerometerCalibrated;       // Skip accelerometer calibration when the first frame is applied
+} simSensorState_t;
+
+// Called by the simulator thread for every received frame, never blocks
+void simSensorStatePublish(const simSensorState_t *state);
+// Called by the main loop, returns true when a new frame has been applied
+// or when no simulator has published anything yet
+bool simSensorStateApply(void);
@@ -352,66 +352,56 @@ static void* listenWorker(void* arg)
             yaw += 3600;
         }
 
+        simSensorState_t state = { 0 };
+
         if (hasJoystick) {
-            uint16_t channelValues[XPLANE_JOYSTICK_AXIS_COUNT];
-            channelValues[0] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[0]);
-            channelValues[1] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[1]);
-            channelValues[2] = FLOAT_0_1_TO_PWM(joystickRaw[2]);
-            channelValues[3] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[3]);
-            channelValues[4] = FLOAT_0_1_TO_PWM(joystickRaw[4]);
-            channelValues[5] = FLOAT_0_1_TO_PWM(joystickRaw[5]);
-            channelValues[6] = FLOAT_0_1_TO_PWM(joystickRaw[6]);
-            channelValues[7] = FLOAT_0_1_TO_PWM(joystickRaw[7]);
-
-            rxSimSetChannelValue(channelValues, XPLANE_JOYSTICK_AXIS_COUNT);
+            state.channelValues[0] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[0]);
+            state.channelValues[1] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[1]);
+            state.channelValues[2] = FLOAT_0_1_TO_PWM(joystickRaw[2]);
+            state.channelValues[3] = FLOAT_MINUS_1_1_TO_PWM(joystickRaw[3]);
+            state.channelValues[4] = FLOAT_0_1_TO_PWM(joystickRaw[4]);
+            state.channelValues[5] = FLOAT_0_1_TO_PWM(joystickRaw[5]);
+            state.channelValues[6] = FLOAT_0_1_TO_PWM(joystickRaw[6]);
+            state.channelValues[7] = FLOAT_0_1_TO_PWM(joystickRaw[7]);
+            state.channelCount = XPLANE_JOYSTICK_AXIS_COUNT;
         }
 
-        gpsFakeSet(
-            GPS_FIX_3D,
-            16,
-            (int32_t)roundf(lattitude * 10000000),
-            (int32_t)roundf(longitude * 10000000),
-            (int32_t)roundf(elevation * 100),
-            (int16_t)roundf(groundspeed * 100),
-            (int16_t)roundf(hpath * 10),
-            0, //(int16_t)roundf(-local_vz * 100),
-            0, //(int16_t)roundf(local_vx * 100),
-            0, //(int16_t)roundf(-local_vy * 100),
-            0
-        );
+        state.numSat = 16;
+        state.lat = (int32_t)roundf(lattitude * 10000000);
+        state.lon = (int32_t)roundf(longitude * 10000000);
+        state.alt = (int32_t)roundf(elevation * 100);
+        state.groundSpeed = (int16_t)roundf(groundspeed * 100);
+        state.groundCourse = (int16_t)roundf(hpath * 10);
 
         const int32_t altitideOverGround = (int32_t)roundf(agl * 100);
         if (altitideOverGround > 0 && altitideOverGround <= RANGEFINDER_VIRTUAL_MAX_RANGE_CM) {
-            fakeRangefindersSetData(altitideOverGround);
+            state.rangefinderCm = altitideOverGround;
         } else {
-            fakeRangefindersSetData(-1);
+            state.rangefinderCm = -1;
         }
 
         const int16_t roll_inav = roll * 10;
         const int16_t pitch_inav = -pitch * 10;
         const int16_t yaw_inav = yaw * 10;
 
-        if (!useImu) {
-            imuSetAttitudeRPY(roll_inav, pitch_inav, yaw_inav);
-            imuUpdateAttitude(micros());
-        }
+        state.setAttitude = !useImu;
+        state.roll = roll_inav;
+        state.pitch = pitch_inav;
+        state.yaw = yaw_inav;
 
-        fakeAccSet(
-            constrainToInt16(-accel_x * GRAVITY_MSS * 1000.0f),
-            constrainToInt16(accel_y * GRAVITY_MSS * 1000.0f),
-            constrainToInt16(accel_z * GRAVITY_MSS * 1000.0f)
-        );
+        state.acc[X] = constrainToInt16(-accel_x * GRAVITY_MSS * 1000.0f);
+        state.acc[Y] = constrainToInt16(accel_y * GRAVITY_MSS * 1000.0f);
+        state.acc[Z] = constrainToInt16(accel_z * GRAVITY_MSS * 1000.0f);
 
-        fakeGyroSet(
-            constrainToInt16(gyro_x * 16.0f),
-            constrainToInt16(-gyro_y * 16.0f),
-            constrainToInt16(-gyro_z * 16.0f)
-        );
+        state.gyro[X] = constrainToInt16(gyro_x * 16.0f);
+        state.gyro[Y] = constrainToInt16(-gyro_y * 16.0f);
+        state.gyro[Z] = constrainToInt16(-gyro_z * 16.0f);
 
-        fakeBaroSet((int32_t)roundf(barometer * 3386.39f), DEGREES_TO_CENTIDEGREES(21));
-        fakePitotSetAirspeed(airspeed * 100.0f);
+        state.baroPressure = (int32_t)roundf(barometer * 3386.39f);
+        state.baroTemperature = DEGREES_TO_CENTIDEGREES(21);
+        state.airSpeed = airspeed * 100.0f;
 
-        fakeBattSensorSetVbat(16.8f * 100);
+        state.vbat = 16.8f * 100;
 
         fpQuaternion_t quat;
         fpVector3_t north;
@@ -420,20 +410,15 @@ static void* listenWorker(void* arg)
         north.z = 0.0f;
         computeQuaternionFromRPY(&quat, roll_inav, pitch_inav, yaw_inav);
         transformVectorEarthToBody(&north, &quat);
-        fakeMagSet(
-            constrainToInt16(north.x * 16000.0f),
-            constrainToInt16(north.y * 16000.0f),
-            constrainToInt16(north.z * 16000.0f)
-        );
-
-        if (!initalized) {
-            ENABLE_ARMING_FLAG(SIMULATOR_MODE_SITL);
-            // Aircraft can wobble on the runway and prevents calibration of the accelerometer
-            ENABLE_STATE(ACCELEROMETER_CALIBRATED);
-            initalized = true;
-        }
+        state.mag[X] = constrainToInt16(north.x * 16000.0f);
+        state.mag[Y] = constrainToInt16(north.y * 16000.0f);
+        state.mag[Z] = constrainToInt16(north.z * 16000.0f);
+
+        // Aircraft can wobble on the runway and prevents calibration of the accelerometer
+        state.accelerometerCalibrated = true;
 
-        unlockMainPID();
+        simSensorStatePublish(&state);
+        initalized = true;
     }
 
     return NULL;
@@ -29,6 +29,7 @@
 #include <time.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
 #include <getopt.h>
 #include <errno.h>
 #include <time.h>
@@ -44,6 +45,7 @@
 #include "target.h"
 
 #include "fc/runtime_config.h"
+#include "common/maths.h"
 #include "common/utils.h"
 #include "scheduler/scheduler.h"
 #include "drivers/system.h"
@@ -62,7 +64,6 @@ uint32_t SystemCoreClock = 500 * 1e6; // fake 500 MHz;
 char _estack = 0 ;
 char _Min_Stack_Size = 0;
 
-static pthread_mutex_t mainLoopLock;
 static SitlSim_e sitlSim = SITL_SIM_NONE;
 static struct timespec start_time;
 static uint8_t pwmMapping[MAX_MOTORS + MAX_SERVOS];
@@ -71,14 +72,41 @@ static bool useImu = false;
 static char *simIp = NULL;
 static int simPort = 0;
 
+static SitlClock_e sitlClock = SITL_CLOCK_REALTIME;
+static timeDelta_t lockstepStepUs = SITL_LOCKSTEP_DEFAULT_STEP_US;
+static pthread_t mainThread;
+// Virtual clock, only advanced by the main thread
+static _Atomic timeUs_t virtualTimeUs;
+// Lockstep: the main thread may run up to this time, extended by every simulator frame
+static timeUs_t virtualTimeLimitUs;
+static pthread_mutex_t virtualClockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t virtualClockCond = PTHREAD_COND_INITIALIZER;
+
 static char **c_argv;
 
 void systemInit(void) {
 
     fprintf(stderr, "INAV %d.%d.%d SITL\n", FC_VERSION_MAJOR, FC_VERSION_MINOR, FC_VERSION_PATCH_LEVEL);
     clock_gettime(CLOCK_MONOTONIC, &start_time);
+    mainThread = pthread_self();
     fprintf(stderr, "[SYSTEM] Init...\n");
 
+    if (sitlClock == SITL_CLOCK_LOCKSTEP && sitlSim == SITL_SIM_NONE) {
+        fprintf(stderr, "[CLOCK] Lockstep requires a simulator, using virtual clock.\n");
+        sitlClock = SITL_CLOCK_VIRTUAL;
+    }
+
+    switch (sitlClock) {
+        case SITL_CLOCK_VIRTUAL:
+            fprintf(stderr, "[CLOCK] Virtual clock, running as fast as possible.\n");
+            break;
+        case SITL_CLOCK_LOCKSTEP:
+            fprintf(stderr, "[CLOCK] Lockstep, %dus per simulator frame.\n", (int)lockstepStepUs);
+            break;
+        default:
+            break;
+    }
+
 #if !defined(__FreeBSD__)  && !defined(__APPLE__)
     pthread_attr_t thAttr;
     int policy = 0;
@@ -89,11 +117,6 @@ void systemInit(void) {
     pthread_attr_destroy(&thAttr);
 #endif
 
-    if (pthread_mutex_init(&mainLoopLock, NULL) != 0) {
-        fprintf(stderr, "[SYSTEM] Unable to create mainLoop lock.\n");
-        exit(1);
-    }
-
     if (sitlSim != SITL_SIM_NONE) {
         fprintf(stderr, "[SIM] Waiting for connection...\n");
     }
@@ -174,6 +197,9 @@ void printCmdLineOptions(void)
     fprintf(stderr, "--simip=[ip]                         IP-Address oft the simulator host. If not specified localhost (127.0.0.1) is used.\n");
     fprintf(stderr, "--simport=[port]                     Port oft the simulator host.\n");
     fprintf(stderr, "--useimu                             Use IMU sensor data from the simulator instead of using attitude data from the simulator directly (experimental, not recommended).\n");
+    fprintf(stderr, "--clock=[realtime|virtual|lockstep]  Time source. realtime = wall clock (default), virtual = time only advances with the scheduler, as fast as the host can run,\n");
+    fprintf(stderr, "                                     lockstep = like virtual, but each simulator frame advances time by --simstep and the simulator waits for INAV.\n");
+    fprintf(stderr, "--simstep=[us]                       Virtual time per simulator frame in lockstep mode. Default: %d\n", SITL_LOCKSTEP_DEFAULT_STEP_US);
     fprintf(stderr, "--chanmap=[mapstring]                Channel mapping. Maps INAVs motor and servo PWM outputs to the virtual receiver output in the simulator.\n");
     fprintf(stderr, "                                     The mapstring has the following format: M(otor)|S(servo)<INAV-OUT>-<RECEIVER-OUT>,... All numbers must have two digits\n");
     fprintf(stderr, "                                     For example: Map motor 1 to virtal receiver output 1, servo 1 to output 2 and servo 2 to output 3:\n");
@@ -197,6 +223,8 @@ void parseArguments(int argc, char *argv[])
             {"simport", required_argument, 0, 'p'},
             {"help", no_argument, 0, 'h'},
             {"path", required_argument, 0, 'e'},
+            {"clock", required_argument, 0, 't'},
+            {"simstep", required_argument, 0, 'd'},
             {NULL, 0, NULL, 0}
         };
 
@@ -236,6 +264,24 @@ void parseArguments(int argc, char *argv[])
                     fprintf(stderr, "[EEPROM] Invalid path, using eeprom file in program directory\n.");
                 }
                 break;
+            case 't':
+                if (strcmp(optarg, "realtime") == 0) {
+                    sitlClock = SITL_CLOCK_REALTIME;
+                } else if (strcmp(optarg, "virtual") == 0) {
+                    sitlClock = SITL_CLOCK_VIRTUAL;
+                } else if (strcmp(optarg, "lockstep") == 0) {
+                    sitlClock = SITL_CLOCK_LOCKSTEP;
+                } else {
+                    fprintf(stderr, "[CLOCK] Unsupported clock %s.\n", optarg);
+                }
+                break;
+            case 'd':
+                lockstepStepUs = atoi(optarg);
+                if (lockstepStepUs <= 0) {
+                    fprintf(stderr, "[CLOCK] Invalid simulator step, using %dus.\n", SITL_LOCKSTEP_DEFAULT_STEP_US);
+                    lockstepStepUs = SITL_LOCKSTEP_DEFAULT_STEP_US;
+                }
+                break;
             case 'h':
                 printCmdLineOptions();
                 exit(0);
@@ -250,17 +296,70 @@ void parseArguments(int argc, char *argv[])
 }
 
 
-bool lockMainPID(void) {
-    return pthread_mutex_trylock(&mainLoopLock) == 0;
+static void virtualClockAdvance(timeUs_t us)
+{
+    const timeUs_t now = atomic_load_explicit(&virtualTimeUs, memory_order_relaxed) + us;
+    atomic_store_explicit(&virtualTimeUs, now, memory_order_release);
+
+    if (sitlClock == SITL_CLOCK_LOCKSTEP) {
+        pthread_mutex_lock(&virtualClockMutex);
+        if ((timeDelta_t)(now - virtualTimeLimitUs) >= 0) {
+            // Step consumed, let the simulator continue
+            pthread_cond_broadcast(&virtualClockCond);
+        }
+        pthread_mutex_unlock(&virtualClockMutex);
+    }
+}
+
+void sitlClockIdle(void)
+{
+    if (sitlClock == SITL_CLOCK_REALTIME) {
+        return;
+    }
+
+    const timeUs_t now = atomic_load_explicit(&virtualTimeUs, memory_order_relaxed);
+    // Every pass costs at least 1us, so polling loops always make progress
+    timeDelta_t advance = MAX(schedulerGetTimeUntilNextTask(now), 1);
+
+    if (sitlClock == SITL_CLOCK_LOCKSTEP) {
+        pthread_mutex_lock(&virtualClockMutex);
+        while ((timeDelta_t)(virtualTimeLimitUs - now) <= 0) {
+            pthread_cond_wait(&virtualClockCond, &virtualClockMutex);
+        }
+        advance = MIN(advance, (timeDelta_t)(virtualTimeLimitUs - now));
+        pthread_mutex_unlock(&virtualClockMutex);
+    }
+
+    schedulerAddIdleTime(advance);
+    virtualClockAdvance(advance);
 }
 
-void unlockMainPID(void)
+void sitlClockStep(void)
 {
-    pthread_mutex_unlock(&mainLoopLock);
+    if (sitlClock != SITL_CLOCK_LOCKSTEP) {
+        return;
+    }
+
+    pthread_mutex_lock(&virtualClockMutex);
+    const timeUs_t now = atomic_load(&virtualTimeUs);
+    // Startup delays may have run past the last step
+    if ((timeDelta_t)(virtualTimeLimitUs - now) < 0) {
+        virtualTimeLimitUs = now;
+    }
+    virtualTimeLimitUs += lockstepStepUs;
+    pthread_cond_broadcast(&virtualClockCond);
+    while ((timeDelta_t)(virtualTimeLimitUs - atomic_load(&virtualTimeUs)) > 0) {
+        pthread_cond_wait(&virtualClockCond, &virtualClockMutex);
+    }
+    pthread_mutex_unlock(&virtualClockMutex);
 }
 
 // Replacements for system functions
 timeUs_t micros(void) {
+    if (sitlClock != SITL_CLOCK_REALTIME) {
+        return atomic_load_explicit(&virtualTimeUs, memory_order_acquire);
+    }
+
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
 
@@ -278,6 +377,12 @@ uint32_t millis(void) {
 
 void delayMicroseconds(timeUs_t us)
 {
+    // Busy waits of the firmware are free with a virtual clock, other threads always sleep
+    if (sitlClock != SITL_CLOCK_REALTIME && pthread_equal(pthread_self(), mainThread)) {
+        virtualClockAdvance(us);
+        return;
+    }
+
     usleep(us);
 }
 
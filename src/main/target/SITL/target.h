@@ -187,10 +187,20 @@ typedef enum
     SITL_SIM_XPLANE,
 } SitlSim_e;
 
+typedef enum
+{
+    SITL_CLOCK_REALTIME,
+    SITL_CLOCK_VIRTUAL,
+    SITL_CLOCK_LOCKSTEP,
+} SitlClock_e;
+
+#define SITL_LOCKSTEP_DEFAULT_STEP_US 5000
+
 
 
-extern bool lockMainPID(void);
-extern void unlockMainPID(void);
+extern bool simSensorStateApply(void);
+extern void sitlClockIdle(void);
+extern void sitlClockStep(void);
 extern void parseArguments(int argc, char *argv[]);
 extern char *strnstr(const char *s, const char *find, size_t slen);
 extern int lookupAddress (char *, int, int, struct sockaddr *, socklen_t*);
@@ -29,6 +29,11 @@
 #define NOINLINE
 #endif
 
+#if defined(STM32F4)
+// Random CRC table reads often miss the small ART data cache and pay the flash wait states
+#define USE_CRC_TABLES_IN_FASTRAM
+#endif
+
 #define DYNAMIC_HEAP_SIZE   2048
 
 #define I2C1_OVERCLOCK false
@@ -59,6 +64,13 @@
 
 // This is the shortest period in microseconds that the scheduler will allow
 #define SCHEDULER_DELAY_LIMIT           10
+// Pick next task from deadline ordered heaps instead of scanning the whole task queue every cycle
+//#define USE_SCHEDULER_DEADLINE
+// Per task execution time, lateness and realtime blocking histograms (tasks histogram CLI and MSP2_INAV_TASK_HISTOGRAM).
+// Diagnostics only, left out of the F411 and F722 MCUs for the ~2KB of RAM they take
+#if (MCU_FLASH_SIZE > 512) || defined(SITL_BUILD)
+#define USE_SCHEDULER_HISTOGRAMS
+#endif
 
 #if defined(MAG_I2C_BUS) || defined(VCM5883_I2C_BUS)
 #define USE_MAG_VCM5883
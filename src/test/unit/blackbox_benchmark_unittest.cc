@@ -0,0 +1,409 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host side benchmark of the blackbox frame encoder.
+ *
+ * Links the real blackbox.c, blackbox_encoding.c and blackbox_io.c and
+ * logs into a serial port whose driver only copies into a sink buffer,
+ * so the numbers show the cost of encoding and handing bytes over to
+ * the device, not of the device itself. Flight state changes every
+ * iteration so P-frame deltas are not trivially zero.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_io.h"
+
+    #include "build/debug.h"
+    #include "build/version.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+    #include "config/parameter_group.h"
+
+    #include "drivers/serial.h"
+    #include "drivers/time.h"
+
+    #include "drivers/pwm_output.h"
+
+    #include "fc/config.h"
+    #include "fc/controlrate_profile.h"
+    #include "fc/fc_core.h"
+    #include "fc/rc_smoothing.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/servos.h"
+
+    #include "io/beeper.h"
+    #include "io/gps.h"
+
+    #include "navigation/navigation.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/diagnostics.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+    #include "sensors/temperature.h"
+
+    extern serialPort_t *blackboxPort;
+
+    void loadMainState(timeUs_t currentTimeUs);
+    void writeIntraframe(void);
+    void writeInterframe(void);
+    void blackboxLogIteration(timeUs_t currentTimeUs);
+    void blackboxAdvanceIterationTimers(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_LOOPTIME_US       500     // 2kHz logging
+#define BENCHMARK_ITERATIONS        200000
+#define BENCHMARK_MOTOR_COUNT       4
+#define BENCHMARK_SINK_SIZE         4096    // Power of two
+
+static uint8_t sink[BENCHMARK_SINK_SIZE];
+static uint32_t sinkBytes;
+static timeUs_t benchmarkTimeUs;
+
+static void sinkWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    sink[sinkBytes++ & (BENCHMARK_SINK_SIZE - 1)] = ch;
+}
+
+static void sinkWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    UNUSED(instance);
+    const uint8_t *bytes = (const uint8_t *)data;
+    while (count > 0) {
+        const uint32_t offset = sinkBytes & (BENCHMARK_SINK_SIZE - 1);
+        const int chunk = MIN(count, (int)(BENCHMARK_SINK_SIZE - offset));
+        memcpy(&sink[offset], bytes, chunk);
+        sinkBytes += chunk;
+        bytes += chunk;
+        count -= chunk;
+    }
+}
+
+static uint32_t sinkTxBytesFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return BENCHMARK_SINK_SIZE;
+}
+
+static bool sinkIsTxBufferEmpty(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return true;
+}
+
+static const struct serialPortVTable sinkVTable = {
+    .serialWrite = sinkWrite,
+    .serialTotalRxWaiting = NULL,
+    .serialTotalTxFree = sinkTxBytesFree,
+    .serialRead = NULL,
+    .readBuf = NULL,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = sinkIsTxBufferEmpty,
+    .setMode = NULL,
+    .writeBuf = sinkWriteBuf,
+    .isConnected = NULL,
+    .isIdle = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+};
+
+static serialPort_t sinkPort;
+
+static float sineTable[256];
+static uint8_t phase;
+
+static void initFlightState(void)
+{
+    for (unsigned i = 0; i < ARRAYLEN(sineTable); i++) {
+        sineTable[i] = sinf(2.0f * M_PIf * i / ARRAYLEN(sineTable));
+    }
+    phase = 0;
+    benchmarkTimeUs = 0;
+}
+
+static float wave(unsigned multiplier, unsigned offset)
+{
+    return sineTable[(uint8_t)(phase * multiplier + offset * 64)];
+}
+
+/*
+ * Moves every logged value a little each loop, roughly like a quad in
+ * forward flight with some vibration. Table driven so that producing the
+ * state costs little next to logging it.
+ */
+static void updateFlightState(void)
+{
+    static uint32_t seed = 0x1234567;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        seed = seed * 1664525 + 1013904223;
+        const float noise = ((int32_t)(seed >> 16) - 32768) / 32768.0f;
+
+        gyro.gyroADCf[axis] = 40.0f * wave(3, axis) + 8.0f * noise;
+        gyro.gyroRaw[axis] = gyro.gyroADCf[axis] + 20.0f * noise;
+        acc.accADCf[axis] = (axis == Z ? 1.0f : 0.0f) + 0.05f * noise;
+        axisPID_Setpoint[axis] = 30.0f * wave(3, axis);
+        axisPID_P[axis] = 0.5f * (axisPID_Setpoint[axis] - gyro.gyroADCf[axis]);
+        axisPID_I[axis] = 10.0f * wave(1, axis);
+        axisPID_D[axis] = 4.0f * noise;
+        axisPID_F[axis] = 0.2f * axisPID_Setpoint[axis];
+    }
+
+    attitude.values.roll = 100.0f * wave(1, 0);
+    attitude.values.pitch = -80.0f + 20.0f * wave(1, 1);
+    attitude.values.yaw = 1800.0f + 1800.0f * wave(1, 2);
+
+    for (int i = 0; i < 4; i++) {
+        rcCommand[i] = 100.0f * wave(1, i);
+    }
+    rcCommand[THROTTLE] = 1400 + rcCommand[THROTTLE];
+
+    for (int i = 0; i < BENCHMARK_MOTOR_COUNT; i++) {
+        seed = seed * 1664525 + 1013904223;
+        motor[i] = 1400 + 150.0f * wave(3, i) + (int16_t)(seed >> 28);
+    }
+
+    phase++;
+    benchmarkTimeUs += BENCHMARK_LOOPTIME_US;
+}
+
+static double benchmarkNsPerIteration(const std::function<void(void)> &fn)
+{
+    // Warm up caches
+    for (int i = 0; i < BENCHMARK_ITERATIONS / 10; i++) {
+        fn();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / BENCHMARK_ITERATIONS;
+}
+
+static void printResult(const char *name, double nsPerIteration, uint32_t bytes)
+{
+    const double bytesPerIteration = (double)bytes / (BENCHMARK_ITERATIONS + BENCHMARK_ITERATIONS / 10);
+
+    std::cout << "  " << std::left << std::setw(24) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << nsPerIteration << " ns/frame"
+              << std::setw(8) << std::setprecision(1) << bytesPerIteration << " B/frame"
+              << std::setw(8) << std::setprecision(1) << bytesPerIteration * 1000.0 / nsPerIteration << " B/us" << std::endl;
+}
+
+class BlackboxBenchmark : public ::testing::Test
+{
+protected:
+    virtual void SetUp() {
+        memset(&sinkPort, 0, sizeof(sinkPort));
+        sinkPort.vTable = &sinkVTable;
+        blackboxPort = &sinkPort;
+
+        gyroConfigMutable()->looptime = BENCHMARK_LOOPTIME_US;
+
+        blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+        blackboxConfigMutable()->rate_num = 1;
+        blackboxConfigMutable()->rate_denom = 1;
+        blackboxConfigMutable()->includeFlags = BLACKBOX_FEATURE_NAV_PID | BLACKBOX_FEATURE_NAV_POS | BLACKBOX_FEATURE_ACC
+            | BLACKBOX_FEATURE_ATTITUDE | BLACKBOX_FEATURE_RC_DATA | BLACKBOX_FEATURE_RC_COMMAND | BLACKBOX_FEATURE_MOTORS
+            | BLACKBOX_FEATURE_GYRO_RAW;
+
+        initFlightState();
+        updateFlightState();
+
+        blackboxInit();
+        blackboxStart();
+    }
+};
+
+TEST_F(BlackboxBenchmark, Frames)
+{
+    std::cout << "Blackbox frame encoding (" << BENCHMARK_ITERATIONS << " frames):" << std::endl;
+
+    sinkBytes = 0;
+    const double intraNs = benchmarkNsPerIteration([] {
+        updateFlightState();
+        loadMainState(benchmarkTimeUs);
+        writeIntraframe();
+        blackboxDeviceFlush();
+    });
+    const uint32_t intraBytes = sinkBytes;
+    printResult("writeIntraframe", intraNs, intraBytes);
+
+    sinkBytes = 0;
+    const double interNs = benchmarkNsPerIteration([] {
+        updateFlightState();
+        loadMainState(benchmarkTimeUs);
+        writeInterframe();
+        blackboxDeviceFlush();
+    });
+    const uint32_t interBytes = sinkBytes;
+    printResult("writeInterframe", interNs, interBytes);
+
+    sinkBytes = 0;
+    const double iterationNs = benchmarkNsPerIteration([] {
+        updateFlightState();
+        blackboxLogIteration(benchmarkTimeUs);
+        blackboxAdvanceIterationTimers();
+    });
+    printResult("blackboxLogIteration", iterationNs, sinkBytes);
+
+    // The decoder needs a frame marker and at least a few bytes of payload
+    EXPECT_GT(intraBytes, interBytes);
+    EXPECT_GT(interBytes / (BENCHMARK_ITERATIONS + BENCHMARK_ITERATIONS / 10), 8U);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t stateFlags;
+int16_t rcCommand[4];
+uint8_t detectedSensors[SENSOR_INDEX_COUNT];
+attitudeEulerAngles_t attitude;
+acc_t acc;
+baro_t baro;
+gyro_t gyro;
+mag_t mag;
+int16_t motor[MAX_SUPPORTED_MOTORS];
+int16_t servo[MAX_SUPPORTED_SERVOS];
+int32_t axisPID_P[FLIGHT_DYNAMICS_INDEX_COUNT], axisPID_I[FLIGHT_DYNAMICS_INDEX_COUNT], axisPID_D[FLIGHT_DYNAMICS_INDEX_COUNT];
+int32_t axisPID_F[FLIGHT_DYNAMICS_INDEX_COUNT], axisPID_Setpoint[FLIGHT_DYNAMICS_INDEX_COUNT];
+int32_t debug[DEBUG32_VALUE_COUNT];
+uint8_t debugMode;
+gpsSolutionData_t gpsSol;
+gpsLocation_t GPS_home;
+boxBitmask_t rcModeActivationMask;
+
+int16_t navCurrentState;
+int16_t navActualVelocity[3];
+int16_t navDesiredVelocity[3];
+int32_t navTargetPosition[3];
+int32_t navLatestActualPosition[3];
+int16_t navActualSurface;
+uint16_t navFlags;
+uint16_t navEPH;
+uint16_t navEPV;
+int16_t navAccNEU[3];
+
+const char* const buildDate = "Jan  1 2000";
+const char* const buildTime = "00:00:00";
+const char* const shortGitRevision = "MASTER";
+const char* const targetName = "BENCHMARK";
+
+static pidProfile_t benchmarkPidProfile;
+pidProfile_t *pidProfile_ProfileCurrent = &benchmarkPidProfile;
+const controlRateConfig_t *currentControlRateProfile;
+accelerometerConfig_t accelerometerConfig_System;
+barometerConfig_t barometerConfig_System;
+batteryMetersConfig_t batteryMetersConfig_System;
+compassConfig_t compassConfig_System;
+featureConfig_t featureConfig_System;
+gyroConfig_t gyroConfig_System;
+motorConfig_t motorConfig_System;
+rcControlsConfig_t rcControlsConfig_System;
+rxConfig_t rxConfig_System;
+systemConfig_t systemConfig_System;
+
+static navigationPIDControllers_t navPids;
+const navigationPIDControllers_t *getNavigationPIDControllers(void) { return &navPids; }
+const pidBank_t *pidBank(void) { return &benchmarkPidProfile.bank_mc; }
+
+timeMs_t millis(void) { return benchmarkTimeUs / 1000; }
+uint32_t getLooptime(void) { return BENCHMARK_LOOPTIME_US; }
+
+bool blackboxDeviceOpen(void) { return true; }
+void blackboxDeviceClose(void) {}
+
+bool feature(uint32_t mask) { return mask == FEATURE_BLACKBOX; }
+bool sensors(uint32_t) { return false; }
+bool IS_RC_MODE_ACTIVE(boxId_e) { return false; }
+bool isModeActivationConditionPresent(boxId_e) { return false; }
+failsafePhase_e failsafePhase(void) { return FAILSAFE_IDLE; }
+disarmReason_t getDisarmReason(void) { return DISARM_NONE; }
+uint32_t getArmingBeepTimeMicros(void) { return 0; }
+
+uint8_t getMotorCount(void) { return BENCHMARK_MOTOR_COUNT; }
+bool isMixerUsingServos(void) { return false; }
+int getThrottleIdleValue(void) { return 1150; }
+uint32_t getEscUpdateFrequency(void) { return 400; }
+uint16_t getRcUpdateFrequency(void) { return 50; }
+
+int16_t rxGetChannelValue(unsigned channel) { return 1500 + rcCommand[channel % 4]; }
+bool rxAreFlightChannelsValid(void) { return true; }
+bool rxIsReceivingSignal(void) { return true; }
+uint16_t getRSSI(void) { return 1023; }
+rssiSource_e getRSSISource(void) { return RSSI_SOURCE_NONE; }
+
+int16_t getAmperage(void) { return 1000; }
+uint16_t getBatteryRawVoltage(void) { return 1600; }
+uint16_t getBatterySagCompensatedVoltage(void) { return 1600; }
+uint16_t getPowerSupplyImpedance(void) { return 0; }
+bool getBaroTemperature(int16_t *) { return false; }
+bool getIMUTemperature(int16_t *) { return false; }
+
+hardwareSensorStatus_e getHwAccelerometerStatus(void) { return HW_SENSOR_OK; }
+hardwareSensorStatus_e getHwBarometerStatus(void) { return HW_SENSOR_NONE; }
+hardwareSensorStatus_e getHwCompassStatus(void) { return HW_SENSOR_NONE; }
+hardwareSensorStatus_e getHwGPSStatus(void) { return HW_SENSOR_NONE; }
+hardwareSensorStatus_e getHwGyroStatus(void) { return HW_SENSOR_OK; }
+hardwareSensorStatus_e getHwPitotmeterStatus(void) { return HW_SENSOR_NONE; }
+hardwareSensorStatus_e getHwRangefinderStatus(void) { return HW_SENSOR_NONE; }
+
+int getWaypointCount(void) { return 0; }
+bool isWaypointListValid(void) { return false; }
+
+bool rtcGetDateTime(dateTime_t *) { return false; }
+bool dateTimeFormatLocal(char *buf, dateTime_t *) { buf[0] = '\0'; return false; }
+}
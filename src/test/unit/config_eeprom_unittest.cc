@@ -0,0 +1,299 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that saves append the changed PGs to the config store, compact it
+ * when it's full and that the config reloads after each save, using a fake
+ * streamer that erases pages as it enters them like the flash ones do.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/config_eeprom.h"
+    #include "config/config_streamer.h"
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "drivers/system.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FAKE_PAGE_SIZE          256
+
+// Sized so a full copy of the config fills the first page exactly:
+// header, generation record, records, footer and checksum
+static uint8_t pgSystem[20];
+static uint8_t pgProfile[3][10];
+static uint8_t pgLarge[163];
+
+#define FULL_COPY_SIZE          FAKE_PAGE_SIZE
+#define RECORD_SIZE(pgSize)     (6 + (pgSize))
+// Segments hold records, footer and checksum and start at a streamer word
+#define SEGMENT_SIZE(recordsSize)   ((recordsSize) + 4)
+#define ALIGN_TO_WORD(offset)   (((offset) + CONFIG_STREAMER_BUFFER_SIZE - 1) / CONFIG_STREAMER_BUFFER_SIZE * CONFIG_STREAMER_BUFFER_SIZE)
+
+extern "C" {
+const pgRegistry_t testPgRegistry[] __attribute__ ((section("pg_registry"), used, aligned(4))) = {
+    { .pgn = PG_RESERVED_FOR_TESTING_1, .size = sizeof(pgSystem) | PGR_SIZE_SYSTEM_FLAG, .address = pgSystem, .copy = NULL, .ptr = NULL, .reset = { .ptr = NULL } },
+    { .pgn = PG_RESERVED_FOR_TESTING_2, .size = sizeof(pgProfile[0]) | PGR_SIZE_PROFILE_FLAG, .address = pgProfile[0], .copy = NULL, .ptr = NULL, .reset = { .ptr = NULL } },
+    { .pgn = PG_RESERVED_FOR_TESTING_3, .size = sizeof(pgLarge) | PGR_SIZE_SYSTEM_FLAG, .address = pgLarge, .copy = NULL, .ptr = NULL, .reset = { .ptr = NULL } },
+};
+}
+
+static int fullCopyWrites;
+static int wordsWritten;
+
+static void resetConfigArea(void)
+{
+    memset(eepromData, CONFIG_STREAMER_ERASED_BYTE, sizeof(eepromData));
+    memset(pgSystem, 1, sizeof(pgSystem));
+    memset(pgProfile, 2, sizeof(pgProfile));
+    memset(pgLarge, 3, sizeof(pgLarge));
+    fullCopyWrites = 0;
+    wordsWritten = 0;
+}
+
+// Clears the PGs and loads them back, they must come back as they were
+static void expectConfigReloads(void)
+{
+    uint8_t system[sizeof(pgSystem)];
+    uint8_t profile[sizeof(pgProfile)];
+    uint8_t large[sizeof(pgLarge)];
+    memcpy(system, pgSystem, sizeof(system));
+    memcpy(profile, pgProfile, sizeof(profile));
+    memcpy(large, pgLarge, sizeof(large));
+
+    memset(pgSystem, 0xAA, sizeof(pgSystem));
+    memset(pgProfile, 0xAA, sizeof(pgProfile));
+    memset(pgLarge, 0xAA, sizeof(pgLarge));
+
+    EXPECT_TRUE(isEEPROMContentValid());
+    EXPECT_TRUE(loadEEPROM());
+    EXPECT_EQ(0, memcmp(system, pgSystem, sizeof(system)));
+    EXPECT_EQ(0, memcmp(profile, pgProfile, sizeof(profile)));
+    EXPECT_EQ(0, memcmp(large, pgLarge, sizeof(large)));
+}
+
+// Leaves the start of a record behind, like an append cut short
+static void writePartialSegment(void)
+{
+    const uint8_t partialRecord[] = { RECORD_SIZE(sizeof(pgSystem)), 0, PG_RESERVED_FOR_TESTING_1 & 0xFF, PG_RESERVED_FOR_TESTING_1 >> 8, 0, 0, 0x55, 0x55 };
+    memcpy(&eepromData[ALIGN_TO_WORD(getEEPROMConfigSize())], partialRecord, sizeof(partialRecord));
+}
+
+TEST(ConfigEepromTest, SaveAppendsChangedPgs)
+{
+    resetConfigArea();
+
+    // The first save writes a full copy
+    writeConfigToEEPROM();
+    EXPECT_EQ(1, fullCopyWrites);
+    EXPECT_EQ(FULL_COPY_SIZE, getEEPROMConfigSize());
+    expectConfigReloads();
+
+    // Later ones append the changed PG instances only
+    pgSystem[5] = 42;
+    pgProfile[1][3] = 43;
+    writeConfigToEEPROM();
+    EXPECT_EQ(1, fullCopyWrites);
+    EXPECT_EQ(FULL_COPY_SIZE + SEGMENT_SIZE(RECORD_SIZE(sizeof(pgSystem)) + RECORD_SIZE(sizeof(pgProfile[1]))), getEEPROMConfigSize());
+    expectConfigReloads();
+
+    pgProfile[1][3] = 44;
+    writeConfigToEEPROM();
+    EXPECT_EQ(1, fullCopyWrites);
+    expectConfigReloads();
+    EXPECT_EQ(44, pgProfile[1][3]);
+    EXPECT_EQ(2, pgProfile[0][3]);
+}
+
+TEST(ConfigEepromTest, UnchangedSaveWritesNothing)
+{
+    resetConfigArea();
+    writeConfigToEEPROM();
+    pgLarge[0] = 7;
+    writeConfigToEEPROM();
+
+    const int words = wordsWritten;
+    const uint16_t size = getEEPROMConfigSize();
+    writeConfigToEEPROM();
+    EXPECT_EQ(words, wordsWritten);
+    EXPECT_EQ(size, getEEPROMConfigSize());
+    expectConfigReloads();
+}
+
+TEST(ConfigEepromTest, FullStoreIsCompacted)
+{
+    resetConfigArea();
+    writeConfigToEEPROM();
+
+    // Append segments until the next one doesn't fit
+    int appends = 0;
+    while (ALIGN_TO_WORD(getEEPROMConfigSize()) + ALIGN_TO_WORD(SEGMENT_SIZE(RECORD_SIZE(sizeof(pgLarge)))) <= EEPROM_SIZE) {
+        pgLarge[appends]++;
+        writeConfigToEEPROM();
+        EXPECT_EQ(1, fullCopyWrites);
+        expectConfigReloads();
+        appends++;
+    }
+    EXPECT_GT(appends, 1);
+
+    pgLarge[appends]++;
+    writeConfigToEEPROM();
+    EXPECT_EQ(2, fullCopyWrites);
+    EXPECT_EQ(FULL_COPY_SIZE, getEEPROMConfigSize());
+    expectConfigReloads();
+
+    // And appends start over after the new copy
+    pgSystem[0] = 9;
+    writeConfigToEEPROM();
+    EXPECT_EQ(2, fullCopyWrites);
+    EXPECT_GT(getEEPROMConfigSize(), FULL_COPY_SIZE);
+    expectConfigReloads();
+}
+
+TEST(ConfigEepromTest, InterruptedAppendIsIgnored)
+{
+    resetConfigArea();
+    writeConfigToEEPROM();
+    pgSystem[1] = 11;
+    writeConfigToEEPROM();
+
+    // What an append cut short left behind doesn't load
+    writePartialSegment();
+    const uint16_t size = getEEPROMConfigSize();
+    expectConfigReloads();
+    EXPECT_EQ(size, getEEPROMConfigSize());
+    EXPECT_EQ(11, pgSystem[1]);
+    EXPECT_EQ(1, pgSystem[2]);
+
+    // The next save can't append over it and writes a full copy
+    pgSystem[2] = 12;
+    writeConfigToEEPROM();
+    EXPECT_EQ(2, fullCopyWrites);
+    EXPECT_EQ(FULL_COPY_SIZE, getEEPROMConfigSize());
+    expectConfigReloads();
+}
+
+TEST(ConfigEepromTest, OlderGenerationSegmentIsNotLoaded)
+{
+    resetConfigArea();
+    writeConfigToEEPROM();
+
+    // A segment appended to the first full copy, at the start of the second page
+    pgSystem[3] = 33;
+    writeConfigToEEPROM();
+    EXPECT_EQ(FULL_COPY_SIZE + SEGMENT_SIZE(RECORD_SIZE(sizeof(pgSystem))), getEEPROMConfigSize());
+
+    // Back to the content of the first copy, written as a new full copy. It
+    // ends at the same page boundary and leaves the second page as it was.
+    pgSystem[3] = 1;
+    writePartialSegment();
+    writeConfigToEEPROM();
+    EXPECT_EQ(2, fullCopyWrites);
+    EXPECT_EQ(RECORD_SIZE(sizeof(pgSystem)), eepromData[FULL_COPY_SIZE]);
+
+    // The segment left over from the first copy must not load
+    EXPECT_EQ(FULL_COPY_SIZE, getEEPROMConfigSize());
+    expectConfigReloads();
+    EXPECT_EQ(1, pgSystem[3]);
+
+    // Appending over it erases the page, no full copy is needed
+    pgProfile[2][0] = 34;
+    writeConfigToEEPROM();
+    EXPECT_EQ(2, fullCopyWrites);
+    EXPECT_EQ(FULL_COPY_SIZE + SEGMENT_SIZE(RECORD_SIZE(sizeof(pgProfile[2]))), getEEPROMConfigSize());
+    expectConfigReloads();
+    EXPECT_EQ(34, pgProfile[2][0]);
+    EXPECT_EQ(1, pgSystem[3]);
+}
+
+// STUBS
+
+extern "C" {
+
+void failureMode(failureMode_e mode)
+{
+    ADD_FAILURE() << "failureMode(" << mode << ")";
+}
+
+void config_streamer_impl_unlock(void) {}
+void config_streamer_impl_lock(void) {}
+
+bool config_streamer_impl_is_page_start(uintptr_t address)
+{
+    return (address - (uintptr_t)eepromData) % FAKE_PAGE_SIZE == 0;
+}
+
+int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
+{
+    const uintptr_t offset = c->address - (uintptr_t)eepromData;
+    EXPECT_LE(offset + CONFIG_STREAMER_BUFFER_SIZE, sizeof(eepromData));
+
+    if (config_streamer_impl_is_page_start(c->address)) {
+        memset(&eepromData[offset], CONFIG_STREAMER_ERASED_BYTE, FAKE_PAGE_SIZE);
+    }
+    if (offset == 0) {
+        fullCopyWrites++;
+    }
+
+    // Flash is only programmed where it's erased
+    for (int ii = 0; ii < CONFIG_STREAMER_BUFFER_SIZE; ii++) {
+        EXPECT_EQ(CONFIG_STREAMER_ERASED_BYTE, eepromData[offset + ii]);
+    }
+    memcpy(&eepromData[offset], buffer, CONFIG_STREAMER_BUFFER_SIZE);
+    wordsWritten++;
+
+    c->address += CONFIG_STREAMER_BUFFER_SIZE;
+    return 0;
+}
+
+const pgRegistry_t *pgFind(pgn_t pgn)
+{
+    for (unsigned ii = 0; ii < ARRAYLEN(testPgRegistry); ii++) {
+        if (pgN(&testPgRegistry[ii]) == pgn) {
+            return &testPgRegistry[ii];
+        }
+    }
+    return NULL;
+}
+
+void pgReset(const pgRegistry_t *reg, int profileIndex)
+{
+    memset(reg->address + pgSize(reg) * profileIndex, 0, pgSize(reg));
+}
+
+void pgLoad(const pgRegistry_t *reg, int profileIndex, const void *from, int size, int version)
+{
+    pgReset(reg, profileIndex);
+    if (version == pgVersion(reg)) {
+        memcpy(reg->address + pgSize(reg) * profileIndex, from, MIN(size, pgSize(reg)));
+    }
+}
+
+}
@@ -0,0 +1,223 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks the table driven CRCs against the bit by bit implementations they
+ * replaced and measures both on a host.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/crc.h"
+    #include "common/streambuf.h"
+    #include "common/utils.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_BUFFER_SIZE   4096
+#define BENCHMARK_ITERATIONS    2000
+
+static uint16_t referenceCrc16Ccitt(uint16_t crc, uint8_t a)
+{
+    crc ^= (uint16_t)a << 8;
+    for (int ii = 0; ii < 8; ++ii) {
+        if (crc & 0x8000) {
+            crc = (crc << 1) ^ 0x1021;
+        } else {
+            crc = crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t referenceCrc8Poly(uint8_t crc, uint8_t a, uint8_t poly)
+{
+    crc ^= a;
+    for (int ii = 0; ii < 8; ++ii) {
+        if (crc & 0x80) {
+            crc = (crc << 1) ^ poly;
+        } else {
+            crc = crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t referenceCrc8DvbS2(uint8_t crc, uint8_t a)
+{
+    return referenceCrc8Poly(crc, a, 0xD5);
+}
+
+static uint8_t referenceCrc8(uint8_t crc, uint8_t a)
+{
+    return referenceCrc8Poly(crc, a, 0x07);
+}
+
+template <typename T, typename F>
+static T referenceUpdate(T crc, const uint8_t *data, uint32_t length, F step)
+{
+    for (uint32_t ii = 0; ii < length; ii++) {
+        crc = step(crc, data[ii]);
+    }
+    return crc;
+}
+
+static void fillPseudoRandom(uint8_t *buf, size_t size, uint32_t seed)
+{
+    for (size_t ii = 0; ii < size; ii++) {
+        seed = seed * 1103515245 + 12345;
+        buf[ii] = seed >> 16;
+    }
+}
+
+class CrcTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp() {
+        crcInit();
+    }
+};
+
+TEST_F(CrcTest, CheckValues)
+{
+    const uint8_t check[] = "123456789";
+    const uint32_t length = sizeof(check) - 1;
+
+    EXPECT_EQ(0x31C3, crc16_ccitt_update(0, check, length));    // CRC-16/XMODEM
+    EXPECT_EQ(0xBC, crc8_dvb_s2_update(0, check, length));      // CRC-8/DVB-S2
+    EXPECT_EQ(0xF4, crc8_update(0, check, length));             // CRC-8/SMBUS
+}
+
+TEST_F(CrcTest, SingleByteMatchesBitwiseForAllStates)
+{
+    for (int a = 0; a < 256; a++) {
+        for (int crc = 0; crc < 65536; crc++) {
+            ASSERT_EQ(referenceCrc16Ccitt(crc, a), crc16_ccitt(crc, a)) << "crc " << crc << " byte " << a;
+        }
+        for (int crc = 0; crc < 256; crc++) {
+            ASSERT_EQ(referenceCrc8DvbS2(crc, a), crc8_dvb_s2(crc, a)) << "crc " << crc << " byte " << a;
+            ASSERT_EQ(referenceCrc8(crc, a), crc8(crc, a)) << "crc " << crc << " byte " << a;
+        }
+    }
+}
+
+TEST_F(CrcTest, UpdateMatchesBitwise)
+{
+    uint8_t buf[600];
+    fillPseudoRandom(buf, sizeof(buf), 42);
+
+    // Every length and alignment up to a few hundred bytes, seeded with a running CRC
+    uint16_t seed16 = 0xFFFF;
+    uint8_t seed8 = 0x5A;
+    for (uint32_t offset = 0; offset < 8; offset++) {
+        for (uint32_t length = 0; length + offset <= sizeof(buf); length += 7) {
+            const uint8_t *data = buf + offset;
+
+            const uint16_t crc16 = crc16_ccitt_update(seed16, data, length);
+            ASSERT_EQ(referenceUpdate<uint16_t>(seed16, data, length, referenceCrc16Ccitt), crc16);
+            ASSERT_EQ(referenceUpdate<uint8_t>(seed8, data, length, referenceCrc8DvbS2), crc8_dvb_s2_update(seed8, data, length));
+            ASSERT_EQ(referenceUpdate<uint8_t>(seed8, data, length, referenceCrc8), crc8_update(seed8, data, length));
+
+            seed16 = crc16;
+            seed8 = crc16 >> 8;
+        }
+    }
+}
+
+TEST_F(CrcTest, SbufAppendMatchesBitwise)
+{
+    uint8_t buf[64];
+    sbuf_t sbuf;
+
+    sbuf.ptr = buf;
+    sbuf.end = ARRAYEND(buf);
+    for (int ii = 0; ii < 32; ii++) {
+        sbufWriteU8(&sbuf, ii * 37);
+    }
+    crc16_ccitt_sbuf_append(&sbuf, buf);
+    const uint16_t crc16 = buf[32] | (buf[33] << 8);
+    EXPECT_EQ(referenceUpdate<uint16_t>(0, buf, 32, referenceCrc16Ccitt), crc16);
+
+    sbuf.ptr = buf + 32;
+    crc8_dvb_s2_sbuf_append(&sbuf, buf);
+    EXPECT_EQ(referenceUpdate<uint8_t>(0, buf, 32, referenceCrc8DvbS2), buf[32]);
+}
+
+static double benchmarkNsPerByte(const std::function<void(void)> &fn)
+{
+    // Warm up caches
+    for (int i = 0; i < BENCHMARK_ITERATIONS / 10; i++) {
+        fn();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((double)BENCHMARK_ITERATIONS * BENCHMARK_BUFFER_SIZE);
+}
+
+static void printResult(const char *name, double bitwiseNs, double tableNs)
+{
+    std::cout << "  " << std::left << std::setw(16) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << bitwiseNs << " ns/B bitwise"
+              << std::setw(8) << tableNs << " ns/B table"
+              << std::setw(8) << std::setprecision(1) << bitwiseNs / tableNs << "x" << std::endl;
+}
+
+TEST_F(CrcTest, Benchmark)
+{
+    static uint8_t buf[BENCHMARK_BUFFER_SIZE];
+    fillPseudoRandom(buf, sizeof(buf), 7);
+
+    // Results go through a volatile so the loops can't be dropped
+    static volatile uint32_t sink;
+
+    std::cout << "CRC over " << BENCHMARK_BUFFER_SIZE << " byte buffers:" << std::endl;
+
+    const double crc16BitwiseNs = benchmarkNsPerByte([] { sink = referenceUpdate<uint16_t>(sink, buf, sizeof(buf), referenceCrc16Ccitt); });
+    const double crc16TableNs = benchmarkNsPerByte([] { sink = crc16_ccitt_update(sink, buf, sizeof(buf)); });
+    printResult("crc16_ccitt", crc16BitwiseNs, crc16TableNs);
+
+    const double dvbBitwiseNs = benchmarkNsPerByte([] { sink = referenceUpdate<uint8_t>(sink, buf, sizeof(buf), referenceCrc8DvbS2); });
+    const double dvbTableNs = benchmarkNsPerByte([] { sink = crc8_dvb_s2_update(sink, buf, sizeof(buf)); });
+    printResult("crc8_dvb_s2", dvbBitwiseNs, dvbTableNs);
+
+    const double crc8BitwiseNs = benchmarkNsPerByte([] { sink = referenceUpdate<uint8_t>(sink, buf, sizeof(buf), referenceCrc8); });
+    const double crc8TableNs = benchmarkNsPerByte([] { sink = crc8_update(sink, buf, sizeof(buf)); });
+    printResult("crc8", crc8BitwiseNs, crc8TableNs);
+
+    EXPECT_LT(crc16TableNs, crc16BitwiseNs);
+    EXPECT_LT(dvbTableNs, dvbBitwiseNs);
+    EXPECT_LT(crc8TableNs, crc8BitwiseNs);
+}
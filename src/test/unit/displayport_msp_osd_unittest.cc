@@ -0,0 +1,430 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drives the MSP displayport with recorded OSD layouts over a simulated
+ * bandwidth limited link. Every MSP frame is decoded into a fake VTX
+ * canvas, so the tests check both the bytes sent per frame and that the
+ * VTX ends up showing what the OSD drew.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "config/parameter_group_ids.h"
+
+    #include "drivers/display.h"
+    #include "drivers/osd_symbols.h"
+    #include "drivers/time.h"
+
+    #include "fc/rc_modes.h"
+
+    #include "io/displayport_msp.h"
+    #include "io/displayport_msp_osd.h"
+    #include "io/osd.h"
+    #include "io/serial.h"
+
+    #include "msp/msp.h"
+    #include "msp/msp_protocol.h"
+    #include "msp/msp_serial.h"
+
+    PG_REGISTER(osdConfig_t, osdConfig, PG_OSD_CONFIG, 0);
+    PG_REGISTER(osdLayoutsConfig_t, osdLayoutsConfig, PG_OSD_LAYOUTS_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define MSP_V1_FRAME_OVERHEAD 6
+#define DRAW_CALLS_PER_FRAME 4  // drawScreen() only sends every 4th call
+#define FRAME_MS 16
+
+#define VTX_ROWS 22
+#define VTX_COLS 60
+
+static timeMs_t simulatedMillis;
+
+static uint16_t vtxCanvas[VTX_ROWS][VTX_COLS];
+static uint16_t vtxDisplayed[VTX_ROWS][VTX_COLS];
+
+static int linkBytesFree;
+static int frameBytes;
+static int writeStringCount;
+static int clearScreenCount;
+static int droppedFrames;
+
+static void vtxClear(void)
+{
+    for (int row = 0; row < VTX_ROWS; row++) {
+        for (int col = 0; col < VTX_COLS; col++) {
+            vtxCanvas[row][col] = SYM_BLANK;
+        }
+    }
+}
+
+static void vtxDecode(const uint8_t *data, int len)
+{
+    switch (data[0]) {
+    case MSP_DP_CLEAR_SCREEN:
+        vtxClear();
+        clearScreenCount++;
+        break;
+    case MSP_DP_WRITE_STRING:
+        {
+            const uint8_t row = data[1];
+            const uint8_t col = data[2];
+            const uint16_t page = (data[3] & (1 << DISPLAYPORT_MSP_ATTR_FONTPAGE)) ? 0x100 : 0;
+            for (int ii = 4; ii < len; ii++) {
+                vtxCanvas[row][col + ii - 4] = data[ii] | page;
+            }
+            writeStringCount++;
+        }
+        break;
+    case MSP_DP_DRAW_SCREEN:
+        memcpy(vtxDisplayed, vtxCanvas, sizeof(vtxCanvas));
+        break;
+    default:
+        break;
+    }
+}
+
+static mspResult_e vtxRequest(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    UNUSED(cmd);
+    UNUSED(reply);
+    UNUSED(mspPostProcessFn);
+    return MSP_RESULT_ACK;
+}
+
+typedef struct recordedElement_s {
+    uint8_t row;
+    uint8_t col;
+    const char *format;
+    int step;   // Value change per frame, 0 for static text
+} recordedElement_t;
+
+// Elements and positions taken from an analog PAL layout and from a DJI
+// HD layout, values change at typical rates.
+static const recordedElement_t palLayout[] = {
+    { 1,  1,  "\x06%2d",       1 },   // RSSI
+    { 1,  23, "%3d.%dV",       1 },   // Battery
+    { 2,  1,  "%4d.%dA",       3 },   // Current
+    { 12, 1,  "\x76%4d",       7 },   // Altitude
+    { 12, 23, "%3d\x1e",       2 },   // Speed
+    { 14, 12, "%02d:%02d",     0 },   // Fly time
+    { 15, 1,  "%5dMAH",        1 },   // mAh drawn
+    { 7,  12, "ANGLE",         0 },   // Flight mode
+    { 15, 20, "\x13%5d",       5 },   // Home distance
+};
+
+static const recordedElement_t hdLayout[] = {
+    { 1,  2,  "\x06%2d",       1 },
+    { 1,  50, "%3d.%dV",       1 },
+    { 2,  2,  "%4d.%dA",       3 },
+    { 2,  50, "%5dMAH",        1 },
+    { 10, 2,  "\x76%4d",       7 },
+    { 10, 52, "%3d\x1e",       2 },
+    { 11, 2,  "%4d",           1 },   // Vario
+    { 11, 52, "%4d",           9 },   // Heading
+    { 19, 25, "%02d:%02d",     0 },
+    { 20, 2,  "\x13%5d",       5 },
+    { 20, 50, "%4d\x18",       4 },   // Trip distance
+    { 0,  26, "MANUAL",        0 },
+    { 19, 2,  "%3d.%03d",      11 },  // Latitude
+    { 19, 50, "%3d.%03d",      13 },  // Longitude
+};
+
+class DisplayportMspOsdTest : public ::testing::Test {
+protected:
+    displayPort_t *displayPort;
+    int linkBytesPerFrame;
+
+    void SetUp() override
+    {
+        simulatedMillis = 1000;
+        osdConfigMutable()->msp_displayport_fullframe_interval = -1;
+        displayPort = mspOsdDisplayPortInit(VIDEO_SYSTEM_DJIWTF);
+        ASSERT_NE(nullptr, displayPort);
+        linkBytesPerFrame = 1000;
+        linkBytesFree = linkBytesPerFrame;
+        mspOsdSerialProcess(vtxRequest);
+        displayPort->vTable->clearScreen(displayPort);
+        vtxClear();
+        drawFrame();
+        clearScreenCount = 0;
+        writeStringCount = 0;
+    }
+
+    // Returns the number of bytes sent to the VTX during this frame
+    int drawFrame(void)
+    {
+        frameBytes = 0;
+        simulatedMillis += FRAME_MS;
+        linkBytesFree = linkBytesPerFrame;
+        mspOsdSerialProcess(vtxRequest);
+        for (int ii = 0; ii < DRAW_CALLS_PER_FRAME; ii++) {
+            displayPort->vTable->drawScreen(displayPort);
+        }
+        return frameBytes;
+    }
+
+    void drawLayout(const recordedElement_t *layout, size_t count, int frame)
+    {
+        char buff[32];
+        for (size_t ii = 0; ii < count; ii++) {
+            const int value = 100 + frame * layout[ii].step;
+            snprintf(buff, sizeof(buff), layout[ii].format, value / 10 % 1000, value % 10);
+            displayPort->vTable->writeString(displayPort, layout[ii].col, layout[ii].row, buff, TEXT_ATTRIBUTES_NONE);
+        }
+    }
+
+    int vtxMismatches(void)
+    {
+        int mismatches = 0;
+        for (int row = 0; row < displayPort->rows; row++) {
+            for (int col = 0; col < displayPort->cols; col++) {
+                uint16_t c;
+                displayPort->vTable->readChar(displayPort, col, row, &c, NULL);
+                if (c != vtxDisplayed[row][col]) {
+                    mismatches++;
+                }
+            }
+        }
+        return mismatches;
+    }
+};
+
+TEST_F(DisplayportMspOsdTest, TestMergesNearbyRuns)
+{
+    displayPort->vTable->writeString(displayPort, 0, 3, "12", TEXT_ATTRIBUTES_NONE);
+    displayPort->vTable->writeString(displayPort, 6, 3, "34", TEXT_ATTRIBUTES_NONE);
+    displayPort->vTable->writeString(displayPort, 40, 3, "56", TEXT_ATTRIBUTES_NONE);
+    drawFrame();
+
+    // The first two runs are closer than an MSP frame header and get merged
+    EXPECT_EQ(2, writeStringCount);
+    EXPECT_EQ(0, vtxMismatches());
+}
+
+TEST_F(DisplayportMspOsdTest, TestSaturatedLinkDefersInsteadOfDropping)
+{
+    // About 9600 baud, well below what the layout needs when it changes
+    linkBytesPerFrame = 24;
+
+    for (int frame = 0; frame < 100; frame++) {
+        drawLayout(hdLayout, ARRAYLEN(hdLayout), frame);
+        drawFrame();
+    }
+    EXPECT_EQ(0, droppedFrames);
+
+    // Once values settle, the deferred characters catch up
+    for (int frame = 0; frame < 50; frame++) {
+        drawFrame();
+    }
+    EXPECT_EQ(0, vtxMismatches());
+}
+
+TEST_F(DisplayportMspOsdTest, TestFullFrameRefreshIsIncremental)
+{
+    drawLayout(hdLayout, ARRAYLEN(hdLayout), 0);
+    displayPort->vTable->writeString(displayPort, 5, 5, "WARN", TEXT_ATTRIBUTES_NONE);
+    drawFrame();
+    displayPort->vTable->writeString(displayPort, 5, 5, "    ", TEXT_ATTRIBUTES_NONE);
+    drawFrame();
+    ASSERT_EQ(0, vtxMismatches());
+
+    // Lose some updates on the way to the VTX, including the one erasing the warning
+    vtxCanvas[1][3] = vtxCanvas[10][53] = vtxCanvas[20][4] = 'X';
+    vtxCanvas[5][5] = 'W';
+    memcpy(vtxDisplayed, vtxCanvas, sizeof(vtxCanvas));
+    ASSERT_EQ(4, vtxMismatches());
+
+    osdConfigMutable()->msp_displayport_fullframe_interval = 10;
+    int maxFrameBytes = 0;
+    for (int frame = 0; frame < 20; frame++) {
+        maxFrameBytes = std::max(maxFrameBytes, drawFrame());
+    }
+
+    EXPECT_EQ(0, vtxMismatches());
+    EXPECT_EQ(0, clearScreenCount);
+    // Never more than a couple of rows in a single frame
+    EXPECT_LE(maxFrameBytes, 2 * (VTX_COLS + 10) + MSP_V1_FRAME_OVERHEAD + 1);
+}
+
+TEST_F(DisplayportMspOsdTest, TestBytesPerFrame)
+{
+    struct {
+        const char *name;
+        videoSystem_e videoSystem;
+        const recordedElement_t *layout;
+        size_t count;
+    } layouts[] = {
+        { "PAL", VIDEO_SYSTEM_PAL, palLayout, ARRAYLEN(palLayout) },
+        { "HD", VIDEO_SYSTEM_DJIWTF, hdLayout, ARRAYLEN(hdLayout) },
+    };
+
+    osdConfigMutable()->msp_displayport_fullframe_interval = 10;
+
+    for (auto &recorded : layouts) {
+        const int frames = 300;
+        int totalBytes = 0;
+        int maxFrameBytes = 0;
+
+        displayPort = mspOsdDisplayPortInit(recorded.videoSystem);
+        displayPort->vTable->clearScreen(displayPort);
+        // Initial paint of the layout is not part of the steady state
+        drawLayout(recorded.layout, recorded.count, 0);
+        drawFrame();
+        writeStringCount = 0;
+
+        for (int frame = 1; frame <= frames; frame++) {
+            drawLayout(recorded.layout, recorded.count, frame);
+            const int bytes = drawFrame();
+            totalBytes += bytes;
+            maxFrameBytes = std::max(maxFrameBytes, bytes);
+        }
+
+        std::cout << std::setw(4) << recorded.name << ": "
+                  << std::fixed << std::setprecision(1) << (float)totalBytes / frames << " B/frame avg, "
+                  << maxFrameBytes << " B max, "
+                  << (float)writeStringCount / frames << " writes/frame" << std::endl;
+
+        EXPECT_EQ(0, vtxMismatches());
+        EXPECT_EQ(0, droppedFrames);
+        // Full frame refreshes are spread out, so no frame comes close to the screen size
+        EXPECT_LT(maxFrameBytes, displayPort->rows * displayPort->cols / 4);
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+bool cmsInMenu = false;
+uint8_t cliMode = 0;
+const uint32_t baudRates[] = { 0, 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200 };
+
+static serialPortConfig_t mspOsdPortConfig;
+static serialPort_t mspOsdPort;
+
+timeMs_t millis(void)
+{
+    return simulatedMillis;
+}
+
+bool IS_RC_MODE_ACTIVE(boxId_e boxId)
+{
+    UNUSED(boxId);
+    return false;
+}
+
+void displayInit(displayPort_t *instance, const displayPortVTable_t *vTable)
+{
+    instance->vTable = vTable;
+    instance->vTable->clearScreen(instance);
+    instance->vTable->resync(instance);
+}
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return &mspOsdPortConfig;
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function,
+    serialReceiveCallbackPtr callback, void *rxCallbackData, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier);
+    UNUSED(function);
+    UNUSED(callback);
+    UNUSED(rxCallbackData);
+    UNUSED(baudrate);
+    UNUSED(mode);
+    UNUSED(options);
+    return &mspOsdPort;
+}
+
+void resetMspPort(mspPort_t *mspPortToReset, serialPort_t *serialPort)
+{
+    memset(mspPortToReset, 0, sizeof(*mspPortToReset));
+    mspPortToReset->port = serialPort;
+}
+
+void mspSerialProcessOnePort(mspPort_t * const mspPort, mspEvaluateNonMspData_e evaluateNonMspData, mspProcessCommandFnPtr mspProcessCommandFn)
+{
+    UNUSED(mspPort);
+    UNUSED(evaluateNonMspData);
+    mspPacket_t cmd, reply;
+    mspPostProcessFnPtr postProcessFn = NULL;
+    memset(&cmd, 0, sizeof(cmd));
+    memset(&reply, 0, sizeof(reply));
+    cmd.cmd = MSP_STATUS;
+    mspProcessCommandFn(&cmd, &reply, &postProcessFn);
+}
+
+uint32_t mspSerialTxBytesFree(serialPort_t *port)
+{
+    UNUSED(port);
+    return linkBytesFree;
+}
+
+int mspSerialPushPort(uint16_t cmd, const uint8_t *data, int datalen, mspPort_t *mspPort, mspVersion_e version)
+{
+    UNUSED(cmd);
+    UNUSED(mspPort);
+    UNUSED(version);
+
+    const int frameLength = datalen + MSP_V1_FRAME_OVERHEAD;
+    if (frameLength > linkBytesFree) {
+        droppedFrames++;
+        return 0;
+    }
+    linkBytesFree -= frameLength;
+    frameBytes += frameLength;
+    vtxDecode(data, datalen);
+    return frameLength;
+}
+
+int osdGetActiveLayout(bool *overridden)
+{
+    UNUSED(overridden);
+    return 0;
+}
+
+uint8_t osdIncElementIndex(uint8_t elementIndex)
+{
+    return (elementIndex + 1) % OSD_ITEM_COUNT;
+}
+
+bool osdItemIsFixed(osd_items_e item)
+{
+    UNUSED(item);
+    return false;
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/time.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOPTIME_US 500
+#define SAMPLE_COUNT 1000
+
+// Different signal on each axis so a mixed up axis index shows up
+static float testSample(int axis, int i)
+{
+    return 200.0f * sin_approx(2.0f * M_PIf * 80.0f * (axis + 1) * i * US2S(LOOPTIME_US)) + 10.0f * axis;
+}
+
+TEST(FilterUnittest, Pt1Filter3MatchesScalar)
+{
+    pt1Filter_t scalar[XYZ_AXIS_COUNT];
+    pt1Filter3_t batched;
+
+    pt1Filter3Init(&batched, 90, US2S(LOOPTIME_US));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1FilterInit(&scalar[axis], 90, US2S(LOOPTIME_US));
+    }
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        if (i == SAMPLE_COUNT / 2) {
+            pt1Filter3UpdateCutoff(&batched, 150);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                pt1FilterUpdateCutoff(&scalar[axis], 150);
+            }
+        }
+
+        float samples[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            samples[axis] = testSample(axis, i);
+        }
+        pt1Filter3Apply(&batched, samples);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_FLOAT_EQ(pt1FilterApply(&scalar[axis], testSample(axis, i)), samples[axis]);
+        }
+    }
+}
+
+TEST(FilterUnittest, BiquadFilter3MatchesScalar)
+{
+    biquadFilter_t scalar[XYZ_AXIS_COUNT];
+    biquadFilter3_t batched;
+
+    biquadFilter3InitLPF(&batched, 110, LOOPTIME_US);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInitLPF(&scalar[axis], 110, LOOPTIME_US);
+    }
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        if (i == SAMPLE_COUNT / 2) {
+            biquadFilter3Update(&batched, 70, LOOPTIME_US, BIQUAD_Q, FILTER_LPF);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                biquadFilterUpdate(&scalar[axis], 70, LOOPTIME_US, BIQUAD_Q, FILTER_LPF);
+            }
+        }
+
+        float samples[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            samples[axis] = testSample(axis, i);
+        }
+        biquadFilter3Apply(&batched, samples);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_FLOAT_EQ(biquadFilterApply(&scalar[axis], testSample(axis, i)), samples[axis]);
+        }
+    }
+}
+
+TEST(FilterUnittest, BiquadFilter3NotchBankMatchesScalar)
+{
+    const unsigned notchCount = 3;
+    biquadFilter_t scalar[XYZ_AXIS_COUNT][notchCount];
+    biquadFilter3_t batched[notchCount];
+
+    for (unsigned n = 0; n < notchCount; n++) {
+        biquadFilter3Init(&batched[n], 80 * (n + 1), LOOPTIME_US, 3.0f, FILTER_NOTCH);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterInit(&scalar[axis][n], 80 * (n + 1), LOOPTIME_US, 3.0f, FILTER_NOTCH);
+        }
+    }
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        // Per axis center frequency updates, as done by the dynamic notch
+        const int updateAxis = i % XYZ_AXIS_COUNT;
+        const float centerHz = 80.0f + (i % 20) + 10 * updateAxis;
+        for (unsigned n = 0; n < notchCount; n++) {
+            biquadFilter3UpdateAxis(&batched[n], updateAxis, centerHz * (n + 1), LOOPTIME_US, 3.0f, FILTER_NOTCH);
+            biquadFilterUpdate(&scalar[updateAxis][n], centerHz * (n + 1), LOOPTIME_US, 3.0f, FILTER_NOTCH);
+        }
+
+        float samples[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            samples[axis] = testSample(axis, i);
+        }
+        biquadFilter3BankApplyDF1(batched, notchCount, samples);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float expected = testSample(axis, i);
+            for (unsigned n = 0; n < notchCount; n++) {
+                expected = biquadFilterApplyDF1(&scalar[axis][n], expected);
+            }
+            EXPECT_FLOAT_EQ(expected, samples[axis]);
+        }
+    }
+}
+
+TEST(FilterUnittest, NullFilter3IsPassthrough)
+{
+    float samples[XYZ_AXIS_COUNT] = { 1.0f, -2.0f, 3.0f };
+
+    nullFilter3Apply(NULL, samples);
+
+    EXPECT_FLOAT_EQ(1.0f, samples[X]);
+    EXPECT_FLOAT_EQ(-2.0f, samples[Y]);
+    EXPECT_FLOAT_EQ(3.0f, samples[Z]);
+}
@@ -0,0 +1,209 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that flashfs buffers asynchronous writes while the flash is busy
+ * and accounts for the data it has to drop, using a fake flash chip.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "drivers/flash.h"
+    #include "drivers/time.h"
+
+    #include "io/flashfs.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FAKE_PAGE_SIZE          256
+#define FAKE_PAGES_PER_SECTOR   16
+#define FAKE_SECTORS            8
+#define FAKE_SIZE               (FAKE_PAGE_SIZE * FAKE_PAGES_PER_SECTOR * FAKE_SECTORS)
+
+static uint8_t fakeFlash[FAKE_SIZE];
+static bool fakeFlashBusy;
+static int fakeFlashPrograms;
+static timeUs_t fakeTimeUs;
+
+static const flashGeometry_t fakeGeometry = {
+    .sectors = FAKE_SECTORS,
+    .pageSize = FAKE_PAGE_SIZE,
+    .sectorSize = FAKE_PAGE_SIZE * FAKE_PAGES_PER_SECTOR,
+    .totalSize = FAKE_SIZE,
+    .pagesPerSector = FAKE_PAGES_PER_SECTOR,
+    .flashType = FLASH_TYPE_NOR,
+};
+
+static flashPartition_t fakePartition = {
+    .type = FLASH_PARTITION_TYPE_FLASHFS,
+    .startSector = 0,
+    .endSector = FAKE_SECTORS - 1,
+};
+
+static void resetFlashfs(void)
+{
+    memset(fakeFlash, 0xff, sizeof(fakeFlash));
+    fakeFlashBusy = false;
+    fakeFlashPrograms = 0;
+    flashfsInit();
+    flashfsEraseCompletely();
+}
+
+static void fillPattern(uint8_t *buf, int len, uint8_t start)
+{
+    for (int ii = 0; ii < len; ii++) {
+        buf[ii] = start + ii;
+    }
+}
+
+TEST(FlashfsTest, BusyFlashBuffersAsyncWrites)
+{
+    resetFlashfs();
+
+    uint8_t data[FLASHFS_WRITE_BUFFER_USABLE];
+    fillPattern(data, sizeof(data), 0);
+
+    // While the flash is busy everything that fits in the buffer is kept
+    fakeFlashBusy = true;
+    for (unsigned ii = 0; ii < sizeof(data); ii += 16) {
+        flashfsWrite(data + ii, MIN(16U, sizeof(data) - ii), false);
+    }
+    EXPECT_EQ(0, fakeFlashPrograms);
+    EXPECT_EQ(sizeof(data), flashfsGetOffset());
+
+    const flashfsStats_t *stats = flashfsGetStats();
+    EXPECT_EQ(0U, stats->droppedWrites);
+    EXPECT_GT(stats->busyDeferrals, 0U);
+    EXPECT_EQ(sizeof(data), stats->bufferPeak);
+
+    // And reaches the flash once it becomes ready
+    fakeFlashBusy = false;
+    while (!flashfsFlushAsync()) {
+    }
+    EXPECT_EQ(0, memcmp(fakeFlash, data, sizeof(data)));
+    EXPECT_EQ(0xff, fakeFlash[sizeof(data)]);
+}
+
+TEST(FlashfsTest, FullBufferDropsAreCounted)
+{
+    resetFlashfs();
+
+    uint8_t data[FLASHFS_WRITE_BUFFER_USABLE];
+    fillPattern(data, sizeof(data), 0);
+
+    fakeFlashBusy = true;
+    flashfsWrite(data, sizeof(data) - 10, false);
+    flashfsWrite(data, 20, false);
+
+    const flashfsStats_t *stats = flashfsGetStats();
+    EXPECT_EQ(1U, stats->droppedWrites);
+    EXPECT_EQ(20U, stats->droppedBytes);
+    EXPECT_EQ(sizeof(data) - 10, flashfsGetOffset());
+
+    // Erasing starts the statistics over
+    fakeFlashBusy = false;
+    flashfsEraseCompletely();
+    EXPECT_EQ(0U, stats->droppedWrites);
+    EXPECT_EQ(0U, stats->droppedBytes);
+}
+
+TEST(FlashfsTest, SyncWritesAccountStallTime)
+{
+    resetFlashfs();
+
+    uint8_t data[FAKE_PAGE_SIZE * 2];
+    fillPattern(data, sizeof(data), 7);
+
+    flashfsWrite(data, sizeof(data), true);
+    flashfsFlushSync();
+
+    EXPECT_EQ(0, memcmp(fakeFlash, data, sizeof(data)));
+    EXPECT_GT(flashfsGetStats()->stallTimeUs, 0U);
+}
+
+// STUBS
+
+extern "C" {
+
+timeUs_t micros(void)
+{
+    // Every flash operation takes 100us
+    return fakeTimeUs += 100;
+}
+
+bool flashIsReady(void)
+{
+    return !fakeFlashBusy;
+}
+
+uint32_t flashPageProgram(uint32_t address, const uint8_t *data, int length)
+{
+    EXPECT_FALSE(fakeFlashBusy);
+    EXPECT_LE(address % FAKE_PAGE_SIZE + length, FAKE_PAGE_SIZE);
+    for (int ii = 0; ii < length; ii++) {
+        fakeFlash[address + ii] &= data[ii];
+    }
+    fakeFlashPrograms++;
+    return address + length;
+}
+
+int flashReadBytes(uint32_t address, uint8_t *buffer, int length)
+{
+    memcpy(buffer, fakeFlash + address, length);
+    return length;
+}
+
+void flashFlush(void) {}
+
+void flashEraseSector(uint32_t address)
+{
+    memset(fakeFlash + address, 0xff, FAKE_PAGE_SIZE * FAKE_PAGES_PER_SECTOR);
+}
+
+const flashGeometry_t *flashGetGeometry(void)
+{
+    return &fakeGeometry;
+}
+
+flashPartition_t *flashPartitionFindByType(flashPartitionType_e type)
+{
+    return type == FLASH_PARTITION_TYPE_FLASHFS ? &fakePartition : NULL;
+}
+
+uint32_t flashPartitionSize(flashPartition_t *partition)
+{
+    return FLASH_PARTITION_SECTOR_COUNT(partition) * fakeGeometry.sectorSize;
+}
+
+void flashPartitionErase(flashPartition_t *partition)
+{
+    UNUSED(partition);
+    memset(fakeFlash, 0xff, sizeof(fakeFlash));
+}
+
+}
@@ -0,0 +1,438 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Host side benchmark of the gyro -> filter -> PID -> mixer hot path.
+ *
+ * Links the real gyro.c filter chain, filter.c, rpm_filter.c, kalman.c,
+ * pid.c and mixer.c and feeds them with a synthetic gyro stream made of
+ * white noise and motor harmonics. Reports ns/iteration per stage and
+ * per gyro filter configuration, so filter stack and compiler flag
+ * changes can be compared before they go onto an aircraft.
+ *
+ * The dynamic notch needs CMSIS DSP for its FFT and is not available on
+ * the host, so its notch bank is benchmarked through the same filter.c
+ * 3-axis kernels it uses on target.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/calibration.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/parameter_group.h"
+
+    #include "drivers/accgyro/accgyro_fake.h"
+    #include "drivers/pwm_output.h"
+    #include "drivers/time.h"
+
+    #include "fc/config.h"
+    #include "fc/controlrate_profile.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/imu.h"
+    #include "flight/kalman.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/rpm_filter.h"
+
+    #include "navigation/navigation.h"
+
+    #include "rx/rx.h"
+
+    #include "scheduler/scheduler.h"
+
+    #include "sensors/battery.h"
+    #include "sensors/esc_sensor.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+
+    extern zeroCalibrationVector_t gyroCalibration[];
+
+    extern const gyroConfig_t pgResetTemplate_gyroConfig;
+    extern const pidProfile_t pgResetTemplate_pidProfile;
+    extern const mixerConfig_t pgResetTemplate_mixerConfig;
+    extern const motorConfig_t pgResetTemplate_motorConfig;
+    extern const reversibleMotorsConfig_t pgResetTemplate_reversibleMotorsConfig;
+    extern const rpmFilterConfig_t pgResetTemplate_rpmFilterConfig;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_LOOPTIME_US       500     // 2kHz gyro and PID loop
+#define BENCHMARK_SAMPLE_COUNT      4096
+#define BENCHMARK_ITERATIONS        200000
+#define BENCHMARK_MOTOR_COUNT       4
+#define BENCHMARK_MOTOR_HZ          180.0f  // Fundamental of the motor noise
+#define BENCHMARK_NOTCH_COUNT       3       // Notches per axis of the dynamic notch bank
+
+static int16_t gyroStream[BENCHMARK_SAMPLE_COUNT][XYZ_AXIS_COUNT];
+static controlRateConfig_t benchmarkRateProfile;
+static batteryProfile_t benchmarkBatteryProfile;
+static escSensorData_t benchmarkEscData[BENCHMARK_MOTOR_COUNT];
+static unsigned streamIndex;
+
+/*
+ * White noise plus the motor fundamental and two harmonics, different
+ * phase per axis. Deterministic so runs are comparable.
+ */
+static void generateGyroStream(void)
+{
+    uint32_t seed = 0x1234567;
+
+    for (int i = 0; i < BENCHMARK_SAMPLE_COUNT; i++) {
+        const float t = i * US2S(BENCHMARK_LOOPTIME_US);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            seed = seed * 1664525 + 1013904223;
+            const float noise = ((int32_t)(seed >> 16) - 32768) / 32768.0f * 40.0f;
+
+            float harmonics = 0;
+            for (int h = 1; h <= 3; h++) {
+                harmonics += 300.0f / h * sin_approx(2.0f * M_PIf * BENCHMARK_MOTOR_HZ * h * t + axis);
+            }
+
+            gyroStream[i][axis] = constrain(lrintf(100.0f * axis + noise + harmonics), INT16_MIN, INT16_MAX);
+        }
+    }
+}
+
+static void feedGyroSample(void)
+{
+    const int16_t *sample = gyroStream[streamIndex++ % BENCHMARK_SAMPLE_COUNT];
+    fakeGyroSet(sample[X], sample[Y], sample[Z]);
+}
+
+static void benchmarkResetConfigs(void)
+{
+    *gyroConfigMutable() = pgResetTemplate_gyroConfig;
+    gyroConfigMutable()->looptime = BENCHMARK_LOOPTIME_US;
+    gyroConfigMutable()->kalmanEnabled = false;
+
+    *pidProfileMutable() = pgResetTemplate_pidProfile;
+    *mixerConfigMutable() = pgResetTemplate_mixerConfig;
+    *motorConfigMutable() = pgResetTemplate_motorConfig;
+    *reversibleMotorsConfigMutable() = pgResetTemplate_reversibleMotorsConfig;
+
+    *rpmFilterConfigMutable() = pgResetTemplate_rpmFilterConfig;
+    rpmFilterConfigMutable()->gyro_filter_enabled = false;
+
+    // Quad X
+    static const motorMixer_t quadX[BENCHMARK_MOTOR_COUNT] = {
+        { 1.0f, -1.0f,  1.0f, -1.0f },
+        { 1.0f, -1.0f, -1.0f,  1.0f },
+        { 1.0f,  1.0f,  1.0f,  1.0f },
+        { 1.0f,  1.0f, -1.0f, -1.0f },
+    };
+    memset(primaryMotorMixerMutable(0), 0, sizeof(motorMixer_t) * MAX_SUPPORTED_MOTORS);
+    memcpy(primaryMotorMixerMutable(0), quadX, sizeof(quadX));
+
+    memset(&benchmarkRateProfile, 0, sizeof(benchmarkRateProfile));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        benchmarkRateProfile.stabilized.rates[axis] = 70;
+    }
+    currentControlRateProfile = &benchmarkRateProfile;
+
+    memset(&benchmarkBatteryProfile, 0, sizeof(benchmarkBatteryProfile));
+    benchmarkBatteryProfile.motor.throttleIdle = 15.0f;
+    benchmarkBatteryProfile.motor.throttleScale = 1.0f;
+    currentBatteryProfile = &benchmarkBatteryProfile;
+
+    for (int i = 0; i < BENCHMARK_MOTOR_COUNT; i++) {
+        benchmarkEscData[i].rpm = lrintf(BENCHMARK_MOTOR_HZ * 60.0f);
+    }
+}
+
+static void initHotPath(void)
+{
+    generateGyroStream();
+    streamIndex = 0;
+
+    gyroInit();
+    gyroCalibration[0].params.state = ZERO_CALIBRATION_DONE;
+
+    // Mixer first, the RPM filter bank is sized by the motor count
+    mixerInit();
+    pidInit();
+    pidInitFilters();
+
+    // Same order as fcInit()
+    disableRpmFilters();
+    rpmFiltersInit();
+    // Let the motor frequency LPF settle on the synthetic ESC telemetry
+    for (int i = 0; i < 1000; i++) {
+        rpmFilterUpdateTask(0);
+    }
+
+    ENABLE_ARMING_FLAG(ARMED);
+    rcCommand[ROLL] = 50;
+    rcCommand[PITCH] = -30;
+    rcCommand[YAW] = 20;
+    rcCommand[THROTTLE] = 1400;
+}
+
+static double benchmarkNsPerIteration(const std::function<void(void)> &fn)
+{
+    // Warm up caches and filter states
+    for (int i = 0; i < BENCHMARK_ITERATIONS / 10; i++) {
+        fn();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        fn();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / BENCHMARK_ITERATIONS;
+}
+
+static void printResult(const char *name, double nsPerIteration)
+{
+    std::cout << "  " << std::left << std::setw(32) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << nsPerIteration << " ns/iter" << std::endl;
+}
+
+static void expectGyroOutputs(void)
+{
+    EXPECT_TRUE(gyro.initialized);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_TRUE(isfinite(gyro.gyroADCf[axis]));
+        EXPECT_NE(0, gyro.gyroADCf[axis]);
+    }
+}
+
+static void expectMotorOutputs(void)
+{
+    EXPECT_EQ(BENCHMARK_MOTOR_COUNT, getMotorCount());
+    for (int i = 0; i < getMotorCount(); i++) {
+        EXPECT_GE(motor[i], motorConfig()->mincommand);
+        EXPECT_LE(motor[i], motorConfig()->maxthrottle);
+    }
+}
+
+class FlightHotPathBenchmark : public ::testing::Test
+{
+protected:
+    virtual void SetUp() {
+        benchmarkResetConfigs();
+    }
+};
+
+TEST_F(FlightHotPathBenchmark, Stages)
+{
+    rpmFilterConfigMutable()->gyro_filter_enabled = true;
+    initHotPath();
+
+    std::cout << "Per stage (" << BENCHMARK_ITERATIONS << " iterations):" << std::endl;
+
+    printResult("gyroUpdate", benchmarkNsPerIteration([] {
+        feedGyroSample();
+        gyroUpdate();
+    }));
+    printResult("gyroFilter", benchmarkNsPerIteration([] {
+        gyroFilter();
+    }));
+    printResult("pidController", benchmarkNsPerIteration([] {
+        pidController(US2S(BENCHMARK_LOOPTIME_US));
+    }));
+    printResult("mixTable", benchmarkNsPerIteration([] {
+        mixTable();
+    }));
+    printResult("full loop", benchmarkNsPerIteration([] {
+        feedGyroSample();
+        gyroUpdate();
+        gyroFilter();
+        pidController(US2S(BENCHMARK_LOOPTIME_US));
+        mixTable();
+    }));
+
+    expectGyroOutputs();
+    expectMotorOutputs();
+}
+
+TEST_F(FlightHotPathBenchmark, GyroFilterConfigurations)
+{
+    const struct {
+        const char *name;
+        uint8_t mainLpfType;
+        uint16_t mainLpfHz;
+        bool rpmFilter;
+        bool kalman;
+    } configurations[] = {
+        { "main lpf off",               FILTER_PT1,    0,   false, false },
+        { "main lpf pt1",               FILTER_PT1,    110, false, false },
+        { "main lpf biquad",            FILTER_BIQUAD, 110, false, false },
+        { "pt1 + rpm filter",           FILTER_PT1,    110, true,  false },
+        { "pt1 + kalman",               FILTER_PT1,    110, false, true  },
+        { "pt1 + rpm filter + kalman",  FILTER_PT1,    110, true,  true  },
+    };
+
+    std::cout << "gyroUpdate + gyroFilter per configuration (" << BENCHMARK_ITERATIONS << " iterations):" << std::endl;
+
+    for (unsigned i = 0; i < ARRAYLEN(configurations); i++) {
+        benchmarkResetConfigs();
+        gyroConfigMutable()->gyro_main_lpf_type = configurations[i].mainLpfType;
+        gyroConfigMutable()->gyro_main_lpf_hz = configurations[i].mainLpfHz;
+        gyroConfigMutable()->kalmanEnabled = configurations[i].kalman;
+        rpmFilterConfigMutable()->gyro_filter_enabled = configurations[i].rpmFilter;
+        initHotPath();
+
+        printResult(configurations[i].name, benchmarkNsPerIteration([] {
+            feedGyroSample();
+            gyroUpdate();
+            gyroFilter();
+        }));
+
+        expectGyroOutputs();
+    }
+}
+
+TEST_F(FlightHotPathBenchmark, DynamicNotchBank)
+{
+    static biquadFilter_t scalarNotch[XYZ_AXIS_COUNT][BENCHMARK_NOTCH_COUNT];
+    static biquadFilter3_t notch[BENCHMARK_NOTCH_COUNT];
+    static float output[XYZ_AXIS_COUNT];
+
+    generateGyroStream();
+
+    for (int i = 0; i < BENCHMARK_NOTCH_COUNT; i++) {
+        const float centerHz = BENCHMARK_MOTOR_HZ * (i + 1);
+        biquadFilter3Init(&notch[i], centerHz, BENCHMARK_LOOPTIME_US, 2.5f, FILTER_NOTCH);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterInit(&scalarNotch[axis][i], centerHz, BENCHMARK_LOOPTIME_US, 2.5f, FILTER_NOTCH);
+        }
+    }
+
+    std::cout << "Dynamic notch bank, " << BENCHMARK_NOTCH_COUNT << " notches per axis (" << BENCHMARK_ITERATIONS << " iterations):" << std::endl;
+
+    printResult("scalar apply", benchmarkNsPerIteration([] {
+        const int16_t *sample = gyroStream[streamIndex++ % BENCHMARK_SAMPLE_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float value = sample[axis];
+            for (int i = 0; i < BENCHMARK_NOTCH_COUNT; i++) {
+                value = biquadFilterApplyDF1(&scalarNotch[axis][i], value);
+            }
+            output[axis] = value;
+        }
+    }));
+
+    printResult("3-axis apply", benchmarkNsPerIteration([] {
+        const int16_t *sample = gyroStream[streamIndex++ % BENCHMARK_SAMPLE_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            output[axis] = sample[axis];
+        }
+        biquadFilter3BankApplyDF1(notch, BENCHMARK_NOTCH_COUNT, output);
+    }));
+
+    // One centre frequency update per loop, as the analyser does for a single axis
+    printResult("3-axis apply + update", benchmarkNsPerIteration([] {
+        const int16_t *sample = gyroStream[streamIndex++ % BENCHMARK_SAMPLE_COUNT];
+        const int updateAxis = streamIndex % XYZ_AXIS_COUNT;
+        const float centerHz = BENCHMARK_MOTOR_HZ + (streamIndex % 32);
+        for (int i = 0; i < BENCHMARK_NOTCH_COUNT; i++) {
+            biquadFilter3UpdateAxis(&notch[i], updateAxis, centerHz * (i + 1), BENCHMARK_LOOPTIME_US, 2.5f, FILTER_NOTCH);
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            output[axis] = sample[axis];
+        }
+        biquadFilter3BankApplyDF1(notch, BENCHMARK_NOTCH_COUNT, output);
+    }));
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_TRUE(isfinite(output[axis]));
+    }
+}
+
+// STUBS
+
+extern "C" {
+uint32_t armingFlags;
+uint32_t stateFlags;
+uint32_t flightModeFlags;
+int16_t rcCommand[4];
+uint8_t detectedSensors[SENSOR_INDEX_COUNT];
+attitudeEulerAngles_t attitude;
+const controlRateConfig_t *currentControlRateProfile;
+const batteryProfile_t *currentBatteryProfile;
+rcControlsConfig_t rcControlsConfig_System;
+navConfig_t navConfig_System;
+
+static timeMs_t milliTime = 0;
+timeMs_t millis(void) { return milliTime++; }
+void delay(timeMs_t) {}
+
+uint32_t getLooptime(void) { return BENCHMARK_LOOPTIME_US; }
+uint32_t getGyroLooptime(void) { return BENCHMARK_LOOPTIME_US; }
+void sensorsSet(uint32_t) {}
+void schedulerResetTaskStatistics(cfTaskId_e) {}
+
+bool feature(uint32_t) { return false; }
+bool IS_RC_MODE_ACTIVE(boxId_e) { return false; }
+bool areSticksDeflected(void) { return true; }
+bool throttleStickIsLow(void) { return false; }
+int32_t getRcStickDeflection(int32_t axis) { return rcCommand[axis]; }
+rollPitchStatus_e calculateRollPitchCenterStatus(void) { return NOT_CENTERED; }
+int16_t rxGetChannelValue(unsigned) { return 1500; }
+
+bool failsafeIsActive(void) { return false; }
+bool failsafeRequiresMotorStop(void) { return false; }
+
+float calculateCosTiltAngle(void) { return 1.0f; }
+void imuTransformVectorEarthToBody(fpVector3_t *) {}
+float calculateThrottleCompensationFactor(void) { return 1.0f; }
+bool isAmperageConfigured(void) { return false; }
+
+escSensorData_t *getEscTelemetry(uint8_t esc) { return &benchmarkEscData[esc % BENCHMARK_MOTOR_COUNT]; }
+
+bool isFlightAxisAngleOverrideActive(uint8_t) { return false; }
+float getFlightAxisAngleOverride(uint8_t, float angle) { return angle; }
+float getFlightAxisRateOverride(uint8_t, float rate) { return rate; }
+
+float getEstimatedActualVelocity(int) { return 0; }
+int8_t navigationGetHeadingControlState(void) { return NAV_HEADING_CONTROL_NONE; }
+bool navigationInAutomaticThrottleMode(void) { return false; }
+bool navigationIsControllingAltitude(void) { return false; }
+bool navigationIsControllingThrottle(void) { return false; }
+bool navigationIsFlyingAutonomousMode(void) { return false; }
+bool navigationRequiresTurnAssistance(void) { return false; }
+
+void pwmWriteMotor(uint8_t, uint16_t) {}
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+}
@@ -0,0 +1,400 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Feeds UBX streams as a u-blox 8 sends them (NAV-SOL and NAV-PVT every
+ * epoch, interleaved with ACKs and NMEA left over from before configuration)
+ * through the real UBLOX protocol threads. Data arrives in chunks of random
+ * size, one chunk per GPS task run, and every epoch must come out as one
+ * solution, in order, whatever the chunking, alignment or corruption.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <iostream>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "drivers/serial.h"
+    #include "drivers/time.h"
+
+    #include "io/gps.h"
+    #include "io/gps_private.h"
+    #include "io/gps_ublox.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define UBX_CLASS_NAV       0x01
+#define UBX_CLASS_ACK       0x05
+#define UBX_NAV_SOL         0x06
+#define UBX_NAV_PVT         0x07
+#define UBX_ACK_ACK         0x01
+
+typedef std::vector<uint8_t> stream_t;
+
+static stream_t rxStream;
+static size_t rxDelivered;      // bytes made available by the fake UART so far
+static size_t rxConsumed;       // bytes read by the driver
+static unsigned portCalls;      // calls through the serial port vtable
+
+static std::vector<gpsSolutionData_t> solutions;
+
+static uint32_t rngState;
+
+static uint32_t rng(void)
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return rngState >> 8;
+}
+
+static void put16(stream_t &buf, size_t offset, uint16_t value)
+{
+    buf[offset] = value;
+    buf[offset + 1] = value >> 8;
+}
+
+static void put32(stream_t &buf, size_t offset, uint32_t value)
+{
+    put16(buf, offset, value);
+    put16(buf, offset + 2, value >> 16);
+}
+
+static void appendFrame(stream_t &stream, uint8_t msgClass, uint8_t msgId, const stream_t &payload)
+{
+    stream_t frame = { UBX_PREAMBLE1, UBX_PREAMBLE2, msgClass, msgId, (uint8_t)payload.size(), (uint8_t)(payload.size() >> 8) };
+    frame.insert(frame.end(), payload.begin(), payload.end());
+
+    uint8_t ck_a = 0, ck_b = 0;
+    for (size_t ii = 2; ii < UBX_HEADER_SIZE + payload.size(); ii++) {
+        ck_a += frame[ii];
+        ck_b += ck_a;
+    }
+    frame.push_back(ck_a);
+    frame.push_back(ck_b);
+
+    stream.insert(stream.end(), frame.begin(), frame.end());
+}
+
+static int32_t epochLatitude(unsigned epoch)
+{
+    return 473977000 + epoch * 37;
+}
+
+static int32_t epochLongitude(unsigned epoch)
+{
+    return 85455000 - epoch * 53;
+}
+
+static void appendEpoch(stream_t &stream, unsigned epoch)
+{
+    stream_t sol(52, 0);
+    put32(sol, 0, epoch * 100);
+    sol[10] = 3;                    // 3D fix
+    sol[11] = 0x01;                 // fix valid
+    put16(sol, 44, 120);            // pDOP
+    sol[47] = 14;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_NAV_SOL, sol);
+
+    stream_t pvt(92, 0);
+    put32(pvt, 0, epoch * 100);
+    put16(pvt, 4, 2024);
+    pvt[6] = 5;
+    pvt[7] = 17;
+    pvt[11] = 0x03;                 // date and time valid
+    pvt[20] = 3;
+    pvt[21] = 0x01;
+    pvt[23] = 14;
+    put32(pvt, 24, epochLongitude(epoch));
+    put32(pvt, 28, epochLatitude(epoch));
+    put32(pvt, 36, 512000 + epoch); // mm
+    put32(pvt, 40, 1500);
+    put32(pvt, 44, 2500);
+    put32(pvt, 48, 1000 + epoch);   // mm/s
+    put32(pvt, 52, (uint32_t)-2000);
+    put32(pvt, 60, 2236);
+    put16(pvt, 76, 120);
+    appendFrame(stream, UBX_CLASS_NAV, UBX_NAV_PVT, pvt);
+}
+
+// A u-blox 8 stream of `epochs` solutions. ACK frames (2 byte payload) are
+// sprinkled in so that following frames land on every alignment.
+static stream_t makeStream(unsigned epochs)
+{
+    const char *nmea = "$GNGGA,123519.00,4724.000,N,00832.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    stream_t stream(nmea, nmea + strlen(nmea));
+
+    for (unsigned epoch = 0; epoch < epochs; epoch++) {
+        for (unsigned ack = 0; ack < epoch % 4; ack++) {
+            appendFrame(stream, UBX_CLASS_ACK, UBX_ACK_ACK, { 0x06, 0x01 });
+        }
+        appendEpoch(stream, epoch);
+    }
+
+    return stream;
+}
+
+static uint32_t fakeRxBytesWaiting(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    portCalls++;
+    return rxDelivered - rxConsumed;
+}
+
+static uint8_t fakeRead(serialPort_t *instance)
+{
+    UNUSED(instance);
+    portCalls++;
+    return rxStream[rxConsumed++];
+}
+
+static int fakeReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    UNUSED(instance);
+    portCalls++;
+    const int len = MIN((size_t)count, rxDelivered - rxConsumed);
+    memcpy(data, &rxStream[rxConsumed], len);
+    rxConsumed += len;
+    return len;
+}
+
+static uint32_t fakeTxBytesFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return 256;
+}
+
+static bool fakeIsTxBufferEmpty(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return true;
+}
+
+static void fakeWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    UNUSED(ch);
+}
+
+static void fakeSetBaudRate(serialPort_t *instance, uint32_t baudRate)
+{
+    UNUSED(instance);
+    UNUSED(baudRate);
+}
+
+static struct serialPortVTable fakeVTable = {
+    .serialWrite = fakeWrite,
+    .serialTotalRxWaiting = fakeRxBytesWaiting,
+    .serialTotalTxFree = fakeTxBytesFree,
+    .serialRead = fakeRead,
+    .readBuf = fakeReadBuf,
+    .serialSetBaudRate = fakeSetBaudRate,
+    .isSerialTransmitBufferEmpty = fakeIsTxBufferEmpty,
+    .setMode = NULL,
+    .writeBuf = NULL,
+    .isConnected = NULL,
+    .isIdle = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+};
+
+static serialPort_t fakePort;
+static gpsConfig_t fakeGpsConfig;
+
+// Runs the GPS task once per chunk, chunk sizes uniform in [1, maxChunk]
+static void runGps(const stream_t &stream, unsigned maxChunk)
+{
+    rxStream = stream;
+    rxDelivered = rxConsumed = 0;
+    portCalls = 0;
+    solutions.clear();
+    memset(&gpsStats, 0, sizeof(gpsStats));
+
+    fakeGpsConfig.autoConfig = GPS_AUTOCONFIG_OFF;
+    fakeGpsConfig.autoBaud = GPS_AUTOBAUD_OFF;
+    gpsState.gpsConfig = &fakeGpsConfig;
+    fakePort.vTable = &fakeVTable;
+    gpsState.gpsPort = &fakePort;
+    gpsRestartUBLOX();
+
+    while (rxDelivered < rxStream.size()) {
+        rxDelivered = MIN(rxStream.size(), rxDelivered + 1 + rng() % maxChunk);
+        gpsHandleUBLOX();
+    }
+
+    // Each run hands over at most one solution, let the driver catch up
+    size_t handedOver;
+    do {
+        handedOver = solutions.size();
+        gpsHandleUBLOX();
+        gpsHandleUBLOX();
+    } while (solutions.size() != handedOver || rxConsumed < rxDelivered);
+}
+
+static void expectEpochs(const std::vector<unsigned> &epochs)
+{
+    ASSERT_EQ(epochs.size(), solutions.size());
+    for (size_t ii = 0; ii < epochs.size(); ii++) {
+        const unsigned epoch = epochs[ii];
+        EXPECT_EQ(epochLatitude(epoch), solutions[ii].llh.lat) << "solution " << ii;
+        EXPECT_EQ(epochLongitude(epoch), solutions[ii].llh.lon) << "solution " << ii;
+        EXPECT_EQ((512000 + (int)epoch) / 10, solutions[ii].llh.alt);
+        EXPECT_EQ((int)(1000 + epoch) / 10, solutions[ii].velNED[X]);
+        EXPECT_EQ(-200, solutions[ii].velNED[Y]);
+        EXPECT_EQ(GPS_FIX_3D, solutions[ii].fixType);
+        EXPECT_EQ(14, solutions[ii].numSat);
+        EXPECT_EQ(2024, solutions[ii].time.year);
+    }
+}
+
+static std::vector<unsigned> allEpochs(unsigned count)
+{
+    std::vector<unsigned> epochs;
+    for (unsigned epoch = 0; epoch < count; epoch++) {
+        epochs.push_back(epoch);
+    }
+    return epochs;
+}
+
+TEST(GpsUbloxTest, EveryChunkingDecodesEveryEpoch)
+{
+    const stream_t stream = makeStream(200);
+
+    for (unsigned maxChunk : { 1u, 7u, 64u, 300u, 1024u }) {
+        rngState = maxChunk;
+        runGps(stream, maxChunk);
+
+        SCOPED_TRACE(maxChunk);
+        expectEpochs(allEpochs(200));
+        EXPECT_EQ(0u, gpsStats.errors);
+        EXPECT_EQ(200u * 2 + 300u, gpsStats.packetCount);
+        EXPECT_EQ(stream.size(), rxConsumed);
+
+        std::cout << "chunks up to " << maxChunk << " bytes: " << stream.size() << " bytes in "
+            << portCalls << " serial port calls" << std::endl;
+    }
+}
+
+TEST(GpsUbloxTest, SolutionsBackToBackInOneChunk)
+{
+    // Whole stream at once, every solution still has to be handed over on its own
+    const stream_t stream = makeStream(50);
+    rngState = 1;
+    runGps(stream, stream.size());
+
+    expectEpochs(allEpochs(50));
+    EXPECT_LT(portCalls, 50u * 4);
+}
+
+TEST(GpsUbloxTest, CorruptedFramesAreDroppedAndCounted)
+{
+    stream_t stream = makeStream(100);
+
+    // Flip a payload byte of the PVT frame of some epochs. Each epoch's PVT
+    // frame ends its group, so find them by scanning for their headers.
+    std::vector<unsigned> expected;
+    unsigned epoch = 0;
+    unsigned corrupted = 0;
+    for (size_t ii = 0; ii + 4 < stream.size(); ii++) {
+        if (stream[ii] == UBX_PREAMBLE1 && stream[ii + 1] == UBX_PREAMBLE2 && stream[ii + 2] == UBX_CLASS_NAV && stream[ii + 3] == UBX_NAV_PVT) {
+            if (epoch % 7 == 3) {
+                stream[ii + UBX_HEADER_SIZE + 30] ^= 0x40;
+                corrupted++;
+            } else {
+                expected.push_back(epoch);
+            }
+            epoch++;
+            ii += 6;
+        }
+    }
+    ASSERT_EQ(100u, epoch);
+
+    rngState = 2;
+    runGps(stream, 128);
+
+    expectEpochs(expected);
+    EXPECT_EQ(corrupted, gpsStats.errors);
+}
+
+TEST(GpsUbloxTest, RecoversFromGarbageAndFalseSync)
+{
+    stream_t stream;
+    const stream_t good = makeStream(20);
+
+    // Noise full of sync chars, a header with an impossible payload length
+    // and one claiming a payload longer than the noise that follows it
+    for (int ii = 0; ii < 300; ii++) {
+        stream.push_back((ii % 5 == 0) ? UBX_PREAMBLE1 : (ii % 5 == 1) ? UBX_PREAMBLE2 : (uint8_t)rng());
+    }
+    stream.insert(stream.end(), { UBX_PREAMBLE1, UBX_PREAMBLE2, UBX_CLASS_NAV, UBX_NAV_PVT, 0xFF, 0xFF });
+    stream.insert(stream.end(), { UBX_PREAMBLE1, UBX_PREAMBLE2, UBX_CLASS_NAV, UBX_NAV_PVT, 0x00, 0x01 });
+    for (int ii = 0; ii < 300; ii++) {
+        stream.push_back(0x20 + ii % 64);
+    }
+    stream.insert(stream.end(), good.begin(), good.end());
+
+    rngState = 3;
+    runGps(stream, 100);
+
+    expectEpochs(allEpochs(20));
+    EXPECT_GT(gpsStats.errors, 0u);
+}
+
+// STUBS
+
+extern "C" {
+gpsReceiverData_t gpsState;
+gpsSolutionData_t gpsSol;
+gpsStatistics_t gpsStats;
+
+const uint32_t baudRates[] = { 0, 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
+        400000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2470000 };
+baudRate_e gpsToSerialBaudRate[GPS_BAUDRATE_COUNT] = { BAUD_115200, BAUD_57600, BAUD_38400, BAUD_19200, BAUD_9600, BAUD_230400 };
+
+timeMs_t millis(void) { return 0; }
+
+void gpsSetState(gpsState_e state) { gpsState.state = state; }
+void gpsSetProtocolTimeout(timeMs_t timeoutMs) { UNUSED(timeoutMs); }
+uint16_t gpsConstrainEPE(uint32_t epe) { return MIN(epe, 9999u); }
+uint16_t gpsConstrainHDOP(uint32_t hdop) { return MIN(hdop, 9999u); }
+
+void gpsProcessNewSolutionData(void)
+{
+    solutions.push_back(gpsSol);
+}
+
+char *strnstr(const char *s, const char *find, size_t slen)
+{
+    const size_t len = strlen(find);
+    for (; slen >= len && *s; s++, slen--) {
+        if (strncmp(s, find, len) == 0) {
+            return (char *)s;
+        }
+    }
+    return NULL;
+}
+}
@@ -0,0 +1,496 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drives the MAX7456 driver with recorded OSD screens against an emulated
+ * chip. Every SPI byte is fed into a model of the display memory, so the
+ * tests check that the streamed updates leave the chip showing the same
+ * characters as the legacy one write per character encoding, and how many
+ * bytes and update calls each of them needs.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "drivers/bus.h"
+    #include "drivers/max7456.h"
+    #include "drivers/osd.h"
+    #include "drivers/time.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define CHARS_PER_SCREEN    MAX7456_BUFFER_CHARS_PAL
+
+// Registers and bits as documented in the MAX7456 datasheet
+#define REG_VM0             0x00
+#define REG_DMM             0x04
+#define REG_DMAH            0x05
+#define REG_DMAL            0x06
+#define REG_DMDI            0x07
+#define REG_READ            0x80
+#define REG_STAT            0xA0
+
+#define VM0_RESET           0x02
+#define DMM_AUTOINC         0x01
+#define DMM_CLEAR           0x04
+#define DMM_8BIT            0x40
+#define DMM_ATTR_MASK       0x38
+#define DMAH_ATTR           0x02
+#define STAT_PAL            0x01
+#define END_STRING          0xFF
+
+typedef struct fakeMax7456_s {
+    uint8_t regs[0x80];
+    uint16_t addr;
+    bool attrSelected;
+    uint8_t chr[CHARS_PER_SCREEN];
+    uint8_t attr[CHARS_PER_SCREEN];
+    unsigned bytes;
+    unsigned transfers;
+} fakeMax7456_t;
+
+static fakeMax7456_t chip;
+static busDevice_t fakeBusDevice;
+static timeMs_t fakeMillis;
+
+static void fakeClearMemory(fakeMax7456_t *dev)
+{
+    memset(dev->chr, 0, sizeof(dev->chr));
+    memset(dev->attr, 0, sizeof(dev->attr));
+}
+
+static void fakeStore(fakeMax7456_t *dev, uint8_t chr, uint8_t attr)
+{
+    ASSERT_LT(dev->addr, CHARS_PER_SCREEN);
+    dev->chr[dev->addr] = chr;
+    dev->attr[dev->addr] = attr;
+}
+
+static void fakeWriteRegister(fakeMax7456_t *dev, uint8_t reg, uint8_t val)
+{
+    switch (reg) {
+        case REG_VM0:
+            dev->regs[REG_VM0] = val & ~VM0_RESET;
+            if (val & VM0_RESET) {
+                dev->regs[REG_DMM] = 0;
+                fakeClearMemory(dev);
+            }
+            break;
+        case REG_DMM:
+            if (val & DMM_CLEAR) {
+                fakeClearMemory(dev);
+            }
+            dev->regs[REG_DMM] = val & ~DMM_CLEAR;
+            break;
+        case REG_DMAH:
+            dev->attrSelected = val & DMAH_ATTR;
+            dev->addr = (dev->addr & 0xFF) | ((val & 0x01) << 8);
+            break;
+        case REG_DMAL:
+            dev->addr = (dev->addr & 0x100) | val;
+            break;
+        case REG_DMDI: {
+            const uint8_t dmm = dev->regs[REG_DMM];
+            if (dmm & DMM_AUTOINC) {
+                if (val == END_STRING) {
+                    dev->regs[REG_DMM] &= ~DMM_AUTOINC;
+                } else {
+                    fakeStore(dev, val, (dmm & DMM_ATTR_MASK) << 2);
+                    dev->addr++;
+                }
+            } else if (!(dmm & DMM_8BIT)) {
+                fakeStore(dev, val, (dmm & DMM_ATTR_MASK) << 2);
+            } else if (dev->attrSelected) {
+                ASSERT_LT(dev->addr, CHARS_PER_SCREEN);
+                dev->attr[dev->addr] = val;
+            } else {
+                ASSERT_LT(dev->addr, CHARS_PER_SCREEN);
+                dev->chr[dev->addr] = val;
+            }
+            break;
+        }
+        default:
+            dev->regs[reg & 0x7F] = val;
+            break;
+    }
+}
+
+static void fakeTransfer(fakeMax7456_t *dev, const uint8_t *buf, int len)
+{
+    ASSERT_EQ(0, len % 2);
+    for (int ii = 0; ii < len; ii += 2) {
+        fakeWriteRegister(dev, buf[ii], buf[ii + 1]);
+    }
+    dev->bytes += len;
+    dev->transfers++;
+}
+
+// The per character encoder the driver used before runs were streamed in
+// auto-increment mode, kept here as the reference for the byte counts.
+typedef struct legacyEncoder_s {
+    uint8_t dmm;
+    uint16_t shown[CHARS_PER_SCREEN];
+    bool dirty[CHARS_PER_SCREEN];
+} legacyEncoder_t;
+
+#define LEGACY_CHARS_PER_UPDATE     10
+
+static bool legacyDrawScreenPartial(legacyEncoder_t *enc, fakeMax7456_t *dev)
+{
+    uint8_t buf[LEGACY_CHARS_PER_UPDATE * 7 * 2];
+    int len = 0;
+    int count = 0;
+
+    for (unsigned pos = 0; pos < CHARS_PER_SCREEN && count < LEGACY_CHARS_PER_UPDATE; pos++) {
+        if (!enc->dirty[pos]) {
+            continue;
+        }
+        const uint8_t mode = osdCharacterGridBuffer[pos] & 0xFF;
+        const uint8_t chr = osdCharacterGridBuffer[pos] >> 8;
+        const uint8_t ph = pos >> 8;
+        const uint8_t pl = pos & 0xFF;
+        if (mode & 0x04) {
+            if (!(enc->dmm & DMM_8BIT)) {
+                enc->dmm |= DMM_8BIT;
+                buf[len++] = REG_DMM; buf[len++] = enc->dmm;
+            }
+            buf[len++] = REG_DMAH; buf[len++] = ph | DMAH_ATTR;
+            buf[len++] = REG_DMAL; buf[len++] = pl;
+            buf[len++] = REG_DMDI; buf[len++] = mode << 2;
+        } else if ((enc->dmm & DMM_8BIT) || (enc->dmm & DMM_ATTR_MASK) != mode) {
+            enc->dmm = (enc->dmm & ~(DMM_8BIT | DMM_ATTR_MASK)) | mode;
+            buf[len++] = REG_DMM; buf[len++] = enc->dmm;
+        }
+        buf[len++] = REG_DMAH; buf[len++] = ph;
+        buf[len++] = REG_DMAL; buf[len++] = pl;
+        buf[len++] = REG_DMDI; buf[len++] = chr;
+        enc->dirty[pos] = false;
+        count++;
+    }
+
+    if (len) {
+        fakeTransfer(dev, buf, len);
+        return true;
+    }
+    return false;
+}
+
+// Sends the characters marked dirty, one update call at a time, and
+// returns the number of calls needed.
+static unsigned legacyUpdate(legacyEncoder_t *enc, fakeMax7456_t *dev)
+{
+    unsigned calls = 0;
+    while (legacyDrawScreenPartial(enc, dev)) {
+        calls++;
+    }
+    return calls;
+}
+
+static legacyEncoder_t legacy;
+static fakeMax7456_t legacyChip;
+
+// Marks what the last driver call changed in osdCharacterGridBuffer as
+// dirty for the legacy encoder, like the driver does for itself.
+static void legacyTrackChanges(void)
+{
+    for (unsigned ii = 0; ii < CHARS_PER_SCREEN; ii++) {
+        if (legacy.shown[ii] != osdCharacterGridBuffer[ii]) {
+            legacy.shown[ii] = osdCharacterGridBuffer[ii];
+            legacy.dirty[ii] = true;
+        }
+    }
+}
+
+static void screenWrite(uint8_t x, uint8_t y, const char *buff, uint8_t mode)
+{
+    max7456Write(x, y, buff, mode);
+    legacyTrackChanges();
+}
+
+static void screenWriteChar(uint8_t x, uint8_t y, uint16_t c, uint8_t mode)
+{
+    max7456WriteChar(x, y, c, mode);
+    legacyTrackChanges();
+}
+
+static void screenClear(void)
+{
+    max7456ClearScreen();
+    legacyTrackChanges();
+}
+
+// Runs the driver until it has nothing left to send and returns the
+// number of update calls that transferred something.
+static unsigned driverUpdate(void)
+{
+    unsigned calls = 0;
+    for (;;) {
+        const unsigned transfers = chip.transfers;
+        max7456Update();
+        if (chip.transfers == transfers) {
+            return calls;
+        }
+        calls++;
+    }
+}
+
+static void expectChipShowsScreen(const fakeMax7456_t *dev)
+{
+    for (unsigned ii = 0; ii < CHARS_PER_SCREEN; ii++) {
+        const uint16_t val = osdCharacterGridBuffer[ii];
+        const uint8_t chr = val >> 8;
+        const uint8_t attr = (val & 0xFF) << 2;
+        if ((chr == 0x20 || chr == 0x00) && attr == 0) {
+            // Blank, the chip might hold either of them
+            EXPECT_TRUE(dev->chr[ii] == 0x20 || dev->chr[ii] == 0x00) << "pos " << ii;
+            EXPECT_EQ(0, dev->attr[ii]) << "pos " << ii;
+        } else {
+            EXPECT_EQ(chr, dev->chr[ii]) << "pos " << ii;
+            EXPECT_EQ(attr, dev->attr[ii]) << "pos " << ii;
+        }
+    }
+}
+
+#define BLINK   MAX7456_MODE_BLINK
+#define INVERT  MAX7456_MODE_INVERT
+
+static void drawFlightScreen(int frame)
+{
+    char buf[32];
+
+    screenWrite(1, 1, "RSSI", 0);
+    snprintf(buf, sizeof(buf), "%3d", 99 - frame % 7);
+    screenWrite(5, 1, buf, 0);
+    snprintf(buf, sizeof(buf), "%2d.%02dV", 16 - frame / 40, (frame * 7) % 100);
+    screenWrite(22, 1, buf, 0);
+    snprintf(buf, sizeof(buf), "%02d:%02d", frame / 60, frame % 60);
+    screenWrite(24, 2, buf, 0);
+    screenWriteChar(1, 2, 0x10A, 0);                   // extended font page
+    snprintf(buf, sizeof(buf), "%4dM", 120 + frame * 3 % 17);
+    screenWrite(1, 7, buf, 0);
+    snprintf(buf, sizeof(buf), "%3dKMH", 45 + frame % 11);
+    screenWrite(23, 7, buf, 0);
+    screenWriteChar(14, 7, 0x7E + frame % 2, 0);       // crosshair
+    snprintf(buf, sizeof(buf), "%4d", 300 + frame * 13 % 100);
+    screenWrite(13, 13, buf, 0);
+    screenWrite(9, 12, (frame / 5) % 2 ? "LOW BATTERY" : "           ", BLINK);
+    snprintf(buf, sizeof(buf), "%5dMAH", frame * 9);
+    screenWrite(1, 14, buf, 0);
+    snprintf(buf, sizeof(buf), "%02d", frame % 20);
+    screenWrite(17, 14, buf, INVERT);
+    screenWriteChar(19, 14, 0x101 + frame % 3, 0);
+}
+
+static void drawMenuScreen(int page)
+{
+    static const char * const items[] = {
+        "PID TUNING", "RATE PROFILE", "FILTERING", "MIXER",
+        "OSD LAYOUTS", "VTX SETTINGS", "FAILSAFE", "GPS RESCUE",
+        "BLACKBOX", "FEATURES", "SAVE AND REBOOT", "EXIT",
+    };
+    char buf[32];
+
+    screenClear();
+    snprintf(buf, sizeof(buf), "-- MAIN MENU %d --", page);
+    screenWrite(6, 1, buf, 0);
+    for (unsigned ii = 0; ii < ARRAYLEN(items); ii++) {
+        screenWrite(3, 3 + ii, items[ii], 0);
+        snprintf(buf, sizeof(buf), "%3d", (int)(page * 10 + ii));
+        screenWrite(24, 3 + ii, buf, 0);
+    }
+    screenWrite(1, 3 + page % ARRAYLEN(items), ">", INVERT);
+}
+
+class Max7456Test : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        // The driver only initializes the chip once, later tests
+        // start by blanking the screen left by the previous one.
+        static bool initialized = false;
+        if (!initialized) {
+            chip.regs[REG_STAT & 0x7F] = STAT_PAL;
+            max7456Init(VIDEO_SYSTEM_PAL);
+            initialized = true;
+        }
+        max7456ClearScreen();
+        driverUpdate();
+
+        // Start the reference from the same chip and screen state
+        legacyChip = chip;
+        memset(&legacy, 0, sizeof(legacy));
+        legacy.dmm = chip.regs[REG_DMM];
+        memcpy(legacy.shown, osdCharacterGridBuffer, sizeof(legacy.shown));
+        chip.bytes = chip.transfers = 0;
+        legacyChip.bytes = legacyChip.transfers = 0;
+    }
+};
+
+TEST_F(Max7456Test, StreamedRunsMatchLegacyEncoding)
+{
+    unsigned frames = 0;
+    unsigned driverCalls = 0;
+    unsigned legacyCalls = 0;
+
+    for (int frame = 0; frame < 120; frame++) {
+        if (frame >= 60 && frame < 66) {
+            drawMenuScreen(frame - 60);
+        } else {
+            if (frame == 66) {
+                screenClear();
+            }
+            drawFlightScreen(frame);
+        }
+        driverCalls += driverUpdate();
+        legacyCalls += legacyUpdate(&legacy, &legacyChip);
+        frames++;
+
+        expectChipShowsScreen(&chip);
+        expectChipShowsScreen(&legacyChip);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+        << "legacy:   " << (double)legacyChip.bytes / frames << " bytes/frame, "
+        << (double)legacyCalls / frames << " updates/frame" << std::endl
+        << "streamed: " << (double)chip.bytes / frames << " bytes/frame, "
+        << (double)driverCalls / frames << " updates/frame" << std::endl;
+
+    EXPECT_LT(chip.bytes, legacyChip.bytes);
+    EXPECT_LT(driverCalls, legacyCalls);
+}
+
+TEST_F(Max7456Test, FullRedrawFitsFewerUpdates)
+{
+    drawMenuScreen(3);
+    const unsigned legacyCalls = legacyUpdate(&legacy, &legacyChip);
+    const unsigned driverCalls = driverUpdate();
+
+    expectChipShowsScreen(&chip);
+    expectChipShowsScreen(&legacyChip);
+    // A menu is mostly words, so each update carries several times the
+    // characters it used to and the whole screen takes a third less SPI.
+    EXPECT_LE(driverCalls * 3, legacyCalls);
+    EXPECT_LT(chip.bytes * 3, legacyChip.bytes * 2);
+
+    // A full refresh clears the chip and resends everything
+    max7456RefreshAll();
+    expectChipShowsScreen(&chip);
+}
+
+TEST_F(Max7456Test, EndStringCharacterIsNotStreamed)
+{
+    // 0xFF terminates auto-increment mode, so it must be written on its own
+    screenWriteChar(4, 4, 'A', 0);
+    screenWriteChar(5, 4, 'B', 0);
+    screenWriteChar(6, 4, END_STRING, 0);
+    screenWriteChar(7, 4, 'C', 0);
+    screenWriteChar(8, 4, 'D', 0);
+    screenWriteChar(9, 4, 'E', 0);
+    screenWriteChar(10, 4, 'F', 0);
+    driverUpdate();
+
+    expectChipShowsScreen(&chip);
+}
+
+TEST_F(Max7456Test, BlinkAndExtendedCharactersSplitRuns)
+{
+    screenWrite(2, 9, "ABCDE", 0);
+    screenWrite(7, 9, "FGHIJ", BLINK);
+    screenWriteChar(12, 9, 0x150, BLINK);
+    screenWrite(13, 9, "KLMNO", BLINK);
+    driverUpdate();
+
+    expectChipShowsScreen(&chip);
+
+    // Overwrite part of a run with different attributes
+    screenWrite(4, 9, "xyz", INVERT);
+    driverUpdate();
+
+    expectChipShowsScreen(&chip);
+}
+
+// STUBS
+
+extern "C" {
+
+uint16_t osdCharacterGridBuffer[OSD_CHARACTER_GRID_BUFFER_SIZE];
+
+busDevice_t *busDeviceInit(busType_e bus, devHardwareType_e hw, uint8_t tag, resourceOwner_e owner)
+{
+    UNUSED(bus);
+    UNUSED(hw);
+    UNUSED(tag);
+    UNUSED(owner);
+    return &fakeBusDevice;
+}
+
+void busSetSpeed(const busDevice_t *dev, busSpeed_e speed)
+{
+    UNUSED(dev);
+    UNUSED(speed);
+}
+
+bool busWrite(const busDevice_t *dev, uint8_t reg, uint8_t data)
+{
+    UNUSED(dev);
+    fakeWriteRegister(&chip, reg, data);
+    return true;
+}
+
+bool busRead(const busDevice_t *dev, uint8_t reg, uint8_t *data)
+{
+    UNUSED(dev);
+    *data = chip.regs[reg & 0x7F];
+    return true;
+}
+
+bool busTransfer(const busDevice_t *dev, uint8_t *rxBuf, const uint8_t *txBuf, int length)
+{
+    UNUSED(dev);
+    UNUSED(rxBuf);
+    fakeTransfer(&chip, txBuf, length);
+    return true;
+}
+
+timeMs_t millis(void)
+{
+    return fakeMillis++;
+}
+
+void delay(timeMs_t ms)
+{
+    fakeMillis += ms;
+}
+
+void ledToggle(int led)
+{
+    UNUSED(led);
+}
+
+}
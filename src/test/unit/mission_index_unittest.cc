@@ -0,0 +1,135 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks the remaining distance the mission index returns along missions
+ * with loops and with an RTH waypoint ending them.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/vector.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_mission_index.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static navWaypoint_t waypoints[NAV_MAX_WAYPOINTS];
+static navMissionIndex_t missionIndex;
+static const fpVector3_t homePos = { .x = 0, .y = -3000, .z = 0 };
+
+// Waypoint lat and lon are used as local x and y in cm
+static void getWaypointPos(fpVector3_t *pos, const navWaypoint_t *waypoint)
+{
+    pos->x = waypoint->lat;
+    pos->y = waypoint->lon;
+    pos->z = waypoint->alt;
+}
+
+static void setWaypoint(int index, uint8_t action, int32_t x, int32_t y, int16_t p1 = 0, int16_t p3 = 0)
+{
+    memset(&waypoints[index], 0, sizeof(waypoints[index]));
+    waypoints[index].action = action;
+    waypoints[index].lat = x;
+    waypoints[index].lon = y;
+    waypoints[index].p1 = p1;
+    waypoints[index].p3 = p3;
+}
+
+static uint32_t remainingDistance(int activeWp, uint32_t activeWpDistance)
+{
+    uint32_t distance = 0;
+    EXPECT_TRUE(missionIndexGetRemainingDistance(&missionIndex, waypoints, activeWp, activeWpDistance, &distance));
+    return distance;
+}
+
+TEST(MissionIndexTest, RemainingDistanceAlongLegs)
+{
+    setWaypoint(0, NAV_WP_ACTION_WAYPOINT, 0, 0);
+    setWaypoint(1, NAV_WP_ACTION_SET_POI, 500, 500);
+    setWaypoint(2, NAV_WP_ACTION_WAYPOINT, 1000, 0);
+    setWaypoint(3, NAV_WP_ACTION_WAYPOINT, 1000, 1000);
+    missionIndexBuild(&missionIndex, waypoints, 0, 3, &homePos, getWaypointPos);
+
+    EXPECT_EQ(2000U, remainingDistance(0, 0));
+    EXPECT_EQ(1000U + 300U, remainingDistance(1, 300));
+    EXPECT_EQ(1000U + 300U, remainingDistance(2, 300));
+    EXPECT_EQ(300U, remainingDistance(3, 300));
+}
+
+TEST(MissionIndexTest, JumpAddsPendingRepetitions)
+{
+    setWaypoint(0, NAV_WP_ACTION_WAYPOINT, 0, 0);
+    setWaypoint(1, NAV_WP_ACTION_WAYPOINT, 1000, 0);
+    setWaypoint(2, NAV_WP_ACTION_JUMP, 0, 0, 0, 2);
+    setWaypoint(3, NAV_WP_ACTION_WAYPOINT, 1000, 1000);
+    missionIndexBuild(&missionIndex, waypoints, 0, 3, &homePos, getWaypointPos);
+
+    // Every repetition flies 0 -> 1 and back, 2000cm
+    EXPECT_EQ(1000U + 1000U + 2 * 2000U, remainingDistance(0, 0));
+
+    waypoints[2].p3 = 0;
+    EXPECT_EQ(1000U + 1000U, remainingDistance(0, 0));
+
+    // A loop without end has no remaining distance
+    uint32_t distance;
+    waypoints[2].p3 = -1;
+    EXPECT_FALSE(missionIndexGetRemainingDistance(&missionIndex, waypoints, 0, 0, &distance));
+}
+
+TEST(MissionIndexTest, RthWaypointEndsMissionAtHome)
+{
+    setWaypoint(0, NAV_WP_ACTION_WAYPOINT, 0, 0);
+    setWaypoint(1, NAV_WP_ACTION_WAYPOINT, 4000, 0);
+    setWaypoint(2, NAV_WP_ACTION_WAYPOINT, 4000, 3000);
+    // RTH waypoints carry no position, they're flown to home
+    setWaypoint(3, NAV_WP_ACTION_RTH, 0, 0);
+    // Never flown
+    setWaypoint(4, NAV_WP_ACTION_WAYPOINT, 100000, 100000);
+    setWaypoint(5, NAV_WP_ACTION_JUMP, 0, 0, 4, 5);
+    missionIndexBuild(&missionIndex, waypoints, 0, 5, &homePos, getWaypointPos);
+
+    // 2 -> home is 4000 across and 6000 down
+    const uint32_t homeLeg = 7211;
+    EXPECT_EQ(4000U + 3000U + homeLeg, remainingDistance(0, 0));
+    EXPECT_EQ(3000U + homeLeg + 250U, remainingDistance(1, 250));
+    EXPECT_EQ(homeLeg + 250U, remainingDistance(2, 250));
+    EXPECT_EQ(0U, missionIndex.jumpCount);
+
+    uint32_t distance;
+    EXPECT_FALSE(missionIndexGetRemainingDistance(&missionIndex, waypoints, 4, 0, &distance));
+}
+
+TEST(MissionIndexTest, MultiMissionEndingAtRth)
+{
+    // A multi mission starts further down the waypoint list
+    setWaypoint(6, NAV_WP_ACTION_WAYPOINT, 0, 1000);
+    setWaypoint(7, NAV_WP_ACTION_SET_HEAD, 0, 0, 90);
+    setWaypoint(8, NAV_WP_ACTION_RTH, 0, 0);
+    missionIndexBuild(&missionIndex, waypoints, 6, 8, &homePos, getWaypointPos);
+
+    EXPECT_EQ(4000U + 500U, remainingDistance(6, 500));
+}
@@ -0,0 +1,279 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks that pipelined MSP requests are only answered when the TX buffer
+ * has room for the reply, using a fake serial port with a limited TX buffer.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/streambuf.h"
+    #include "common/utils.h"
+
+    #include "drivers/serial.h"
+
+    #include "io/serial.h"
+
+    #include "fc/cli.h"
+
+    #include "msp/msp.h"
+    #include "msp/msp_serial.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FAKE_TX_BUFFER_SIZE     256
+#define REPLY_SIZE              100
+#define LARGE_REPLY_SIZE        240     // Bigger than a bulk frame, about the size of MSP_BOXNAMES
+#define BULK_COMMAND            10
+#define LARGE_COMMAND           11
+#define BULK_FRAMES             3
+
+static std::vector<uint8_t> rxStream;
+static size_t rxConsumed;
+static int txUsed;
+static std::vector<uint16_t> sentReplies;    // command of every reply frame written
+static std::vector<uint16_t> processedCommands;
+
+static uint32_t fakeRxBytesWaiting(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return rxStream.size() - rxConsumed;
+}
+
+static uint8_t fakeRead(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return rxStream[rxConsumed++];
+}
+
+static uint32_t fakeTxBytesFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    // One byte of a ring buffer is always unused
+    return FAKE_TX_BUFFER_SIZE - 1 - txUsed;
+}
+
+static bool fakeIsTxBufferEmpty(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return txUsed == 0;
+}
+
+static void fakeWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    // serialWriteBuf() would wait for the TX buffer to drain
+    EXPECT_LE(count, (int)fakeTxBytesFree(instance));
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    if (count >= 5 && bytes[0] == '$' && bytes[1] == 'M') {
+        sentReplies.push_back(bytes[4]);
+    }
+    txUsed += count;
+}
+
+static struct serialPortVTable fakeVTable = {
+    .serialWrite = NULL,
+    .serialTotalRxWaiting = fakeRxBytesWaiting,
+    .serialTotalTxFree = fakeTxBytesFree,
+    .serialRead = fakeRead,
+    .readBuf = NULL,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = fakeIsTxBufferEmpty,
+    .setMode = NULL,
+    .writeBuf = fakeWriteBuf,
+    .isConnected = NULL,
+    .isIdle = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+};
+
+static serialPort_t fakePort;
+static mspPort_t mspPort;
+
+static mspResult_e fakeProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    UNUSED(mspPostProcessFn);
+    processedCommands.push_back(cmd->cmd);
+    reply->cmd = cmd->cmd;
+
+    if (cmd->cmd != BULK_COMMAND) {
+        const int replySize = cmd->cmd == LARGE_COMMAND ? LARGE_REPLY_SIZE : REPLY_SIZE;
+        for (int ii = 0; ii < replySize; ii++) {
+            sbufWriteU8(&reply->buf, ii);
+        }
+        return MSP_RESULT_ACK;
+    }
+
+    // Bulk reply, the request carries the number of the frame
+    const uint8_t frame = sbufBytesRemaining(&cmd->buf) ? sbufReadU8(&cmd->buf) : 0;
+    for (int ii = 0; ii < MSP_BULK_FRAME_SIZE; ii++) {
+        sbufWriteU8(&reply->buf, frame);
+    }
+    if (frame + 1 < BULK_FRAMES) {
+        reply->continuation[0] = frame + 1;
+        reply->continuationSize = 1;
+    }
+    return MSP_RESULT_ACK;
+}
+
+static void queueRequest(uint8_t cmd)
+{
+    const uint8_t request[] = { '$', 'M', '<', 0, cmd, cmd };
+    rxStream.insert(rxStream.end(), request, request + sizeof(request));
+}
+
+static void resetPort(int txBufferUsed)
+{
+    rxStream.clear();
+    rxConsumed = 0;
+    txUsed = txBufferUsed;
+    sentReplies.clear();
+    processedCommands.clear();
+    fakePort.vTable = &fakeVTable;
+    resetMspPort(&mspPort, &fakePort);
+}
+
+static void processPort(void)
+{
+    mspSerialProcessOnePort(&mspPort, MSP_SKIP_NON_MSP_DATA, fakeProcessCommand);
+}
+
+TEST(MspSerialTest, RequestWaitsForTxSpace)
+{
+    // Not enough room for a reply, no request may be answered, not even the first one
+    resetPort(200);
+    queueRequest(1);
+    queueRequest(2);
+    queueRequest(3);
+
+    processPort();
+    processPort();
+    EXPECT_TRUE(processedCommands.empty());
+    EXPECT_TRUE(sentReplies.empty());
+    EXPECT_EQ(200, txUsed);
+
+    // Once the buffer drains the requests are answered in order,
+    // the next one each time the previous reply has gone out
+    txUsed = 0;
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ 1 }), sentReplies);
+
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ 1 }), sentReplies);
+
+    txUsed = 0;
+    processPort();
+    txUsed = 0;
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ 1, 2, 3 }), sentReplies);
+    EXPECT_EQ(processedCommands, sentReplies);
+}
+
+TEST(MspSerialTest, LargeReplyAfterSmallReplyIsNotDropped)
+{
+    resetPort(0);
+    queueRequest(1);
+    queueRequest(LARGE_COMMAND);
+
+    // The large reply doesn't fit next to the small one, its request waits
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ 1 }), sentReplies);
+    EXPECT_EQ(std::vector<uint16_t>({ 1 }), processedCommands);
+
+    txUsed = 0;
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ 1, LARGE_COMMAND }), sentReplies);
+    EXPECT_EQ(processedCommands, sentReplies);
+}
+
+TEST(MspSerialTest, BulkFramesWaitForTxSpace)
+{
+    resetPort(0);
+    queueRequest(BULK_COMMAND);
+    queueRequest(1);
+
+    // Two bulk frames fit the TX buffer, the rest of the reply
+    // and the next request wait for it to drain
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ BULK_COMMAND, BULK_COMMAND }), sentReplies);
+
+    processPort();
+    EXPECT_EQ(2U, sentReplies.size());
+
+    txUsed = 0;
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ BULK_COMMAND, BULK_COMMAND, BULK_COMMAND }), sentReplies);
+
+    txUsed = 0;
+    processPort();
+    EXPECT_EQ(std::vector<uint16_t>({ BULK_COMMAND, BULK_COMMAND, BULK_COMMAND, 1 }), sentReplies);
+    EXPECT_EQ(processedCommands, sentReplies);
+}
+
+// STUBS
+
+extern "C" {
+bool cliMode = false;
+serialConfig_t serialConfig_System;
+
+const uint32_t baudRates[] = { 0, 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
+        400000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2470000 };
+
+timeMs_t millis(void) { return 0; }
+
+void cliEnter(serialPort_t *serialPort) { UNUSED(serialPort); }
+void systemResetToBootloader(void) {}
+void waitForSerialPortToFinishTransmitting(serialPort_t *serialPort) { UNUSED(serialPort); }
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return NULL;
+}
+
+serialPortConfig_t *findNextSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return NULL;
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr rxCallback,
+    void *rxCallbackData, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier);
+    UNUSED(function);
+    UNUSED(rxCallback);
+    UNUSED(rxCallbackData);
+    UNUSED(baudrate);
+    UNUSED(mode);
+    UNUSED(options);
+    return NULL;
+}
+
+void closeSerialPort(serialPort_t *serialPort) { UNUSED(serialPort); }
+}
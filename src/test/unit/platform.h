@@ -84,3 +84,13 @@ extern SysTick_Type *SysTick;
 #define FAST_CODE 
 #define NOINLINE
 #define EXTENDED_FASTRAM
+
+#if defined(CONFIG_IN_FILE)
+// Config storage in RAM, as target/common_post.h sets it up
+#ifndef EEPROM_SIZE
+#define EEPROM_SIZE     8192
+#endif
+extern uint8_t eepromData[EEPROM_SIZE];
+#define __config_start (*eepromData)
+#define __config_end (eepromData[EEPROM_SIZE])
+#endif
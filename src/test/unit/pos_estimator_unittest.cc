@@ -0,0 +1,292 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays an aggressive multirotor flight through the real inertial position
+ * estimator. The accelerometer is sampled at 500Hz with noise and bias, the
+ * baro at 25Hz and the GPS at 10Hz with its solutions delayed the way a
+ * u-blox receiver delivers them. Estimate error against the flown truth is
+ * compared with and without compensating for the GPS delay.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <iomanip>
+#include <iostream>
+
+extern "C" {
+    #define _Static_assert static_assert
+
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+
+    #include "drivers/time.h"
+
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+
+    #include "io/gps.h"
+
+    #include "navigation/navigation.h"
+    #include "navigation/navigation_private.h"
+    #include "navigation/navigation_pos_estimator_private.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/gyro.h"
+    #include "sensors/sensors.h"
+
+    extern const positionEstimationConfig_t pgResetTemplate_positionEstimationConfig;
+    void initializePositionEstimator(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define REPLAY_LOOP_US          2000        // 500Hz
+#define REPLAY_GPS_US           100000      // 10Hz
+#define REPLAY_BARO_US          40000       // 25Hz
+#define REPLAY_DURATION_US      60000000
+#define REPLAY_SETTLE_US        10000000    // ignore the start while estimate converges
+
+static timeUs_t simTimeUs;
+static int32_t simBaroAltitude;
+static uint32_t rngState;
+
+static float uniform(void)
+{
+    rngState = rngState * 1664525 + 1013904223;
+    return (rngState >> 8) / 16777216.0f;
+}
+
+static float gaussian(float sigma)
+{
+    const float u1 = MAX(uniform(), 1e-7f);
+    const float u2 = uniform();
+    return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PIf * u2);
+}
+
+typedef struct {
+    fpVector3_t pos;
+    fpVector3_t vel;
+    fpVector3_t acc;
+} truth_t;
+
+// Stop-and-go flight, up to 15m/s and 1.2G horizontally, climbing and descending at up to 3m/s
+static truth_t flightAt(timeUs_t timeUs)
+{
+    const float t = US2S(timeUs);
+    const float wx = 2.0f * M_PIf / 8.0f;
+    const float wy = 2.0f * M_PIf / 5.0f;
+    const float wz = 2.0f * M_PIf / 10.0f;
+    truth_t truth;
+
+    truth.pos.x = -1500.0f / wx * cosf(wx * t);
+    truth.vel.x = 1500.0f * sinf(wx * t);
+    truth.acc.x = 1500.0f * wx * cosf(wx * t);
+
+    truth.pos.y = -1000.0f / wy * cosf(wy * t + 1.0f);
+    truth.vel.y = 1000.0f * sinf(wy * t + 1.0f);
+    truth.acc.y = 1000.0f * wy * cosf(wy * t + 1.0f);
+
+    truth.pos.z = 5000.0f - 300.0f / wz * cosf(wz * t);
+    truth.vel.z = 300.0f * sinf(wz * t);
+    truth.acc.z = 300.0f * wz * cosf(wz * t);
+
+    return truth;
+}
+
+typedef struct {
+    float rmsErrorXY;       // cm
+    float maxErrorXY;       // cm
+    float rmsErrorZ;        // cm
+    float rmsVelErrorXY;    // cm/s
+} replayResult_t;
+
+static replayResult_t replay(unsigned gpsDelayMs, unsigned actualGpsDelayMs)
+{
+    memcpy(positionEstimationConfigMutable(), &pgResetTemplate_positionEstimationConfig, sizeof(positionEstimationConfig_t));
+    positionEstimationConfigMutable()->gps_delay_ms = gpsDelayMs;
+    gyroConfigMutable()->init_gyro_cal_enabled = false;
+    gyroConfigMutable()->gravity_cmss_cal = GRAVITY_CMSS;
+
+    memset(&posEstimator, 0, sizeof(posEstimator));
+    posControl.gpsOrigin.valid = true;
+    armingFlags = ARMED | WAS_EVER_ARMED;
+    rngState = 1;
+    simTimeUs = REPLAY_LOOP_US;
+    initializePositionEstimator();
+
+    double sumSqXY = 0, sumSqZ = 0, sumSqVel = 0;
+    float maxErrorXY = 0;
+    unsigned samples = 0;
+
+    for (; simTimeUs < REPLAY_DURATION_US; simTimeUs += REPLAY_LOOP_US) {
+        const truth_t now = flightAt(simTimeUs);
+
+        // Level attitude, body frame lines up with NEU
+        imuMeasuredAccelBF.x = now.acc.x + gaussian(50.0f) + 15.0f;
+        imuMeasuredAccelBF.y = now.acc.y + gaussian(50.0f) - 10.0f;
+        imuMeasuredAccelBF.z = now.acc.z + GRAVITY_CMSS + gaussian(50.0f);
+
+        if (simTimeUs % REPLAY_BARO_US == 0) {
+            simBaroAltitude = lrintf(flightAt(simTimeUs).pos.z - 5000.0f + gaussian(30.0f));
+            updatePositionEstimator_BaroTopic(simTimeUs);
+        }
+
+        if (simTimeUs % REPLAY_GPS_US == 0 && simTimeUs > MS2US(actualGpsDelayMs)) {
+            const truth_t measured = flightAt(simTimeUs - MS2US(actualGpsDelayMs));
+            posEstimator.gps.pos.x = measured.pos.x + gaussian(30.0f);
+            posEstimator.gps.pos.y = measured.pos.y + gaussian(30.0f);
+            posEstimator.gps.pos.z = measured.pos.z - 5000.0f + gaussian(80.0f);
+            posEstimator.gps.vel.x = measured.vel.x + gaussian(10.0f);
+            posEstimator.gps.vel.y = measured.vel.y + gaussian(10.0f);
+            posEstimator.gps.vel.z = measured.vel.z + gaussian(20.0f);
+            posEstimator.gps.eph = 150;
+            posEstimator.gps.epv = 300;
+            posEstimator.gps.lastUpdateTime = simTimeUs;
+        }
+
+        updatePositionEstimator();
+
+        if (simTimeUs >= REPLAY_SETTLE_US) {
+            const float errorXY = calc_length_pythagorean_2D(posEstimator.est.pos.x - now.pos.x, posEstimator.est.pos.y - now.pos.y);
+            sumSqXY += sq(errorXY);
+            sumSqZ += sq(posEstimator.est.pos.z - (now.pos.z - 5000.0f));
+            sumSqVel += sq(posEstimator.est.vel.x - now.vel.x) + sq(posEstimator.est.vel.y - now.vel.y);
+            maxErrorXY = MAX(maxErrorXY, errorXY);
+            samples++;
+        }
+    }
+
+    replayResult_t result;
+    result.rmsErrorXY = sqrt(sumSqXY / samples);
+    result.maxErrorXY = maxErrorXY;
+    result.rmsErrorZ = sqrt(sumSqZ / samples);
+    result.rmsVelErrorXY = sqrt(sumSqVel / samples);
+    return result;
+}
+
+static void report(const char *name, const replayResult_t &result)
+{
+    std::cout << std::fixed << std::setprecision(1) << name
+        << ": XY rms " << result.rmsErrorXY << "cm, max " << result.maxErrorXY
+        << "cm, Z rms " << result.rmsErrorZ << "cm, vel XY rms " << result.rmsVelErrorXY << "cm/s" << std::endl;
+}
+
+TEST(PositionEstimatorTest, DelayedGpsIsFusedAtMeasurementTime)
+{
+    const replayResult_t uncompensated = replay(0, 150);
+    const replayResult_t compensated = replay(150, 150);
+    report("150ms GPS delay, not compensated", uncompensated);
+    report("150ms GPS delay, compensated    ", compensated);
+
+    EXPECT_LT(compensated.rmsErrorXY, uncompensated.rmsErrorXY * 0.6f);
+    EXPECT_LT(compensated.rmsVelErrorXY, uncompensated.rmsVelErrorXY);
+    EXPECT_LT(compensated.rmsErrorXY, 100.0f);
+}
+
+TEST(PositionEstimatorTest, DefaultDelayDoesNotHurtPromptGps)
+{
+    // A receiver faster than the configured delay must not end up worse than
+    // the uncompensated estimate of a typical one
+    const replayResult_t prompt = replay(100, 50);
+    const replayResult_t typical = replay(0, 150);
+    report("50ms GPS delay, 100ms configured", prompt);
+
+    EXPECT_LT(prompt.rmsErrorXY, typical.rmsErrorXY);
+}
+
+TEST(PositionEstimatorTest, BaroFilterDelayIsCompensated)
+{
+    const replayResult_t result = replay(150, 150);
+
+    // Baro average alone lags ~160ms behind a 3m/s climb, i.e. up to ~50cm
+    EXPECT_LT(result.rmsErrorZ, 30.0f);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t armingFlags;
+uint32_t stateFlags;
+uint8_t debugMode;
+int32_t debug[DEBUG32_VALUE_COUNT];
+uint16_t navEPH;
+uint16_t navEPV;
+int16_t navAccNEU[3];
+
+attitudeEulerAngles_t attitude;
+fpVector3_t imuMeasuredAccelBF;
+gpsSolutionData_t gpsSol;
+navigationPosControl_t posControl;
+gyroConfig_t gyroConfig_System;
+
+timeUs_t micros(void) { return simTimeUs; }
+timeMs_t millis(void) { return simTimeUs / 1000; }
+
+bool sensors(uint32_t mask) { return mask & (SENSOR_GPS | SENSOR_BARO | SENSOR_ACC); }
+bool IS_RC_MODE_ACTIVE(boxId_e boxId) { UNUSED(boxId); return false; }
+
+bool isImuReady(void) { return true; }
+bool isImuHeadingValid(void) { return true; }
+void imuTransformVectorBodyToEarth(fpVector3_t * v) { UNUSED(v); }
+void imuTransformVectorEarthToBody(fpVector3_t * v) { UNUSED(v); }
+void imuSetMagneticDeclination(float declinationDeg) { UNUSED(declinationDeg); }
+
+bool accIsClipped(void) { return false; }
+float accGetVibrationLevel(void) { return 0; }
+uint32_t accGetClipCount(void) { return 0; }
+void setGravityCalibration(float calibrationGravity) { UNUSED(calibrationGravity); }
+
+int32_t baroCalculateAltitude(void) { return simBaroAltitude; }
+bool baroIsCalibrationComplete(void) { return true; }
+
+bool isGPSHeadingValid(void) { return false; }
+float geoCalculateMagDeclination(const gpsLocation_t * llh) { UNUSED(llh); return 0; }
+void geoSetOrigin(gpsOrigin_t * origin, const gpsLocation_t * llh, geoOriginResetMode_e resetMode) { UNUSED(origin); UNUSED(llh); UNUSED(resetMode); }
+bool geoConvertGeodeticToLocal(fpVector3_t * pos, const gpsOrigin_t * origin, const gpsLocation_t * llh, geoAltitudeConversionMode_e altConv)
+{
+    UNUSED(pos); UNUSED(origin); UNUSED(llh); UNUSED(altConv);
+    return true;
+}
+
+void estimationCalculateAGL(estimationContext_t * ctx) { UNUSED(ctx); }
+bool estimationCalculateCorrection_XY_FLOW(estimationContext_t * ctx) { UNUSED(ctx); return false; }
+
+void updateActualHeading(bool headingValid, int32_t newHeading, int32_t newGroundCourse) { UNUSED(headingValid); UNUSED(newHeading); UNUSED(newGroundCourse); }
+void updateActualHorizontalPositionAndVelocity(bool estPosValid, bool estVelValid, float newX, float newY, float newVelX, float newVelY)
+{
+    UNUSED(estPosValid); UNUSED(estVelValid); UNUSED(newX); UNUSED(newY); UNUSED(newVelX); UNUSED(newVelY);
+}
+void updateActualAltitudeAndClimbRate(bool estimateValid, float newAltitude, float newVelocity, float surfaceDistance, float surfaceVelocity, navigationEstimateStatus_e surfaceStatus)
+{
+    UNUSED(estimateValid); UNUSED(newAltitude); UNUSED(newVelocity); UNUSED(surfaceDistance); UNUSED(surfaceVelocity); UNUSED(surfaceStatus);
+}
+}
@@ -0,0 +1,337 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays flown tracks into the RTH trackback store and measures how far
+ * the flown path strays from the track it keeps, compared with the old
+ * ring of NAV_RTH_TRACKBACK_POINTS raw points that only remembered the
+ * most recent part of the flight.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/vector.h"
+
+    #include "navigation/navigation_rth_trackback.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LEGACY_TRACKBACK_POINTS     50      // ring size before the store was simplified
+#define SAMPLE_INTERVAL_S           1.0f
+#define TRACKPOINT_SPACING_CM       5000.0f // trackpoints saved at least every 50m
+
+typedef std::vector<fpVector3_t> track_t;
+
+static fpVector3_t makePos(float x, float y, float z)
+{
+    fpVector3_t pos;
+    pos.x = x;
+    pos.y = y;
+    pos.z = z;
+    return pos;
+}
+
+static float distance3D(const fpVector3_t &a, const fpVector3_t &b)
+{
+    return sqrtf(sq(a.x - b.x) + sq(a.y - b.y) + sq(a.z - b.z));
+}
+
+static float distanceToSegment(const fpVector3_t &p, const fpVector3_t &a, const fpVector3_t &b)
+{
+    const float segX = b.x - a.x, segY = b.y - a.y, segZ = b.z - a.z;
+    const float lenSq = sq(segX) + sq(segY) + sq(segZ);
+    float t = 0;
+    if (lenSq > 0) {
+        t = ((p.x - a.x) * segX + (p.y - a.y) * segY + (p.z - a.z) * segZ) / lenSq;
+        t = std::min(1.0f, std::max(0.0f, t));
+    }
+    return distance3D(p, makePos(a.x + t * segX, a.y + t * segY, a.z + t * segZ));
+}
+
+static float distanceToPath(const fpVector3_t &p, const track_t &path)
+{
+    if (path.size() == 1) {
+        return distance3D(p, path[0]);
+    }
+    float best = INFINITY;
+    for (size_t ii = 0; ii + 1 < path.size(); ii++) {
+        best = std::min(best, distanceToSegment(p, path[ii], path[ii + 1]));
+    }
+    return best;
+}
+
+// Flies a path given as heading (deg) and climb rate (cm/s) per second of
+// flight at constant ground speed, recording a sample every second.
+template <typename F>
+static track_t fly(unsigned seconds, float speed, F control)
+{
+    track_t flown;
+    fpVector3_t pos = makePos(0, 0, 5000);
+    for (unsigned t = 0; t < seconds; t++) {
+        float heading, climbRate;
+        control(t, &heading, &climbRate);
+        pos.x += speed * SAMPLE_INTERVAL_S * cosf(DEGREES_TO_RADIANS(heading));
+        pos.y += speed * SAMPLE_INTERVAL_S * sinf(DEGREES_TO_RADIANS(heading));
+        pos.z += climbRate * SAMPLE_INTERVAL_S;
+        flown.push_back(pos);
+    }
+    return flown;
+}
+
+// 40km out with a slow meander and a climb, then back by another route
+static track_t longRangeTrack(void)
+{
+    return fly(4400, 1800, [](unsigned t, float *heading, float *climb) {
+        const bool out = t < 2200;
+        *heading = (out ? 20 : 200 + 15) + 25 * sinf(t / 90.0f);
+        *climb = out ? (t < 300 ? 150 : 0) : -20;
+    });
+}
+
+// 20 survey legs of 1.5km, 100m apart
+static track_t surveyTrack(void)
+{
+    return fly(20 * (100 + 7), 1500, [](unsigned t, float *heading, float *climb) {
+        const unsigned leg = t / 107;
+        const unsigned phase = t % 107;
+        if (phase < 100) {
+            *heading = (leg % 2) ? 180 : 0;
+        } else {
+            *heading = 90;
+        }
+        *climb = 0;
+    });
+}
+
+// Wandering multirotor flight with frequent course changes
+static track_t wanderTrack(void)
+{
+    uint32_t seed = 12345;
+    float heading = 0;
+    return fly(3600, 800, [&](unsigned t, float *hdg, float *climb) {
+        if (t % 20 == 0) {
+            seed = seed * 1103515245 + 12345;
+            heading += (float)((seed >> 16) % 120) - 60;
+        }
+        *hdg = heading;
+        *climb = (t % 600 < 300) ? 30 : -30;
+    });
+}
+
+typedef struct replayResult_s {
+    unsigned trackpoints;
+    unsigned storedPoints;
+    float maxDeviation;         // cm, flown path to stored track
+    float coveredFraction;      // part of the flown path within 50m of the stored track
+} replayResult_t;
+
+static replayResult_t measure(const track_t &flown, const track_t &kept, unsigned trackpoints)
+{
+    replayResult_t result = {};
+    result.trackpoints = trackpoints;
+    result.storedPoints = kept.size();
+    unsigned covered = 0;
+    for (const fpVector3_t &p : flown) {
+        const float deviation = distanceToPath(p, kept);
+        result.maxDeviation = std::max(result.maxDeviation, deviation);
+        covered += deviation < 5000;
+    }
+    result.coveredFraction = (float)covered / flown.size();
+    return result;
+}
+
+static replayResult_t replay(const track_t &flown, rthTrackback_t *tb)
+{
+    unsigned trackpoints = 0;
+    fpVector3_t last = flown[0];
+
+    rthTrackbackReset(tb);
+    rthTrackbackAddPoint(tb, &flown[0]);
+    trackpoints++;
+    for (size_t ii = 1; ii < flown.size(); ii++) {
+        if (distance3D(flown[ii], last) >= TRACKPOINT_SPACING_CM || ii == flown.size() - 1) {
+            rthTrackbackAddPoint(tb, &flown[ii]);
+            last = flown[ii];
+            trackpoints++;
+        }
+    }
+
+    track_t kept;
+    for (unsigned ii = 0; ii < tb->count; ii++) {
+        fpVector3_t pos;
+        rthTrackbackGetPoint(tb, ii, &pos);
+        kept.push_back(pos);
+    }
+    return measure(flown, kept, trackpoints);
+}
+
+static replayResult_t replayLegacy(const track_t &flown)
+{
+    track_t ring;
+    unsigned trackpoints = 0;
+    fpVector3_t last = flown[0];
+
+    for (size_t ii = 0; ii < flown.size(); ii++) {
+        if (ii == 0 || distance3D(flown[ii], last) >= TRACKPOINT_SPACING_CM || ii == flown.size() - 1) {
+            ring.push_back(flown[ii]);
+            if (ring.size() > LEGACY_TRACKBACK_POINTS) {
+                ring.erase(ring.begin());
+            }
+            last = flown[ii];
+            trackpoints++;
+        }
+    }
+    return measure(flown, ring, trackpoints);
+}
+
+static void report(const char *name, const replayResult_t &legacy, const replayResult_t &simplified, const rthTrackback_t *tb)
+{
+    std::cout << std::fixed << std::setprecision(1) << name << ": " << legacy.trackpoints << " trackpoints" << std::endl
+        << "  legacy:     " << LEGACY_TRACKBACK_POINTS * sizeof(fpVector3_t) << " bytes, "
+        << legacy.storedPoints << " points, " << legacy.coveredFraction * 100 << "% of path covered, max deviation "
+        << legacy.maxDeviation / 100 << "m" << std::endl
+        << "  simplified: " << sizeof(rthTrackback_t) << " bytes, "
+        << simplified.storedPoints << " points, " << simplified.coveredFraction * 100 << "% of path covered, max deviation "
+        << simplified.maxDeviation / 100 << "m (tolerance " << tb->tolerance / 100 << "m)" << std::endl;
+}
+
+TEST(RthTrackbackTest, LongRangeFlightKeepsWholeRoute)
+{
+    static rthTrackback_t tb;
+    const track_t flown = longRangeTrack();
+
+    const replayResult_t legacy = replayLegacy(flown);
+    const replayResult_t simplified = replay(flown, &tb);
+    report("long range", legacy, simplified, &tb);
+
+    EXPECT_LE(sizeof(rthTrackback_t), LEGACY_TRACKBACK_POINTS * sizeof(fpVector3_t) + 16);
+    EXPECT_GT(simplified.trackpoints, (unsigned)RTH_TRACKBACK_POINTS);
+    EXPECT_LT(legacy.coveredFraction, 0.2f);
+    EXPECT_FLOAT_EQ(1.0f, simplified.coveredFraction);
+    EXPECT_LT(simplified.maxDeviation, 5000);
+}
+
+TEST(RthTrackbackTest, SurveyKeepsEveryTurn)
+{
+    static rthTrackback_t tb;
+    const track_t flown = surveyTrack();
+
+    const replayResult_t legacy = replayLegacy(flown);
+    const replayResult_t simplified = replay(flown, &tb);
+    report("survey", legacy, simplified, &tb);
+
+    // Straight legs collapse to their ends, so every turn fits and only
+    // the corner cutting of the trackpoint spacing remains
+    EXPECT_FLOAT_EQ(1.0f, simplified.coveredFraction);
+    EXPECT_LT(tb.tolerance, RTH_TRACKBACK_MIN_DEVIATION);
+    EXPECT_LT(simplified.maxDeviation, TRACKPOINT_SPACING_CM / 2 + RTH_TRACKBACK_XY_RESOLUTION);
+}
+
+TEST(RthTrackbackTest, WanderingFlightDegradesGracefully)
+{
+    static rthTrackback_t tb;
+    const track_t flown = wanderTrack();
+
+    const replayResult_t legacy = replayLegacy(flown);
+    const replayResult_t simplified = replay(flown, &tb);
+    report("wander", legacy, simplified, &tb);
+
+    EXPECT_GT(simplified.coveredFraction, legacy.coveredFraction);
+    EXPECT_GT(simplified.coveredFraction, 0.9f);
+}
+
+TEST(RthTrackbackTest, EndpointsSurviveCompaction)
+{
+    static rthTrackback_t tb;
+    const track_t flown = longRangeTrack();
+    replay(flown, &tb);
+
+    fpVector3_t first, last;
+    rthTrackbackGetPoint(&tb, 0, &first);
+    rthTrackbackGetPoint(&tb, tb.count - 1, &last);
+
+    // Within the quantization step
+    EXPECT_LT(distance3D(first, flown.front()), RTH_TRACKBACK_XY_RESOLUTION);
+    EXPECT_LT(distance3D(last, flown.back()), RTH_TRACKBACK_XY_RESOLUTION);
+    EXPECT_LE(tb.count, RTH_TRACKBACK_POINTS);
+}
+
+TEST(RthTrackbackTest, QuantizationClampsFarPoints)
+{
+    static rthTrackback_t tb;
+    rthTrackbackReset(&tb);
+
+    const fpVector3_t far = makePos(1e9f, -1e9f, 1e7f);
+    rthTrackbackAddPoint(&tb, &far);
+
+    fpVector3_t pos;
+    rthTrackbackGetPoint(&tb, 0, &pos);
+    EXPECT_FLOAT_EQ(INT16_MAX * RTH_TRACKBACK_XY_RESOLUTION, pos.x);
+    EXPECT_FLOAT_EQ(INT16_MIN * RTH_TRACKBACK_XY_RESOLUTION, pos.y);
+    EXPECT_FLOAT_EQ(INT16_MAX * RTH_TRACKBACK_Z_RESOLUTION, pos.z);
+}
+
+TEST(RthTrackbackTest, CancelledTrackbackResumesFromActivePoint)
+{
+    static rthTrackback_t tb;
+    rthTrackbackReset(&tb);
+
+    // Outbound leg A..E
+    for (int ii = 0; ii < 5; ii++) {
+        const fpVector3_t pos = makePos(ii * 100000.0f, 0, 5000);
+        rthTrackbackAddPoint(&tb, &pos);
+    }
+
+    // Trackback flies E, D and C, then RTH is cancelled with C active
+    const unsigned activeIndex = 2;
+
+    // Recording resumes on a new leg heading away from the track
+    rthTrackbackTruncate(&tb, activeIndex + 1);
+    for (int ii = 1; ii <= 2; ii++) {
+        const fpVector3_t pos = makePos(200000.0f, ii * 100000.0f, 5000);
+        rthTrackbackAddPoint(&tb, &pos);
+    }
+
+    // The next trackback replays the new leg, then C, B and A, never E or D
+    const float expectedY[] = { 200000.0f, 100000.0f, 0, 0, 0 };
+    const float expectedX[] = { 200000.0f, 200000.0f, 200000.0f, 100000.0f, 0 };
+    ASSERT_EQ(5, tb.count);
+    for (int ii = tb.count - 1, step = 0; ii >= 0; ii--, step++) {
+        fpVector3_t pos;
+        rthTrackbackGetPoint(&tb, ii, &pos);
+        EXPECT_FLOAT_EQ(expectedX[step], pos.x);
+        EXPECT_FLOAT_EQ(expectedY[step], pos.y);
+    }
+
+    // Truncating past the end keeps everything
+    rthTrackbackTruncate(&tb, RTH_TRACKBACK_POINTS);
+    EXPECT_EQ(5, tb.count);
+}
@@ -0,0 +1,377 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+    #include "common/maths.h"
+    #include "scheduler/scheduler.h"
+
+    typedef struct {
+        cfTask_t *tasks[TASK_COUNT];
+        int size;
+    } taskHeap_t;
+
+    extern taskHeap_t timedTaskHeap;
+    extern taskHeap_t idleTaskHeap;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Simulated execution times of the tasks in microseconds, roughly a F7 board at 2kHz PID
+enum {
+    gyroTime = 25,
+    pidTime = 150,
+    systemTime = 5,
+    serialTime = 20,
+    batteryTime = 5,
+    temperatureTime = 2,
+    rxCheckTime = 2,
+    rxMainTime = 40,
+    gpsTime = 30,
+    compassTime = 40,
+    baroTime = 30,
+    dashboardTime = 60,
+    telemetryTime = 10,
+    ledStripTime = 15,
+    osdTime = 80,
+    cmsTime = 10,
+    programmingTime = 20,
+    rpmFilterTime = 10,
+    auxTime = 15,
+    idleSpinTime = 2,
+    rxFramePeriod = 6666,
+};
+
+extern "C" {
+    // set up micros() to simulate time
+    static timeUs_t simulatedTime = 0;
+    static timeUs_t nextRxFrameAt = 0;
+    static uint32_t executions[TASK_COUNT];
+    static timeDelta_t maxLateness[TASK_COUNT];
+    static uint64_t totalLateness[TASK_COUNT];
+
+    timeUs_t micros(void) { return simulatedTime; }
+
+    static void accountTask(cfTaskId_e taskId, timeUs_t executionTime)
+    {
+        const cfTask_t *task = &cfTasks[taskId];
+        if (executions[taskId] > 0 && !task->checkFunc) {
+            const timeDelta_t lateness = task->taskLatestDeltaTime - task->desiredPeriod;
+            maxLateness[taskId] = MAX(maxLateness[taskId], lateness);
+            totalLateness[taskId] += MAX(lateness, 0);
+        }
+        executions[taskId]++;
+        simulatedTime += executionTime;
+    }
+
+    void taskRunRealtimeCallbacks(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); simulatedTime += idleSpinTime; }
+    static void taskGyro(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_GYRO, gyroTime); }
+    static void taskMainPidLoop(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_PID, pidTime); }
+    static void taskSystemWrapper(timeUs_t currentTimeUs) { taskSystem(currentTimeUs); accountTask(TASK_SYSTEM, systemTime); }
+    static void taskHandleSerial(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_SERIAL, serialTime); }
+    static void taskUpdateBattery(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_BATTERY, batteryTime); }
+    static void taskUpdateTemperature(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_TEMPERATURE, temperatureTime); }
+    static bool taskUpdateRxCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+    {
+        UNUSED(currentDeltaTimeUs);
+        simulatedTime += rxCheckTime;
+        return (timeDelta_t)(currentTimeUs - nextRxFrameAt) >= 0;
+    }
+    static void taskUpdateRxMain(timeUs_t currentTimeUs) { nextRxFrameAt = currentTimeUs + rxFramePeriod; accountTask(TASK_RX, rxMainTime); }
+    static void taskProcessGPS(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_GPS, gpsTime); }
+    static void taskUpdateCompass(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_COMPASS, compassTime); }
+    static void taskUpdateBaro(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_BARO, baroTime); }
+    static void taskDashboardUpdate(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_DASHBOARD, dashboardTime); }
+    static void taskTelemetry(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_TELEMETRY, telemetryTime); }
+    static void taskLedStrip(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_LEDSTRIP, ledStripTime); }
+    static void taskUpdateOsd(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_OSD, osdTime); }
+    static void cmsHandler(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_CMS, cmsTime); }
+    static void programmingFrameworkUpdateTask(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_PROGRAMMING_FRAMEWORK, programmingTime); }
+    static void rpmFilterUpdateTask(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_RPM_FILTER, rpmFilterTime); }
+    static void taskUpdateAux(timeUs_t currentTimeUs) { UNUSED(currentTimeUs); accountTask(TASK_AUX, auxTime); }
+
+    cfTask_t cfTasks[TASK_COUNT] = {};
+}
+
+static void defineTask(cfTaskId_e taskId, const char *taskName,
+                       bool (*checkFunc)(timeUs_t, timeDelta_t), void (*taskFunc)(timeUs_t),
+                       timeDelta_t desiredPeriod, uint8_t staticPriority)
+{
+    const cfTask_t task = { taskName, checkFunc, taskFunc, desiredPeriod, staticPriority, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    memcpy((void *)&cfTasks[taskId], &task, sizeof(task));
+}
+
+// Same task set as fc_tasks.c
+static void defineTasks(void)
+{
+    memset((void *)cfTasks, 0, sizeof(cfTasks));
+    defineTask(TASK_SYSTEM, "SYSTEM", NULL, taskSystemWrapper, TASK_PERIOD_HZ(10), TASK_PRIORITY_HIGH);
+    defineTask(TASK_PID, "PID", NULL, taskMainPidLoop, TASK_PERIOD_US(500), TASK_PRIORITY_REALTIME);
+    defineTask(TASK_GYRO, "GYRO", NULL, taskGyro, TASK_PERIOD_US(250), TASK_PRIORITY_REALTIME);
+    defineTask(TASK_SERIAL, "SERIAL", NULL, taskHandleSerial, TASK_PERIOD_HZ(100), TASK_PRIORITY_LOW);
+    defineTask(TASK_BATTERY, "BATTERY", NULL, taskUpdateBattery, TASK_PERIOD_HZ(50), TASK_PRIORITY_MEDIUM);
+    defineTask(TASK_TEMPERATURE, "TEMPERATURE", NULL, taskUpdateTemperature, TASK_PERIOD_HZ(100), TASK_PRIORITY_LOW);
+    defineTask(TASK_RX, "RX", taskUpdateRxCheck, taskUpdateRxMain, TASK_PERIOD_HZ(10), TASK_PRIORITY_HIGH);
+    defineTask(TASK_GPS, "GPS", NULL, taskProcessGPS, TASK_PERIOD_HZ(50), TASK_PRIORITY_MEDIUM);
+    defineTask(TASK_COMPASS, "COMPASS", NULL, taskUpdateCompass, TASK_PERIOD_HZ(10), TASK_PRIORITY_MEDIUM);
+    defineTask(TASK_BARO, "BARO", NULL, taskUpdateBaro, TASK_PERIOD_HZ(20), TASK_PRIORITY_MEDIUM);
+    defineTask(TASK_DASHBOARD, "DASHBOARD", NULL, taskDashboardUpdate, TASK_PERIOD_HZ(10), TASK_PRIORITY_LOW);
+    defineTask(TASK_TELEMETRY, "TELEMETRY", NULL, taskTelemetry, TASK_PERIOD_HZ(500), TASK_PRIORITY_IDLE);
+    defineTask(TASK_LEDSTRIP, "LEDSTRIP", NULL, taskLedStrip, TASK_PERIOD_HZ(100), TASK_PRIORITY_IDLE);
+    defineTask(TASK_OSD, "OSD", NULL, taskUpdateOsd, TASK_PERIOD_HZ(250), TASK_PRIORITY_LOW);
+    defineTask(TASK_CMS, "CMS", NULL, cmsHandler, TASK_PERIOD_HZ(50), TASK_PRIORITY_LOW);
+    defineTask(TASK_PROGRAMMING_FRAMEWORK, "PROGRAMMING", NULL, programmingFrameworkUpdateTask, TASK_PERIOD_HZ(10), TASK_PRIORITY_IDLE);
+    defineTask(TASK_RPM_FILTER, "RPM", NULL, rpmFilterUpdateTask, TASK_PERIOD_HZ(300), TASK_PRIORITY_LOW);
+    defineTask(TASK_AUX, "AUX", NULL, taskUpdateAux, TASK_PERIOD_HZ(100), TASK_PRIORITY_HIGH);
+}
+
+static void enableAllTasks(void)
+{
+    simulatedTime = 0;
+    nextRxFrameAt = 0;
+    memset(executions, 0, sizeof(executions));
+    memset(maxLateness, 0, sizeof(maxLateness));
+    memset(totalLateness, 0, sizeof(totalLateness));
+
+    defineTasks();
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        if (cfTasks[taskId].taskFunc) {
+            setTaskEnabled((cfTaskId_e)taskId, true);
+        }
+    }
+}
+
+static void expectHeapOrdered(const taskHeap_t *heap)
+{
+    for (int ii = 1; ii < heap->size; ii++) {
+        const cfTask_t *parent = heap->tasks[(ii - 1) / 2];
+        const cfTask_t *child = heap->tasks[ii];
+        EXPECT_LE((timeDelta_t)((parent->lastExecutedAt + parent->desiredPeriod) - (child->lastExecutedAt + child->desiredPeriod)), 0);
+    }
+}
+
+TEST(SchedulerDeadlineUnittest, TestQueueMembership)
+{
+    enableAllTasks();
+
+    // GYRO and PID are realtime, RX is event driven, TELEMETRY, LEDSTRIP and PROGRAMMING are idle
+    EXPECT_EQ(3, idleTaskHeap.size);
+    EXPECT_EQ(TASK_COUNT - 6, timedTaskHeap.size);
+    expectHeapOrdered(&timedTaskHeap);
+    expectHeapOrdered(&idleTaskHeap);
+
+    setTaskEnabled(TASK_OSD, false);
+    EXPECT_EQ(TASK_COUNT - 7, timedTaskHeap.size);
+    expectHeapOrdered(&timedTaskHeap);
+
+    // Enabling twice must not duplicate the task
+    setTaskEnabled(TASK_OSD, true);
+    setTaskEnabled(TASK_OSD, true);
+    EXPECT_EQ(TASK_COUNT - 6, timedTaskHeap.size);
+
+    setTaskEnabled(TASK_TELEMETRY, false);
+    EXPECT_EQ(2, idleTaskHeap.size);
+    expectHeapOrdered(&idleTaskHeap);
+}
+
+TEST(SchedulerDeadlineUnittest, TestRescheduleKeepsHeapOrder)
+{
+    enableAllTasks();
+
+    for (int ii = 0; ii < 2000; ii++) {
+        scheduler();
+        expectHeapOrdered(&timedTaskHeap);
+        expectHeapOrdered(&idleTaskHeap);
+    }
+
+    rescheduleTask(TASK_COMPASS, TASK_PERIOD_HZ(1000));
+    expectHeapOrdered(&timedTaskHeap);
+    rescheduleTask(TASK_SERIAL, TASK_PERIOD_HZ(1));
+    expectHeapOrdered(&timedTaskHeap);
+}
+
+TEST(SchedulerDeadlineUnittest, TestIdleTasksRunOnlyWhenNothingElseIsDue)
+{
+    enableAllTasks();
+
+    // Make every task except telemetry not due
+    simulatedTime = 1000000;
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        cfTasks[taskId].lastExecutedAt = simulatedTime;
+    }
+    cfTasks[TASK_TELEMETRY].lastExecutedAt = simulatedTime - TASK_PERIOD_HZ(500);
+    nextRxFrameAt = simulatedTime + rxFramePeriod;
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        setTaskEnabled((cfTaskId_e)taskId, true);
+    }
+
+    // Overdue idle task is executed if nothing else is waiting
+    scheduler();
+    EXPECT_EQ(1U, executions[TASK_TELEMETRY]);
+
+    // A due non-idle task is preferred to an overdue idle task
+    cfTasks[TASK_TELEMETRY].lastExecutedAt = simulatedTime - 10 * TASK_PERIOD_HZ(500);
+    cfTasks[TASK_BATTERY].lastExecutedAt = simulatedTime - TASK_PERIOD_HZ(50);
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        setTaskEnabled((cfTaskId_e)taskId, true);
+    }
+    scheduler();
+    EXPECT_EQ(1U, executions[TASK_BATTERY]);
+    EXPECT_EQ(1U, executions[TASK_TELEMETRY]);
+}
+
+TEST(SchedulerDeadlineUnittest, TestReplayTaskSet)
+{
+    enableAllTasks();
+
+    const timeUs_t simulationTimeUs = 10 * 1000000;
+    uint32_t schedulerCalls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (simulatedTime < simulationTimeUs) {
+        scheduler();
+        schedulerCalls++;
+    }
+    const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[ SCHEDULER ] %u scheduler() calls, %.1f ns per call (selection + simulated tasks)\n",
+        schedulerCalls, (double)elapsedNs / schedulerCalls);
+    printf("[ SCHEDULER ] %-12s %8s %8s %12s %12s\n", "task", "runs", "expected", "avg late us", "max late us");
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        const cfTask_t *task = &cfTasks[taskId];
+        const uint32_t expected = task->checkFunc ? simulationTimeUs / rxFramePeriod : simulationTimeUs / task->desiredPeriod;
+        printf("[ SCHEDULER ] %-12s %8u %8u %12.1f %12d\n", task->taskName, executions[taskId], expected,
+            executions[taskId] > 1 ? (double)totalLateness[taskId] / (executions[taskId] - 1) : 0.0, maxLateness[taskId]);
+    }
+
+    // Realtime tasks are never starved and are late by less than the longest non-realtime task
+    EXPECT_GE(executions[TASK_GYRO], 0.95 * simulationTimeUs / cfTasks[TASK_GYRO].desiredPeriod);
+    EXPECT_GE(executions[TASK_PID], 0.95 * simulationTimeUs / cfTasks[TASK_PID].desiredPeriod);
+    EXPECT_LT(maxLateness[TASK_GYRO], pidTime + osdTime);
+
+    // Every other task gets to run at its desired rate within a reasonable margin
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        const cfTask_t *task = &cfTasks[taskId];
+        const uint32_t expected = task->checkFunc ? simulationTimeUs / rxFramePeriod : simulationTimeUs / task->desiredPeriod;
+        EXPECT_GE(executions[taskId], 0.8 * expected) << task->taskName;
+    }
+}
+
+TEST(SchedulerDeadlineUnittest, TestHistograms)
+{
+    enableAllTasks();
+    schedulerResetTaskHistograms();
+
+    while (simulatedTime < 1000000) {
+        scheduler();
+    }
+
+    taskHistogram_t histogram;
+
+    // OSD always takes 80us, which falls into [64, 128) bucket
+    EXPECT_TRUE(getTaskHistogram(TASK_OSD, TASK_HISTOGRAM_EXECUTION, &histogram));
+    EXPECT_EQ(executions[TASK_OSD], histogram.bucket[7]);
+    EXPECT_EQ(7U, taskHistogramPercentileBucket(&histogram, 50));
+    EXPECT_EQ(128U, taskHistogramBucketLimit(7));
+
+    // Blocking is tracked only for realtime tasks, and GYRO is held off by other tasks at some point
+    EXPECT_FALSE(getTaskHistogram(TASK_OSD, TASK_HISTOGRAM_BLOCKED, &histogram));
+    EXPECT_TRUE(getTaskHistogram(TASK_GYRO, TASK_HISTOGRAM_BLOCKED, &histogram));
+    uint32_t blocked = 0;
+    for (int ii = 0; ii < TASK_HISTOGRAM_BUCKET_COUNT; ii++) {
+        blocked += histogram.bucket[ii];
+    }
+    EXPECT_GT(blocked, 0U);
+
+    // Lateness never exceeds the longest task by much
+    EXPECT_TRUE(getTaskHistogram(TASK_GYRO, TASK_HISTOGRAM_LATENESS, &histogram));
+    EXPECT_LE(taskHistogramBucketLimit(taskHistogramPercentileBucket(&histogram, 100)), 256U);
+
+    schedulerResetTaskHistograms();
+    EXPECT_TRUE(getTaskHistogram(TASK_OSD, TASK_HISTOGRAM_EXECUTION, &histogram));
+    EXPECT_EQ(0, histogram.bucket[7]);
+}
+
+static void makeNothingDue(void)
+{
+    simulatedTime = 1000000;
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        cfTasks[taskId].lastExecutedAt = simulatedTime;
+    }
+    nextRxFrameAt = simulatedTime;
+}
+
+TEST(SchedulerDeadlineUnittest, TestSignaledTaskRunsAheadOfTimedTasks)
+{
+    enableAllTasks();
+    makeNothingDue();
+
+    // AUX is three periods overdue, which outweighs a polled RX frame
+    cfTasks[TASK_AUX].lastExecutedAt = simulatedTime - 3 * TASK_PERIOD_HZ(100);
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        setTaskEnabled((cfTaskId_e)taskId, true);
+    }
+    scheduler();
+    EXPECT_EQ(1U, executions[TASK_AUX]);
+    EXPECT_EQ(0U, executions[TASK_RX]);
+    scheduler();
+    EXPECT_EQ(1U, executions[TASK_RX]);
+
+    // The same frame signaled by the driver goes first
+    enableAllTasks();
+    makeNothingDue();
+    cfTasks[TASK_AUX].lastExecutedAt = simulatedTime - 3 * TASK_PERIOD_HZ(100);
+    schedulerInit();
+    for (int taskId = 0; taskId < TASK_COUNT; taskId++) {
+        setTaskEnabled((cfTaskId_e)taskId, true);
+    }
+    schedulerResetTaskHistograms();
+    const timeUs_t frameAt = simulatedTime - 100;
+    schedulerSignalTask(TASK_RX, frameAt);
+    scheduler();
+    EXPECT_EQ(0U, executions[TASK_AUX]);
+    EXPECT_EQ(1U, executions[TASK_RX]);
+    EXPECT_EQ(frameAt, cfTasks[TASK_RX].lastSignaledAt);
+    EXPECT_FALSE(cfTasks[TASK_RX].signalPending);
+
+    // Lateness is accounted from the time the frame was signaled, [64, 128) bucket
+    taskHistogram_t histogram;
+    EXPECT_TRUE(getTaskHistogram(TASK_RX, TASK_HISTOGRAM_LATENESS, &histogram));
+    EXPECT_EQ(1U, histogram.bucket[7]);
+
+    // Overdue realtime tasks still go first
+    simulatedTime += TASK_PERIOD_US(500);
+    nextRxFrameAt = simulatedTime;
+    schedulerSignalTask(TASK_RX, simulatedTime);
+    scheduler();
+    EXPECT_EQ(1U, executions[TASK_RX]);
+    scheduler();
+    scheduler();
+    EXPECT_EQ(2U, executions[TASK_RX]);
+    EXPECT_EQ(1U, executions[TASK_GYRO]);
+    EXPECT_EQ(1U, executions[TASK_PID]);
+}
@@ -0,0 +1,356 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks the compiled servo mixer against the rule by rule mixer it
+ * replaced, over a corpus of random mixer configurations and flight
+ * states.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+    #include "config/parameter_group.h"
+
+    #include "drivers/pwm_output.h"
+
+    #include "fc/config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/servos.h"
+
+    #include "programming/global_variables.h"
+    #include "programming/logic_condition.h"
+
+    #include "rx/rx.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define CORPUS_CONFIGS      500
+#define CORPUS_STEPS        50
+#define RX_CHANNELS         16
+#define GVAR_COUNT          8
+#define CONDITION_COUNT     4
+
+static const float dT = 0.001f;
+
+static int16_t rxChannels[RX_CHANNELS];
+static int32_t gvars[GVAR_COUNT];
+static bool conditions[CONDITION_COUNT];
+static bool camstabActive;
+static uint32_t seed;
+
+static uint32_t nextRandom(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static int randomRange(int min, int max)
+{
+    return min + (int)(nextRandom() % (uint32_t)(max - min + 1));
+}
+
+/*
+ * The mixer as it was before the rules were compiled
+ */
+static int16_t referenceServo[MAX_SUPPORTED_SERVOS];
+static rateLimitFilter_t referenceSpeedLimitFilter[MAX_SERVO_RULES];
+
+static void referenceServoMixer(float dT)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    int ruleCount = 0;
+    int16_t input[INPUT_SOURCE_COUNT];
+
+    for (int i = 0; i < MAX_SERVO_RULES && customServoMixers(i)->rate != 0; i++) {
+        rules[ruleCount++] = *customServoMixers(i);
+    }
+
+    if (FLIGHT_MODE(MANUAL_MODE)) {
+        input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
+        input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
+        input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
+    } else {
+        input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
+        input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
+        input[INPUT_STABILIZED_YAW] = axisPID[YAW];
+
+        if (feature(FEATURE_REVERSIBLE_MOTORS) && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE) &&
+        (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER)) {
+            input[INPUT_STABILIZED_YAW] *= -1;
+        }
+    }
+
+    input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
+    input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
+    input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
+    input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
+    input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
+    input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+
+    input[INPUT_FEATURE_FLAPS] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
+
+    input[INPUT_MAX] = 500;
+    for (int i = 0; i < GVAR_COUNT; i++) {
+        input[INPUT_GVAR_0 + i] = constrain(gvGet(i), -1000, 1000);
+    }
+
+    if (IS_RC_MODE_ACTIVE(BOXCAMSTAB)) {
+        input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -900, 900, -500, +500);
+        input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+    } else {
+        input[INPUT_GIMBAL_PITCH] = 0;
+        input[INPUT_GIMBAL_ROLL] = 0;
+    }
+
+    input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;
+
+    for (int i = 0; i < 8; i++) {
+        input[INPUT_RC_ROLL + i] = rxGetChannelValue(ROLL + i) - PWM_RANGE_MIDDLE;
+        input[INPUT_RC_CH9 + i] = rxGetChannelValue(AUX5 + i) - PWM_RANGE_MIDDLE;
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        referenceServo[i] = 0;
+    }
+
+    for (int i = 0; i < ruleCount; i++) {
+        if (!logicConditionGetValue(rules[i].conditionId)) {
+            continue;
+        }
+
+        const uint8_t target = rules[i].targetChannel;
+        const uint8_t from = rules[i].inputSource;
+
+        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&referenceSpeedLimitFilter[i], input[from], rules[i].speed * 10, dT);
+
+        referenceServo[target] += ((int32_t)inputLimited * rules[i].rate) / 100;
+    }
+
+    if (!ARMING_FLAG(ARMED)) {
+        for (int i = 0; i < ruleCount; i++) {
+            const uint8_t target = rules[i].targetChannel;
+            const uint8_t from = rules[i].inputSource;
+
+            if (from == INPUT_STABILIZED_THROTTLE || from == INPUT_RC_THROTTLE) {
+                referenceServo[target] = motorConfig()->mincommand;
+            }
+        }
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        const float scaleMax = (servoParams(i)->max - servoParams(i)->middle) / 500.0f;
+        const float scaleMin = (servoParams(i)->middle - servoParams(i)->min) / 500.0f;
+
+        referenceServo[i] = ((int32_t)servoParams(i)->rate * referenceServo[i]) / 100L;
+
+        if (referenceServo[i] > 0) {
+            referenceServo[i] = (int16_t) (referenceServo[i] * scaleMax);
+        } else {
+            referenceServo[i] = (int16_t) (referenceServo[i] * scaleMin);
+        }
+
+        referenceServo[i] += servoParams(i)->middle;
+        referenceServo[i] = constrain(referenceServo[i], servoParams(i)->min, servoParams(i)->max);
+    }
+}
+
+static void randomizeConfig(void)
+{
+    const int ruleCount = randomRange(0, MAX_SERVO_RULES);
+    // Few targets make rules share outputs, many spread them out
+    const int targetCount = randomRange(1, MAX_SUPPORTED_SERVOS);
+
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        servoMixer_t *rule = customServoMixersMutable(i);
+
+        if (i < ruleCount) {
+            rule->targetChannel = randomRange(0, targetCount - 1);
+            rule->inputSource = randomRange(0, INPUT_SOURCE_COUNT - 1);
+            rule->rate = randomRange(-1000, 999);
+            if (rule->rate >= 0) {
+                rule->rate++;
+            }
+            rule->speed = (nextRandom() & 1) ? 0 : randomRange(1, MAX_SERVO_SPEED);
+            rule->conditionId = randomRange(-1, CONDITION_COUNT - 1);
+        } else {
+            memset(rule, 0, sizeof(*rule));
+            rule->conditionId = -1;
+        }
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        servoParam_t *param = servoParamsMutable(i);
+
+        param->min = randomRange(SERVO_OUTPUT_MIN, 1400);
+        param->max = randomRange(1600, SERVO_OUTPUT_MAX);
+        param->middle = randomRange(param->min, param->max);
+        param->rate = randomRange(-125, 125);
+    }
+
+    servoConfigMutable()->flaperon_throw_offset = randomRange(FLAPERON_THROW_MIN, FLAPERON_THROW_MAX);
+    motorConfigMutable()->mincommand = randomRange(900, 1100);
+    mixerConfigMutable()->platformType = randomRange(PLATFORM_MULTIROTOR, PLATFORM_OTHER);
+    featureConfigMutable()->enabledFeatures = (nextRandom() & 1) ? FEATURE_REVERSIBLE_MOTORS : 0;
+}
+
+static void randomizeFlightState(void)
+{
+    for (int axis = 0; axis < 3; axis++) {
+        rcCommand[axis] = randomRange(-500, 500);
+        axisPID[axis] = randomRange(-700, 700);
+    }
+    for (int i = 0; i < RX_CHANNELS; i++) {
+        rxChannels[i] = randomRange(PWM_RANGE_MIN, PWM_RANGE_MAX);
+    }
+    for (int i = 0; i < GVAR_COUNT; i++) {
+        gvars[i] = randomRange(-1500, 1500);
+    }
+    for (int i = 0; i < CONDITION_COUNT; i++) {
+        conditions[i] = nextRandom() & 1;
+    }
+
+    attitude.values.roll = randomRange(-1800, 1800);
+    attitude.values.pitch = randomRange(-900, 900);
+    mixerThrottleCommand = randomRange(1000, 2000);
+    camstabActive = nextRandom() & 1;
+
+    flightModeFlags = 0;
+    if (nextRandom() & 1) {
+        flightModeFlags |= MANUAL_MODE;
+    }
+    if (nextRandom() & 1) {
+        flightModeFlags |= FLAPERON;
+    }
+    armingFlags = (nextRandom() & 3) ? ARMED : 0;
+}
+
+TEST(ServoMixerTest, CompiledMixerMatchesReference)
+{
+    seed = 0x5e12f0;
+
+    for (int config = 0; config < CORPUS_CONFIGS; config++) {
+        randomizeConfig();
+
+        // Speed limit filters are kept across configurations by both mixers,
+        // indexed by rule, so they stay in step without a reset
+        servosInit();
+
+        for (int step = 0; step < CORPUS_STEPS; step++) {
+            randomizeFlightState();
+
+            servoMixer(dT);
+            referenceServoMixer(dT);
+
+            for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+                ASSERT_EQ(referenceServo[i], servo[i]) << "config " << config << " step " << step << " servo " << i;
+            }
+        }
+    }
+}
+
+TEST(ServoMixerTest, FlyingWing)
+{
+    const servoMixer_t rules[] = {
+        { .targetChannel = 3, .inputSource = INPUT_STABILIZED_ROLL,  .rate = 50,  .speed = 0, .conditionId = -1 },
+        { .targetChannel = 3, .inputSource = INPUT_STABILIZED_PITCH, .rate = 50,  .speed = 0, .conditionId = -1 },
+        { .targetChannel = 4, .inputSource = INPUT_STABILIZED_ROLL,  .rate = -50, .speed = 0, .conditionId = -1 },
+        { .targetChannel = 4, .inputSource = INPUT_STABILIZED_PITCH, .rate = 50,  .speed = 0, .conditionId = -1 },
+    };
+
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        memset(customServoMixersMutable(i), 0, sizeof(servoMixer_t));
+    }
+    memcpy(customServoMixersMutable(0), rules, sizeof(rules));
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        servoParamsMutable(i)->min = 1000;
+        servoParamsMutable(i)->max = 2000;
+        servoParamsMutable(i)->middle = 1500;
+        servoParamsMutable(i)->rate = 100;
+    }
+
+    flightModeFlags = 0;
+    armingFlags = ARMED;
+    featureConfigMutable()->enabledFeatures = 0;
+    axisPID[ROLL] = 200;
+    axisPID[PITCH] = 100;
+
+    servosInit();
+    servoMixer(dT);
+
+    EXPECT_EQ(1650, servo[3]);
+    EXPECT_EQ(1450, servo[4]);
+    EXPECT_EQ(1500, servo[0]);
+    EXPECT_EQ(1500, servo[MAX_SUPPORTED_SERVOS - 1]);
+}
+
+// STUBS
+
+extern "C" {
+int16_t rcCommand[4];
+int16_t axisPID[3];
+int32_t axisPID_I[3];
+int mixerThrottleCommand;
+attitudeEulerAngles_t attitude;
+fpVector3_t imuMeasuredRotationBF;
+uint32_t flightModeFlags;
+uint32_t armingFlags;
+timeMs_t millis(void) { return 0; }
+
+featureConfig_t featureConfig_System;
+motorConfig_t motorConfig_System;
+mixerConfig_t mixerConfig_System;
+
+bool feature(uint32_t mask) { return featureConfig()->enabledFeatures & mask; }
+bool IS_RC_MODE_ACTIVE(boxId_e boxId) { return boxId == BOXCAMSTAB && camstabActive; }
+int16_t rxGetChannelValue(unsigned channelNumber) { return rxChannels[channelNumber]; }
+int32_t gvGet(uint8_t index) { return gvars[index]; }
+int logicConditionGetValue(int8_t conditionId) { return conditionId < 0 || conditions[conditionId]; }
+
+uint32_t getLooptime(void) { return 1000; }
+void pwmWriteServo(uint8_t, uint16_t) {}
+void saveConfigAndNotify(void) {}
+void pidResetErrorAccumulators(void) {}
+void pidReduceErrorAccumulators(int8_t, uint8_t) {}
+float getTotalRateTarget(void) { return 0; }
+float getAxisIterm(uint8_t) { return 0; }
+float getFixedWingLevelTrim(void) { return 0; }
+bool areSticksDeflected(void) { return false; }
+bool isGPSHeadingValid(void) { return false; }
+}
@@ -0,0 +1,120 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/parameter_group.h"
+
+    #include "settings_generated.h"
+    #include "fc/settings.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(SettingsTest, EverySettingIsFound)
+{
+    char name[SETTING_MAX_NAME_LENGTH];
+    char buf[SETTING_MAX_NAME_LENGTH];
+
+    for (unsigned ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
+        const setting_t *setting = settingGet(ii);
+        settingGetName(setting, name);
+
+        EXPECT_EQ(setting, settingFind(name)) << name;
+        EXPECT_EQ(setting, settingFindIgnoringCase(name, strlen(name), buf)) << name;
+        EXPECT_STREQ(name, buf);
+    }
+}
+
+TEST(SettingsTest, UnknownNamesAreNotFound)
+{
+    char name[SETTING_MAX_NAME_LENGTH];
+    char buf[SETTING_MAX_NAME_LENGTH];
+
+    EXPECT_EQ(NULL, settingFind(""));
+    EXPECT_EQ(NULL, settingFind("not_a_setting"));
+
+    for (unsigned ii = 0; ii < SETTINGS_TABLE_COUNT; ii++) {
+        settingGetName(settingGet(ii), name);
+        const size_t length = strlen(name);
+
+        // Prefixes and extensions of a valid name must not match it
+        name[length - 1] = '\0';
+        const setting_t *prefix = settingFind(name);
+        if (prefix) {
+            EXPECT_STREQ(name, (settingGetName(prefix, buf), buf));
+        }
+
+        if (length + 1 < SETTING_MAX_NAME_LENGTH) {
+            settingGetName(settingGet(ii), name);
+            strcat(name, "x");
+            const setting_t *extended = settingFind(name);
+            if (extended) {
+                EXPECT_STREQ(name, (settingGetName(extended, buf), buf));
+            }
+        }
+    }
+}
+
+TEST(SettingsTest, FindIgnoringCase)
+{
+    char name[SETTING_MAX_NAME_LENGTH];
+    char upper[SETTING_MAX_NAME_LENGTH + 8];
+    char buf[SETTING_MAX_NAME_LENGTH];
+
+    const setting_t *setting = settingGet(SETTINGS_TABLE_COUNT / 2);
+    settingGetName(setting, name);
+
+    for (size_t ii = 0; ii <= strlen(name); ii++) {
+        upper[ii] = toupper(name[ii]);
+    }
+
+    // settingFind() is case sensitive
+    EXPECT_EQ(NULL, settingFind(upper));
+    EXPECT_EQ(setting, settingFindIgnoringCase(upper, strlen(upper), buf));
+    EXPECT_STREQ(name, buf);
+
+    // Only the first length characters are part of the name, as in "set name = value"
+    strcat(upper, " = 1");
+    EXPECT_EQ(setting, settingFindIgnoringCase(upper, strlen(name), buf));
+    EXPECT_EQ(NULL, settingFindIgnoringCase(upper, strlen(name) - 1, buf));
+    EXPECT_EQ(NULL, settingFindIgnoringCase(upper, strlen(upper), buf));
+}
+
+// STUBS
+extern "C" {
+const pgRegistry_t *pgFind(pgn_t)
+{
+    return NULL;
+}
+
+uint8_t getConfigProfile(void)
+{
+    return 0;
+}
+
+uint8_t getConfigBatteryProfile(void)
+{
+    return 0;
+}
+}
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 #define USE_MAG
 #define USE_BARO
 #define USE_GPS
@@ -52,3 +54,5 @@
 #define TARGET_IO_PORTB         0xffff
 #define TARGET_IO_PORTC         0xffff
 
+// Provided by newlib on the targets, tests using it define their own
+extern char *strnstr(const char *s, const char *find, size_t slen);
@@ -0,0 +1,212 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Checks the lookup table WS2811 encoder and the incremental strip update
+ * against the bit by bit encoder of every LED they replaced.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/color.h"
+    #include "common/colorconversion.h"
+
+    #include "drivers/io.h"
+    #include "drivers/timer.h"
+    #include "drivers/light_ws2811strip.h"
+
+    extern uint16_t dmaBufferOffset;
+    extern timerDMASafeType_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
+
+    void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define BIT_COMPARE_1 ((WS2811_TIMER_HZ / WS2811_CARRIER_HZ) * 2 / 3)
+#define BIT_COMPARE_0 ((WS2811_TIMER_HZ / WS2811_CARRIER_HZ) / 3)
+
+// Marks buffer entries that must not be written
+#define POISON 0xDEADBEEF
+
+static timerDMASafeType_t referenceBuffer[WS2811_DATA_BUFFER_SIZE];
+static uint32_t seed;
+
+static uint32_t nextRandom(void)
+{
+    seed = seed * 1664525 + 1013904223;
+    return seed >> 8;
+}
+
+static void referenceEncode(timerDMASafeType_t *dst, const rgbColor24bpp_t *color)
+{
+    uint32_t grb = (color->rgb.g << 16) | (color->rgb.r << 8) | (color->rgb.b);
+
+    for (int8_t index = 23; index >= 0; index--) {
+        *dst++ = (grb & (1 << index)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
+    }
+}
+
+static void referenceEncodeStrip(const hsvColor_t *colors)
+{
+    for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+        referenceEncode(&referenceBuffer[i * WS2811_BITS_PER_LED], hsvToRgb24(&colors[i]));
+    }
+}
+
+static hsvColor_t randomColor(void)
+{
+    hsvColor_t color;
+    color.h = nextRandom() % (HSV_HUE_MAX + 1);
+    color.s = nextRandom();
+    color.v = nextRandom();
+    return color;
+}
+
+TEST(WS2812, updateDMABuffer)
+{
+    rgbColor24bpp_t color1 = { .raw = {0xFF,0xAA,0x55} };
+
+    dmaBufferOffset = 0;
+    fastUpdateLEDDMABuffer(&color1);
+
+    EXPECT_EQ(24, dmaBufferOffset);
+
+    // GRB, MSB first
+    const uint8_t expected[3] = { 0xAA, 0xFF, 0x55 };
+    for (int byteIndex = 0; byteIndex < 3; byteIndex++) {
+        for (int bit = 0; bit < 8; bit++) {
+            const bool set = expected[byteIndex] & (0x80 >> bit);
+            EXPECT_EQ(set ? BIT_COMPARE_1 : BIT_COMPARE_0, ledStripDMABuffer[(byteIndex * 8) + bit]);
+        }
+    }
+}
+
+TEST(WS2812, encoderMatchesBitwiseForAllBytes)
+{
+    for (int value = 0; value < 256; value++) {
+        rgbColor24bpp_t color;
+        color.rgb.r = value;
+        color.rgb.g = value ^ 0x5A;
+        color.rgb.b = ~value;
+
+        referenceEncode(referenceBuffer, &color);
+
+        dmaBufferOffset = WS2811_BITS_PER_LED;
+        fastUpdateLEDDMABuffer(&color);
+
+        ASSERT_EQ(2 * WS2811_BITS_PER_LED, dmaBufferOffset);
+        ASSERT_EQ(0, memcmp(referenceBuffer, &ledStripDMABuffer[WS2811_BITS_PER_LED], WS2811_BITS_PER_LED * sizeof(timerDMASafeType_t))) << "value " << value;
+    }
+}
+
+TEST(WS2812, incrementalUpdateMatchesFullEncode)
+{
+    hsvColor_t colors[WS2811_LED_STRIP_LENGTH];
+
+    seed = 0x2811;
+    for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+        colors[i] = randomColor();
+    }
+
+    // Init clears the DMA buffer and encodes the whole strip
+    setStripColors(colors);
+    ws2811LedStripInit();
+    referenceEncodeStrip(colors);
+    ASSERT_EQ(0, memcmp(referenceBuffer, ledStripDMABuffer, sizeof(referenceBuffer)));
+
+    for (int frame = 0; frame < 2000; frame++) {
+        // A few LEDs change, some are overwritten and restored like overlapping layers do
+        bool changed[WS2811_LED_STRIP_LENGTH] = { false };
+        const int changes = nextRandom() % 4;
+        for (int n = 0; n < changes; n++) {
+            const int index = nextRandom() % WS2811_LED_STRIP_LENGTH;
+            colors[index] = randomColor();
+            changed[index] = true;
+        }
+
+        const int restored = nextRandom() % WS2811_LED_STRIP_LENGTH;
+        const hsvColor_t flash = randomColor();
+        setLedHsv(restored, &flash);
+
+        switch (nextRandom() % 3) {
+            case 0:
+                setStripColors(colors);
+                break;
+            case 1:
+                for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+                    setLedHsv(i, &colors[i]);
+                }
+                break;
+            case 2:
+                for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+                    setLedHsv(i, &colors[i]);
+                    if (changed[i]) {
+                        scaleLedValue(i, 50);
+                        colors[i].v = (uint16_t)colors[i].v * 50 / 100;
+                    }
+                }
+                break;
+        }
+
+        // LEDs that end up unchanged must not be encoded again
+        referenceEncodeStrip(colors);
+        for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+            if (!changed[i]) {
+                ledStripDMABuffer[i * WS2811_BITS_PER_LED] = POISON;
+            }
+        }
+
+        ws2811UpdateStrip();
+
+        for (int i = 0; i < WS2811_LED_STRIP_LENGTH; i++) {
+            timerDMASafeType_t *encoded = &ledStripDMABuffer[i * WS2811_BITS_PER_LED];
+            if (!changed[i]) {
+                ASSERT_EQ(POISON, encoded[0]) << "frame " << frame << " led " << i;
+                encoded[0] = referenceBuffer[i * WS2811_BITS_PER_LED];
+            }
+        }
+        ASSERT_EQ(0, memcmp(referenceBuffer, ledStripDMABuffer, sizeof(referenceBuffer))) << "frame " << frame;
+    }
+}
+
+// STUBS
+
+extern "C" {
+static timerHardware_t ws2811TimerHardware;
+static uint8_t ws2811Tch[sizeof(void *) * 16];
+
+const timerHardware_t * timerGetByTag(ioTag_t, timerUsageFlag_e) { return &ws2811TimerHardware; }
+TCH_t * timerGetTCH(const timerHardware_t *) { return (TCH_t *)ws2811Tch; }
+void timerConfigBase(TCH_t *, uint16_t, uint32_t) {}
+void timerPWMConfigChannel(TCH_t *, uint16_t) {}
+bool timerPWMConfigChannelDMA(TCH_t *, void *, uint8_t, uint32_t) { return true; }
+void timerPWMPrepareDMA(TCH_t *, uint32_t) {}
+void timerPWMStartDMA(TCH_t *) {}
+bool timerPWMDMAInProgress(TCH_t *) { return false; }
+
+IO_t IOGetByTag(ioTag_t) { return IO_NONE; }
+void IOInit(IO_t, resourceOwner_e, resourceType_e, uint8_t) {}
+void IOConfigGPIOAF(IO_t, ioConfig_t, uint8_t) {}
+}
@@ -38,6 +38,8 @@ DEBUG = false
 INFO = false
 
 SETTINGS_WORDS_BITS_PER_CHAR = 5
+# Bit offset of every Nth word is stored, see settingGetWord()
+SETTINGS_WORDS_OFFSET_STEP = 8
 
 def dputs(s)
     puts s if DEBUG
@@ -271,6 +273,85 @@ class ValueEncoder
     end
 end
 
+# Perfect hash over the setting names (hash and displace).
+# Names are first hashed into buckets, then each bucket gets the
+# smallest seed that maps all of its names to free slots. At runtime
+# a lookup costs two hashes and one name decode to verify the match.
+# Must be kept in sync with settingNameHash() in fc/settings.c
+class NameHash
+    FNV_OFFSET_BASIS = 2166136261
+    FNV_PRIME = 16777619
+    MAX_SEED = 255
+
+    attr_reader :buckets
+    attr_reader :seeds
+    attr_reader :slots
+
+    def self.hash(name, seed)
+        h = FNV_OFFSET_BASIS ^ seed
+        name.each_byte do |c|
+            h = ((h ^ c) * FNV_PRIME) & 0xffffffff
+        end
+        return h
+    end
+
+    def initialize(names)
+        # Seeds must fit in an uint8_t, so the last buckets to be placed need
+        # some free slots to choose from. Try every bucket load and a few
+        # slot table sizes, keeping the smallest hash that can be built.
+        best = nil
+        (0..8).each do |extra|
+            slot_count = names.length + (names.length * extra + 7) / 8
+            (1..6).each do |load|
+                bucket_count = [(names.length + load - 1) / load, 1].max
+                placed = place(names, bucket_count, slot_count)
+                next if placed.nil?
+                placed[:size] = bucket_count + slot_size(slot_count) * slot_count
+                best = placed if best.nil? || placed[:size] < best[:size]
+            end
+        end
+        raise "Could not build setting name hash" if best.nil?
+        @buckets = best[:seeds].length
+        @seeds = best[:seeds]
+        @slots = best[:slots]
+    end
+
+    def slot_type
+        slot_size(@slots.length) == 1 ? "uint8_t" : "uint16_t"
+    end
+
+    def size
+        @seeds.length + slot_size(@slots.length) * @slots.length
+    end
+
+    private
+
+    def slot_size(slot_count)
+        slot_count <= 256 ? 1 : 2
+    end
+
+    def place(names, bucket_count, slot_count)
+        by_bucket = Hash.new { |h, k| h[k] = [] }
+        names.each_with_index do |name, idx|
+            by_bucket[NameHash.hash(name, 0) % bucket_count] << idx
+        end
+        seeds = Array.new(bucket_count, 0)
+        slots = Array.new(slot_count, nil)
+        # Biggest buckets first, they're the hardest to place
+        by_bucket.keys.sort_by { |b| [-by_bucket[b].length, b] }.each do |b|
+            seed = (1..MAX_SEED).find do |seed|
+                candidate = by_bucket[b].map { |idx| NameHash.hash(names[idx], seed) % slot_count }
+                candidate.uniq.length == candidate.length && candidate.all? { |s| slots[s].nil? }
+            end
+            return nil if seed.nil?
+            by_bucket[b].each { |idx| slots[NameHash.hash(names[idx], seed) % slot_count] = idx }
+            seeds[b] = seed
+        end
+        # Unused slots can point anywhere, the name is always verified
+        return { :seeds => seeds, :slots => slots.map { |s| s || 0 } }
+    end
+end
+
 OFF_ON_TABLE = Hash["name" => "off_on", "values" => ["OFF", "ON"]]
 
 class Generator
@@ -303,6 +384,7 @@ class Generator
         sanitize_fields
         resolv_min_max_and_default_values_if_possible
         initialize_name_encoder
+        initialize_name_hash
         initialize_value_encoder
         validate_default_values
 
@@ -340,6 +422,7 @@ class Generator
         puts "name encoder uses #{word_idx} word indexing"
         puts "each setting name uses #{@name_encoder.max_length} bytes"
         puts "#{@name_encoder.estimated_size(@count)} bytes estimated for setting name storage"
+        puts "name hash uses #{@name_hash.buckets} buckets and #{@name_hash.slots.length} slots, #{@name_hash.size} bytes"
         values_size = @value_encoder.values.length * 4
         puts "min/max value storage uses #{values_size} bytes"
         value_idx_size = @value_encoder.index_bytes * 2
@@ -389,7 +472,10 @@ class Generator
             buf << "#define SETTING_ENCODED_NAME_USES_BYTE_INDEXING\n"
         end
         buf << "#define SETTINGS_WORDS_BITS_PER_CHAR #{SETTINGS_WORDS_BITS_PER_CHAR}\n"
+        buf << "#define SETTINGS_WORDS_OFFSET_STEP #{SETTINGS_WORDS_OFFSET_STEP}\n"
         buf << "#define SETTINGS_TABLE_COUNT #{@count}\n"
+        buf << "#define SETTING_NAME_HASH_BUCKETS #{@name_hash.buckets}\n"
+        buf << "#define SETTING_NAME_HASH_SLOTS #{@name_hash.slots.length}\n"
         offset_type = "uint16_t"
         if can_use_byte_offsetof
             offset_type = "uint8_t"
@@ -548,7 +634,13 @@ class Generator
             end
             acc_bits = (acc_bits + word_bits) % 8
         end
-        @name_encoder.words.each do |w|
+        word_offsets = Array.new
+        word_offset = 0
+        @name_encoder.words.each_with_index do |w, ii|
+            if ii % SETTINGS_WORDS_OFFSET_STEP == 0
+                word_offsets << word_offset
+            end
+            word_offset += (w.bytesize + 1) * word_bits
             buf << "\t"
             w.each_byte {|c| encode_byte.call(c)}
             encode_byte.call(0)
@@ -563,6 +655,13 @@ class Generator
         end
         buf << "};\n"
 
+        # Write the bit offsets of every SETTINGS_WORDS_OFFSET_STEP word
+        buf << "static const uint16_t settingNamesWordOffsets[] = {\n"
+        word_offsets.each_slice(8) do |offsets|
+            buf << "\t#{offsets.join(", ")},\n"
+        end
+        buf << "};\n"
+
         # Output symbol array
         buf << "static const char wordSymbols[] = {"
         symbols.each { |s| buf << "'#{s.chr}'," }
@@ -602,6 +701,19 @@ class Generator
             raise "can't encode indexed values requiring #{@value_encoder.index_bytes} bytes"
         end
 
+        # Write the name hash. Seeds are indexed by bucket, slots contain
+        # the index in settingsTable
+        buf << "static const uint8_t settingNameHashSeeds[] = {\n"
+        @name_hash.seeds.each_slice(16) do |s|
+            buf << "\t#{s.join(", ")},\n"
+        end
+        buf << "};\n"
+        buf << "static const #{@name_hash.slot_type} settingNameHashSlots[] = {\n"
+        @name_hash.slots.each_slice(16) do |s|
+            buf << "\t#{s.join(", ")},\n"
+        end
+        buf << "};\n"
+
         # Write setting_t values
         buf << "static const setting_t settingsTable[] = {\n"
 
@@ -1030,6 +1142,15 @@ class Generator
         @name_encoder = best
     end
 
+    def initialize_name_hash
+        names = []
+        foreach_enabled_member do |group, member|
+            names << member["name"]
+        end
+        @name_hash = NameHash.new(names)
+        dputs "Using #{@name_hash.buckets} buckets and #{@name_hash.slots.length} slots for the setting name hash"
+    end
+
     def initialize_value_encoder
         values = []
         constants = []